@@ -30,7 +30,7 @@
 
 
 #include <mysql/cdk/codec.h>
-#include <sstream>
+#include <mysql/cdk/foundation/varint.h>
 #include "../parser/json_parser.h"
 
 PUSH_SYS_WARNINGS
@@ -41,13 +41,13 @@ POP_SYS_WARNINGS
 
 PUSH_PB_WARNINGS
 #include <google/protobuf/wire_format_lite.h>
-#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 POP_PB_WARNINGS
 
 #undef min
 
 using namespace cdk;
 using namespace parser;
+namespace varint = cdk::foundation::varint;
 
 
 
@@ -140,15 +140,13 @@ struct zigzag<T, true>
       throw_error(cdkerrc::conversion_error,
                   "Codec<TYPE_INTEGER>: conversion overflow");
 
-    return google::protobuf::internal::WireFormatLite::ZigZagEncode64(
-             static_cast<int64_t>(val)
-           );
+    return varint::zigzag_encode(static_cast<int64_t>(val));
   }
 
   static
   T decode(uint64_t val)
   {
-    int64_t tmp = google::protobuf::internal::WireFormatLite::ZigZagDecode64(val);
+    int64_t tmp = varint::zigzag_decode(val);
 
     /*
       Note: to avoid singed/unsigned comparison we cast to uint64_t or
@@ -222,12 +220,9 @@ template <typename T>
 size_t Codec<TYPE_INTEGER>::internal_from_bytes(bytes buf, T &val)
 {
   uint64_t val_tmp;
+  size_t sz = varint::decode(buf.begin(), buf.end(), val_tmp);
 
-  assert(buf.size() < (size_t)std::numeric_limits<int>::max());
-
-  google::protobuf::io::CodedInputStream input_buffer(buf.begin(), (int)buf.size());
-
-  if (!input_buffer.ReadVarint64(&val_tmp))
+  if (0 == sz)
   {
     throw Error(cdkerrc::conversion_error,
                 "Codec<TYPE_INTEGER>: integer conversion error");
@@ -238,9 +233,6 @@ size_t Codec<TYPE_INTEGER>::internal_from_bytes(bytes buf, T &val)
   else
     val = zigzag_decode_signed<T>(val_tmp);
 
-  assert(input_buffer.CurrentPosition() >= 0);
-  size_t sz = static_cast<size_t>(input_buffer.CurrentPosition());
-
   return sz;
 }
 
@@ -293,13 +285,47 @@ size_t Codec<TYPE_INTEGER>::from_bytes(bytes buf, uint64_t &val)
 }
 
 
+size_t Codec<TYPE_INTEGER>::from_bytes(const bytes *fields, size_t count,
+                                       int64_t *vals, bool *nulls)
+{
+  const bool is_unsigned = m_fmt.is_unsigned();
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const byte *beg = fields[i].begin();
+    const byte *end = fields[i].end();
+
+    if (nulls)
+      nulls[i] = (beg == end);
+
+    if (beg == end)
+    {
+      vals[i] = 0;
+      continue;
+    }
+
+    uint64_t val;
+
+    if (0 == varint::decode(beg, end, val))
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_INTEGER>: integer conversion error");
+
+    if (!is_unsigned)
+      vals[i] = varint::zigzag_decode(val);
+    else if (val <= (uint64_t)std::numeric_limits<int64_t>::max())
+      vals[i] = (int64_t)val;
+    else
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_INTEGER>: conversion overflow");
+  }
+
+  return count;
+}
+
+
 template <typename T>
 size_t Codec<TYPE_INTEGER>::internal_to_bytes(T val, bytes buf)
 {
-  assert(buf.size() < (size_t)std::numeric_limits<int>::max());
-  google::protobuf::io::ArrayOutputStream buffer(buf.begin(), (int)buf.size());
-  google::protobuf::io::CodedOutputStream output_buffer(&buffer);
-
   uint64_t val_tmp;
 
   if (m_fmt.is_unsigned())
@@ -307,13 +333,13 @@ size_t Codec<TYPE_INTEGER>::internal_to_bytes(T val, bytes buf)
   else
     val_tmp = zigzag_encode_signed(val);
 
-  output_buffer.WriteVarint64(val_tmp);
+  size_t sz = varint::encode(val_tmp, buf.begin(), buf.end());
 
-  if (output_buffer.HadError())
+  if (0 == sz)
     throw Error(cdkerrc::conversion_error,
                 "Codec<TYPE_INTEGER>: buffer to small");
 
-  return static_cast<size_t>(output_buffer.ByteCount());
+  return sz;
 }
 
 
@@ -364,63 +390,357 @@ size_t Codec<TYPE_INTEGER>::to_bytes(uint64_t val, bytes buf)
   return internal_to_bytes(val, buf);
 }
 
-std::string Codec<TYPE_FLOAT>::internal_decimal_to_string(bytes buf)
+/*
+  Decoding DECIMAL values
+  -----------------------
+  Server sends DECIMAL values in packed BCD format: the first byte holds
+  the scale, followed by decimal digits stored two per byte, followed by
+  sign nibble which is 0xC for positive and 0xD for negative values. If the
+  number of digits is odd, the sign nibble is the low nibble of the last
+  byte, otherwise the whole last byte is the sign (and its low nibble is
+  ignored).
+
+  Values are decoded directly from the BCD digits. Conversion to floating
+  point numbers uses exact arithmetic when possible and falls back to
+  strtod()/strtof() on a string in exponential notation, which does not
+  depend on locale settings.
+*/
+
+namespace {
+
+class Packed_decimal
 {
-  if (buf.size() < 2)
-    THROW("Invalid DECIMAL buffer");
-  byte scale_digits = *buf.begin();
-  byte sign_byte = *(buf.end() - 1);
-  int last_digit = -1;
-  bool is_negative;
+  const byte *m_digits;
+  unsigned    m_count;
+  unsigned    m_scale;
+  bool        m_negative;
+
+public:
+
+  Packed_decimal(bytes buf)
+  {
+    if (buf.size() < 2)
+      THROW("Invalid DECIMAL buffer");
+
+    byte sign_byte = *(buf.end() - 1);
+
+    m_scale = *buf.begin();
+    m_digits = buf.begin() + 1;
+    m_count = 2 * unsigned(buf.size() - 2);
+
+    if ((sign_byte & 0x0C) == 0x0C)
+    {
+      // The high nibble of the sign byte holds the last digit.
+      m_count++;
+      m_negative = (sign_byte & 0x0D) == 0x0D;
+    }
+    else if ((sign_byte & 0xC0) == 0xC0)
+      m_negative = (sign_byte & 0xD0) == 0xD0;
+    else
+      THROW("Invalid DECIMAL buffer");
+
+    if (0 == m_count || m_count < m_scale)
+      THROW("Invalid DECIMAL buffer");
+  }
+
+  unsigned count() const { return m_count; }
+  unsigned scale() const { return m_scale; }
+  bool is_negative() const { return m_negative; }
+
+  unsigned operator[](unsigned pos) const
+  {
+    byte b = m_digits[pos / 2];
+    unsigned digit = (pos % 2) ? (b & 0x0F) : (b >> 4);
+    if (digit > 9)
+      THROW("Invalid DECIMAL buffer");
+    return digit;
+  }
 
   /*
-    Last 4 bits of DECIMAL should always be 1100 (0xC) for positive
-    or 1101 (0xD) for negative value
+    Store the coefficient in val and return true if it has at most
+    19 significant digits. Otherwise return false.
   */
-  if ((sign_byte & 0x0C) == 0x0C)
+
+  bool coefficient(uint64_t &val) const
   {
-    /* A digit must be retrieved from the first 4 bits of the sign byte */
-    last_digit = (int)(sign_byte >> 4);
-    is_negative = (sign_byte & 0x0D) == 0x0D;
+    unsigned pos = 0;
+    for (; pos < m_count && 0 == (*this)[pos]; ++pos);
+
+    if (m_count - pos > 19)
+      return false;
+
+    val = 0;
+    for (; pos < m_count; ++pos)
+      val = 10 * val + (*this)[pos];
+    return true;
   }
-  else if ((sign_byte & 0xC0) == 0xC0)
+
+  /*
+    Convert to floating point number using given strtod()-like function.
+    The value is presented to the function in the form "[-]DDDe-S" which
+    does not contain locale specific decimal point.
+  */
+
+  template <typename T>
+  T parse(T (*conv)(const char*, char**)) const
   {
-    /* No digit in the sign byte */
-    is_negative = (sign_byte & 0xD0) == 0xD0;
+    char small[96];
+    std::string big;
+    char *buf = small;
+
+    if (m_count + 8 > sizeof(small))
+    {
+      big.resize(m_count + 8);
+      buf = &big[0];
+    }
+
+    char *p = buf;
+
+    if (m_negative)
+      *p++ = '-';
+    for (unsigned pos = 0; pos < m_count; ++pos)
+      *p++ = char('0' + (*this)[pos]);
+    *p++ = 'e';
+    *p++ = '-';
+    if (m_scale >= 100)
+      *p++ = char('0' + m_scale / 100);
+    if (m_scale >= 10)
+      *p++ = char('0' + (m_scale / 10) % 10);
+    *p++ = char('0' + m_scale % 10);
+    *p = '\0';
+
+    char *end;
+    T val = conv(buf, &end);
+
+    if (*end != '\0')
+      THROW("Codec<TYPE_FLOAT>: conversion overflow");
+    return val;
   }
-  else
-    THROW("Invalid DECIMAL buffer");
 
-  int total_digits = ((int)buf.size() - 2) * 2 + (last_digit + 1 ? 1 : 0);
-  if (total_digits <= scale_digits)
-    THROW("Invalid DECIMAL buffer");
+};
+
+
+static const double pow10_tab[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+/*
+  Unsigned 128-bit integer stored as four 32-bit limbs (least significant
+  first), with the few operations needed to convert DECIMAL values.
+*/
+
+struct Uint128
+{
+  uint32_t m_limb[4];
+
+  Uint128(uint64_t lo = 0, uint64_t hi = 0)
+  {
+    m_limb[0] = uint32_t(lo);
+    m_limb[1] = uint32_t(lo >> 32);
+    m_limb[2] = uint32_t(hi);
+    m_limb[3] = uint32_t(hi >> 32);
+  }
 
-  std::stringstream sstream;
+  uint64_t lo() const { return (uint64_t(m_limb[1]) << 32) | m_limb[0]; }
+  uint64_t hi() const { return (uint64_t(m_limb[3]) << 32) | m_limb[2]; }
+
+  bool is_zero() const
+  {
+    return 0 == (m_limb[0] | m_limb[1] | m_limb[2] | m_limb[3]);
+  }
+
+  // this = this*mul + add, returns false on overflow.
+
+  bool mul_add(uint32_t mul, uint32_t add)
+  {
+    uint64_t carry = add;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+      uint64_t t = uint64_t(m_limb[i]) * mul + carry;
+      m_limb[i] = uint32_t(t);
+      carry = t >> 32;
+    }
+    return 0 == carry;
+  }
 
-  if (is_negative)
-    sstream << "-";
+  // this = this/div, returns the remainder.
 
-  int pos = 0;
-  for (byte *b = buf.begin() + 1; b < buf.end() - 1; ++b)
+  uint32_t div(uint32_t div)
   {
-    do
+    uint64_t rem = 0;
+    for (unsigned i = 4; i > 0; --i)
     {
-      if (total_digits - scale_digits == pos)
-        /* Getting the locale decimal point */
-        sstream << std::use_facet< std::numpunct<char> >(sstream.getloc()).decimal_point();;
+      uint64_t t = (rem << 32) | m_limb[i-1];
+      m_limb[i-1] = uint32_t(t / div);
+      rem = t % div;
+    }
+    return uint32_t(rem);
+  }
+};
+
+
+/*
+  Write decimal digits of the coefficient at the end of the buffer
+  which ends at 'end'. Returns pointer to the first digit.
+*/
+
+char* coefficient_digits(const cdk::Decimal &val, char *end)
+{
+  Uint128 coef(val.lo, val.hi);
+  char *p = end;
+
+  do {
+    uint32_t chunk = coef.div(1000000000);
+    bool last = coef.is_zero();
+    for (unsigned i = 0; i < 9 && (!last || chunk); ++i)
+    {
+      *--p = char('0' + chunk % 10);
+      chunk /= 10;
+    }
+  } while (!coef.is_zero());
+
+  if (p == end)
+    *--p = '0';
+
+  return p;
+}
+
+}  // anonymous namespace
+
+
+std::string cdk::Decimal::str() const
+{
+  // 128-bit coefficient has at most 39 digits, scale is at most 255.
+
+  char buf[300];
+  char *end = buf + sizeof(buf);
+  char *digits = coefficient_digits(*this, end);
+  size_t count = size_t(end - digits);
+
+  std::string out;
+  out.reserve(count + scale + 3);
+
+  if (negative)
+    out.push_back('-');
+
+  if (count > scale)
+  {
+    out.append(digits, count - scale);
+    digits += count - scale;
+    count = scale;
+  }
+  else
+    out.push_back('0');
+
+  if (scale > 0)
+  {
+    out.push_back('.');
+    out.append(scale - count, '0');
+    out.append(digits, count);
+  }
+
+  return out;
+}
+
+
+double cdk::Decimal::to_double() const
+{
+  if (0 == hi && lo < (uint64_t(1) << 53) && scale <= 22)
+  {
+    // Both numbers are exact, so a single division rounds correctly.
+    double val = double(lo) / pow10_tab[scale];
+    return negative ? -val : val;
+  }
+
+  char buf[48];
+  char *end = buf + 40;
+  char *p = coefficient_digits(*this, end);
+
+  if (negative)
+    *--p = '-';
+  *end++ = 'e';
+  *end++ = '-';
+  if (scale >= 100)
+    *end++ = char('0' + scale / 100);
+  if (scale >= 10)
+    *end++ = char('0' + (scale / 10) % 10);
+  *end++ = char('0' + scale % 10);
+  *end = '\0';
+
+  return strtod(p, NULL);
+}
 
-      if (pos % 2)
-        sstream << (int)(*b & 0x0F);
-      else
-        sstream << (int)(*b >> 4);
-      ++pos;
-    } while (pos % 2);
+
+std::string Codec<TYPE_FLOAT>::internal_decimal_to_string(bytes buf)
+{
+  Packed_decimal dec(buf);
+  unsigned int_digits = dec.count() - dec.scale();
+  std::string out;
+
+  out.reserve(dec.count() + 3);
+
+  if (dec.is_negative())
+    out.push_back('-');
+
+  // Skip leading zeros of the integer part.
+
+  unsigned pos = 0;
+  for (; pos + 1 < int_digits && 0 == dec[pos]; ++pos);
+
+  if (0 == int_digits)
+    out.push_back('0');
+
+  for (; pos < dec.count(); ++pos)
+  {
+    if (pos == int_digits)
+      out.push_back('.');
+    out.push_back(char('0' + dec[pos]));
+  }
+
+  return out;
+}
+
+
+size_t Codec<TYPE_FLOAT>::from_bytes(bytes buf, Decimal &val)
+{
+  if (m_fmt.type() != cdk::Format<cdk::TYPE_FLOAT>::DECIMAL)
+    throw Error(cdkerrc::conversion_error,
+                "Codec<TYPE_FLOAT>: can not store FLOAT or DOUBLE value"
+                " into Decimal variable");
+
+  Packed_decimal dec(buf);
+  Uint128 coef;
+
+  /*
+    Consume digits in chunks of at most 9 digits, each of which fits
+    into a 32-bit limb.
+  */
+
+  for (unsigned pos = 0; pos < dec.count();)
+  {
+    uint32_t chunk = 0;
+    uint32_t mul = 1;
+
+    for (unsigned i = 0; i < 9 && pos < dec.count(); ++i, ++pos)
+    {
+      chunk = 10 * chunk + dec[pos];
+      mul *= 10;
+    }
+
+    if (!coef.mul_add(mul, chunk))
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_FLOAT>: DECIMAL value too big for exact"
+                  " representation");
   }
 
-  if (last_digit + 1)
-    sstream << last_digit;
+  val.lo = coef.lo();
+  val.hi = coef.hi();
+  val.scale = uint8_t(dec.scale());
+  val.negative = dec.is_negative();
 
-  return sstream.str();
+  return buf.size();
 }
 
 
@@ -428,12 +748,21 @@ size_t Codec<TYPE_FLOAT>::from_bytes(bytes buf, float &val)
 {
   if (m_fmt.type() == cdk::Format<cdk::TYPE_FLOAT>::DECIMAL)
   {
-    std::string s = internal_decimal_to_string(buf);
-    const char *data = s.c_str();
-    char *str_end;
-    float f = strtof(data, &str_end);
+    Packed_decimal dec(buf);
+    uint64_t coef;
+    float f;
 
-    if (*str_end != '\0' || f == std::numeric_limits<float>::infinity())
+    if (dec.coefficient(coef) && coef < (1U << 24) && dec.scale() <= 10)
+    {
+      f = float(coef) / float(pow10_tab[dec.scale()]);
+      if (dec.is_negative())
+        f = -f;
+    }
+    else
+      f = dec.parse(strtof);
+
+    if (f == std::numeric_limits<float>::infinity()
+        || f == -std::numeric_limits<float>::infinity())
       THROW("Codec<TYPE_FLOAT>: conversion overflow");
     val = f;
     return buf.size();
@@ -460,15 +789,21 @@ size_t Codec<TYPE_FLOAT>::from_bytes(bytes buf, double &val)
 {
   if (m_fmt.type() == cdk::Format<cdk::TYPE_FLOAT>::DECIMAL)
   {
-    std::string s = internal_decimal_to_string(buf);
-    const char *data = s.c_str();
-    char *str_end;
-    double d = strtod(data, &str_end);
+    Packed_decimal dec(buf);
+    uint64_t coef;
 
     /* No need to check for value overflow from DECIMAL to double */
-    if (*str_end != '\0')
-      THROW("Codec<TYPE_FLOAT>: conversion overflow");
-    val = d;
+
+    if (dec.coefficient(coef) && coef < (uint64_t(1) << 53)
+        && dec.scale() <= 22)
+    {
+      val = double(coef) / pow10_tab[dec.scale()];
+      if (dec.is_negative())
+        val = -val;
+    }
+    else
+      val = dec.parse(strtod);
+
     return buf.size();
   }
 
@@ -512,12 +847,186 @@ size_t Codec<TYPE_FLOAT>::to_bytes(double val, bytes buf)
 }
 
 
+/*
+  Decoding/encoding temporal values
+  ---------------------------------
+*/
+
+namespace {
+
+inline
+char* put_digits(char *p, unsigned val, unsigned width)
+{
+  for (unsigned i = width; i > 0; --i)
+  {
+    p[i-1] = char('0' + val % 10);
+    val /= 10;
+  }
+  return p + width;
+}
+
+}  // anonymous namespace
+
+
+std::string cdk::Datetime::str(bool date, bool time) const
+{
+  char buf[32];
+  char *p = buf;
+
+  if (date)
+  {
+    p = put_digits(p, year, 4);
+    *p++ = '-';
+    p = put_digits(p, month, 2);
+    *p++ = '-';
+    p = put_digits(p, day, 2);
+    if (time)
+      *p++ = ' ';
+  }
+  else
+  {
+    time = true;
+    if (negative)
+      *p++ = '-';
+  }
+
+  if (time)
+  {
+    unsigned width = 2;
+    for (unsigned h = hour; h > 99; h /= 10)
+      ++width;
+    p = put_digits(p, hour, width);
+    *p++ = ':';
+    p = put_digits(p, minute, 2);
+    *p++ = ':';
+    p = put_digits(p, second, 2);
+    if (usec)
+    {
+      *p++ = '.';
+      p = put_digits(p, usec, 6);
+    }
+  }
+
+  return std::string(buf, p);
+}
+
+
+size_t Codec<TYPE_DATETIME>::from_bytes(bytes buf, Datetime &val)
+{
+  const byte *pos = buf.begin();
+  const byte *end = buf.end();
+
+  val = Datetime();
+
+  /*
+    Read fields in the order in which they are sent. Fields missing at
+    the end of the buffer are 0.
+  */
+
+  uint64_t field[7] = { 0, 0, 0, 0, 0, 0, 0 };
+  unsigned first = 0;
+
+  if (Format<TYPE_DATETIME>::TIME == m_fmt.type())
+  {
+    if (pos == end || *pos > 1)
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_DATETIME>: invalid TIME value");
+
+    val.negative = (1 == *pos++);
+    first = 3;
+  }
+
+  for (unsigned i = first; i < 7 && pos < end; ++i)
+  {
+    size_t sz = varint::decode(pos, end, field[i]);
+    if (0 == sz)
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_DATETIME>: temporal value conversion error");
+    pos += sz;
+  }
+
+  if (pos < end
+      || field[0] > 9999 || field[1] > 12 || field[2] > 31
+      || field[3] > (first ? 0xFFFF : 23) || field[4] > 59 || field[5] > 59
+      || field[6] > 999999)
+    throw Error(cdkerrc::conversion_error,
+                "Codec<TYPE_DATETIME>: invalid temporal value");
+
+  val.year   = (uint16_t)field[0];
+  val.month  = (uint8_t)field[1];
+  val.day    = (uint8_t)field[2];
+  val.hour   = (uint16_t)field[3];
+  val.minute = (uint8_t)field[4];
+  val.second = (uint8_t)field[5];
+  val.usec   = (uint32_t)field[6];
+
+  return (size_t)(pos - buf.begin());
+}
+
+
+size_t Codec<TYPE_DATETIME>::to_bytes(const Datetime &val, bytes buf)
+{
+  byte *pos = buf.begin();
+  byte *end = buf.end();
+
+  uint64_t field[7] = {
+    val.year, val.month, val.day, val.hour, val.minute, val.second, val.usec
+  };
+  unsigned first = 0;
+  unsigned last = 7;
+
+  if (Format<TYPE_DATETIME>::TIME == m_fmt.type())
+  {
+    if (pos == end)
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_DATETIME>: buffer to small");
+    *pos++ = val.negative ? 1 : 0;
+    first = 3;
+  }
+  else
+  {
+    // Date part is always sent, trailing zero time fields are omitted.
+    for (; last > 3 && 0 == field[last-1]; --last);
+  }
+
+  for (unsigned i = first; i < last; ++i)
+  {
+    size_t sz = varint::encode(field[i], pos, end);
+    if (0 == sz)
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_DATETIME>: buffer to small");
+    pos += sz;
+  }
+
+  return (size_t)(pos - buf.begin());
+}
+
+
+size_t Codec<TYPE_DATETIME>::from_bytes(bytes buf, std::string &str)
+{
+  Datetime val;
+  size_t sz = from_bytes(buf, val);
+  bool is_time = Format<TYPE_DATETIME>::TIME == m_fmt.type();
+  str = val.str(!is_time, is_time || m_fmt.has_time());
+  return sz;
+}
+
+
 size_t Codec<TYPE_DOCUMENT>::from_bytes(bytes data, JSON::Processor &jp)
 {
-  std::string json_string(data.begin(), data.end());
-  JSON_parser parser(json_string);
-  parser.process(jp);
-  return 0; // FIXME
+  /*
+    Note: xprotocol adds 0x00 byte at the end of bytes encoding, which is
+    not part of the JSON text.
+  */
+
+  const char *beg = (const char*)data.begin();
+  const char *end = (const char*)data.end();
+
+  if (end > beg && '\0' == *(end - 1))
+    --end;
+
+  JSON_parser::parse(beg, end, jp);
+  return data.size();
 }
 
 Codec<TYPE_DOCUMENT>::Doc_format Codec<TYPE_DOCUMENT>::m_format;
@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+
+#include <mysql/cdk/mux.h>
+#include <mysql/cdk/cursor.h>
+
+
+namespace cdk {
+
+
+/*
+  Mpsc_queue
+  ==========
+
+  This is the intrusive MPSC queue algorithm by D. Vyukov. Nodes form
+  a singly linked list from m_tail to m_head. Producers atomically replace
+  m_head with the new node and then link the previous head to it. Between
+  these two steps the list is temporarily broken, which the consumer
+  detects and then reports the queue as empty.
+
+  The stub node is used so that the list is never empty: whenever the
+  consumer is about to take the last node, the stub is pushed behind it.
+*/
+
+Mpsc_queue::Node* Mpsc_queue::pop()
+{
+  Node *tail = m_tail;
+  Node *next = tail->m_next.load(std::memory_order_acquire);
+
+  if (tail == &m_stub)
+  {
+    if (!next)
+      return NULL;
+    m_tail = tail = next;
+    next = tail->m_next.load(std::memory_order_acquire);
+  }
+
+  if (next)
+  {
+    m_tail = next;
+    return tail;
+  }
+
+  // If tail is not the last node then some producer is in the middle of push.
+
+  if (tail != m_head.load(std::memory_order_acquire))
+    return NULL;
+
+  push(&m_stub);
+
+  next = tail->m_next.load(std::memory_order_acquire);
+
+  if (next)
+  {
+    m_tail = next;
+    return tail;
+  }
+
+  return NULL;
+}
+
+
+/*
+  Session_mux
+  ===========
+*/
+
+Session_mux::Session_mux(ds::TCPIP &ds, const ds::TCPIP::Options &options)
+  : m_sess(ds, options)
+  , m_sleeping(false), m_stop(false)
+  , m_batch_count(0), m_stmt_count(0)
+{
+  start();
+}
+
+Session_mux::Session_mux(ds::Multi_source &ds)
+  : m_sess(ds)
+  , m_sleeping(false), m_stop(false)
+  , m_batch_count(0), m_stmt_count(0)
+{
+  start();
+}
+
+#ifndef _WIN32
+Session_mux::Session_mux(ds::Unix_socket &ds,
+                         const ds::Unix_socket::Options &options)
+  : m_sess(ds, options)
+  , m_sleeping(false), m_stop(false)
+  , m_batch_count(0), m_stmt_count(0)
+{
+  start();
+}
+#endif //_WIN32
+
+
+Session_mux::~Session_mux()
+{
+  m_stop = true;
+
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_sleeping = false;
+    m_cv.notify_one();
+  }
+
+  if (m_worker.joinable())
+    m_worker.join();
+}
+
+
+void Session_mux::start()
+{
+  m_worker = std::thread(&Session_mux::run, this);
+}
+
+
+std::shared_ptr<Session_mux::Result>
+Session_mux::sql(const string &query, Any_list *args)
+{
+  if (m_stop)
+    throw_error("Session_mux: session is closed");
+
+  std::shared_ptr<Result> res(new Result(query, args));
+  res->m_self = res;
+  m_queue.push(res.get());
+  wake_up();
+  return res;
+}
+
+
+/*
+  The worker thread sets m_sleeping before it checks the queue for the
+  last time and goes to sleep. A producer clears the flag after pushing
+  a request and, if it was set, notifies the worker. This way producers
+  take the mutex only when the worker is (about to be) sleeping.
+*/
+
+void Session_mux::wake_up()
+{
+  if (!m_sleeping.exchange(false))
+    return;
+
+  std::lock_guard<std::mutex> guard(m_mutex);
+  m_cv.notify_one();
+}
+
+
+void Session_mux::run()
+{
+  std::vector<std::shared_ptr<Result>> batch;
+  batch.reserve(max_batch);
+
+  for (;;)
+  {
+    Mpsc_queue::Node *node = m_queue.pop();
+
+    if (!node)
+    {
+      if (!batch.empty())
+      {
+        execute(batch);
+        batch.clear();
+        continue;
+      }
+
+      m_sleeping = true;
+
+      node = m_queue.pop();
+
+      if (!node)
+      {
+        if (m_stop)
+          return;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]{ return !m_sleeping || m_stop; });
+        continue;
+      }
+
+      m_sleeping = false;
+    }
+
+    Result *res = static_cast<Result*>(node);
+    batch.emplace_back();
+    batch.back().swap(res->m_self);
+
+    if (max_batch == batch.size())
+    {
+      execute(batch);
+      batch.clear();
+    }
+  }
+}
+
+
+/*
+  Row processor which copies rows of a result set into Result object.
+*/
+
+class Session_mux::Result::Reader
+  : public Cursor::Row_processor
+{
+  Result &m_res;
+  std::vector<Field> *m_row = NULL;
+
+public:
+
+  Reader(Result &res) : m_res(res) {}
+
+  bool row_begin(row_count_t)
+  {
+    m_res.m_rows.emplace_back(m_res.m_cols.size());
+    m_row = &m_res.m_rows.back();
+    return true;
+  }
+
+  void row_end(row_count_t) {}
+
+  size_t field_begin(col_count_t pos, size_t)
+  {
+    Field &fld = m_row->at(pos);
+    fld.m_null = false;
+    fld.m_data.clear();
+    return SIZE_MAX;
+  }
+
+  size_t field_data(col_count_t pos, bytes data)
+  {
+    std::vector<byte> &buf = m_row->at(pos).m_data;
+    buf.insert(buf.end(), data.begin(), data.end());
+    return SIZE_MAX;
+  }
+
+  void field_end(col_count_t) {}
+
+  void field_null(col_count_t pos)
+  {
+    m_row->at(pos).m_null = true;
+  }
+
+  void end_of_data() {}
+
+  void read(Cursor &c)
+  {
+    for (col_count_t pos = 0; pos < c.col_count(); ++pos)
+    {
+      m_res.m_cols.emplace_back();
+      Column &col = m_res.m_cols.back();
+      col.m_type = c.type(pos);
+      col.m_name = c.col_info(pos).name();
+
+      const Format_info &fi = c.format(pos);
+
+      switch (col.m_type)
+      {
+#define MUX_FORMAT(X) \
+      case TYPE_##X: \
+        col.m_format.reset(new Format<TYPE_##X>(fi)); break;
+
+        MUX_FORMAT(INTEGER)
+        MUX_FORMAT(FLOAT)
+        MUX_FORMAT(STRING)
+        MUX_FORMAT(DATETIME)
+        MUX_FORMAT(BYTES)
+        MUX_FORMAT(DOCUMENT)
+
+      default:
+        // No encoding format information for GEOMETRY and XML.
+        break;
+      }
+    }
+
+    c.get_rows(*this);
+    c.wait();
+  }
+};
+
+
+/*
+  Execute a batch of requests: all statements are sent first and then
+  replies are read and stored in the corresponding results.
+
+  If an error is thrown (other than one reported by the server for
+  a statement), the connection is not usable anymore. Then the current
+  and all following requests, also in later batches, complete with that
+  error.
+*/
+
+void Session_mux::execute(std::vector<std::shared_ptr<Result>> &batch)
+{
+  std::unique_ptr<Error> error;
+  size_t sent = 0;
+
+  if (m_conn_error)
+  {
+    for (auto &res : batch)
+      res->complete(m_conn_error.get());
+    return;
+  }
+
+  try {
+
+    if (!m_sess.is_valid())
+      throw_error("Session_mux: session is not valid");
+
+    for (auto &res : batch)
+    {
+      m_sess.sql(res->m_stmt, res->m_args);
+      m_sess.send_ahead();
+      ++sent;
+    }
+  }
+  catch (const Error &e)
+  {
+    error.reset(e.clone());
+  }
+  catch (const std::exception &e)
+  {
+    error.reset(new Error(cdkerrc::generic_error, std::string(e.what())));
+  }
+
+  m_batch_count++;
+  m_stmt_count += sent;
+
+  for (size_t i = 0; i < batch.size(); ++i)
+  {
+    Result &res = *batch[i];
+
+    if (error || i >= sent)
+    {
+      res.complete(error.get());
+      continue;
+    }
+
+    try {
+
+      Reply r(m_sess.next_reply());
+
+      if (r.has_results())
+      {
+        Cursor c(r);
+        Result::Reader(res).read(c);
+      }
+
+      r.wait();
+
+      if (0 < r.entry_count())
+      {
+        std::unique_ptr<Error> err(r.get_error().clone());
+        res.complete(err.get());
+        continue;
+      }
+
+      res.m_affected_rows = r.affected_rows();
+      res.m_last_insert_id = r.last_insert_id();
+      res.complete(NULL);
+    }
+    catch (const Error &e)
+    {
+      error.reset(e.clone());
+      res.complete(error.get());
+    }
+    catch (const std::exception &e)
+    {
+      error.reset(new Error(cdkerrc::generic_error, std::string(e.what())));
+      res.complete(error.get());
+    }
+  }
+
+  if (error)
+    m_conn_error = std::move(error);
+}
+
+
+/*
+  Session_mux::Result
+  ===================
+*/
+
+void Session_mux::Result::complete(const Error *error)
+{
+  if (error)
+  {
+    m_error.reset(error->clone());
+    m_cols.clear();
+    m_rows.clear();
+  }
+
+  std::lock_guard<std::mutex> guard(m_mutex);
+  m_done = true;
+  m_cv.notify_all();
+}
+
+
+void Session_mux::Result::wait() const
+{
+  if (!m_done)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]{ return m_done.load(); });
+  }
+
+  if (m_error)
+    m_error->rethrow();
+}
+
+
+bool Session_mux::Result::get(row_count_t row, col_count_t col,
+                              bytes &data) const
+{
+  const Field &fld = m_rows.at(row).at(col);
+
+  if (fld.m_null)
+    return false;
+
+  byte *beg = const_cast<byte*>(fld.m_data.data());
+  data = bytes(beg, fld.m_data.size());
+  return true;
+}
+
+
+}  // cdk
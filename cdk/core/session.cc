@@ -32,11 +32,213 @@
 #include <mysql/cdk/session.h>
 #include <mysql/cdk/mysqlx/session.h>
 
+PUSH_SYS_WARNINGS
+#include <map>
+#include <mutex>
+#include <list>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+POP_SYS_WARNINGS
+
 
 namespace cdk {
 
 using std::unique_ptr;
 
+
+/*
+  Background prober of data sources which were marked down.
+
+  When connection to a data source fails, it is marked down in its
+  Host_stats and a probe is scheduled here. Sessions created from
+  a Multi_source skip data sources which are down. The prober thread
+  schedules probes which try to connect to such data sources and to get
+  server capabilities over X Protocol. When this succeeds, the data source
+  is marked up again. Otherwise the next probe is scheduled with exponential
+  backoff.
+
+  Each probe runs in its own thread, so that a data source which does not
+  respond does not delay probes of other data sources. Connection attempts
+  made by probes, and waiting for the reply to the capabilities request,
+  time out after probe_timeout. Thus a server which accepts connections
+  but never replies is probed again later instead of blocking the probe
+  forever.
+
+  The prober is created on first use and is never destroyed. Its threads are
+  detached so that they do not delay process exit. They use only the prober
+  itself and Host_stats instances from the registry (see Host_stats::get()),
+  which are never destroyed either.
+*/
+
+class Host_prober
+{
+public:
+
+  using clock = std::chrono::steady_clock;
+  using Check = std::function<bool()>;
+
+  static const uint64_t probe_timeout = 5000000;  // usec
+
+  static Host_prober& get()
+  {
+    static Host_prober *prober = new Host_prober();
+    return *prober;
+  }
+
+  void add(ds::Host_stats &stats, const Check &check);
+
+  /*
+    Delay before the next probe of a data source after given number of
+    consecutive failures: 1s, 2s, 4s, ... up to 1 min.
+  */
+
+  static clock::duration backoff(unsigned failures)
+  {
+    unsigned shift = failures > 0 ? failures - 1 : 0;
+    if (shift > 6)
+      shift = 6;
+    return std::min<clock::duration>(
+      std::chrono::seconds(1u << shift), std::chrono::seconds(60)
+    );
+  }
+
+private:
+
+  struct Probe
+  {
+    ds::Host_stats   *m_stats;
+    Check             m_check;
+    clock::time_point m_time;
+  };
+
+  std::mutex m_guard;
+  std::condition_variable m_cond;
+  std::list<Probe> m_probes;
+  bool m_started = false;
+
+  void run();
+  void probe(Probe);
+};
+
+
+void Host_prober::add(ds::Host_stats &stats, const Check &check)
+{
+  std::lock_guard<std::mutex> lock(m_guard);
+
+  m_probes.push_back({ &stats, check, clock::now() + backoff(stats.failures()) });
+
+  if (!m_started)
+  {
+    std::thread(&Host_prober::run, this).detach();
+    m_started = true;
+  }
+
+  m_cond.notify_one();
+}
+
+
+void Host_prober::run()
+{
+  std::unique_lock<std::mutex> lock(m_guard);
+
+  for (;;)
+  {
+    if (m_probes.empty())
+    {
+      m_cond.wait(lock);
+      continue;
+    }
+
+    auto next = std::min_element(m_probes.begin(), m_probes.end(),
+      [](const Probe &a, const Probe &b) { return a.m_time < b.m_time; }
+    );
+
+    if (clock::now() < next->m_time)
+    {
+      m_cond.wait_until(lock, next->m_time);
+      continue;
+    }
+
+    Probe due = *next;
+    m_probes.erase(next);
+
+    // Data source could be marked up by a session in the meantime.
+
+    if (!due.m_stats->is_down())
+      continue;
+
+    std::thread(&Host_prober::probe, this, due).detach();
+  }
+}
+
+
+void Host_prober::probe(Probe probe)
+{
+  if (probe.m_check())
+  {
+    probe.m_stats->mark_up();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_guard);
+
+  probe.m_stats->mark_down();
+  probe.m_time = clock::now() + backoff(probe.m_stats->failures());
+  m_probes.push_back(probe);
+  m_cond.notify_one();
+}
+
+
+/*
+  Check if X Protocol server accepts connections on the given connection
+  object by asking it for its capabilities.
+*/
+
+template <class Conn>
+static bool probe_connection(Conn &conn)
+{
+  try {
+    conn.connect();
+    conn.set_read_timeout(Host_prober::probe_timeout);
+
+    protocol::mysqlx::Protocol proto(conn);
+    protocol::mysqlx::Reply_processor prc;
+
+    proto.snd_CapabilitiesGet().wait();
+    proto.rcv_Capabilities(prc).wait();
+    return true;
+  }
+  catch (...)
+  {
+    return false;
+  }
+}
+
+static Host_prober::Check probe_for(const ds::TCPIP &ds)
+{
+  std::string host = ds.host();
+  unsigned short port = ds.port();
+
+  return [host, port]() {
+    foundation::connection::TCPIP conn(host, port, Host_prober::probe_timeout);
+    return probe_connection(conn);
+  };
+}
+
+#ifndef WIN32
+static Host_prober::Check probe_for(const ds::Unix_socket &ds)
+{
+  std::string path = ds.path();
+
+  return [path]() {
+    foundation::connection::Unix_socket conn(path);
+    return probe_connection(conn);
+  };
+}
+#endif
+
 /*
   A class that creates a session from given data source.
 
@@ -56,6 +258,15 @@ struct Session_builder
   scoped_ptr<Error>     m_error;
   unsigned              m_attempts = 0;
 
+  /*
+    If m_skip_down is true, data sources which are marked down in their
+    Host_stats are not tried. Number of such skipped data sources is
+    counted in m_skipped.
+  */
+
+  bool                  m_skip_down = false;
+  unsigned              m_skipped = 0;
+
   Session_builder(bool throw_errors = false)
     : m_throw_errors(throw_errors)
   {}
@@ -90,6 +301,17 @@ struct Session_builder
   template <class Conn>
   bool connect(Conn&);
 
+  /*
+    Record that connection to a data source failed. If this marks it down,
+    a background probe which checks when it is available again is scheduled.
+  */
+
+  void host_down(ds::Host_stats &stats, const Host_prober::Check &check)
+  {
+    if (stats.mark_down())
+      Host_prober::get().add(stats, check);
+  }
+
 #ifdef WITH_SSL
 
   /*
@@ -158,13 +380,32 @@ Session_builder::operator() (
   using foundation::connection::TCPIP;
   using foundation::connection::Socket_base;
 
+  ds::Host_stats &stats = ds::Host_stats::get(ds);
+
+  if (m_skip_down && stats.is_down())
+  {
+    ++m_skipped;
+    return false;  // known to be down, continue to next host
+  }
+
   unique_ptr<TCPIP> connection(new TCPIP(ds.host(), ds.port()));
 
   if (!connect(*connection))
+  {
+    host_down(stats, probe_for(ds));
     return false;  // continue to next host if available
+  }
 
 #ifdef WITH_SSL
 
+  /*
+    Note: Unless TLS is disabled, TLS capability is negotiated with the
+    server, which takes one round trip.
+  */
+
+  unsigned tls_rtt =
+    TLS::Options::SSL_MODE::DISABLED == options.get_tls().ssl_mode() ? 0 : 1;
+
   /*
     Note: We must be careful to release the unique_ptr<> if tls_connect()
     throws error or returns a TLS object because in that case the plain
@@ -194,7 +435,7 @@ Session_builder::operator() (
     */
 
     m_conn.reset(tls_conn);
-    m_sess = new mysqlx::Session(*tls_conn, options);
+    m_sess = new mysqlx::Session(*tls_conn, options, &stats);
   }
   else
 #endif
@@ -206,11 +447,23 @@ Session_builder::operator() (
       will still take care of deleting the connection object.
     */
 
-    m_sess = new mysqlx::Session(*connection, options);
+    m_sess = new mysqlx::Session(*connection, options, &stats);
     m_conn.reset(connection.release());
   }
 
+#ifdef WITH_SSL
+  m_sess->add_handshake_rtt(tls_rtt);
+#endif
+
+  /*
+    Note: Data source is marked up only after the session was established.
+    Information which the session stored in `stats` is kept.
+  */
+
+  stats.mark_up();
+
   m_database = options.database();
+  stats.handshake_done(m_sess->handshake_rtt());
   return true;
 }
 
@@ -224,15 +477,29 @@ Session_builder::operator() (
   using foundation::connection::Unix_socket;
   using foundation::connection::Socket_base;
 
+  ds::Host_stats &stats = ds::Host_stats::get(ds);
+
+  if (m_skip_down && stats.is_down())
+  {
+    ++m_skipped;
+    return false;  // known to be down, continue to next host
+  }
+
   unique_ptr<Unix_socket> connection(new Unix_socket(ds.path()));
 
   if (!connect(*connection))
+  {
+    host_down(stats, probe_for(ds));
     return false;  // continue to next host if available
+  }
 
-  m_sess = new mysqlx::Session(*connection, options);
+  m_sess = new mysqlx::Session(*connection, options, &stats);
   m_conn.reset(connection.release());
 
+  stats.mark_up();  // see note above
+
   m_database = options.database();
+  stats.handshake_done(m_sess->handshake_rtt());
 
   return true;
 }
@@ -373,6 +640,27 @@ Session::Session(ds::TCPIP &ds, const ds::TCPIP::Options &options)
 }
 
 
+/*
+  Registry of data source statistics. Entries are never removed, so that
+  references returned by Host_stats::get() stay valid. The registry itself
+  is never destroyed, because these references are used by prober threads
+  which can still run at process exit (see Host_prober).
+*/
+
+ds::Host_stats& ds::Host_stats::get(const std::string &key)
+{
+  static std::mutex *guard = new std::mutex();
+  static std::map<std::string, Host_stats> *registry
+    = new std::map<std::string, Host_stats>();
+
+  std::lock_guard<std::mutex> lock(*guard);
+  return (*registry)[key];
+}
+
+
+std::atomic<unsigned> ds::Multi_source::s_next(0);
+
+
 struct ds::Multi_source::Access
 {
   template <class Visitor>
@@ -387,10 +675,22 @@ Session::Session(ds::Multi_source &ds)
 {
   Session_builder sb;
 
+  /*
+    Known dead hosts are skipped only if there are other hosts to try. With
+    a single host we always attempt to connect.
+  */
+
+  sb.m_skip_down = 1 < ds.size();
+
   ds::Multi_source::Access::visit(ds, sb);
 
   if (!sb.m_sess)
   {
+    if (0 == sb.m_attempts && 0 < sb.m_skipped)
+      throw_error(
+        "Could not connect to any of the given data sources:"
+        " all of them are marked down"
+      );
     if (1 == sb.m_attempts && sb.m_error)
       sb.m_error->rethrow();
     else
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmark of DECIMAL decoding
+  =============================
+
+  Compares the previous way of decoding DECIMAL values, which printed the
+  BCD digits to a std::stringstream and parsed the result with strtod(),
+  with Codec<TYPE_FLOAT> decoding directly from BCD digits. Conversion to
+  exact Decimal representation and to string are measured too. Data sets
+  imitate typical DECIMAL columns: money amounts, rates with many
+  fractional digits and wide values that do not fit into Decimal.
+
+  Usage: decimal_bench [<iterations>]
+*/
+
+#include <mysql/cdk.h>
+
+PUSH_SYS_WARNINGS
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+POP_SYS_WARNINGS
+
+using namespace ::cdk;
+using std::cout;
+using std::endl;
+
+
+class Decimal_format
+  : public Format_info
+{
+  bool for_type(Type_info ti) const override
+  {
+    return TYPE_FLOAT == ti;
+  }
+
+  void get_info(Format<TYPE_FLOAT> &fmt) const override
+  {
+    Format<TYPE_FLOAT>::Access::set_fmt(fmt, Format<TYPE_FLOAT>::DECIMAL);
+  }
+
+  using Format_info::get_info;
+};
+
+
+/*
+  Previous implementation of DECIMAL to double conversion.
+*/
+
+double old_decimal_to_double(bytes buf)
+{
+  byte scale_digits = *buf.begin();
+  byte sign_byte = *(buf.end() - 1);
+  int last_digit = -1;
+  bool is_negative;
+
+  if ((sign_byte & 0x0C) == 0x0C)
+  {
+    last_digit = (int)(sign_byte >> 4);
+    is_negative = (sign_byte & 0x0D) == 0x0D;
+  }
+  else
+    is_negative = (sign_byte & 0xD0) == 0xD0;
+
+  int total_digits = ((int)buf.size() - 2) * 2 + (last_digit + 1 ? 1 : 0);
+
+  std::stringstream sstream;
+
+  if (is_negative)
+    sstream << "-";
+
+  int pos = 0;
+  for (byte *b = buf.begin() + 1; b < buf.end() - 1; ++b)
+  {
+    do
+    {
+      if (total_digits - scale_digits == pos)
+        sstream << std::use_facet< std::numpunct<char> >(sstream.getloc()).decimal_point();
+
+      if (pos % 2)
+        sstream << (int)(*b & 0x0F);
+      else
+        sstream << (int)(*b >> 4);
+      ++pos;
+    } while (pos % 2);
+  }
+
+  if (last_digit + 1)
+    sstream << last_digit;
+
+  std::string s = sstream.str();
+  return strtod(s.c_str(), NULL);
+}
+
+
+/*
+  Generate column of DECIMAL(precision, scale) values in the packed BCD
+  format used by the server.
+*/
+
+std::vector<std::string> make_column(unsigned precision, unsigned scale,
+                                     size_t rows)
+{
+  std::vector<std::string> column;
+  unsigned seed = 1;
+
+  for (size_t row = 0; row < rows; ++row)
+  {
+    seed = seed * 1103515245 + 12345;
+
+    // Values use between 1/2 and all of the available digits.
+
+    unsigned count = precision / 2 + (seed >> 16) % (precision / 2 + 1);
+    bool negative = 0 != (seed & 0x100);
+
+    std::string digits;
+    for (unsigned i = 0; i < count; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      digits.push_back(char((seed >> 16) % 10));
+    }
+
+    if (digits.size() < scale + 1)
+      digits.insert(0, scale + 1 - digits.size(), 0);
+
+    std::string val(1, char(scale));
+    size_t i = 0;
+    for (; i + 1 < digits.size(); i += 2)
+      val.push_back(char((digits[i] << 4) | digits[i+1]));
+
+    if (i < digits.size())
+      val.push_back(char((digits[i] << 4) | (negative ? 0x0D : 0x0C)));
+    else
+      val.push_back(char(negative ? 0xD0 : 0xC0));
+
+    column.push_back(val);
+  }
+
+  return column;
+}
+
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+inline
+bytes to_bytes(const std::string &val)
+{
+  return bytes((byte*)val.data(), val.size());
+}
+
+
+void run(const char *name, unsigned precision, unsigned scale,
+         unsigned iterations)
+{
+  const size_t rows = 10000;
+  std::vector<std::string> column = make_column(precision, scale, rows);
+  Decimal_format fi;
+  Codec<TYPE_FLOAT> codec(fi);
+  double check = 0;
+  size_t mismatch = 0;
+
+  for (size_t row = 0; row < rows; ++row)
+  {
+    double val;
+    codec.from_bytes(to_bytes(column[row]), val);
+    if (val != old_decimal_to_double(to_bytes(column[row])))
+      ++mismatch;
+  }
+
+  bench_clock::time_point start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (size_t row = 0; row < rows; ++row)
+      check += old_decimal_to_double(to_bytes(column[row]));
+  double t_old = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+  start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (size_t row = 0; row < rows; ++row)
+    {
+      double val;
+      codec.from_bytes(to_bytes(column[row]), val);
+      check += val;
+    }
+  double t_new = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+  double mvals = double(rows) * iterations / 1e6;
+
+  cout << name << " DECIMAL(" << precision << "," << scale << ")" << endl;
+  cout << "  to double: stringstream " << mvals / t_old << " M/s, "
+       << "BCD " << mvals / t_new << " M/s (x" << t_old / t_new << ")"
+       << endl;
+
+  if (mismatch)
+    cout << "  " << mismatch << " values differ from previous conversion"
+         << endl;
+
+  if (precision > 38)
+    return;
+
+  start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (size_t row = 0; row < rows; ++row)
+    {
+      Decimal val;
+      codec.from_bytes(to_bytes(column[row]), val);
+      check += double(val.lo & 1);
+    }
+  double t_exact = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+  size_t len = 0;
+  Decimal val;
+  start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (size_t row = 0; row < rows; ++row)
+    {
+      codec.from_bytes(to_bytes(column[row]), val);
+      len += val.str().length();
+    }
+  double t_str = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+  cout << "  to Decimal: " << mvals / t_exact << " M/s, "
+       << "to string: " << mvals / t_str << " M/s" << endl;
+
+  if (0 == check || 0 == len)
+    cout << "  (no data)" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned iterations = argc > 1 ? (unsigned)atoi(argv[1]) : 20;
+
+  run("money", 12, 2, iterations);
+  run("rate", 30, 10, iterations);
+  run("wide", 65, 30, iterations);
+
+  return 0;
+}
@@ -33,7 +33,10 @@
 #include "session_test.h"
 
 #include <iostream>
+#include <thread>
+#include <atomic>
 #include <mysql/cdk.h>
+#include <mysql/cdk/foundation/socket.h>
 
 
 using ::std::cout;
@@ -886,6 +889,272 @@ TEST_F(Session_core, trx)
 }
 
 
+TEST_F(Session_core, trx_lazy)
+{
+  try {
+    SKIP_IF_NO_XPLUGIN;
+
+    Session s(this);
+
+    if (!s.is_valid())
+      FAIL() << "Invalid Session!";
+
+    do_sql(s, L"DROP TABLE IF EXISTS t");
+    do_sql(s, L"CREATE TABLE t (a INT PRIMARY KEY)");
+
+    s.set_lazy_begin(true);
+
+    auto count = [&s]() -> unsigned
+    {
+      struct Prc : cdk::Row_processor
+      {
+        unsigned m_count = 0;
+
+        bool row_begin(row_count_t) { return true; }
+        void row_end(row_count_t) { m_count++; }
+        size_t field_begin(col_count_t, size_t) { return 0; }
+        void field_end(col_count_t) {}
+        void field_null(col_count_t) {}
+        size_t field_data(col_count_t, bytes) { return 0; }
+        void end_of_data() {}
+      }
+      prc;
+
+      Reply r(s.sql(L"SELECT a FROM t"));
+      Cursor c(r);
+      c.get_rows(prc);
+      c.wait();
+      return prc.m_count;
+    };
+
+    cout << "Empty transactions" << endl;
+
+    s.begin();
+    s.commit();
+    s.begin();
+    s.rollback();
+
+    cout << "Begin sent with the first statement" << endl;
+
+    s.begin();
+    do_sql(s, L"INSERT INTO t VALUES (1)");
+    do_sql(s, L"INSERT INTO t VALUES (2)");
+    s.commit();
+
+    s.begin();
+    do_sql(s, L"INSERT INTO t VALUES (3)");
+    s.rollback();
+
+    EXPECT_EQ(2U, count());
+
+    cout << "Commit sent with the last statement" << endl;
+
+    s.begin();
+    s.commit_after_next();
+    do_sql(s, L"INSERT INTO t VALUES (3)");
+    s.commit();
+
+    EXPECT_EQ(3U, count());
+
+    // Rows of the last statement are read before reply to COMMIT.
+
+    s.begin();
+    s.commit_after_next();
+    EXPECT_EQ(3U, count());
+    s.commit();
+
+    cout << "Commit is not executed if the last statement fails" << endl;
+
+    s.begin();
+    do_sql(s, L"INSERT INTO t VALUES (4)");
+    s.commit_after_next();
+    EXPECT_THROW(do_sql(s, L"INSERT INTO t VALUES (1)"), Error);
+
+    try {
+      s.commit();
+      FAIL() << "Expected error";
+    }
+    catch (const Error &e)
+    {
+      cout << "Expected error: " << e << endl;
+    }
+
+    s.rollback();
+
+    EXPECT_EQ(3U, count());
+
+    cout << "Error of START TRANSACTION is reported for the statement"
+         << endl;
+
+    do_sql(s, L"XA START 'trx_lazy'");
+    s.begin();
+
+    try {
+      do_sql(s, L"INSERT INTO t VALUES (5)");
+      FAIL() << "Expected error";
+    }
+    catch (const Error &e)
+    {
+      cout << "Expected error: " << e << endl;
+      // ER_XAER_RMFAIL
+      EXPECT_EQ(1399, e.code().value());
+    }
+
+    do_sql(s, L"XA END 'trx_lazy'");
+    do_sql(s, L"XA ROLLBACK 'trx_lazy'");
+
+    EXPECT_EQ(3U, count());
+
+    cout << "Done!" << endl;
+  }
+  CATCH_TEST_GENERIC
+}
+
+
+TEST(Session_mux, queue)
+{
+  struct Node : Mpsc_queue::Node
+  {
+    unsigned m_producer;
+    unsigned m_seq;
+  };
+
+  const unsigned producers = 4;
+  const unsigned count = 10000;
+
+  std::vector<Node> nodes(producers*count);
+  Mpsc_queue queue;
+  std::vector<std::thread> threads;
+
+  for (unsigned p = 0; p < producers; ++p)
+    threads.emplace_back([&nodes, &queue, p, count]()
+    {
+      for (unsigned i = 0; i < count; ++i)
+      {
+        Node &node = nodes[p*count + i];
+        node.m_producer = p;
+        node.m_seq = i;
+        queue.push(&node);
+      }
+    });
+
+  // Nodes from each producer must be popped in the order they were pushed.
+
+  std::vector<unsigned> next(producers, 0);
+
+  for (unsigned popped = 0; popped < producers*count;)
+  {
+    Node *node = static_cast<Node*>(queue.pop());
+
+    if (!node)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    ASSERT_EQ(next[node->m_producer], node->m_seq);
+    next[node->m_producer]++;
+    popped++;
+  }
+
+  for (auto &t : threads)
+    t.join();
+
+  EXPECT_EQ(nullptr, queue.pop());
+
+  for (unsigned p = 0; p < producers; ++p)
+    EXPECT_EQ(count, next[p]);
+}
+
+
+TEST_F(Session_core, mux)
+{
+  try {
+    SKIP_IF_NO_XPLUGIN;
+
+    Session_mux mux(get_ds(), get_opts());
+
+    const unsigned threads_count = 8;
+    const unsigned count = 200;
+
+    std::vector<std::thread> threads;
+    std::atomic<unsigned> errors(0);
+
+    for (unsigned t = 0; t < threads_count; ++t)
+      threads.emplace_back([&mux, &errors, t, count]()
+      {
+        std::vector<std::shared_ptr<Session_mux::Result>> results;
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+          std::wstring query = L"SELECT " + std::to_wstring(t*count + i)
+                               + L" AS val";
+          results.push_back(mux.sql(query));
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+          Session_mux::Result &res = *results[i];
+
+          try {
+            res.wait();
+          }
+          catch (const Error &e)
+          {
+            cout << "Error: " << e << endl;
+            errors++;
+            continue;
+          }
+
+          bytes data;
+          int64_t val = -1;
+
+          if (1 != res.col_count() || 1 != res.row_count()
+              || string(L"val") != res.col_name(0)
+              || TYPE_INTEGER != res.type(0)
+              || !res.get(0, 0, data))
+          {
+            errors++;
+            continue;
+          }
+
+          Codec<TYPE_INTEGER> codec(res.format<TYPE_INTEGER>(0));
+          codec.from_bytes(data, val);
+
+          if ((int64_t)(t*count + i) != val)
+            errors++;
+        }
+      });
+
+    for (auto &t : threads)
+      t.join();
+
+    EXPECT_EQ(0U, errors.load());
+    EXPECT_EQ(threads_count*count, mux.stmt_count());
+
+    cout << "Statements: " << mux.stmt_count()
+         << ", batches: " << mux.batch_count() << endl;
+
+    EXPECT_LT(mux.batch_count(), mux.stmt_count());
+
+    cout << "Errors are reported for individual statements" << endl;
+
+    auto bad = mux.sql(L"SELECT * FROM no_such_table");
+    auto good = mux.sql(L"SELECT NULL");
+
+    EXPECT_THROW(bad->wait(), Error);
+    good->wait();
+
+    bytes data;
+    EXPECT_EQ(1U, good->row_count());
+    EXPECT_FALSE(good->get(0, 0, data));
+
+    cout << "Done!" << endl;
+  }
+  CATCH_TEST_GENERIC
+}
+
+
 #if 0
 
 parser::JSON_parser m_parser;
@@ -1169,6 +1438,280 @@ TEST_F(Session_core, failover_add)
 }
 
 
+/*
+  Check the order in which Multi_source visits data sources with different
+  load balancing policies. No connections are made, the visitor only records
+  host names of visited data sources.
+*/
+
+struct LB_visitor
+{
+  std::vector<std::string> m_hosts;
+
+  bool operator() (const ds::TCPIP &ds, const ds::TCPIP::Options&)
+  {
+    m_hosts.push_back(ds.host());
+    return false;
+  }
+
+#ifndef WIN32
+  bool operator() (const ds::Unix_socket&, const ds::Unix_socket::Options&)
+  {
+    return false;
+  }
+#endif
+
+  bool operator() (const ds::TCPIP_old&, const ds::TCPIP_old::Options&)
+  {
+    return false;
+  }
+};
+
+
+TEST(Multi_source, load_balancing)
+{
+  ds::TCPIP::Options options("root");
+  ds::Multi_source ms;
+
+  ms.add(ds::TCPIP("lb_host1", 1), options, 0);
+  ms.add(ds::TCPIP("lb_host2", 1), options, 0);
+  ms.add(ds::TCPIP("lb_host3", 1), options, 0);
+
+  cout << "Round robin" << endl;
+
+  ms.set_policy(ds::Load_balancing::ROUND_ROBIN);
+
+  std::string prev;
+
+  for (unsigned i = 0; i < 6; ++i)
+  {
+    LB_visitor vis;
+    ms.visit(vis);
+
+    ASSERT_EQ(3U, vis.m_hosts.size());
+    EXPECT_NE(prev, vis.m_hosts[0]);
+    prev = vis.m_hosts[0];
+
+    // The remaining hosts follow in the list order.
+
+    for (unsigned pos = 1; pos < 3; ++pos)
+    {
+      EXPECT_EQ('1' + (vis.m_hosts[0].back() - '1' + pos) % 3,
+                vis.m_hosts[pos].back());
+    }
+  }
+
+  cout << "Least outstanding requests" << endl;
+
+  ds::Host_stats &stats1 = ds::Host_stats::get(ds::TCPIP("lb_host1", 1));
+  ds::Host_stats &stats2 = ds::Host_stats::get(ds::TCPIP("lb_host2", 1));
+  ds::Host_stats &stats3 = ds::Host_stats::get(ds::TCPIP("lb_host3", 1));
+
+  stats1.request_begin();
+  stats1.request_begin();
+  stats3.request_begin();
+
+  ms.set_policy(ds::Load_balancing::LEAST_OUTSTANDING);
+
+  for (unsigned i = 0; i < 3; ++i)
+  {
+    LB_visitor vis;
+    ms.visit(vis);
+
+    ASSERT_EQ(3U, vis.m_hosts.size());
+    EXPECT_EQ("lb_host2", vis.m_hosts[0]);
+    EXPECT_EQ("lb_host3", vis.m_hosts[1]);
+    EXPECT_EQ("lb_host1", vis.m_hosts[2]);
+  }
+
+  cout << "Lowest latency" << endl;
+
+  stats1.request_end(100);
+  stats1.request_end(100);
+  stats3.request_end(5000);
+  stats2.request_begin();
+  stats2.request_end(1000);
+
+  EXPECT_EQ(0U, stats1.outstanding());
+  EXPECT_EQ(100U, stats1.latency());
+
+  ms.set_policy(ds::Load_balancing::LOWEST_LATENCY);
+
+  for (unsigned i = 0; i < 3; ++i)
+  {
+    LB_visitor vis;
+    ms.visit(vis);
+
+    ASSERT_EQ(3U, vis.m_hosts.size());
+    EXPECT_EQ("lb_host1", vis.m_hosts[0]);
+    EXPECT_EQ("lb_host2", vis.m_hosts[1]);
+    EXPECT_EQ("lb_host3", vis.m_hosts[2]);
+  }
+
+  cout << "Random weighted by priority" << endl;
+
+  ms.clear();
+  ms.add(ds::TCPIP("lb_host1", 1), options, 98);
+  ms.add(ds::TCPIP("lb_host2", 1), options, 1);
+  ms.add(ds::TCPIP("lb_host3", 1), options, 1);
+  ms.set_policy(ds::Load_balancing::RANDOM);
+
+  unsigned first = 0;
+
+  for (unsigned i = 0; i < 1000; ++i)
+  {
+    LB_visitor vis;
+    ms.visit(vis);
+
+    ASSERT_EQ(3U, vis.m_hosts.size());
+    std::set<std::string> hosts(vis.m_hosts.begin(), vis.m_hosts.end());
+    EXPECT_EQ(3U, hosts.size());
+
+    if ("lb_host1" == vis.m_hosts[0])
+      ++first;
+  }
+
+  cout << "lb_host1 chosen first " << first << " times" << endl;
+  EXPECT_LT(900U, first);
+}
+
+
+/*
+  Check that hosts which could not be connected are marked down and skipped
+  by later sessions. Connections to local ports 1 and 2 are expected to be
+  refused.
+*/
+
+TEST(Multi_source, host_health)
+{
+  ds::TCPIP::Options options("root");
+  ds::Multi_source ms;
+
+  ds::TCPIP host1("127.0.0.1", 1);
+  ds::TCPIP host2("127.0.0.1", 2);
+
+  ms.add(host1, options, 0);
+  ms.add(host2, options, 0);
+
+  ds::Host_stats &stats1 = ds::Host_stats::get(host1);
+  ds::Host_stats &stats2 = ds::Host_stats::get(host2);
+
+  EXPECT_FALSE(stats1.is_down());
+  EXPECT_FALSE(stats2.is_down());
+
+  EXPECT_THROW(cdk::Session s(ms), Error);
+
+  EXPECT_TRUE(stats1.is_down());
+  EXPECT_TRUE(stats2.is_down());
+  EXPECT_EQ(1U, stats1.down_count());
+  EXPECT_EQ(1U, stats1.failures());
+
+  cout << "Hosts marked down are skipped" << endl;
+
+  try {
+    cdk::Session s(ms);
+    FAIL() << "Session should not be created";
+  }
+  catch (const Error &e)
+  {
+    cout << "Expected error: " << e << endl;
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("marked down"));
+  }
+
+  EXPECT_EQ(1U, stats1.down_count());
+  EXPECT_EQ(0U, stats1.up_count());
+
+  cout << "Marking host up" << endl;
+
+  EXPECT_TRUE(stats1.mark_up());
+  EXPECT_FALSE(stats1.mark_up());
+  EXPECT_FALSE(stats1.is_down());
+  EXPECT_EQ(0U, stats1.failures());
+  EXPECT_EQ(1U, stats1.up_count());
+
+  EXPECT_THROW(cdk::Session s(ms), Error);
+  EXPECT_TRUE(stats1.is_down());
+  EXPECT_EQ(2U, stats1.down_count());
+}
+
+
+/*
+  Check that a host which accepts connections but fails the handshake is
+  not marked up. A local listener accepts a single connection and closes it
+  right away.
+*/
+
+TEST(Multi_source, mark_up_after_handshake)
+{
+  using cdk::foundation::Socket;
+
+  ds::TCPIP::Options options("root");
+  ds::TCPIP host("127.0.0.1", 9877);
+  ds::Host_stats &stats = ds::Host_stats::get(host);
+
+  stats.mark_down();
+  EXPECT_TRUE(stats.is_down());
+
+  std::thread server([]() {
+    Socket sock(9877);
+    Socket::Connection conn(sock);
+    conn.wait();
+    conn.close();
+  });
+
+  cdk::foundation::sleep(500);
+
+  EXPECT_THROW(cdk::Session s(host, options), Error);
+  server.join();
+
+  EXPECT_TRUE(stats.is_down());
+  EXPECT_EQ(0U, stats.up_count());
+}
+
+
+TEST(Multi_source, handshake_info)
+{
+  using cdk::ds::mysqlx::Protocol_options;
+
+  ds::Host_stats &stats = ds::Host_stats::get("handshake_info");
+
+  EXPECT_EQ(-1, stats.auth_method(L"root"));
+  EXPECT_EQ(UINT64_MAX, stats.proto_fields());
+
+  stats.set_auth_method(L"root", Protocol_options::SHA256_MEMORY);
+  stats.set_auth_method(L"old_user", Protocol_options::MYSQL41);
+  stats.set_proto_fields(cdk::mysqlx::Protocol_fields::UPSERT);
+  stats.handshake_done(3);
+  stats.handshake_done(1);
+
+  EXPECT_EQ(int(Protocol_options::SHA256_MEMORY), stats.auth_method(L"root"));
+  EXPECT_EQ(int(Protocol_options::MYSQL41), stats.auth_method(L"old_user"));
+  EXPECT_EQ(-1, stats.auth_method(L"other"));
+  EXPECT_EQ(uint64_t(cdk::mysqlx::Protocol_fields::UPSERT), stats.proto_fields());
+  EXPECT_EQ(2U, stats.handshakes());
+  EXPECT_EQ(4U, stats.handshake_round_trips());
+
+  cout << "Remembered information is kept while host is up" << endl;
+
+  EXPECT_FALSE(stats.mark_up());
+  EXPECT_EQ(int(Protocol_options::SHA256_MEMORY), stats.auth_method(L"root"));
+
+  cout << "Remembered information is cleared when host goes down" << endl;
+
+  EXPECT_TRUE(stats.mark_down());
+  EXPECT_EQ(-1, stats.auth_method(L"root"));
+  EXPECT_EQ(-1, stats.auth_method(L"old_user"));
+  EXPECT_EQ(UINT64_MAX, stats.proto_fields());
+
+  cout << "Information stored before host is marked up is kept" << endl;
+
+  stats.set_auth_method(L"root", Protocol_options::MYSQL41);
+  EXPECT_TRUE(stats.mark_up());
+  EXPECT_EQ(int(Protocol_options::MYSQL41), stats.auth_method(L"root"));
+  EXPECT_EQ(2U, stats.handshakes());
+}
+
+
 TEST_F(Session_core, failover_error)
 {
   SKIP_IF_NO_XPLUGIN;
@@ -1473,6 +2016,59 @@ TEST_F(Session_core, auth_method)
 
 }
 
+TEST_F(Session_core, handshake)
+{
+  SKIP_IF_NO_XPLUGIN;
+
+  try
+  {
+    using cdk::ds::mysqlx::Protocol_options;
+
+    ds::TCPIP ds(m_host, m_port);
+    ds::TCPIP::Options options("root");
+
+    ds::Host_stats &stats = ds::Host_stats::get(ds);
+
+    {
+      cdk::Session s(ds, options);
+      if (!s.is_valid())
+        FAIL() << "Session is not valid";
+      cout << "first handshake: " << s.handshake_round_trips()
+           << " round trips" << endl;
+    }
+
+    EXPECT_NE(-1, stats.auth_method(L"root"));
+    EXPECT_NE(UINT64_MAX, stats.proto_fields());
+
+    uint64_t handshakes = stats.handshakes();
+    uint64_t round_trips = stats.handshake_round_trips();
+
+    /*
+      The second session uses information remembered from the first one
+      and skips protocol field checks.
+    */
+
+    cdk::Session s(ds, options);
+    if (!s.is_valid())
+      FAIL() << "Session is not valid";
+
+    cout << "second handshake: " << s.handshake_round_trips()
+         << " round trips" << endl;
+
+    EXPECT_EQ(handshakes + 1, stats.handshakes());
+    EXPECT_EQ(round_trips + s.handshake_round_trips(),
+              stats.handshake_round_trips());
+
+    // Authentication takes at most 2 round trips, TLS negotiation 1.
+
+    EXPECT_GE(3U, s.handshake_round_trips());
+  }
+  catch (Error &e)
+  {
+    FAIL() << "CDK error: " << e << endl;
+  }
+}
+
 TEST_F(Session_core, external_auth)
 {
   SKIP_IF_NO_XPLUGIN;
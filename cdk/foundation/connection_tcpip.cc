@@ -47,11 +47,13 @@ class connection_TCPIP_impl
 {
   std::string m_host;
   unsigned short m_port;
+  uint64_t m_timeout;
 
 public:
 
-  connection_TCPIP_impl(const std::string &host, unsigned short port)
-    : m_host(host), m_port(port)
+  connection_TCPIP_impl(const std::string &host, unsigned short port,
+                        uint64_t timeout_usec)
+    : m_host(host), m_port(port), m_timeout(timeout_usec)
   {}
 
   void do_connect();
@@ -66,7 +68,7 @@ void connection_TCPIP_impl::do_connect()
   if (is_open())
     return;
 
-  m_sock = connection::detail::connect(m_host.c_str(), m_port);
+  m_sock = connection::detail::connect(m_host.c_str(), m_port, m_timeout);
 }
 
 
@@ -116,8 +118,9 @@ namespace connection {
 
 
 TCPIP::TCPIP(const std::string& host,
-             unsigned short port)
-  : opaque_impl<TCPIP>(NULL, host, port)
+             unsigned short port,
+             uint64_t connect_timeout_usec)
+  : opaque_impl<TCPIP>(NULL, host, port, connect_timeout_usec)
 {}
 
 
@@ -202,7 +205,7 @@ void Socket_base::Read_op::do_wait()
     byte* data = buffer.begin() + m_currentBufferOffset;
     size_t buffer_size = buffer.size() - m_currentBufferOffset;
 
-    detail::recv(impl.m_sock, data, buffer_size); // TODO: Implement operation deadline.
+    detail::recv(impl.m_sock, data, buffer_size, impl.m_read_timeout); // TODO: Implement operation deadline.
 
     m_currentBufferOffset = 0;
   }
@@ -244,8 +247,8 @@ void Socket_base::Read_some_op::common_read(bool wait)
 
   const bytes& buffer = m_bufs.get_buffer(0);
 
-  // TODO: Add timeout support.
-  set_completed(detail::recv_some(impl.m_sock, buffer.begin(), buffer.size(), wait));
+  set_completed(detail::recv_some(impl.m_sock, buffer.begin(), buffer.size(),
+                                  wait, impl.m_read_timeout));
 }
 
 
@@ -359,6 +362,11 @@ void Socket_base::connect()
   get_base_impl().do_connect();
 }
 
+void Socket_base::set_read_timeout(uint64_t timeout_usec)
+{
+  get_base_impl().m_read_timeout = timeout_usec;
+}
+
 void Socket_base::close()
 {
   get_base_impl().close();
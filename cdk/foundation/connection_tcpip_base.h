@@ -69,6 +69,7 @@ public:
   typedef detail::Socket socket;
 
   socket m_sock;
+  uint64_t m_read_timeout = 0;  // usec, 0 means no timeout
 
   Impl()
     : m_sock(detail::NULL_SOCKET)
@@ -543,7 +543,8 @@ DIAGNOSTIC_PUSH
   DISABLE_WARNING(4189)
 #endif
 
-Socket connect(const char *host_name, unsigned short port)
+Socket connect(const char *host_name, unsigned short port,
+               uint64_t timeout_usec)
 {
   Socket socket = NULL_SOCKET;
   addrinfo* host_list = NULL;
@@ -591,10 +592,13 @@ Socket connect(const char *host_name, unsigned short port)
         if (connect_result == SOCKET_ERROR && errno == EINPROGRESS)
       #endif
         {
-          int select_result = select_one(socket, SELECT_MODE_WRITE, true);
+          int select_result
+            = select_one(socket, SELECT_MODE_WRITE, true, timeout_usec);
 
           if (select_result < 0)
             throw_socket_error();
+          else if (select_result == 0)
+            throw connection::Error_timeout();
           else
             check_socket_error(socket);
 
@@ -722,9 +726,16 @@ Socket listen_and_accept(unsigned short port)
 }
 
 
-int select_one(Socket socket, Select_mode mode, bool wait)
+int select_one(Socket socket, Select_mode mode, bool wait,
+               uint64_t timeout_usec)
 {
-  timeval zero_timeout = {};
+  timeval timeout = {};
+
+  if (wait && timeout_usec)
+  {
+    timeout.tv_sec = static_cast<long>(timeout_usec / 1000000);
+    timeout.tv_usec = static_cast<long>(timeout_usec % 1000000);
+  }
 
 DIAGNOSTIC_PUSH
 
@@ -747,7 +758,7 @@ DIAGNOSTIC_POP
   int result = ::select(FD_SETSIZE,
     mode == SELECT_MODE_READ ? &socket_set : NULL,
     mode == SELECT_MODE_WRITE ? &socket_set : NULL,
-    &except_set, wait ? NULL : &zero_timeout);
+    &except_set, (wait && !timeout_usec) ? NULL : &timeout);
 
   if (result > 0 && FD_ISSET(socket, &except_set))
     check_socket_error(socket);
@@ -773,7 +784,8 @@ size_t bytes_available(Socket socket)
 }
 
 
-void recv(Socket socket, byte *buffer, size_t buffer_size)
+void recv(Socket socket, byte *buffer, size_t buffer_size,
+          uint64_t timeout_usec)
 {
   // TODO: Investigate if more efficient implementation is possible with ::recv() and MSG_WAITALL flag.
 
@@ -783,7 +795,9 @@ void recv(Socket socket, byte *buffer, size_t buffer_size)
   size_t bytes_received = 0;
 
   while (bytes_received != buffer_size)
-    bytes_received += recv_some(socket, buffer + bytes_received, buffer_size - bytes_received, true);
+    bytes_received += recv_some(socket, buffer + bytes_received,
+                                buffer_size - bytes_received, true,
+                                timeout_usec);
 }
 
 
@@ -799,7 +813,8 @@ void send(Socket socket, const byte *buffer, size_t buffer_size)
 }
 
 
-size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait)
+size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait,
+                 uint64_t timeout_usec)
 {
   if (buffer_size == 0)
     return 0;
@@ -813,7 +828,7 @@ size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait)
 
   size_t bytes_received = 0;
 
-  int select_result = select_one(socket, SELECT_MODE_READ, wait);
+  int select_result = select_one(socket, SELECT_MODE_READ, wait, timeout_usec);
 
   if (select_result > 0)
   {
@@ -847,6 +862,8 @@ size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait)
   }
   else if (select_result == 0)
   {
+    if (wait && timeout_usec)
+      throw connection::Error_timeout();
     return 0;
   }
   else
@@ -235,18 +235,24 @@ addrinfo* addrinfo_from_string(const char* host_name, unsigned short port);
     Destination host name.
   @param[in] port
     Destination host port.
+  @param[in] timeout_usec
+    If not 0, maximal time in microseconds to wait for the connection
+    to be established.
 
   @return
     Connected socket.
 
   @throw cdk::foundation::Error
     Connection failed.
+  @throw cdk::foundation::connection::Error_timeout
+    Connection was not established within the given time.
 
   @note
     This function always blocks.
 */
 
-Socket connect(const char *host, unsigned short port);
+Socket connect(const char *host, unsigned short port,
+               uint64_t timeout_usec = 0);
 
 #ifndef _WIN32
 /**
@@ -304,6 +310,9 @@ Socket listen_and_accept(unsigned short port);
     I/O mode.
   @param[in] wait
     If `true`, function will block. Otherwise, it will return immediately.
+  @param[in] timeout_usec
+    If not 0 and `wait` is `true`, function blocks at most for that many
+    microseconds.
 
   @return
     Same as POSIX `select` function.
@@ -312,7 +321,8 @@ Socket listen_and_accept(unsigned short port);
     If after testing socket is in an erroneous state, function throws.
 */
 
-int select_one(Socket socket, Select_mode mode, bool wait);
+int select_one(Socket socket, Select_mode mode, bool wait,
+               uint64_t timeout_usec = 0);
 
 
 /**
@@ -346,9 +356,13 @@ size_t bytes_available(Socket socket);
   @param[in] buffer_size
     Number of bytes that will be read from a socket. May not be larger than
     the size of `buffer`.
+  @param[in] timeout_usec
+    If not 0, maximal time in microseconds to wait for more data to arrive.
 
   @throw cdk::foundation::connection::Error_eos
     End-of-stream encountered.
+  @throw cdk::foundation::connection::Error_timeout
+    No data arrived within the given time.
   @throw cdk::foundation::Error
     Socket read failed.
 
@@ -356,7 +370,8 @@ size_t bytes_available(Socket socket);
     This function always blocks.
 */
 
-void recv(Socket socket, byte *buffer, size_t buffer_size);
+void recv(Socket socket, byte *buffer, size_t buffer_size,
+          uint64_t timeout_usec = 0);
 
 
 /**
@@ -397,17 +412,23 @@ void send(Socket socket, const byte *buffer, size_t buffer_size);
     than the size of `buffer`.
   @param[in] wait
     If `true`, operation will block. Otherwise, data is immediately available.
+  @param[in] timeout_usec
+    If not 0 and `wait` is `true`, maximal time in microseconds to wait for
+    data to arrive.
 
   @return
     The number of bytes read from a socket.
 
   @throw cdk::foundation::connection::Error_eos
     End-of-stream encountered.
+  @throw cdk::foundation::connection::Error_timeout
+    No data arrived within the given time.
   @throw cdk::foundation::Error
     Socket read failed.
 */
 
-size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait);
+size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait,
+                 uint64_t timeout_usec = 0);
 
 
 /**
@@ -46,12 +46,10 @@ string& string::set_utf8(const std::string &str)
 string::operator std::string() const
 {
   Codec<Type::STRING> codec;
-  size_t len = 4*length() + 1;
-  char *buf = new char[4*length() + 1];
-  len= codec.to_bytes(*this, bytes((byte*)buf, len));
-  buf[len] = '\0';
-  const std::string out(buf, buf+len);
-  delete[] buf;
+  std::string out;
+  out.resize(codec.measure(*this));
+  if (!out.empty())
+    codec.to_bytes(*this, bytes((byte*)&out[0], out.size()));
   return out;
 }
 
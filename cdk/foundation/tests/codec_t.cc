@@ -30,6 +30,7 @@
 
 #include "test.h"
 #include <mysql/cdk/foundation/codec.h>
+#include <mysql/cdk/foundation/varint.h>
 
 using namespace ::std;
 using namespace ::cdk::foundation;
@@ -104,6 +105,136 @@ TEST(Foundation, string)
 }
 
 
+/*
+  Check UTF-8 kernels on longer strings, so that SIMD code paths and block
+  boundaries are exercised, and on invalid input.
+*/
+
+TEST(Foundation, string_utf8)
+{
+  using cdk::foundation::string;
+
+  cout <<"using " <<utf8::kernel_name() <<" kernel" <<endl;
+
+  Codec<Type::STRING> codec;
+
+#define SAMPLE_PAIR(X,Y,Z) { Y, Z },
+
+  struct { const wchar_t *wide; const char *utf8; } samples[] = {
+    SAMPLES(SAMPLE_PAIR)
+  };
+
+  /*
+    Build long strings mixing the samples in different order, so that
+    multi-byte characters land at different positions relative to 16 and
+    32 byte blocks.
+  */
+
+  for (unsigned shift = 0; shift < 40; ++shift)
+  {
+    string wide(std::wstring(shift, L'x'));
+    std::string narrow(shift, 'x');
+
+    for (unsigned i = 0; i < 50; ++i)
+    {
+      unsigned pos = (i + shift) % (sizeof(samples)/sizeof(samples[0]));
+      wide.append(samples[pos].wide);
+      narrow.append(samples[pos].utf8);
+    }
+
+    // 4-byte sequence (U+1F600)
+
+    wide.push_back((wchar_t)0x1F600);
+    narrow.append("\xF0\x9F\x98\x80");
+
+    EXPECT_TRUE(utf8::valid((byte*)narrow.data(),
+                            (byte*)narrow.data() + narrow.size()));
+
+    EXPECT_EQ(narrow.size(), codec.measure(wide));
+
+    std::string buf(narrow.size(), '\0');
+    size_t len = codec.to_bytes(wide, bytes(buf));
+    EXPECT_EQ(narrow.size(), len);
+    EXPECT_EQ(narrow, buf);
+
+    string back;
+    EXPECT_EQ(narrow.size(), codec.from_bytes(bytes(narrow), back));
+    EXPECT_EQ(wide, back);
+
+    // Output buffer too small
+
+    EXPECT_THROW(codec.to_bytes(wide, bytes((byte*)&buf[0], buf.size() - 1)),
+                 Error);
+  }
+
+  const char *invalid[] = {
+    "\x80",                   // lone continuation byte
+    "abc\xC3",                // truncated 2-byte sequence
+    "\xE2\x82",               // truncated 3-byte sequence
+    "\xF0\x9F\x98",           // truncated 4-byte sequence
+    "\xC0\xAF",               // overlong 2-byte
+    "\xE0\x80\xAF",           // overlong 3-byte
+    "\xF0\x80\x80\xAF",       // overlong 4-byte
+    "\xED\xA0\x80",           // surrogate
+    "\xF4\x90\x80\x80",       // above U+10FFFF
+    "\xF8\x88\x80\x80\x80",   // 5-byte sequence
+    "\xC3\xA9\xA9",           // extra continuation byte
+    "\xE2\x28\xA1",           // missing continuation byte
+  };
+
+  // Offset of the invalid sequence within each of the above
+
+  size_t invalid_pos[] = { 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0 };
+
+  for (unsigned i = 0; i < sizeof(invalid)/sizeof(invalid[0]); ++i)
+  {
+    cout <<"checking invalid sequence " <<i <<endl;
+
+    // Put the invalid sequence at different positions in a longer string.
+
+    for (unsigned pre = 0; pre < 70; pre += 7)
+    {
+      std::string str = std::string(pre, 'a') + invalid[i]
+                        + std::string(70 - pre, 'b');
+      string out;
+      EXPECT_FALSE(utf8::valid((byte*)str.data(),
+                               (byte*)str.data() + str.size()));
+      EXPECT_EQ(pre + invalid_pos[i],
+                utf8::invalid_pos((byte*)str.data(),
+                                  (byte*)str.data() + str.size()));
+      EXPECT_THROW(codec.from_bytes(bytes(str), out), Error);
+    }
+
+    // Invalid sequence at the very end of input.
+
+    std::string str = std::string(64, 'a') + invalid[i];
+    string out;
+    EXPECT_THROW(codec.from_bytes(bytes(str), out), Error);
+  }
+
+  // Error description tells where the invalid sequence is
+
+  try {
+    std::string str("abcde\x80");
+    string out;
+    codec.from_bytes(bytes(str), out);
+    FAIL() <<"Should throw error";
+  }
+  catch (const Error &err)
+  {
+    cout <<"Expected error: " <<err <<endl;
+    EXPECT_NE(std::string::npos, std::string(err.what()).find("at byte 5"));
+  }
+
+  // Invalid code points in wide strings
+
+  string bad_wide(L"abc");
+  bad_wide.push_back((wchar_t)0xD800);
+  EXPECT_THROW(codec.measure(bad_wide), Error);
+  EXPECT_THROW((std::string)bad_wide, Error);
+}
+
+
 /*
   Number Codecs
   =============
@@ -405,3 +536,67 @@ TEST(Foundation, number)
   EXPECT_EQ(2U,howmuch);
 
 }
+
+
+TEST(Foundation, varint)
+{
+  /*
+    Check values of all possible varint lengths, decoded from a buffer
+    which ends right after the varint (byte-by-byte path) and from one
+    with spare bytes after it (word-at-a-time path).
+  */
+
+  byte buf[32];
+
+  for (unsigned bits = 0; bits <= 64; ++bits)
+  {
+    uint64_t vals[3] = {
+      bits < 64 ? (uint64_t(1) << bits) - 1 : ~uint64_t(0),
+      bits < 64 ? uint64_t(1) << bits : 0,
+      uint64_t(0x5A5A5A5A5A5A5A5AULL) >> (64 - (bits ? bits : 1))
+    };
+
+    for (unsigned i = 0; i < 3; ++i)
+    {
+      memset(buf, 0xFF, sizeof(buf));
+      size_t len = varint::encode(vals[i], buf, buf + sizeof(buf));
+      ASSERT_GT(len, 0U);
+      ASSERT_LE(len, varint::max_size);
+
+      uint64_t val = 0;
+      EXPECT_EQ(len, varint::decode(buf, buf + len, val));
+      EXPECT_EQ(vals[i], val);
+
+      val = 0;
+      EXPECT_EQ(len, varint::decode(buf, buf + sizeof(buf), val));
+      EXPECT_EQ(vals[i], val);
+
+      // Truncated varint
+
+      EXPECT_EQ(0U, varint::decode(buf, buf + len - 1, val));
+
+      // Buffer too small for encoding
+
+      EXPECT_EQ(0U, varint::encode(vals[i], buf, buf + len - 1));
+    }
+  }
+
+  // Varint longer than 10 bytes is rejected
+
+  memset(buf, 0x80, sizeof(buf));
+  uint64_t val;
+  EXPECT_EQ(0U, varint::decode(buf, buf + sizeof(buf), val));
+
+  // Zig-zag encoding
+
+  int64_t svals[] = {
+    0, -1, 1, -64, 64, std::numeric_limits<int64_t>::min(),
+    std::numeric_limits<int64_t>::max()
+  };
+
+  for (unsigned i = 0; i < sizeof(svals)/sizeof(svals[0]); ++i)
+    EXPECT_EQ(svals[i], varint::zigzag_decode(varint::zigzag_encode(svals[i])));
+
+  EXPECT_EQ(1U, varint::zigzag_encode(-1));
+  EXPECT_EQ(2U, varint::zigzag_encode(1));
+}
@@ -398,6 +398,54 @@ TEST_F(Foundation_connection_tcpip, sudden_close)
 }
 
 
+/*
+  Test that a blocking read times out when read timeout is set and server
+  does not send anything.
+
+  Note: Test server should be started before running this test.
+*/
+
+
+TEST_F(Foundation_connection_tcpip, read_timeout)
+{
+  using cdk::foundation::byte;
+  using connection::TCPIP;
+
+  byte buf_raw[100];
+  buffers bufs(buf_raw, sizeof(buf_raw));
+
+  TCPIP conn("localhost", PORT);
+
+  try {
+    conn.connect();
+  }
+  catch (Error &e)
+  {
+    cout << "Connection error: " << e << endl;
+    FAIL() << "Connection error: " << e << endl;
+  }
+
+  // Test server waits for our message, so nothing arrives.
+
+  conn.set_read_timeout(500000);
+
+  cout << "Reading from server ..." << endl;
+
+  {
+    TCPIP::Read_op read_op(conn, bufs);
+    EXPECT_THROW(read_op.wait(), connection::Error_timeout);
+  }
+
+  {
+    TCPIP::Read_some_op read_op(conn, bufs);
+    EXPECT_THROW(read_op.wait(), connection::Error_timeout);
+  }
+
+  conn.close();
+  cout << "Done!" << endl;
+}
+
+
 /*
   Testing behavior of APIs when there is no connection.
   Stage 1: calling APIs on fresh TCPIP instance without connection
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmark of UTF-8 string decoding/encoding
+  ===========================================
+
+  Compares String_codec based on std::codecvt_utf8<> facet, which converts
+  one character at a time, with Codec<Type::STRING> which uses UTF-8
+  kernels from utf8.h. Input data imitates string columns of a result set:
+  many short values of varying length with ASCII-heavy, mixed (European
+  languages) or CJK content.
+
+  Usage: string_bench [<iterations>]
+
+  Results are meaningful only for an optimized (Release) build. Without
+  optimization SIMD intrinsics are not inlined and the kernels run several
+  times slower than the codecvt facet (AVX2 was 4-6x slower in a -O0 Debug
+  build). In a Release build decoding was x1.19 faster for mixed and x1.66
+  for CJK data.
+*/
+
+#include <mysql/cdk/foundation/codec.h>
+
+PUSH_SYS_WARNINGS
+#include <codecvt>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+POP_SYS_WARNINGS
+
+using namespace ::cdk::foundation;
+using std::cout;
+using std::endl;
+
+
+/*
+  Reference codec using standard library facet.
+*/
+
+struct std_codecvt_utf8 : public std::codecvt_utf8<char_t>
+{
+  size_t measure(const string&) const { return 0; }
+};
+
+typedef String_codec<std_codecvt_utf8> Std_codec;
+
+
+static const char *ascii_words[] = {
+  "john.smith@example.com", "Warehouse", "2018-03-11", "ACTIVE",
+  "c7f1b9a2-55e1-4b2e-9d0f-3f8a1e6b7c21", "New York", "Order #10023",
+  "This is a somewhat longer free text comment stored in a VARCHAR column."
+};
+
+static const char *mixed_words[] = {
+  "Mog\xC4\x99 je\xC5\x9B\xC4\x87 szk\xC5\x82o", "M\xC3\xBCnchen",
+  "Posso comer vidro, n\xC3\xA3o me faz mal", "Z\xC3\xBCrich", "Fran\xC3\xA7ois",
+  "\xD0\xAF \xD0\xBC\xD0\xBE\xD0\xB6\xD1\x83 \xD1\x97\xD1\x81\xD1\x82\xD0\xB8",
+  "Stra\xC3\x9F" "e 12", "S\xC3\xA3o Paulo"
+};
+
+static const char *cjk_words[] = {
+  "\xE7\xA7\x81\xE3\x81\xAF\xE3\x82\xAC\xE3\x83\xA9\xE3\x82\xB9\xE3\x82\x92",
+  "\xE6\x9D\xB1\xE4\xBA\xAC\xE9\x83\xBD",
+  "\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x89\xE3\x82\x8C\xE3\x81\xBE\xE3\x81\x99",
+  "\xE5\x8C\x97\xE4\xBA\xAC\xE5\xB8\x82\xE6\x9C\x9D\xE9\x98\xB3\xE5\x8C\xBA",
+  "\xE3\x81\x9D\xE3\x82\x8C\xE3\x81\xAF\xE7\xA7\x81\xE3\x82\x92\xE5\x82\xB7"
+  "\xE3\x81\xA4\xE3\x81\x91\xE3\x81\xBE\xE3\x81\x9B\xE3\x82\x93\xE3\x80\x82"
+};
+
+
+/*
+  Generate column values by concatenating 1 to 4 words.
+*/
+
+template <size_t N>
+std::vector<std::string> make_column(const char *(&words)[N], size_t rows)
+{
+  std::vector<std::string> column;
+  unsigned seed = 1;
+
+  for (size_t row = 0; row < rows; ++row)
+  {
+    std::string val;
+    seed = seed * 1103515245 + 12345;
+    unsigned count = 1 + (seed >> 16) % 4;
+    for (unsigned i = 0; i < count; ++i)
+    {
+      if (i > 0)
+        val.push_back(' ');
+      val.append(words[(seed >> (4 + 3*i)) % N]);
+    }
+    column.push_back(val);
+  }
+
+  return column;
+}
+
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+
+template <class CODEC>
+double bench_decode(CODEC &codec, const std::vector<std::string> &column,
+                    unsigned iterations, size_t &total)
+{
+  string out;
+  bench_clock::time_point start = bench_clock::now();
+
+  for (unsigned i = 0; i < iterations; ++i)
+    for (size_t row = 0; row < column.size(); ++row)
+      total += codec.from_bytes(bytes(column[row]), out);
+
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+
+template <class CODEC>
+double bench_encode(CODEC &codec, const std::vector<string> &column,
+                    unsigned iterations, size_t &total)
+{
+  std::vector<byte> buf(1024);
+  bench_clock::time_point start = bench_clock::now();
+
+  for (unsigned i = 0; i < iterations; ++i)
+    for (size_t row = 0; row < column.size(); ++row)
+      total += codec.to_bytes(column[row], bytes(buf.data(), buf.size()));
+
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+
+void run(const char *name, const std::vector<std::string> &column,
+         unsigned iterations)
+{
+  Std_codec std_codec;
+  Codec<Type::STRING> codec;
+
+  size_t bytes_total = 0;
+  std::vector<string> wide;
+
+  for (size_t row = 0; row < column.size(); ++row)
+  {
+    bytes_total += column[row].size();
+    string val;
+    codec.from_bytes(bytes(column[row]), val);
+    wide.push_back(val);
+  }
+
+  double mb = (double)bytes_total * iterations / (1024 * 1024);
+  size_t check = 0;
+
+  double t_std_in = bench_decode(std_codec, column, iterations, check);
+  double t_in = bench_decode(codec, column, iterations, check);
+  double t_std_out = bench_encode(std_codec, wide, iterations, check);
+  double t_out = bench_encode(codec, wide, iterations, check);
+
+  cout << name << " (" << column.size() << " values, "
+       << bytes_total / column.size() << " bytes avg)" << endl;
+  cout << "  decode: codecvt " << mb / t_std_in << " MB/s, "
+       << utf8::kernel_name() << " " << mb / t_in << " MB/s"
+       << " (x" << t_std_in / t_in << ")" << endl;
+  cout << "  encode: codecvt " << mb / t_std_out << " MB/s, "
+       << utf8::kernel_name() << " " << mb / t_out << " MB/s"
+       << " (x" << t_std_out / t_out << ")" << endl;
+
+  if (0 == check)
+    cout << "  (no data)" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned iterations = argc > 1 ? (unsigned)atoi(argv[1]) : 50;
+  const size_t rows = 10000;
+
+#ifndef NDEBUG
+  cout << "WARNING: not an optimized build, timings of "
+       << utf8::kernel_name() << " kernel are not representative" << endl;
+#endif
+
+  run("ascii", make_column(ascii_words, rows), iterations);
+  run("mixed", make_column(mixed_words, rows), iterations);
+  run("cjk", make_column(cjk_words, rows), iterations);
+
+  return 0;
+}
@@ -0,0 +1,879 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  UTF-8 validation and transcoding kernels
+  ========================================
+
+  Validation of non-ASCII input in the SIMD variants uses the lookup
+  algorithm described in: J. Keiser, D. Lemire "Validating UTF-8 In Less
+  Than One Instruction Per Byte". Each input byte is classified together
+  with the byte preceding it using three 16-entry lookup tables (indexed by
+  high nibble of the previous byte, low nibble of the previous byte and
+  high nibble of the current byte). Each bit in the table entries stands
+  for one kind of error and the AND of the three lookups is non-zero only
+  if the 2-byte sequence is invalid. Continuation bytes required by 3 and
+  4 byte sequences are checked separately by looking 2 and 3 bytes back.
+
+  Transcoding assumes that the input has been validated and does not
+  re-check the sequences. Runs of ASCII characters are widened 16 or 32
+  bytes at a time, other characters are decoded one by one.
+*/
+
+#include <mysql/cdk/foundation/utf8.h>
+
+PUSH_SYS_WARNINGS
+#include <string.h>   // for memcpy
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define UTF8_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+POP_SYS_WARNINGS
+
+
+/*
+  With gcc and clang, SIMD variants are compiled for a specific target
+  using function attributes so that the rest of the code does not depend
+  on compiler flags. MSVC allows using intrinsics without any extra
+  annotations.
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE41  __attribute__((target("sse4.1")))
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#else
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
+
+
+namespace cdk {
+namespace foundation {
+namespace utf8 {
+
+
+/*
+  Scalar code
+  ===========
+*/
+
+static const uint64_t high_bits = 0x8080808080808080ULL;
+
+static inline
+bool is_ascii8(const byte *p)
+{
+  uint64_t chunk;
+  memcpy(&chunk, p, sizeof(chunk));
+  return 0 == (chunk & high_bits);
+}
+
+
+/*
+  Return pointer to the first byte of the first invalid sequence in
+  [p, end) or end if the whole input is valid.
+*/
+
+static
+const byte* scan_scalar(const byte *p, const byte *end)
+{
+  while (p < end)
+  {
+    if (end - p >= 8 && is_ascii8(p))
+    {
+      p += 8;
+      continue;
+    }
+
+    byte c = *p;
+
+    if (c < 0x80)
+    {
+      p++;
+      continue;
+    }
+
+    size_t len;
+    byte lo = 0x80, hi = 0xBF;  // allowed range of the second byte
+
+    if (c < 0xC2)
+      return p;                 // continuation byte or overlong 2-byte
+    else if (c < 0xE0)
+      len = 2;
+    else if (c < 0xF0)
+    {
+      len = 3;
+      if (0xE0 == c) lo = 0xA0;   // overlong
+      if (0xED == c) hi = 0x9F;   // surrogates
+    }
+    else if (c < 0xF5)
+    {
+      len = 4;
+      if (0xF0 == c) lo = 0x90;   // overlong
+      if (0xF4 == c) hi = 0x8F;   // above U+10FFFF
+    }
+    else
+      return p;
+
+    if ((size_t)(end - p) < len)
+      return p;
+
+    if (p[1] < lo || p[1] > hi)
+      return p;
+
+    for (size_t i = 2; i < len; ++i)
+      if ((p[i] & 0xC0) != 0x80)
+        return p;
+
+    p += len;
+  }
+
+  return end;
+}
+
+
+static
+bool valid_scalar(const byte *p, const byte *end)
+{
+  return end == scan_scalar(p, end);
+}
+
+
+/*
+  Store code point in the output buffer, splitting it into surrogate pair
+  if char_t is 16-bit wide.
+*/
+
+static inline
+char_t* put_char(char_t *out, uint32_t cp)
+{
+  if (sizeof(char_t) < 4 && cp > 0xFFFF)
+  {
+    cp -= 0x10000;
+    *out++ = (char_t)(0xD800 + (cp >> 10));
+    *out++ = (char_t)(0xDC00 + (cp & 0x3FF));
+    return out;
+  }
+
+  *out++ = (char_t)cp;
+  return out;
+}
+
+
+/*
+  Decode single, non-ASCII character from valid UTF-8 input.
+*/
+
+static inline
+const byte* decode_char(const byte *p, char_t *&out)
+{
+  byte c = *p;
+
+  if (c < 0xE0)
+  {
+    out = put_char(out, ((c & 0x1Fu) << 6) | (p[1] & 0x3Fu));
+    return p + 2;
+  }
+
+  if (c < 0xF0)
+  {
+    out = put_char(out,
+      ((c & 0x0Fu) << 12) | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu));
+    return p + 3;
+  }
+
+  out = put_char(out,
+    ((c & 0x07u) << 18) | ((p[1] & 0x3Fu) << 12)
+    | ((p[2] & 0x3Fu) << 6) | (p[3] & 0x3Fu));
+  return p + 4;
+}
+
+
+/*
+  Decode characters until position stop is reached or passed.
+*/
+
+static inline
+const byte* decode_until(const byte *p, const byte *stop, char_t *&out)
+{
+  while (p < stop)
+  {
+    if (*p < 0x80)
+      *out++ = (char_t)*p++;
+    else
+      p = decode_char(p, out);
+  }
+  return p;
+}
+
+
+static
+size_t decode_scalar(const byte *p, const byte *end, char_t *out)
+{
+  char_t *const start = out;
+
+  while (p < end)
+  {
+    if (end - p >= 8 && is_ascii8(p))
+    {
+      for (unsigned i = 0; i < 8; ++i)
+        out[i] = (char_t)p[i];
+      p += 8;
+      out += 8;
+      continue;
+    }
+
+    p = decode_until(p, (end - p) < 8 ? end : p + 8, out);
+  }
+
+  return (size_t)(out - start);
+}
+
+
+/*
+  Get next code point from wide string, combining surrogate pairs if
+  char_t is 16-bit. Returns false if invalid code point is found.
+*/
+
+static inline
+bool next_code_point(const char_t *&from, const char_t *end, uint32_t &cp)
+{
+  cp = (uint32_t)*from;
+
+  if (sizeof(char_t) < 4)
+  {
+    cp &= 0xFFFF;
+    if (cp >= 0xD800 && cp <= 0xDBFF)
+    {
+      if (from + 1 >= end)
+        return false;
+      uint32_t lo = (uint32_t)from[1] & 0xFFFF;
+      if (lo < 0xDC00 || lo > 0xDFFF)
+        return false;
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+      from += 2;
+      return true;
+    }
+  }
+
+  if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+    return false;
+
+  from++;
+  return true;
+}
+
+
+static inline
+unsigned encoded_width(uint32_t cp)
+{
+  return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+
+size_t measure(const char_t *from, const char_t *end)
+{
+  size_t len = 0;
+
+  while (from < end)
+  {
+    uint32_t cp;
+    if (!next_code_point(from, end, cp))
+      return size_t(-1);
+    len += encoded_width(cp);
+  }
+
+  return len;
+}
+
+
+static
+std::codecvt_base::result
+encode_scalar(const char_t *&from, const char_t *from_end,
+              byte *&to, byte *to_end)
+{
+  while (from < from_end)
+  {
+    const char_t *next = from;
+    uint32_t cp;
+
+    if (!next_code_point(next, from_end, cp))
+      return std::codecvt_base::error;
+
+    unsigned width = encoded_width(cp);
+
+    if (to + width > to_end)
+      return std::codecvt_base::partial;
+
+    switch (width)
+    {
+    case 1:
+      to[0] = (byte)cp;
+      break;
+    case 2:
+      to[0] = (byte)(0xC0 | (cp >> 6));
+      to[1] = (byte)(0x80 | (cp & 0x3F));
+      break;
+    case 3:
+      to[0] = (byte)(0xE0 | (cp >> 12));
+      to[1] = (byte)(0x80 | ((cp >> 6) & 0x3F));
+      to[2] = (byte)(0x80 | (cp & 0x3F));
+      break;
+    default:
+      to[0] = (byte)(0xF0 | (cp >> 18));
+      to[1] = (byte)(0x80 | ((cp >> 12) & 0x3F));
+      to[2] = (byte)(0x80 | ((cp >> 6) & 0x3F));
+      to[3] = (byte)(0x80 | (cp & 0x3F));
+      break;
+    }
+
+    to += width;
+    from = next;
+  }
+
+  return std::codecvt_base::ok;
+}
+
+
+#ifdef UTF8_X86
+
+/*
+  Lookup tables for the SIMD validation
+  =====================================
+
+  Error bits (the names describe the offending 2-byte sequence):
+*/
+
+enum {
+  TOO_SHORT  = 1 << 0,  // 11______ 0_______ or 11______ 11______
+  TOO_LONG   = 1 << 1,  // 0_______ 10______
+  OVERLONG_3 = 1 << 2,  // 11100000 100_____
+  TOO_LARGE  = 1 << 3,  // 11110100 1001____ and above
+  SURROGATE  = 1 << 4,  // 11101101 101_____
+  OVERLONG_2 = 1 << 5,  // 1100000_ 10______
+  TOO_LARGE_1000 = 1 << 6,  // 11110101 1000____ and above
+  OVERLONG_4 = 1 << 6,  // 11110000 1000____
+  TWO_CONTS  = 1 << 7,  // 10______ 10______
+  CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS
+};
+
+#define BYTE_1_HIGH \
+  TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,                 \
+  TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,                 \
+  TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,             \
+  TOO_SHORT | OVERLONG_2,                                 \
+  TOO_SHORT,                                              \
+  TOO_SHORT | OVERLONG_3 | SURROGATE,                     \
+  TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+#define BYTE_1_LOW \
+  CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,           \
+  CARRY | OVERLONG_2,                                     \
+  CARRY,                                                  \
+  CARRY,                                                  \
+  CARRY | TOO_LARGE,                                      \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,         \
+  CARRY | TOO_LARGE | TOO_LARGE_1000,                     \
+  CARRY | TOO_LARGE | TOO_LARGE_1000
+
+#define BYTE_2_HIGH \
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,                           \
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,                           \
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000       \
+    | OVERLONG_4,                                                       \
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,           \
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,            \
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,            \
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+
+/*
+  Bytes at the end of a block which start a sequence that does not fit
+  in the block: 111_____ at position -3 and 11______ at positions -2, -1.
+*/
+
+#define INCOMPLETE_MAX \
+  (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, \
+  (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, \
+  (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF, \
+  (char)0xFF, (char)0xEF, (char)0xDF, (char)0xBF
+
+
+/*
+  SSE4.1 variant
+  ==============
+*/
+
+struct Sse41
+{
+  __m128i m_err;
+  __m128i m_prev;
+  __m128i m_prev_incomplete;
+
+  TARGET_SSE41
+  Sse41()
+    : m_err(_mm_setzero_si128())
+    , m_prev(_mm_setzero_si128())
+    , m_prev_incomplete(_mm_setzero_si128())
+  {}
+
+  TARGET_SSE41
+  void check_block(__m128i in)
+  {
+    if (0 == _mm_movemask_epi8(in))
+    {
+      m_err = _mm_or_si128(m_err, m_prev_incomplete);
+      m_prev_incomplete = _mm_setzero_si128();
+      m_prev = in;
+      return;
+    }
+
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i byte_1_high = _mm_setr_epi8(BYTE_1_HIGH);
+    const __m128i byte_1_low = _mm_setr_epi8(BYTE_1_LOW);
+    const __m128i byte_2_high = _mm_setr_epi8(BYTE_2_HIGH);
+
+    __m128i prev1 = _mm_alignr_epi8(in, m_prev, 15);
+    __m128i prev2 = _mm_alignr_epi8(in, m_prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(in, m_prev, 13);
+
+    __m128i sc = _mm_and_si128(
+      _mm_and_si128(
+        _mm_shuffle_epi8(byte_1_high,
+          _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+        _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+      _mm_shuffle_epi8(byte_2_high,
+        _mm_and_si128(_mm_srli_epi16(in, 4), nibble)));
+
+    // Bytes which must be the 2nd/3rd continuation of 3/4 byte sequences.
+
+    __m128i must23 = _mm_or_si128(
+      _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))),
+      _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))));
+    __m128i must23_80 = _mm_and_si128(must23, _mm_set1_epi8((char)0x80));
+
+    m_err = _mm_or_si128(m_err, _mm_xor_si128(must23_80, sc));
+    m_prev_incomplete = _mm_subs_epu8(in, _mm_setr_epi8(INCOMPLETE_MAX));
+    m_prev = in;
+  }
+
+  TARGET_SSE41
+  static bool valid(const byte *p, const byte *end)
+  {
+    Sse41 state;
+
+    for (; end - p >= 16; p += 16)
+      state.check_block(_mm_loadu_si128((const __m128i*)p));
+
+    if (p < end)
+    {
+      // Zero padding makes incomplete trailing sequences invalid.
+      byte tail[16] = { 0 };
+      memcpy(tail, p, (size_t)(end - p));
+      state.check_block(_mm_loadu_si128((const __m128i*)tail));
+    }
+
+    __m128i err = _mm_or_si128(state.m_err, state.m_prev_incomplete);
+    return 0 != _mm_testz_si128(err, err);
+  }
+
+  /*
+    Store 16 ASCII characters from in as char_t values.
+  */
+
+  TARGET_SSE41
+  static void widen(__m128i in, char_t *out)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(in, zero);
+    __m128i hi = _mm_unpackhi_epi8(in, zero);
+
+    if (sizeof(char_t) == 2)
+    {
+      _mm_storeu_si128((__m128i*)out, lo);
+      _mm_storeu_si128((__m128i*)(out + 8), hi);
+      return;
+    }
+
+    _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi16(hi, zero));
+  }
+
+  TARGET_SSE41
+  static size_t decode(const byte *p, const byte *end, char_t *out)
+  {
+    char_t *const start = out;
+
+    while (end - p >= 16)
+    {
+      __m128i in = _mm_loadu_si128((const __m128i*)p);
+
+      if (0 == _mm_movemask_epi8(in))
+      {
+        widen(in, out);
+        p += 16;
+        out += 16;
+        continue;
+      }
+
+      // Decode characters starting within this block one by one.
+
+      p = decode_until(p, p + 16, out);
+    }
+
+    return (size_t)(out - start) + decode_scalar(p, end, out);
+  }
+
+  /*
+    Encode runs of ASCII characters, 16 at a time, and the remaining ones
+    using scalar code.
+  */
+
+  TARGET_SSE41
+  static std::codecvt_base::result
+  encode(const char_t *&from, const char_t *from_end, byte *&to, byte *to_end)
+  {
+    const unsigned step = 16 * sizeof(char_t) / sizeof(__m128i);
+    const __m128i non_ascii = sizeof(char_t) == 2 ?
+      _mm_set1_epi16((short)0xFF80) : _mm_set1_epi32((int)0xFFFFFF80);
+
+    while (from_end - from >= 16 && to_end - to >= 16)
+    {
+      __m128i in[4];
+      __m128i any = _mm_setzero_si128();
+
+      for (unsigned i = 0; i < step; ++i)
+      {
+        in[i] = _mm_loadu_si128(
+          (const __m128i*)(from + i * sizeof(__m128i) / sizeof(char_t)));
+        any = _mm_or_si128(any, in[i]);
+      }
+
+      if (!_mm_testz_si128(any, non_ascii))
+      {
+        // Convert next 16 characters using scalar code, but do not split
+        // a surrogate pair.
+
+        const char_t *stop = from + 16;
+        if (sizeof(char_t) < 4 && stop < from_end
+            && 0xD800 == ((unsigned)stop[-1] & 0xFC00))
+          ++stop;
+
+        std::codecvt_base::result res = encode_scalar(from, stop, to, to_end);
+        if (std::codecvt_base::ok != res)
+          return res;
+        continue;
+      }
+
+      __m128i packed = sizeof(char_t) == 2 ?
+        _mm_packus_epi16(in[0], in[1]) :
+        _mm_packus_epi16(_mm_packus_epi32(in[0], in[1]),
+                         _mm_packus_epi32(in[2], in[3]));
+
+      _mm_storeu_si128((__m128i*)to, packed);
+      from += 16;
+      to += 16;
+    }
+
+    return encode_scalar(from, from_end, to, to_end);
+  }
+};
+
+
+/*
+  AVX2 variant
+  ============
+*/
+
+struct Avx2
+{
+  __m256i m_err;
+  __m256i m_prev;
+  __m256i m_prev_incomplete;
+
+  TARGET_AVX2
+  Avx2()
+    : m_err(_mm256_setzero_si256())
+    , m_prev(_mm256_setzero_si256())
+    , m_prev_incomplete(_mm256_setzero_si256())
+  {}
+
+  TARGET_AVX2
+  void check_block(__m256i in)
+  {
+    if (0 == _mm256_movemask_epi8(in))
+    {
+      m_err = _mm256_or_si256(m_err, m_prev_incomplete);
+      m_prev_incomplete = _mm256_setzero_si256();
+      m_prev = in;
+      return;
+    }
+
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i byte_1_high = _mm256_setr_epi8(BYTE_1_HIGH, BYTE_1_HIGH);
+    const __m256i byte_1_low = _mm256_setr_epi8(BYTE_1_LOW, BYTE_1_LOW);
+    const __m256i byte_2_high = _mm256_setr_epi8(BYTE_2_HIGH, BYTE_2_HIGH);
+
+    // Previous block's upper half followed by this block's lower half.
+
+    __m256i shifted = _mm256_permute2x128_si256(m_prev, in, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(in, shifted, 15);
+    __m256i prev2 = _mm256_alignr_epi8(in, shifted, 14);
+    __m256i prev3 = _mm256_alignr_epi8(in, shifted, 13);
+
+    __m256i sc = _mm256_and_si256(
+      _mm256_and_si256(
+        _mm256_shuffle_epi8(byte_1_high,
+          _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+        _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+      _mm256_shuffle_epi8(byte_2_high,
+        _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)));
+
+    __m256i must23 = _mm256_or_si256(
+      _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80))),
+      _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80))));
+    __m256i must23_80 = _mm256_and_si256(must23,
+                                         _mm256_set1_epi8((char)0x80));
+
+    m_err = _mm256_or_si256(m_err, _mm256_xor_si256(must23_80, sc));
+    m_prev_incomplete = _mm256_subs_epu8(in,
+      _mm256_setr_epi8(
+        (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+        (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+        (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+        (char)0xFF, (char)0xFF, (char)0xFF, (char)0xFF,
+        INCOMPLETE_MAX));
+    m_prev = in;
+  }
+
+  TARGET_AVX2
+  static bool valid(const byte *p, const byte *end)
+  {
+    Avx2 state;
+
+    for (; end - p >= 32; p += 32)
+      state.check_block(_mm256_loadu_si256((const __m256i*)p));
+
+    if (p < end)
+    {
+      byte tail[32] = { 0 };
+      memcpy(tail, p, (size_t)(end - p));
+      state.check_block(_mm256_loadu_si256((const __m256i*)tail));
+    }
+
+    __m256i err = _mm256_or_si256(state.m_err, state.m_prev_incomplete);
+    return 0 != _mm256_testz_si256(err, err);
+  }
+
+  TARGET_AVX2
+  static void widen(__m128i in, char_t *out)
+  {
+    if (sizeof(char_t) == 2)
+    {
+      _mm256_storeu_si256((__m256i*)out, _mm256_cvtepu8_epi16(in));
+      return;
+    }
+
+    _mm256_storeu_si256((__m256i*)out, _mm256_cvtepu8_epi32(in));
+    _mm256_storeu_si256((__m256i*)(out + 8),
+                        _mm256_cvtepu8_epi32(_mm_srli_si128(in, 8)));
+  }
+
+  TARGET_AVX2
+  static size_t decode(const byte *p, const byte *end, char_t *out)
+  {
+    char_t *const start = out;
+
+    while (end - p >= 32)
+    {
+      __m256i in = _mm256_loadu_si256((const __m256i*)p);
+
+      if (0 == _mm256_movemask_epi8(in))
+      {
+        widen(_mm256_castsi256_si128(in), out);
+        widen(_mm256_extracti128_si256(in, 1), out + 16);
+        p += 32;
+        out += 32;
+        continue;
+      }
+
+      p = decode_until(p, p + 32, out);
+    }
+
+    return (size_t)(out - start) + Sse41::decode(p, end, out);
+  }
+};
+
+
+/*
+  Run-time CPU feature detection.
+*/
+
+static bool cpu_has(bool avx2)
+{
+#if defined(_MSC_VER)
+
+  int info[4];
+  __cpuid(info, 0);
+  int max_leaf = info[0];
+
+  if (max_leaf < 1)
+    return false;
+
+  __cpuid(info, 1);
+  bool sse41 = 0 != (info[2] & (1 << 19));
+
+  if (!avx2)
+    return sse41;
+
+  // AVX2 requires OS support for saving YMM registers (OSXSAVE + XCR0).
+
+  bool osxsave = 0 != (info[2] & (1 << 27));
+  if (!osxsave || max_leaf < 7)
+    return false;
+  if ((_xgetbv(0) & 0x6) != 0x6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return 0 != (info[1] & (1 << 5));
+
+#elif defined(__GNUC__) || defined(__clang__)
+
+  __builtin_cpu_init();
+  return avx2 ?
+    0 != __builtin_cpu_supports("avx2") :
+    0 != __builtin_cpu_supports("sse4.1");
+
+#else
+
+  (void)avx2;
+  return false;
+
+#endif
+}
+
+#endif  // UTF8_X86
+
+
+/*
+  Kernel dispatch
+  ===============
+*/
+
+struct Kernels
+{
+  typedef bool (*valid_t)(const byte*, const byte*);
+  typedef size_t (*decode_t)(const byte*, const byte*, char_t*);
+  typedef std::codecvt_base::result
+          (*encode_t)(const char_t*&, const char_t*, byte*&, byte*);
+
+  const char *m_name;
+  valid_t  m_valid;
+  decode_t m_decode;
+  encode_t m_encode;
+
+  Kernels()
+    : m_name("scalar")
+    , m_valid(valid_scalar)
+    , m_decode(decode_scalar)
+    , m_encode(encode_scalar)
+  {
+#ifdef UTF8_X86
+    if (cpu_has(true))
+    {
+      m_name = "avx2";
+      m_valid = Avx2::valid;
+      m_decode = Avx2::decode;
+      m_encode = Sse41::encode;
+    }
+    else if (cpu_has(false))
+    {
+      m_name = "sse4.1";
+      m_valid = Sse41::valid;
+      m_decode = Sse41::decode;
+      m_encode = Sse41::encode;
+    }
+#endif
+  }
+};
+
+
+static const Kernels& kernels()
+{
+  // Note: initialization of local statics is thread safe in C++11.
+  static const Kernels impl;
+  return impl;
+}
+
+
+bool valid(const byte *beg, const byte *end)
+{
+  return kernels().m_valid(beg, end);
+}
+
+
+size_t invalid_pos(const byte *beg, const byte *end)
+{
+  return static_cast<size_t>(scan_scalar(beg, end) - beg);
+}
+
+
+size_t decode(const byte *beg, const byte *end, char_t *out)
+{
+  return kernels().m_decode(beg, end, out);
+}
+
+
+std::codecvt_base::result
+encode(const char_t *&from, const char_t *from_end, byte *&to, byte *to_end)
+{
+  return kernels().m_encode(from, from_end, to, to_end);
+}
+
+
+const char* kernel_name()
+{
+  return kernels().m_name;
+}
+
+
+}}}  // cdk::foundation::utf8
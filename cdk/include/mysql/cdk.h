@@ -37,6 +37,7 @@
 #include "cdk/reply.h"
 #include "cdk/cursor.h"
 #include "cdk/codec.h"
+#include "cdk/mux.h"
 
 /*
   On Windows, external dependencies can be declared using
@@ -100,15 +100,18 @@ public:
 
   Format(const Format_info &fi)
     : Format_base(TYPE_FLOAT, fi)
+    , m_unsigned(false)
   {
     fi.get_info(*this);
   }
 
   Fmt type() const { return m_fmt; }
+  bool is_unsigned() const { return m_unsigned; }
 
 protected:
 
   Fmt  m_fmt;
+  bool m_unsigned;
 
 public:
 
@@ -274,6 +277,16 @@ public:
   Codec_base(const Format_info &fi)
     : m_fmt(fi)
   {}
+
+  /*
+    Create codec from a copy of encoding format description. This is used
+    when the Format_info instance from which it was obtained is not
+    available anymore (see Session_mux::Result).
+  */
+
+  Codec_base(const Format<TI> &fmt)
+    : m_fmt(fmt)
+  {}
 };
 
 
@@ -297,6 +310,10 @@ public:
     : Codec_base<TYPE_STRING>(fi)
   {}
 
+  Codec(const Format<TYPE_STRING> &fmt)
+    : Codec_base<TYPE_STRING>(fmt)
+  {}
+
   /// Return number of bytes required to encode given string.
   size_t measure(const string&);
 
@@ -335,6 +352,7 @@ class Codec<TYPE_INTEGER>
 public:
 
   Codec(const Format_info &fi) : Codec_base<TYPE_INTEGER>(fi) {}
+  Codec(const Format<TYPE_INTEGER> &fmt) : Codec_base<TYPE_INTEGER>(fmt) {}
 
   virtual size_t from_bytes(bytes buf, int8_t &val);
   virtual size_t from_bytes(bytes buf, int16_t &val);
@@ -354,6 +372,49 @@ public:
   virtual size_t to_bytes(uint16_t val, bytes buf);
   virtual size_t to_bytes(uint32_t val, bytes buf);
   virtual size_t to_bytes(uint64_t val, bytes buf);
+
+  /*
+    Decode a batch of values of a column, given as an array of count
+    raw field buffers, into vals[] array. Empty buffers represent NULL
+    values: they are decoded as 0 and, if nulls array is given, the
+    corresponding nulls[] entry is set to true. Throws conversion error
+    if an unsigned value does not fit into int64_t. Returns the number
+    of decoded values.
+  */
+
+  size_t from_bytes(const bytes *fields, size_t count,
+                    int64_t *vals, bool *nulls = NULL);
+};
+
+
+/*
+  Exact representation of a DECIMAL value. The value equals
+  coefficient * 10^(-scale) where the unsigned coefficient is a 128-bit
+  integer stored in two 64-bit halves. This is enough to hold any DECIMAL
+  value with up to 38 digits.
+*/
+
+struct Decimal
+{
+  uint64_t  lo;         // lower 64 bits of the coefficient
+  uint64_t  hi;         // upper 64 bits of the coefficient
+  uint8_t   scale;      // number of digits after the decimal point
+  bool      negative;
+
+  Decimal()
+    : lo(0), hi(0), scale(0), negative(false)
+  {}
+
+  /*
+    Return decimal string representation of the value. The decimal point
+    is always '.', regardless of the current locale.
+  */
+
+  std::string str() const;
+
+  // Return the nearest double value.
+
+  double to_double() const;
 };
 
 
@@ -369,18 +430,98 @@ class Codec<TYPE_FLOAT>
 public:
 
   Codec(const Format_info &fi) : Codec_base<TYPE_FLOAT>(fi) {}
+  Codec(const Format<TYPE_FLOAT> &fmt) : Codec_base<TYPE_FLOAT>(fmt) {}
 
   virtual ~Codec() {}
 
   virtual size_t from_bytes(bytes buf, float &val);
   virtual size_t from_bytes(bytes buf, double &val);
 
+  /*
+    Decode DECIMAL value without loss of precision. Throws conversion
+    error if the format is not DECIMAL or if the value does not fit
+    into Decimal.
+  */
+
+  virtual size_t from_bytes(bytes buf, Decimal &val);
+
   virtual size_t to_bytes(float val, bytes buf);
   virtual size_t to_bytes(double val, bytes buf);
 
 };
 
 
+/*
+  Value of a temporal type. For DATE, DATETIME and TIMESTAMP values
+  the date part and (optionally) the time part is used. For TIME values
+  only the time part is used, hour can be bigger than 23 and the value
+  can be negative.
+*/
+
+struct Datetime
+{
+  uint16_t  year;
+  uint8_t   month;
+  uint8_t   day;
+  uint16_t  hour;
+  uint8_t   minute;
+  uint8_t   second;
+  uint32_t  usec;       // microseconds
+  bool      negative;   // only TIME values can be negative
+
+  Datetime()
+    : year(0), month(0), day(0), hour(0), minute(0), second(0), usec(0)
+    , negative(false)
+  {}
+
+  /*
+    Return string representation in the format used by MySQL server:
+    "YYYY-MM-DD", "YYYY-MM-DD hh:mm:ss[.uuuuuu]" or "[-]hh:mm:ss[.uuuuuu]",
+    depending on whether date and/or time part is requested. If neither
+    is requested, the value is presented as a TIME value.
+  */
+
+  std::string str(bool date, bool time) const;
+};
+
+
+/*
+  Codec for temporal values. In X protocol these are sent as a sequence
+  of varints: year, month, day, hour, minute, second, microseconds for
+  DATETIME and TIMESTAMP values, where trailing time fields are omitted if
+  they are 0. TIME values start with a sign byte followed by varints hour,
+  minute, second and microseconds.
+*/
+
+template <>
+class Codec<TYPE_DATETIME>
+  : Codec_base<TYPE_DATETIME>
+{
+public:
+
+  // Maximal length of encoded value.
+
+  static const size_t max_size = 12;
+
+  Codec(const Format_info &fi) : Codec_base<TYPE_DATETIME>(fi) {}
+  Codec(const Format<TYPE_DATETIME> &fmt)
+    : Codec_base<TYPE_DATETIME>(fmt)
+  {}
+
+  virtual ~Codec() {}
+
+  virtual size_t from_bytes(bytes buf, Datetime &val);
+  virtual size_t to_bytes(const Datetime &val, bytes buf);
+
+  /*
+    Decode value and return its string representation as given by
+    Datetime::str().
+  */
+
+  virtual size_t from_bytes(bytes buf, std::string &str);
+};
+
+
 template <>
 class Codec<TYPE_DOCUMENT>
   : Codec_base<TYPE_DOCUMENT>
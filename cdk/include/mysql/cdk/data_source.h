@@ -36,7 +36,12 @@
 PUSH_SYS_WARNINGS
 #include <functional>
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <set>
+#include <vector>
+#include <random>
 POP_SYS_WARNINGS
 
 
@@ -291,6 +296,245 @@ namespace ds {
     {}
   };
 
+
+  /*
+    Statistics of requests sent to a single data source, shared by all
+    sessions in the process. Sessions connected to the data source update
+    them and load balancing policies of Multi_source use them to choose
+    a data source for a new session.
+
+    The latency is an exponentially weighted moving average of request
+    times, in microseconds, where each new sample has weight 1/8. A request
+    time is measured from sending a command until the first reply to it
+    arrives. It is 0 if no request has completed yet.
+
+    The object also keeps health state of the data source. It is marked
+    down when connection to it fails and marked up again when a background
+    probe (or a new connection) succeeds. Counters of these transitions
+    and of consecutive failures are kept for monitoring.
+
+    Finally, it remembers what was learned about the server during previous
+    handshakes: the authentication method which succeeded for a given user
+    when the default method was requested and the protocol fields supported
+    by the server. New sessions use this to skip failed authentication
+    attempts and protocol checks. This information is forgotten when the
+    data source is marked down, as the server might have been upgraded
+    before it comes back. Number of handshakes and of round trips they took are
+    counted for monitoring.
+  */
+
+  class Host_stats
+  {
+    std::atomic<unsigned> m_outstanding;
+    std::atomic<uint64_t> m_latency;
+    std::atomic<bool>     m_down;
+    std::atomic<unsigned> m_failures;
+    std::atomic<uint64_t> m_down_count;
+    std::atomic<uint64_t> m_up_count;
+    std::atomic<uint64_t> m_proto_fields;
+    std::atomic<uint64_t> m_handshakes;
+    std::atomic<uint64_t> m_handshake_rtt;
+
+    mutable std::mutex    m_auth_guard;
+    std::map<string, int> m_auth_methods;
+
+  public:
+
+    // Value of auth_method() or proto_fields() if not known yet.
+
+    static const int      UNKNOWN_AUTH = -1;
+    static const uint64_t UNKNOWN_FIELDS = UINT64_MAX;
+
+    Host_stats()
+      : m_outstanding(0), m_latency(0)
+      , m_down(false), m_failures(0), m_down_count(0), m_up_count(0)
+      , m_proto_fields(UNKNOWN_FIELDS)
+      , m_handshakes(0), m_handshake_rtt(0)
+    {}
+
+    /*
+      Return statistics object for the given data source. Objects are
+      created on first use and live until the end of the process.
+    */
+
+    static Host_stats& get(const std::string &key);
+
+    static Host_stats& get(const TCPIP &ds)
+    {
+      return get(ds.host() + ":" + std::to_string(ds.port()));
+    }
+
+#ifndef _WIN32
+    static Host_stats& get(const Unix_socket &ds)
+    {
+      return get(ds.path());
+    }
+#endif
+
+    unsigned outstanding() const
+    {
+      return m_outstanding.load();
+    }
+
+    uint64_t latency() const
+    {
+      return m_latency.load();
+    }
+
+    void request_begin()
+    {
+      ++m_outstanding;
+    }
+
+    void request_end(uint64_t usec)
+    {
+      --m_outstanding;
+
+      uint64_t avg = m_latency.load();
+      uint64_t new_avg;
+
+      do {
+        new_avg = avg ? avg - avg/8 + usec/8 : usec;
+        if (0 == new_avg)
+          new_avg = 1;
+      } while (!m_latency.compare_exchange_weak(avg, new_avg));
+    }
+
+    bool is_down() const
+    {
+      return m_down.load();
+    }
+
+    // Number of failed connection attempts since the last successful one.
+
+    unsigned failures() const
+    {
+      return m_failures.load();
+    }
+
+    // Number of up -> down transitions.
+
+    uint64_t down_count() const
+    {
+      return m_down_count.load();
+    }
+
+    // Number of down -> up transitions.
+
+    uint64_t up_count() const
+    {
+      return m_up_count.load();
+    }
+
+    /*
+      Record failed connection attempt. Returns true if this marked the data
+      source down (it was up before). In that case information remembered
+      from previous handshakes is forgotten.
+    */
+
+    bool mark_down()
+    {
+      ++m_failures;
+      if (m_down.exchange(true))
+        return false;
+      ++m_down_count;
+      {
+        std::lock_guard<std::mutex> lock(m_auth_guard);
+        m_auth_methods.clear();
+      }
+      m_proto_fields = UNKNOWN_FIELDS;
+      return true;
+    }
+
+    /*
+      Record successful connection. Returns true if the data source was
+      down before.
+
+      Note: This should be called only after a session was established, so
+      that a server which accepts connections but fails handshakes is not
+      considered up.
+    */
+
+    bool mark_up()
+    {
+      m_failures = 0;
+      if (!m_down.exchange(false))
+        return false;
+      ++m_up_count;
+      return true;
+    }
+
+    /*
+      Authentication method (a Protocol_options::auth_method_t value) which
+      succeeded last time the default method was used by the given user.
+      Different accounts can use different authentication plugins on the
+      same server.
+    */
+
+    int auth_method(const string &user) const
+    {
+      std::lock_guard<std::mutex> lock(m_auth_guard);
+      auto it = m_auth_methods.find(user);
+      return m_auth_methods.end() == it ? UNKNOWN_AUTH : it->second;
+    }
+
+    void set_auth_method(const string &user, int method)
+    {
+      std::lock_guard<std::mutex> lock(m_auth_guard);
+      m_auth_methods[user] = method;
+    }
+
+    // Protocol_fields flags supported by the server.
+
+    uint64_t proto_fields() const
+    {
+      return m_proto_fields.load();
+    }
+
+    void set_proto_fields(uint64_t fields)
+    {
+      m_proto_fields = fields;
+    }
+
+    // Record completed handshake which took given number of round trips.
+
+    void handshake_done(unsigned round_trips)
+    {
+      ++m_handshakes;
+      m_handshake_rtt += round_trips;
+    }
+
+    uint64_t handshakes() const
+    {
+      return m_handshakes.load();
+    }
+
+    // Total number of round trips of all handshakes.
+
+    uint64_t handshake_round_trips() const
+    {
+      return m_handshake_rtt.load();
+    }
+  };
+
+
+  /*
+    Policies used by Multi_source to decide in which order data sources
+    are tried when creating a session. If connection to the chosen data
+    source fails, the remaining ones are tried in the same order.
+  */
+
+  struct Load_balancing
+  {
+    enum value {
+      FAILOVER,          // highest priority first, random among equal ones
+      ROUND_ROBIN,       // each new session starts with the next data source
+      RANDOM,            // random choice weighted by priorities
+      LEAST_OUTSTANDING, // data source with fewest requests in progress
+      LOWEST_LATENCY     // data source with lowest average request latency
+    };
+  };
+
   class Multi_source
   {
 
@@ -307,17 +551,29 @@ namespace ds {
 
     bool m_is_prioritized;
     unsigned short m_counter;
+    Load_balancing::value m_policy = Load_balancing::FAILOVER;
 
     typedef std::multimap<unsigned short, DS_variant, std::greater<unsigned short>> DS_list;
     DS_list m_ds_list;
 
-  public:
+    /*
+      Return a random number in range [0, n). A per-thread generator is
+      used so that picks are thread-safe, unbiased and independent from
+      the application's std::rand() state.
+    */
 
-    Multi_source() : m_is_prioritized(false), m_counter(65535)
+    static unsigned random(unsigned n)
     {
-      std::srand((unsigned int)time(NULL));
+      assert(n > 0);
+      static thread_local std::mt19937 gen{ std::random_device{}() };
+      return std::uniform_int_distribution<unsigned>(0, n - 1)(gen);
     }
 
+  public:
+
+    Multi_source() : m_is_prioritized(false), m_counter(65535)
+    {}
+
     template <class DS_t, class DS_opt>
     void add(const DS_t &ds, const DS_opt &opt,
              unsigned short prio)
@@ -377,18 +633,173 @@ namespace ds {
     };
 
 
+    /*
+      Visitor which finds statistics of the visited data source.
+    */
+
+    struct Stats_visitor
+    {
+      Host_stats *stats = NULL;
+
+      void operator () (const DS_pair<cdk::ds::TCPIP,
+                                      cdk::ds::TCPIP::Options> &ds_pair)
+      {
+        stats = &Host_stats::get(ds_pair.first);
+      }
+
+#ifndef _WIN32
+      void operator () (const DS_pair<cdk::ds::Unix_socket,
+                                      cdk::ds::Unix_socket::Options> &ds_pair)
+      {
+        stats = &Host_stats::get(ds_pair.first);
+      }
+#endif
+
+      void operator () (const DS_pair<cdk::ds::TCPIP_old,
+                                      cdk::ds::TCPIP_old::Options> &ds_pair)
+      {
+        stats = &Host_stats::get(ds_pair.first);
+      }
+    };
+
+    /*
+      Counter used to choose the first data source for the round-robin
+      policy. It is shared by all Multi_source instances so that sessions
+      created from the same settings use consecutive data sources.
+    */
+
+    static std::atomic<unsigned> s_next;
+
+    /*
+      Put data sources in the order in which they should be tried according
+      to the current (non-failover) load balancing policy.
+    */
+
+    void order_by_policy(std::vector<DS_variant*> &list)
+    {
+      for (auto &item : m_ds_list)
+        list.push_back(&item.second);
+
+      if (list.size() < 2)
+        return;
+
+      if (Load_balancing::RANDOM == m_policy)
+      {
+        /*
+          Choose data sources one by one, each time picking a random one
+          from the remaining ones with probability proportional to its
+          priority (all have the same weight if priorities are not used).
+          Note that add() does not accept priority 0 in a prioritized list,
+          so that all weights, and thus the total, are positive.
+        */
+
+        std::vector<unsigned> weight;
+        unsigned total = 0;
+
+        for (auto &item : m_ds_list)
+        {
+          unsigned w = m_is_prioritized ? item.first : 1;
+          weight.push_back(w);
+          total += w;
+        }
+
+        for (size_t pos = 0; pos + 1 < list.size(); ++pos)
+        {
+          assert(total > 0);
+          unsigned pick = random(total);
+          size_t i = pos;
+
+          for (; pick >= weight[i]; ++i)
+            pick -= weight[i];
+
+          total -= weight[i];
+          std::swap(list[pos], list[i]);
+          std::swap(weight[pos], weight[i]);
+        }
+
+        return;
+      }
+
+      /*
+        For the remaining policies start with the next data source in
+        round-robin order. This way data sources which are equal according
+        to statistics are chosen in turns.
+      */
+
+      std::rotate(list.begin(), list.begin() + (s_next++ % list.size()),
+                  list.end());
+
+      if (Load_balancing::ROUND_ROBIN == m_policy)
+        return;
+
+      std::vector<std::pair<uint64_t, DS_variant*>> keyed;
+
+      for (DS_variant *item : list)
+      {
+        Stats_visitor sv;
+        item->visit(sv);
+        assert(sv.stats);
+        keyed.emplace_back(
+          Load_balancing::LEAST_OUTSTANDING == m_policy ?
+          sv.stats->outstanding() : sv.stats->latency(),
+          item
+        );
+      }
+
+      std::stable_sort(keyed.begin(), keyed.end(),
+        [](const std::pair<uint64_t, DS_variant*> &a,
+           const std::pair<uint64_t, DS_variant*> &b)
+        {
+          return a.first < b.first;
+        }
+      );
+
+      for (size_t pos = 0; pos < list.size(); ++pos)
+        list[pos] = keyed[pos].second;
+    }
+
+
     public:
 
+    void set_policy(Load_balancing::value policy)
+    {
+      m_policy = policy;
+    }
+
+    Load_balancing::value get_policy() const
+    {
+      return m_policy;
+    }
+
     /*
       Call visitor(ds,opts) for each data source ds with options
-      opts in the list. Do it in decreasing priority order, choosing
-      randomly among data sources with the same priority.
+      opts in the list. With the default failover policy do it in decreasing
+      priority order, choosing randomly among data sources with the same
+      priority. Other policies define the order as described
+      for Load_balancing.
       If visitor(...) call returns true, stop the process.
     */
 
     template <class Visitor>
     void visit(Visitor &visitor)
     {
+      if (Load_balancing::FAILOVER != m_policy)
+      {
+        std::vector<DS_variant*> list;
+        order_by_policy(list);
+
+        for (DS_variant *item : list)
+        {
+          Variant_visitor<Visitor> variant_visitor;
+          variant_visitor.vis = &visitor;
+          item->visit(variant_visitor);
+          if (variant_visitor.stop_processing)
+            break;
+        }
+
+        return;
+      }
+
       bool stop_processing = false;
       std::set<DS_variant*> same_prio;
 
@@ -415,7 +826,7 @@ namespace ds {
           auto el = same_prio.begin();
 
           if (same_prio.size() > 1)
-            std::advance(el, std::rand() % same_prio.size());
+            std::advance(el, random((unsigned)same_prio.size()));
 
           item = *el;
           same_prio.erase(el);
@@ -33,6 +33,7 @@
 
 #include "types.h"
 #include "error.h"
+#include "utf8.h"
 #ifdef HAVE_CODECVT_UTF8
 #include <codecvt>
 #else
@@ -246,7 +247,79 @@ public:
 };
 
 
-// String utf8 codec
+/*
+  String utf8 codec
+  -----------------
+  Instead of going through codecvt_utf8 facet one character at a time,
+  this specialization uses UTF-8 kernels from utf8.h which validate and
+  transcode whole strings using SIMD instructions where available.
+*/
+
+template<>
+class String_codec<codecvt_utf8> : public api::String_codec
+{
+public:
+
+  String_codec()
+  {}
+
+  typedef cdk::foundation::char_t char_t;
+
+  size_t measure(const string &in)
+  {
+    size_t len = utf8::measure(in.data(), in.data() + in.length());
+    if (size_t(-1) == len)
+      throw_error("string conversion error: invalid code point");
+    return len;
+  }
+
+  size_t from_bytes(bytes in, string &out)
+  {
+    if (0 == in.size())
+    {
+      out.clear();
+      return 0;
+    }
+
+    if (!utf8::valid(in.begin(), in.end()))
+      throw_error(
+        "string conversion error: invalid UTF-8 sequence at byte "
+        + std::to_string(utf8::invalid_pos(in.begin(), in.end()))
+      );
+
+    // Each input byte produces at most one output character.
+
+    out.resize(in.size());
+    out.resize(utf8::decode(in.begin(), in.end(), &out[0]));
+    return in.size();
+  }
+
+  size_t to_bytes(const string &in, bytes out)
+  {
+    if (0 == in.size())
+      return 0;
+
+    const char_t *in_next = in.data();
+    byte *out_next = out.begin();
+
+    std::codecvt_base::result res =
+      utf8::encode(in_next, in.data() + in.length(), out_next, out.end());
+
+    if (std::codecvt_base::error == res)
+      throw_error(
+        "string conversion error: invalid code point at position "
+        + std::to_string(in_next - in.data())
+      );
+
+    if (std::codecvt_base::ok != res)
+      throw_error("string conversion error: output buffer too small");
+
+    assert(out_next >= out.begin());
+    return static_cast<size_t>(out_next - out.begin());
+  }
+
+};
+
 
 template<>
 class Codec<Type::STRING> : public String_codec<codecvt_utf8>
@@ -118,6 +118,13 @@ public:
   virtual bool is_closed() const;
   virtual unsigned int get_fd() const;
 
+  /*
+    If timeout_usec is not 0, blocking reads throw Error_timeout when no
+    data arrives within that many microseconds.
+  */
+
+  void set_read_timeout(uint64_t timeout_usec);
+
   // Input stream
 
   bool eos() const;
@@ -149,7 +156,13 @@ class TCPIP
 {
 public:
 
-  TCPIP(const std::string& host, unsigned short port);
+  /*
+    If connect_timeout_usec is not 0, connect() throws Error_timeout when
+    connection is not established within that many microseconds.
+  */
+
+  TCPIP(const std::string& host, unsigned short port,
+        uint64_t connect_timeout_usec = 0);
 
   bool is_secure() const
   {
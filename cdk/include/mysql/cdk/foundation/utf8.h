@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_UTF8_H
+#define SDK_FOUNDATION_UTF8_H
+
+#include "types.h"
+
+PUSH_SYS_WARNINGS
+#include <locale>   // for std::codecvt_base
+POP_SYS_WARNINGS
+
+
+namespace cdk {
+namespace foundation {
+namespace utf8 {
+
+/*
+  Kernels for validating UTF-8 byte sequences and transcoding them to/from
+  the internal wide string representation (UTF-32 if char_t is 4 bytes wide,
+  UTF-16 otherwise).
+
+  On x86 platforms the implementation is selected at run time, depending on
+  the instruction set supported by the CPU: there are AVX2 and SSE4.1 variants
+  with a portable scalar fallback. All variants have a fast path for runs of
+  ASCII characters, which are the most common ones in typical column data.
+*/
+
+
+/*
+  Check if bytes in [beg, end) form a valid UTF-8 sequence. Overlong
+  encodings, encoded surrogates, code points above U+10FFFF and truncated
+  sequences are all rejected.
+*/
+
+bool valid(const byte *beg, const byte *end);
+
+
+/*
+  Return offset of the first invalid sequence in [beg, end) or (end - beg)
+  if there is none. This is a scalar scan meant for reporting errors after
+  valid() has failed.
+*/
+
+size_t invalid_pos(const byte *beg, const byte *end);
+
+
+/*
+  Decode UTF-8 sequence [beg, end), which must be valid as checked by
+  valid(), storing characters in the output buffer. The buffer must have
+  room for at least (end - beg) characters. Returns number of characters
+  stored in the buffer.
+*/
+
+size_t decode(const byte *beg, const byte *end, char_t *out);
+
+
+/*
+  Return number of bytes in UTF-8 encoding of the given wide string or
+  size_t(-1) if the string contains invalid code points (or unpaired
+  surrogates for 16-bit char_t).
+*/
+
+size_t measure(const char_t *beg, const char_t *end);
+
+
+/*
+  Encode wide string [from, from_end) as UTF-8, storing bytes in the
+  [to, to_end) buffer. On return, from and to point at the first not
+  converted character and the first not used byte of the buffer,
+  respectively. Result is as for std::codecvt<>::out(): ok if all
+  characters were converted, partial if output buffer is too small
+  and error if invalid code point was found.
+*/
+
+std::codecvt_base::result
+encode(const char_t *&from, const char_t *from_end, byte *&to, byte *to_end);
+
+
+/*
+  Name of the kernel variant selected for this CPU ("avx2", "sse4.1"
+  or "scalar").
+*/
+
+const char* kernel_name();
+
+
+}}}  // cdk::foundation::utf8
+
+#endif
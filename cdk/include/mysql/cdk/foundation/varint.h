@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_VARINT_H
+#define SDK_FOUNDATION_VARINT_H
+
+#include "types.h"
+
+PUSH_SYS_WARNINGS
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+POP_SYS_WARNINGS
+
+
+namespace cdk {
+namespace foundation {
+namespace varint {
+
+/*
+  Inline decoding and encoding of Protobuf base 128 varints and zig-zag
+  encoded signed integers, as used by X protocol for integer values.
+
+  When at least 8 bytes are available in the buffer, the decoder loads them
+  as a single 64-bit word, finds the end of the varint from the mask of
+  cleared continuation bits and gathers 7-bit groups of up to 8 bytes
+  at once: with PEXT instruction if compiled for BMI2, otherwise with a few
+  shift-and-mask steps. Only varints longer than 8 bytes (values of 2^56
+  and more) and varints near the end of the buffer are decoded byte by
+  byte.
+*/
+
+// Maximal length of 64-bit varint.
+
+const size_t max_size = 10;
+
+
+namespace detail {
+
+inline
+size_t decode_slow(const byte *beg, const byte *end, uint64_t &val,
+                   uint64_t acc = 0, unsigned shift = 0)
+{
+  for (const byte *p = beg; p < end && shift < 64; ++p, shift += 7)
+  {
+    acc |= uint64_t(*p & 0x7F) << shift;
+    if (!(*p & 0x80))
+    {
+      val = acc;
+      return size_t(p - beg) + 1;
+    }
+  }
+  return 0;
+}
+
+
+inline
+unsigned ctz64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+  unsigned long pos;
+  _BitScanForward64(&pos, x);
+  return unsigned(pos);
+#elif defined(__GNUC__)
+  return unsigned(__builtin_ctzll(x));
+#else
+  unsigned pos = 0;
+  for (; !(x & 1); x >>= 1)
+    ++pos;
+  return pos;
+#endif
+}
+
+
+// Gather the low 7 bits of each byte of x into a contiguous value.
+
+inline
+uint64_t gather7(uint64_t x)
+{
+#if defined(__BMI2__)
+  return _pext_u64(x, 0x7F7F7F7F7F7F7F7FULL);
+#else
+  x &= 0x7F7F7F7F7F7F7F7FULL;
+  x = ((x & 0x7F007F007F007F00ULL) >> 1) | (x & 0x007F007F007F007FULL);
+  x = ((x & 0x3FFF00003FFF0000ULL) >> 2) | (x & 0x00003FFF00003FFFULL);
+  x = ((x & 0x0FFFFFFF00000000ULL) >> 4) | (x & 0x000000000FFFFFFFULL);
+  return x;
+#endif
+}
+
+}  // detail
+
+
+/*
+  Decode varint stored at the beginning of [beg, end) buffer. Returns
+  number of bytes consumed or 0 if the buffer does not contain a complete
+  varint (or it is longer than 10 bytes).
+*/
+
+inline
+size_t decode(const byte *beg, const byte *end, uint64_t &val)
+{
+  // Common case of 1-byte varint.
+
+  if (beg < end && !(*beg & 0x80))
+  {
+    val = *beg;
+    return 1;
+  }
+
+#if !CDK_BIG_ENDIAN
+
+  if (end - beg >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, beg, 8);
+
+    uint64_t stop = ~word & 0x8080808080808080ULL;
+
+    if (stop)
+    {
+      // Number of bytes of the varint and mask selecting these bytes.
+
+      unsigned len = (detail::ctz64(stop) + 1) / 8;
+      uint64_t mask = len < 8 ? (uint64_t(1) << (8 * len)) - 1 : ~uint64_t(0);
+
+      val = detail::gather7(word & mask);
+      return len;
+    }
+
+    // Longer than 8 bytes: continue with the remaining bytes.
+
+    size_t len
+      = detail::decode_slow(beg + 8, end, val, detail::gather7(word), 56);
+    return len ? 8 + len : 0;
+  }
+
+#endif
+
+  return detail::decode_slow(beg, end, val);
+}
+
+
+/*
+  Encode value as varint into [beg, end) buffer. Returns number of bytes
+  written or 0 if the buffer is too small.
+*/
+
+inline
+size_t encode(uint64_t val, byte *beg, byte *end)
+{
+  byte *p = beg;
+
+  for (; p < end; ++p)
+  {
+    if (val < 0x80)
+    {
+      *p = byte(val);
+      return size_t(p - beg) + 1;
+    }
+    *p = byte(val | 0x80);
+    val >>= 7;
+  }
+
+  return 0;
+}
+
+
+inline
+int64_t zigzag_decode(uint64_t val)
+{
+  return int64_t(val >> 1) ^ -int64_t(val & 1);
+}
+
+
+inline
+uint64_t zigzag_encode(int64_t val)
+{
+  return (uint64_t(val) << 1) ^ uint64_t(val >> 63);
+}
+
+
+}}}  // cdk::foundation::varint
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef CDK_MUX_H
+#define CDK_MUX_H
+
+#include "session.h"
+#include "codec.h"
+
+PUSH_SYS_WARNINGS
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+POP_SYS_WARNINGS
+
+
+namespace cdk {
+
+
+/*
+  Intrusive multi-producer, single-consumer queue
+  ===============================================
+
+  Nodes can be pushed from any thread without taking locks. Only one thread
+  (the consumer) can pop nodes from the queue. The queue does not own its
+  nodes.
+
+  Method pop() returns NULL if the queue is empty, but also if some producer
+  is in the middle of push(). In the latter case the producer will complete
+  the push shortly and the node will be returned by a following pop().
+*/
+
+class Mpsc_queue
+{
+public:
+
+  struct Node
+  {
+    std::atomic<Node*> m_next;
+
+    Node() : m_next(NULL) {}
+    virtual ~Node() {}
+  };
+
+  Mpsc_queue()
+    : m_head(&m_stub), m_tail(&m_stub)
+  {}
+
+  void push(Node *node)
+  {
+    node->m_next.store(NULL, std::memory_order_relaxed);
+    Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->m_next.store(node, std::memory_order_release);
+  }
+
+  Node* pop();
+
+private:
+
+  Node m_stub;
+  std::atomic<Node*> m_head;  // last pushed node
+  Node *m_tail;               // next node to pop (used only by the consumer)
+};
+
+
+/*
+  Multiplexed session
+  ===================
+
+  Session_mux shares a single connection among many threads. Any thread
+  can submit an SQL statement with sql(). Statements are put into
+  a lock-free submission queue from which a worker thread, that owns the
+  underlying cdk::Session, takes them in batches. All statements in a batch
+  are written to the connection before reading any replies (see
+  Session::send_ahead()). Replies are then read in order and each one is
+  stored in the Result object returned by sql() for the corresponding
+  statement, after which the waiting thread is notified.
+
+  Each statement is executed on its own -- there is no way to group
+  statements into a transaction or to rely on session state such as
+  the current schema being changed by other threads. Results are buffered
+  in memory, so this is meant for many small queries, such as point lookups.
+  Only the first result set returned by a statement is kept.
+
+  If the connection fails, the current statement and all statements
+  submitted afterwards complete with the error.
+*/
+
+class Session_mux
+{
+public:
+
+  class Result;
+
+  Session_mux(ds::TCPIP &ds,
+              const ds::TCPIP::Options &options = ds::TCPIP::Options());
+
+  Session_mux(ds::Multi_source&);
+
+#ifndef _WIN32
+  Session_mux(ds::Unix_socket &ds,
+              const ds::Unix_socket::Options &options
+                = ds::Unix_socket::Options());
+#endif //_WIN32
+
+  /*
+    Statements which are in the submission queue are executed before the
+    worker thread stops.
+  */
+
+  ~Session_mux();
+
+  /*
+    Submit statement for execution. Can be called from any thread. If given,
+    the argument list must be valid until the returned result is completed.
+  */
+
+  std::shared_ptr<Result> sql(const string &query, Any_list *args = NULL);
+
+  // Number of batches and statements sent so far.
+
+  uint64_t batch_count() const { return m_batch_count.load(); }
+  uint64_t stmt_count() const { return m_stmt_count.load(); }
+
+  // Maximal number of statements sent before reading replies.
+
+  static const unsigned max_batch = 32;
+
+private:
+
+  Session  m_sess;
+  Mpsc_queue  m_queue;
+
+  std::atomic<bool> m_sleeping;
+  std::atomic<bool> m_stop;
+  std::mutex  m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_worker;
+
+  std::atomic<uint64_t> m_batch_count;
+  std::atomic<uint64_t> m_stmt_count;
+
+  // Error which broke the connection (used only by the worker thread).
+
+  std::unique_ptr<Error> m_conn_error;
+
+  void start();
+  void run();
+  void wake_up();
+  void execute(std::vector<std::shared_ptr<Result>>&);
+};
+
+
+/*
+  Result of a statement submitted to Session_mux.
+
+  Result data can be accessed only after the result is completed, which
+  is after wait() returns without throwing error or when is_completed()
+  returns true.
+*/
+
+class Session_mux::Result
+  : public Mpsc_queue::Node
+{
+public:
+
+  bool is_completed() const { return m_done.load(); }
+
+  /*
+    Wait until reply to the statement is received. Throws error if statement
+    execution failed.
+  */
+
+  void wait() const;
+
+  col_count_t col_count() const { return m_cols.size(); }
+  Type_info   type(col_count_t pos) const { return m_cols.at(pos).m_type; }
+  const string& col_name(col_count_t pos) const
+  { return m_cols.at(pos).m_name; }
+
+  /*
+    Encoding format of values in given column. Type T must be the type
+    of the column. Values can be decoded by Codec<T> created from it.
+  */
+
+  template <Type_info T>
+  const Format<T>& format(col_count_t pos) const
+  {
+    const Column &col = m_cols.at(pos);
+    if (T != col.m_type || !col.m_format)
+      throw_error("Session_mux: incompatible data encoding format");
+    return *static_cast<const Format<T>*>(col.m_format.get());
+  }
+
+  row_count_t row_count() const { return m_rows.size(); }
+
+  /*
+    Get raw bytes of a value in given row and column. Returns false if
+    the value is NULL.
+  */
+
+  bool get(row_count_t row, col_count_t col, bytes &data) const;
+
+  row_count_t affected_rows() const { return m_affected_rows; }
+  row_count_t last_insert_id() const { return m_last_insert_id; }
+
+private:
+
+  struct Column
+  {
+    Type_info m_type;
+    std::shared_ptr<Format_base> m_format;
+    string    m_name;
+  };
+
+  struct Field
+  {
+    bool m_null;
+    std::vector<byte> m_data;
+  };
+
+  string    m_stmt;
+  Any_list *m_args;
+
+  // Keeps the result alive while it is in the submission queue.
+
+  std::shared_ptr<Result> m_self;
+
+  std::vector<Column> m_cols;
+  std::vector<std::vector<Field>> m_rows;
+  row_count_t m_affected_rows = 0;
+  row_count_t m_last_insert_id = 0;
+  std::unique_ptr<Error> m_error;
+
+  std::atomic<bool> m_done;
+  mutable std::mutex m_mutex;
+  mutable std::condition_variable m_cv;
+
+  Result(const string &stmt, Any_list *args)
+    : m_stmt(stmt), m_args(args), m_done(false)
+  {}
+
+  void complete(const Error*);
+
+  class Reader;
+  friend class Session_mux;
+};
+
+
+}  // cdk
+
+#endif
@@ -38,6 +38,7 @@
 #include "common.h"
 
 PUSH_SYS_WARNINGS
+#include <chrono>
 #include <deque>
 POP_SYS_WARNINGS
 
@@ -60,6 +61,7 @@ struct cdk::Format<cdk::TYPE_FLOAT>::Access
 {
   typedef cdk::Format<cdk::TYPE_FLOAT> Format;
   static void set_fmt(Format &o, Format::Fmt fmt) { o.m_fmt= fmt; }
+  static void set_unsigned(Format &o, bool uns)   { o.m_unsigned= uns; }
 };
 
 
@@ -275,6 +277,10 @@ class Col_metadata
       Format<TYPE_FLOAT>::Access::set_fmt(fmt, Format<TYPE_FLOAT>::DECIMAL);
       break;
     }
+
+    // Note: flag 0x01 marks UNSIGNED columns.
+
+    Format<TYPE_FLOAT>::Access::set_unsigned(fmt, 0 != (m_flags & 0x01));
   }
 
   void get_info(Format<TYPE_STRING>& fmt) const
@@ -391,6 +397,7 @@ typedef Session Reply_init;
 
 class Reply;
 class Cursor;
+class RcvTrxReply;
 
 class SessionAuthInterface
 {
@@ -406,6 +413,7 @@ public:
 
 
 typedef protocol::mysqlx::api::Protocol_fields Protocol_fields;
+typedef protocol::mysqlx::Find_cache Find_cache;
 
 class Session
     : public api::Diagnostics
@@ -472,14 +480,61 @@ protected:
   bool m_has_results;
   bool m_discard;
 
+  /*
+    Statistics of the data source to which this session is connected,
+    updated when requests are sent and their first replies arrive.
+  */
+
+  ds::Host_stats *m_host_stats = NULL;
+  bool m_in_request = false;
+  unsigned m_handshake_rtt = 0;
+  std::chrono::steady_clock::time_point m_request_start;
+
+  void request_begin();
+  void request_end();
+
+  /*
+    Pipelined transaction statements
+    --------------------------------
+    START TRANSACTION requested with begin() in lazy mode and COMMIT
+    requested with commit_after_next() are not sent on their own but
+    together with the next command, inside a no_error expectation block
+    (see send_cmd()). Replies to START TRANSACTION and to the opening of
+    the block are read before the reply to the command. Replies to COMMIT
+    and to the closing of the block are stored in m_trx_replies and read
+    before the reply to the next command or by commit(), rollback() or
+    begin(), whichever comes first.
+  */
+
+  bool m_lazy_begin = false;
+  bool m_begin_pending = false;
+  bool m_commit_pending = false;
+  bool m_commit_skipped = false;
+
+  shared_ptr<RcvTrxReply> m_begin_reply;
+  shared_ptr<RcvTrxReply> m_commit_reply;
+  std::deque< shared_ptr<Proto_op> > m_trx_replies;
+
+  void read_trx_replies();
+  shared_ptr<RcvTrxReply> take_commit_reply();
+
+  // Number of commands sent with send_ahead() whose replies were not read.
+
+  unsigned m_sent_ahead = 0;
+
 public:
 
   //cdk::api::Connection* get_connection();
 
   typedef ds::Options<ds::mysqlx::Protocol_options> Options;
 
+  /*
+    If statistics of the data source are given, the session uses information
+    remembered there from previous handshakes (see ds::Host_stats).
+  */
+
   template <class C>
-  Session(C &conn, const Options &options)
+  Session(C &conn, const Options &options, ds::Host_stats *stats = NULL)
     : m_protocol(conn)
     , m_isvalid(false)
     , m_current_reply(NULL)
@@ -494,6 +549,7 @@ public:
     , m_nr_cols(0)
   {
     m_stmt_stats.clear();
+    m_host_stats = stats;
     authenticate(options, conn.is_secure());
     // TODO: make "lazy" checks instead, deferring to the time when given
     // feature is used.
@@ -502,6 +558,27 @@ public:
 
   virtual ~Session();
 
+  void set_host_stats(ds::Host_stats *stats)
+  {
+    m_host_stats = stats;
+  }
+
+  /*
+    Number of round trips to the server done while establishing the session.
+    Round trips done before the session was created, such as negotiating
+    TLS, are added with add_handshake_rtt().
+  */
+
+  unsigned handshake_rtt() const
+  {
+    return m_handshake_rtt;
+  }
+
+  void add_handshake_rtt(unsigned count)
+  {
+    m_handshake_rtt += count;
+  }
+
   /*
     Check if given session is valid. Function is_valid() performs
     a lightweight, local check while check_valid() might communicate with
@@ -541,6 +618,47 @@ public:
   void savepoint_set(const string &savepoint);
   void savepoint_remove(const string &savepoint);
 
+  /*
+    In lazy mode begin() does not contact the server and START TRANSACTION
+    is sent together with the next command. Errors reported for it are
+    reported as errors of that command. If commit() or rollback() is called
+    before any command is sent, they do not contact the server either.
+  */
+
+  void set_lazy_begin(bool lazy)
+  {
+    m_lazy_begin = lazy;
+  }
+
+  /*
+    Send COMMIT right after the next command, in the same round trip. If
+    the command fails, COMMIT is not executed and the transaction remains
+    open. The outcome is reported by the following call to commit(), which
+    in this case does not contact the server. If rollback() is called
+    instead, it throws error if COMMIT was executed and otherwise rolls back
+    the transaction. If begin() is called, it reports failure of COMMIT.
+  */
+
+  void commit_after_next()
+  {
+    m_commit_pending = true;
+  }
+
+  /*
+    Pipelining
+    ----------
+    Normally a command is sent when a Reply object is initialized with it,
+    after the reply to the previous command has been consumed. Method
+    send_ahead() sends the current command (set with sql() or a CRUD method)
+    right away, so that several commands can be sent before reading the reply
+    to any of them. Replies to these commands must then be read in the order
+    in which the commands were sent, by initializing Reply objects with
+    next_reply().
+  */
+
+  void send_ahead();
+  Reply_init &next_reply();
+
   /*
      SQL API
   */
@@ -574,7 +692,8 @@ public:
                         const Param_source *param = NULL,
                         const Lock_mode_value lock_mode = Lock_mode_value::NONE,
                         const Lock_contention_value lock_contention
-                          = Lock_contention_value::DEFAULT);
+                          = Lock_contention_value::DEFAULT,
+                        Find_cache *cache = NULL);
   Reply_init &coll_update(const api::Table_ref&,
                           const Expression*,
                           const Update_spec&,
@@ -597,7 +716,42 @@ public:
                            const Limit *lim = NULL,
                            const Param_source *param = NULL,
                            const Lock_mode_value lock_mode = Lock_mode_value::NONE,
-                           const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT);
+                           const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT,
+                           Find_cache *cache = NULL);
+
+  /*
+    Store in `key` the serialized command which would be sent by coll_find()
+    or table_select() called with the same arguments (and without a view).
+    Nothing is sent to the server.
+  */
+
+  void coll_find_key(std::string &key,
+                     const Table_ref&,
+                     const Expression *expr = NULL,
+                     const Expression::Document *proj = NULL,
+                     const Order_by *order_by = NULL,
+                     const Expr_list *group_by = NULL,
+                     const Expression *having = NULL,
+                     const Limit *lim = NULL,
+                     const Param_source *param = NULL,
+                     const Lock_mode_value lock_mode = Lock_mode_value::NONE,
+                     const Lock_contention_value lock_contention
+                       = Lock_contention_value::DEFAULT,
+                     Find_cache *cache = NULL);
+  void table_select_key(std::string &key,
+                        const Table_ref&,
+                        const Expression *expr = NULL,
+                        const Projection *proj = NULL,
+                        const Order_by *order_by = NULL,
+                        const Expr_list *group_by = NULL,
+                        const Expression *having = NULL,
+                        const Limit *lim = NULL,
+                        const Param_source *param = NULL,
+                        const Lock_mode_value lock_mode = Lock_mode_value::NONE,
+                        const Lock_contention_value lock_contention
+                          = Lock_contention_value::DEFAULT,
+                        Find_cache *cache = NULL);
+
   Reply_init &table_insert(const Table_ref&,
                            Row_source&,
                            const api::Columns *cols,
@@ -46,6 +46,10 @@
 #include "mysqlx/traits.h"
 #include "mysqlx/expr.h"
 
+PUSH_SYS_WARNINGS
+#include <map>
+POP_SYS_WARNINGS
+
 
 namespace cdk {
 namespace protocol {
@@ -502,6 +506,42 @@ public:
 */
 enum Data_model { DEFAULT= 0, DOCUMENT = 1, TABLE = 2 };
 
+
+/*
+  Cache of a serialized Find command used by Protocol::snd_Find().
+
+  The cache holds serialized part of the command which does not depend
+  on values of parameters and on the limit, together with the positions
+  assigned to named parameters. When the same command is sent again, only
+  parameter values and the limit are serialized and appended to the cached
+  bytes (the protocol merges fields of concatenated messages).
+
+  The owner of the cache, such as a statement executed many times, must call
+  reset() whenever other parts of the command change. The cache is also
+  rebuilt if the names of the parameters change.
+*/
+
+class Find_cache
+{
+  std::string  m_prefix;
+  std::map<string, unsigned>  m_params;
+  bool  m_valid = false;
+
+public:
+
+  void reset()
+  {
+    m_valid = false;
+  }
+
+  bool is_valid() const
+  {
+    return m_valid;
+  }
+
+  friend class Protocol;
+};
+
 class Protocol
   : foundation::opaque_impl<Protocol>
   , foundation::nocopy
@@ -514,6 +554,7 @@ public:
 
   template <class C> Protocol(C &conn);
 
+  Op& snd_CapabilitiesGet();
   Op& snd_CapabilitiesSet(const api::Any::Document& caps);
   Op& snd_AuthenticateStart(const char* mechanism, bytes data, bytes response);
   Op& snd_AuthenticateContinue(bytes data);
@@ -552,10 +593,28 @@ public:
 
     @param args  if expressions used in the specification use named parameters,
       this argument map provides values of these parameters
+
+    @param cache  optional cache of the serialized command; if it is valid,
+      the specification is not looked at, except for the limit
   */
 
   Op& snd_Find(Data_model dm, const Find_spec &spec,
-               const api::Args_map *args = NULL);
+               const api::Args_map *args = NULL,
+               Find_cache *cache = NULL);
+
+  /**
+    Serialize CRUD Find command into the given buffer without sending it.
+
+    The bytes stored in `buf` are the same as these that would be sent by
+    `snd_Find()` called with the same arguments. They can be used as a key
+    which identifies the result of the command. If `cache` is given, it is
+    used and filled in the same way as in `snd_Find()`.
+  */
+
+  static void ser_Find(std::string &buf,
+                       Data_model dm, const Find_spec &spec,
+                       const api::Args_map *args = NULL,
+                       Find_cache *cache = NULL);
 
   /**
     Send CRUD Insert command.
@@ -648,12 +707,30 @@ public:
 
   Op& rcv_AuthenticateReply(Auth_processor &);
   Op& rcv_Reply(Reply_processor &);
+
+  /*
+    Receive server reply to CapabilitiesGet. Capabilities reported by the
+    server are not processed - if the server replied with them, ok() is
+    called on the processor.
+  */
+
+  Op& rcv_Capabilities(Reply_processor &);
   Op& rcv_StmtReply(Stmt_processor &);
   Op& rcv_Rows(Row_processor &);
   Op& rcv_MetaData(Mdata_processor &);
 
 private:
 
+  /*
+    Fill `find` message with the parts of Find command which are not
+    stored in the cache, re-building the cache if needed (see snd_Find()).
+  */
+
+  template <class MSG>
+  static void set_find_cached(MSG &find,
+                              Data_model dm, const Find_spec &spec,
+                              const api::Args_map *args, Find_cache &cache);
+
   class Impl;
 
   friend class  Impl;
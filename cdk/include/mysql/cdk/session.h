@@ -82,6 +82,13 @@ public:
   option_t is_valid() { return m_session->is_valid(); }
   option_t check_valid() { return m_session->check_valid(); }
 
+  // Number of round trips to the server done when creating this session.
+
+  unsigned handshake_round_trips() const
+  {
+    return m_session->handshake_rtt();
+  }
+
   void close() {
     m_session->close();
     m_connection->close();
@@ -127,6 +134,28 @@ public:
       m_session->rollback(savepoint);
   }
 
+  /*
+    If lazy begin is enabled, begin() does not contact the server and
+    START TRANSACTION is sent together with the next statement. Transactions
+    in which no statements were executed do not contact the server at all.
+  */
+
+  void set_lazy_begin(bool lazy)
+  {
+    m_session->set_lazy_begin(lazy);
+  }
+
+  /*
+    Send COMMIT together with the next statement. If the statement fails,
+    the transaction is not committed. The outcome is reported by the next
+    call to commit().
+  */
+
+  void commit_after_next()
+  {
+    m_session->commit_after_next();
+  }
+
   /*
     SavePoints are created inside transaction! And later, you can rollback the
     transaction to a specific SavePoint.
@@ -300,6 +329,11 @@ public:
     extracted from the source document. This way the source doucment can be
     transformed into a document with different structure. If `proj` is NULL
     then documents are returned as-is.
+
+    If `cache` is given, it is used to avoid building and serializing
+    the same command again when only parameter values or the limit change
+    (see `protocol::mysqlx::Find_cache`). The caller is responsible for
+    resetting the cache when other parts of the command change.
   */
 
   Reply_init coll_find(const api::Object_ref &coll,
@@ -312,12 +346,13 @@ public:
                        const Limit *lim = NULL,
                        const Param_source *param = NULL,
                        const Lock_mode_value lock_mode = Lock_mode_value::NONE,
-                       const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT
+                       const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT,
+                       mysqlx::Find_cache *cache = NULL
                        )
   {
     return m_session->coll_find(coll, view, expr, proj, order_by,
                                 group_by, having, lim, param,
-                                lock_mode, lock_contention);
+                                lock_mode, lock_contention, cache);
   }
 
   /**
@@ -355,6 +390,8 @@ public:
     alias. Expressions give the values of columns in the resulting row. These
     values can depend on values of fields in the source row.
 
+    Optional `cache` is used in the same way as in `coll_find()`.
+
     @see `api::Projection_processor`
   */
 
@@ -368,11 +405,62 @@ public:
                           const Limit* lim = NULL,
                           const Param_source *param = NULL,
                           const Lock_mode_value lock_mode = Lock_mode_value::NONE,
-                          const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT)
+                          const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT,
+                          mysqlx::Find_cache *cache = NULL)
   {
     return m_session->table_select(tab, view, expr, proj, order_by,
                                    group_by, having, lim, param,
-                                   lock_mode, lock_contention);
+                                   lock_mode, lock_contention, cache);
+  }
+
+  /**
+    Store in `key` the serialized command which would be sent by `coll_find()`
+    called with the same arguments, without sending anything to the server.
+
+    The key identifies the result of the command and can be used, for example,
+    to cache results on the client side. If `cache` is given, it is used
+    and filled in the same way as by `coll_find()`.
+  */
+
+  void coll_find_key(std::string &key,
+                     const api::Object_ref &coll,
+                     const Expression *expr = NULL,
+                     const Expression::Document *proj = NULL,
+                     const Order_by *order_by = NULL,
+                     const Expr_list *group_by = NULL,
+                     const Expression *having = NULL,
+                     const Limit *lim = NULL,
+                     const Param_source *param = NULL,
+                     const Lock_mode_value lock_mode = Lock_mode_value::NONE,
+                     const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT,
+                     mysqlx::Find_cache *cache = NULL)
+  {
+    m_session->coll_find_key(key, coll, expr, proj, order_by,
+                             group_by, having, lim, param,
+                             lock_mode, lock_contention, cache);
+  }
+
+  /**
+    Store in `key` the serialized command which would be sent by
+    `table_select()` called with the same arguments (see `coll_find_key()`).
+  */
+
+  void table_select_key(std::string &key,
+                        const api::Table_ref &tab,
+                        const Expression *expr = NULL,
+                        const Projection *proj = NULL,
+                        const Order_by *order_by = NULL,
+                        const Expr_list *group_by = NULL,
+                        const Expression *having = NULL,
+                        const Limit* lim = NULL,
+                        const Param_source *param = NULL,
+                        const Lock_mode_value lock_mode = Lock_mode_value::NONE,
+                        const Lock_contention_value lock_contention = Lock_contention_value::DEFAULT,
+                        mysqlx::Find_cache *cache = NULL)
+  {
+    m_session->table_select_key(key, tab, expr, proj, order_by,
+                                group_by, having, lim, param,
+                                lock_mode, lock_contention, cache);
   }
 
   /**
@@ -440,6 +528,36 @@ public:
   }
 
 
+  /*
+    Pipelining
+    ----------
+    Method send_ahead() sends the last command created with one of the data
+    manipulation methods without waiting for the replies to earlier commands.
+    Replies to commands sent this way are read, in order, by Reply objects
+    initialized with next_reply():
+
+      sess.sql("SELECT 1"); sess.send_ahead();
+      sess.sql("SELECT 2"); sess.send_ahead();
+
+      Reply r1(sess.next_reply());
+      ...
+      Reply r2(sess.next_reply());
+
+    Commands can not be sent ahead while START TRANSACTION or COMMIT is
+    pending (see set_lazy_begin() and commit_after_next()).
+  */
+
+  void send_ahead()
+  {
+    m_session->send_ahead();
+  }
+
+  Reply_init next_reply()
+  {
+    return m_session->next_reply();
+  }
+
+
   // Async_op interface
 
 public:
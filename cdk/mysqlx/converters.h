@@ -118,6 +118,18 @@ struct Scalar_prc_converter
       break;
     case cdk::TYPE_STRING:
       {
+        // utf8 strings are passed to the protocol without re-coding.
+
+        switch (cdk::Format<cdk::TYPE_STRING>(fi).charset())
+        {
+        case cdk::Charset::utf8:
+        case cdk::Charset::utf8mb4:
+          m_proc->str(data);
+          return;
+        default:
+          break;
+        }
+
         cdk::Codec<cdk::TYPE_STRING> codec(fi);
 
         string val;
@@ -128,7 +140,17 @@ struct Scalar_prc_converter
       break;
     case cdk::TYPE_DATETIME:
       {
-        //TODO: TYPE_DATETIME
+        /*
+          Note: X protocol scalars have no temporal type - the value is
+          sent as a string which server converts as needed.
+        */
+
+        cdk::Codec<cdk::TYPE_DATETIME> codec(fi);
+
+        std::string val;
+        codec.from_bytes(data, val);
+
+        m_proc->str(bytes(val));
       }
       break;
     case cdk::TYPE_BYTES:
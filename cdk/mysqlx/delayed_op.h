@@ -184,6 +184,56 @@ public:
 };
 
 
+/*
+  Open expectation block with no_error condition: if one of the messages
+  inside the block fails, the server does not execute the remaining ones
+  and replies to them with errors.
+*/
+
+class SndExpectNoError
+    : public Proto_delayed_op
+    , public protocol::mysqlx::api::Expectations
+{
+protected:
+
+  Proto_op* start()
+  {
+    return &m_protocol.snd_Expect_Open(*this, false);
+  }
+
+  void process(Processor &prc) const
+  {
+    prc.list_begin();
+    prc.list_el()->set(NO_ERROR);
+    prc.list_end();
+  }
+
+public:
+
+  SndExpectNoError(Protocol& protocol)
+    : Proto_delayed_op(protocol)
+  {}
+};
+
+
+class SndExpectClose
+    : public Proto_delayed_op
+{
+protected:
+
+  Proto_op* start()
+  {
+    return &m_protocol.snd_Expect_Close();
+  }
+
+public:
+
+  SndExpectClose(Protocol& protocol)
+    : Proto_delayed_op(protocol)
+  {}
+};
+
+
 // -------------------------------------------------------------------------
 
 
@@ -579,10 +629,11 @@ protected:
   Expr_converter        m_having_conv;
   Lock_mode_value       m_lock_mode;
   Lock_contention_value m_lock_contention;
+  protocol::mysqlx::Find_cache *m_cache;
 
   Proto_op* start()
   {
-    return &m_protocol.snd_Find(DM, *this, m_param_conv.get());
+    return &m_protocol.snd_Find(DM, *this, m_param_conv.get(), m_cache);
   }
 
 public:
@@ -597,15 +648,29 @@ public:
     const cdk::Limit *lim = NULL,
     const cdk::Param_source *param = NULL,
     const Lock_mode_value locking = Lock_mode_value::NONE,
-    const Lock_contention_value contention = Lock_contention_value::DEFAULT
+    const Lock_contention_value contention = Lock_contention_value::DEFAULT,
+    protocol::mysqlx::Find_cache *cache = NULL
   )
     : Select_op_base(protocol, coll, expr, order_by, lim, param)
     , m_proj_conv(proj)
     , m_group_by_conv(group_by), m_having_conv(having)
     , m_lock_mode(locking)
     , m_lock_contention(contention)
+    , m_cache(cache)
   {}
 
+  /*
+    Store in `buf` the serialized command which would be sent by this
+    operation (see Protocol::ser_Find()).
+  */
+
+  void serialize(std::string &buf)
+  {
+    protocol::mysqlx::Protocol::ser_Find(
+      buf, DM, *this, m_param_conv.get(), m_cache
+    );
+  }
+
 private:
 
   const protocol::mysqlx::api::Projection* project() const
@@ -1149,6 +1214,113 @@ public:
 };
 
 
+/*
+  Receive reply to a message which session sends on its own together with
+  a user command, such as START TRANSACTION or COMMIT statement and the
+  expectation block around them (see Session::send_cmd()).
+
+  If `stmt` is true, the reply to an SQL statement which does not produce
+  a result set is expected, otherwise a plain Ok reply. Error reported by
+  the server is stored in this object and is not added to the session
+  diagnostics.
+*/
+
+class RcvTrxReply
+    : public Proto_delayed_op
+    , private protocol::mysqlx::Mdata_processor
+{
+  typedef protocol::mysqlx::sql_state_t sql_state_t;
+
+  struct Stmt_prc
+    : public protocol::mysqlx::Stmt_processor
+  {
+    RcvTrxReply &m_reply;
+
+    Stmt_prc(RcvTrxReply &reply)
+      : m_reply(reply)
+    {}
+
+    void error(unsigned int code, short int severity,
+               sql_state_t sql_state, const string &msg)
+    {
+      m_reply.error(code, severity, sql_state, msg);
+    }
+  }
+  m_stmt_prc;
+
+  bool m_stmt;
+  unsigned int m_code;
+  sql_state_t  m_sql_state;
+  string       m_msg;
+
+protected:
+
+  Proto_op* start()
+  {
+    if (m_stmt)
+      return &m_protocol.rcv_MetaData(*this);
+    return &m_protocol.rcv_Reply(*this);
+  }
+
+  /*
+    After (empty) meta-data of a statement is read, start reading
+    the final StmtExecuteOk message, unless server reported an error.
+  */
+
+  bool next()
+  {
+    if (!m_stmt || failed() || !op || !op->is_completed())
+      return false;
+    m_stmt = false;
+    op = &m_protocol.rcv_StmtReply(m_stmt_prc);
+    return true;
+  }
+
+  bool do_cont()
+  {
+    Proto_delayed_op::do_cont();
+    next();
+    return is_completed();
+  }
+
+  void do_wait()
+  {
+    Proto_delayed_op::do_wait();
+    if (next())
+      op->wait();
+  }
+
+public:
+
+  RcvTrxReply(Protocol& protocol, bool stmt)
+    : Proto_delayed_op(protocol)
+    , m_stmt_prc(*this)
+    , m_stmt(stmt)
+    , m_code(0)
+  {}
+
+  bool failed() const { return 0 != m_code; }
+  unsigned int code() const { return m_code; }
+  sql_state_t sql_state() const { return m_sql_state; }
+  const string& message() const { return m_msg; }
+
+private:
+
+  void error(unsigned int code, short int severity,
+             sql_state_t sql_state, const string &msg)
+  {
+    // Ignore warnings and notes
+
+    if (severity < 2)
+      return;
+
+    m_code = code;
+    m_sql_state = sql_state;
+    m_msg = msg;
+  }
+};
+
+
 // -------------------------------------------------------------------------
 
 
@@ -79,39 +79,57 @@ struct Proto_field_checker : public cdk::protocol::mysqlx::api::Expectations
   }
 
   /*
-    This method sets the expectation and returns
-    the field flag if it is supported, otherwise 0 is returned.
+    This method sets the expectation data for the given field. Returns
+    false if the field is not known.
   */
-  uint64_t is_supported(Protocol_fields::value v)
+  bool set_field(Protocol_fields::value v)
   {
     switch (v)
     {
       case Protocol_fields::ROW_LOCKING:
         // Find=17, locking=12
         m_data = bytes("17.12");
-        break;
+        return true;
       case Protocol_fields::UPSERT:
         // Insert=18, upsert=6
         m_data = bytes("18.6");
-        break;
+        return true;
       default:
-        return 0;
+        return false;
     }
-    m_proto.snd_Expect_Open(*this, false).wait();
+  }
 
-    Check_reply_prc prc;
-    m_proto.rcv_Reply(prc).wait();
-    uint64_t ret = prc.m_code == 0 ? (uint64_t)v : 0;
+  /*
+    This method checks all given fields and returns the flags of those
+    which are supported. The checks are pipelined: an expectation block is
+    opened and closed for each field without waiting for replies, which are
+    read afterwards. The server replies to each message, also to a close
+    which follows a failed open, so that all replies can be read in order.
+  */
+  uint64_t check(std::initializer_list<Protocol_fields::value> fields)
+  {
+    std::vector<Protocol_fields::value> sent;
 
-    if (prc.m_code == 0 || prc.m_code == 5168)
+    for (Protocol_fields::value v : fields)
     {
-      /*
-        The expectation block needs to be closed if no error
-        or expectation failed error (5168)
-      */
+      if (!set_field(v))
+        continue;
+      m_proto.snd_Expect_Open(*this, false).wait();
       m_proto.snd_Expect_Close().wait();
+      sent.push_back(v);
+    }
+
+    uint64_t ret = 0;
+
+    for (Protocol_fields::value v : sent)
+    {
+      Check_reply_prc prc;
+      m_proto.rcv_Reply(prc).wait();
+      if (prc.m_code == 0)
+        ret |= (uint64_t)v;
       m_proto.rcv_Reply(prc).wait();
     }
+
     return ret;
   }
 };
@@ -349,7 +367,7 @@ private:
 
 
 void Session::do_authenticate(const Options &options,
-                              int original_am,
+                              int am,
                               bool  secure_conn)
 {
 
@@ -357,7 +375,6 @@ void Session::do_authenticate(const Options &options,
 
   using cdk::ds::mysqlx::Protocol_options;
 
-  auto am = original_am;
   if (Protocol_options::DEFAULT == am)
     am = secure_conn ? Protocol_options::PLAIN : Protocol_options::MYSQL41;
 
@@ -387,37 +404,65 @@ void Session::do_authenticate(const Options &options,
                        m_auth_interface->auth_response());
 
   start_reading_auth_reply();
+  ++m_handshake_rtt;
 
   wait();
+}
+
+
+/*
+  With the default authentication method over insecure connection, MYSQL41
+  is tried first and SHA256_MEMORY if it fails. The method which succeeded
+  is remembered, per user, in data source statistics and tried first by
+  the next session of that user, which then does not need the failed
+  attempt.
+*/
+
+void Session::authenticate(const Options &options, bool  secure_conn)
+{
+  using cdk::ds::mysqlx::Protocol_options;
+
+  if (Protocol_options::DEFAULT != options.auth_method() || secure_conn)
+  {
+    do_authenticate(options, options.auth_method(), secure_conn);
+    return;
+  }
+
+  int first = Protocol_options::MYSQL41;
+  int second = Protocol_options::SHA256_MEMORY;
+
+  if (m_host_stats
+      && Protocol_options::SHA256_MEMORY
+         == m_host_stats->auth_method(options.user()))
+    std::swap(first, second);
+
+  do_authenticate(options, first, secure_conn);
 
   if (!m_isvalid)
   {
-    if (Protocol_options::DEFAULT == original_am && !secure_conn)
+    //Cleanup Diagnostic_area
+    clear_errors();
+
+    /*
+      Second attempt does not throw errors. If auth fails, it will always
+      throw below error
+    */
+    try{
+    do_authenticate(options, second, secure_conn);
+    } catch(...)
+    {}
+
+    if (!m_isvalid)
     {
-      //Cleanup Diagnostic_area
-      clear_errors();
-
-      /*
-        Second attempt does not throw errors. If auth fails, it will always
-        throw below error
-      */
-      try{
-      do_authenticate(options, Protocol_options::SHA256_MEMORY, secure_conn);
-      } catch(...)
-      {}
-
-      if (!m_isvalid)
-      {
-        throw_error("Authentication failed using MYSQL41 and SHA256_MEMORY, "
-                      "check username and password or try a secure connection");
-      }
+      throw_error("Authentication failed using MYSQL41 and SHA256_MEMORY, "
+                    "check username and password or try a secure connection");
     }
+
+    first = second;
   }
-}
 
-void Session::authenticate(const Options &options, bool  secure_conn)
-{
-  do_authenticate(options, options.auth_method(),secure_conn);
+  if (m_host_stats)
+    m_host_stats->set_auth_method(options.user(), first);
 }
 
 
@@ -432,6 +477,8 @@ Session::~Session()
   {
   }
 
+  request_end();
+
   try
   {
     m_auth_interface.reset();
@@ -457,11 +504,26 @@ void Session::check_protocol_fields()
     wait();
     if (0 < entry_count())
       get_error().rethrow();
+
+    // Use fields remembered from previous sessions, if any.
+
+    if (m_host_stats
+        && ds::Host_stats::UNKNOWN_FIELDS != m_host_stats->proto_fields())
+    {
+      m_proto_fields = m_host_stats->proto_fields();
+      return;
+    }
+
     Proto_field_checker field_checker(m_protocol);
-    m_proto_fields = 0;
     /* More fields checks will be added here */
-    m_proto_fields |= field_checker.is_supported(Protocol_fields::ROW_LOCKING);
-    m_proto_fields |= field_checker.is_supported(Protocol_fields::UPSERT);
+    m_proto_fields = field_checker.check({
+      Protocol_fields::ROW_LOCKING,
+      Protocol_fields::UPSERT
+    });
+    ++m_handshake_rtt;
+
+    if (m_host_stats)
+      m_host_stats->set_proto_fields(m_proto_fields);
   }
 }
 
@@ -477,6 +539,12 @@ option_t Session::check_valid()
 void Session::close()
 {
   m_reply_op_queue.clear();
+  m_trx_replies.clear();
+  m_begin_pending = false;
+  m_commit_pending = false;
+  m_begin_reply.reset();
+  m_commit_reply.reset();
+  m_sent_ahead = 0;
 
   if (is_valid())
   {
@@ -504,6 +572,42 @@ void Session::deregister_reply(Reply *reply)
 {
   // TODO: Should reply be discared here?
   m_current_reply = NULL;
+  request_end();
+}
+
+
+/*
+  Update data source statistics when a command is sent and when the first
+  reply to it arrives (result set meta-data, OK or error). The sample does
+  not extend until the reply is fully consumed, so that the time spent by
+  the client on processing rows is not counted as server latency.
+*/
+
+void Session::request_begin()
+{
+  if (!m_host_stats)
+    return;
+
+  request_end();
+  m_in_request = true;
+  m_request_start = std::chrono::steady_clock::now();
+  m_host_stats->request_begin();
+}
+
+
+void Session::request_end()
+{
+  if (!m_in_request)
+    return;
+
+  using namespace std::chrono;
+
+  m_in_request = false;
+  m_host_stats->request_end(
+    (uint64_t)duration_cast<microseconds>(
+      steady_clock::now() - m_request_start
+    ).count()
+  );
 }
 
 
@@ -542,8 +646,48 @@ Reply_init& Session::admin(const char *cmd, const cdk::Any::Document &args)
   which will work well in a distributed environment.
 */
 
+/*
+  If COMMIT was sent after the last command, read replies to it and to
+  the other pipelined transaction statements and return the COMMIT reply.
+  Otherwise return null.
+*/
+
+shared_ptr<RcvTrxReply> Session::take_commit_reply()
+{
+  shared_ptr<RcvTrxReply> reply;
+
+  if (!m_commit_reply)
+    return reply;
+
+  read_trx_replies();
+  reply.swap(m_commit_reply);
+  return reply;
+}
+
+
 void Session::begin()
 {
+  m_commit_pending = false;
+
+  /*
+    If COMMIT sent after the last command failed, report it here, as it
+    would be lost otherwise. If it was skipped, because the command failed,
+    the transaction is still open.
+  */
+
+  shared_ptr<RcvTrxReply> reply = take_commit_reply();
+
+  if (reply && reply->failed() && !m_commit_skipped)
+    throw Server_error(reply->code(), reply->sql_state(), reply->message());
+
+  // START TRANSACTION implicitly commits the current transaction.
+
+  if (m_lazy_begin)
+  {
+    m_begin_pending = true;
+    return;
+  }
+
   Reply r(sql(L"START TRANSACTION", NULL));
   r.wait();
   if (r.entry_count() > 0)
@@ -552,6 +696,33 @@ void Session::begin()
 
 void Session::commit()
 {
+  m_commit_pending = false;
+
+  // Check if COMMIT was already sent after the last command.
+
+  shared_ptr<RcvTrxReply> reply = take_commit_reply();
+
+  if (reply)
+  {
+    if (!reply->failed())
+      return;
+
+    if (m_commit_skipped)
+      throw_error(
+        "Transaction was not committed because the last statement failed"
+      );
+
+    throw Server_error(reply->code(), reply->sql_state(), reply->message());
+  }
+
+  // Nothing was sent in the transaction.
+
+  if (m_begin_pending)
+  {
+    m_begin_pending = false;
+    return;
+  }
+
   Reply r(sql(L"COMMIT", NULL));
   r.wait();
   if (r.entry_count() > 0)
@@ -560,6 +731,28 @@ void Session::commit()
 
 void Session::rollback(const string &savepoint)
 {
+  if (savepoint.empty())
+  {
+    m_commit_pending = false;
+
+    /*
+      If COMMIT was already sent after the last command and succeeded, it
+      is too late to roll back. If it was skipped or failed, the transaction
+      is rolled back below.
+    */
+
+    shared_ptr<RcvTrxReply> reply = take_commit_reply();
+
+    if (reply && !reply->failed())
+      throw_error("Transaction was already committed");
+
+    if (m_begin_pending)
+    {
+      m_begin_pending = false;
+      return;
+    }
+  }
+
   string qry = L"ROLLBACK";
   if (!savepoint.empty())
     qry += string(L" TO `") + savepoint + L"`";
@@ -622,16 +815,20 @@ Reply_init& Session::coll_find(const Table_ref &coll,
                                const Limit *lim,
                                const Param_source *param,
                                const Lock_mode_value lock_mode,
-                               const Lock_contention_value lock_contention)
+                               const Lock_contention_value lock_contention,
+                               Find_cache *cache)
 {
   if (lock_mode != Lock_mode_value::NONE &&
       !(m_proto_fields & Protocol_fields::ROW_LOCKING))
     throw_error("Row locking is not supported by this version of the server");
 
+  // Note: cached command is not used when creating a view.
+
   SndFind<protocol::mysqlx::DOCUMENT> *find
     = new SndFind<protocol::mysqlx::DOCUMENT>(
             m_protocol, coll, expr, proj, order_by,
-            group_by, having, lim, param, lock_mode, lock_contention
+            group_by, having, lim, param, lock_mode, lock_contention,
+            view ? NULL : cache
           );
 
   if (view)
@@ -685,7 +882,8 @@ Reply_init& Session::table_select(const Table_ref &coll,
                                   const Limit *lim,
                                   const Param_source *param,
                                   const Lock_mode_value lock_mode,
-                                  const Lock_contention_value lock_contention)
+                                  const Lock_contention_value lock_contention,
+                                  Find_cache *cache)
 {
   if (lock_mode != Lock_mode_value::NONE &&
       !(m_proto_fields & Protocol_fields::ROW_LOCKING))
@@ -694,7 +892,8 @@ Reply_init& Session::table_select(const Table_ref &coll,
   SndFind<protocol::mysqlx::TABLE> *find
     = new SndFind<protocol::mysqlx::TABLE>(
             m_protocol, coll, expr, proj, order_by,
-            group_by, having, lim, param, lock_mode, lock_contention
+            group_by, having, lim, param, lock_mode, lock_contention,
+            view ? NULL : cache
           );
 
   if (view)
@@ -703,6 +902,48 @@ Reply_init& Session::table_select(const Table_ref &coll,
   return set_command(find);
 }
 
+void Session::coll_find_key(std::string &key,
+                            const Table_ref &coll,
+                            const Expression *expr,
+                            const Expression::Document *proj,
+                            const Order_by *order_by,
+                            const Expr_list *group_by,
+                            const Expression *having,
+                            const Limit *lim,
+                            const Param_source *param,
+                            const Lock_mode_value lock_mode,
+                            const Lock_contention_value lock_contention,
+                            Find_cache *cache)
+{
+  SndFind<protocol::mysqlx::DOCUMENT> find(
+    m_protocol, coll, expr, proj, order_by,
+    group_by, having, lim, param, lock_mode, lock_contention, cache
+  );
+
+  find.serialize(key);
+}
+
+void Session::table_select_key(std::string &key,
+                               const Table_ref &coll,
+                               const Expression *expr,
+                               const Projection *proj,
+                               const Order_by *order_by,
+                               const Expr_list *group_by,
+                               const Expression *having,
+                               const Limit *lim,
+                               const Param_source *param,
+                               const Lock_mode_value lock_mode,
+                               const Lock_contention_value lock_contention,
+                               Find_cache *cache)
+{
+  SndFind<protocol::mysqlx::TABLE> find(
+    m_protocol, coll, expr, proj, order_by,
+    group_by, having, lim, param, lock_mode, lock_contention, cache
+  );
+
+  find.serialize(key);
+}
+
 Reply_init& Session::table_update(const api::Table_ref &coll,
                                   const Expression *expr,
                                   const Update_spec &us,
@@ -749,6 +990,7 @@ void Session::auth_continue(bytes data)
 {
   start_authentication_continue(m_auth_interface->auth_continue(data));
   start_reading_auth_reply();
+  ++m_handshake_rtt;
 }
 
 
@@ -797,6 +1039,31 @@ void Session::error(unsigned int code, short int severity,
   default:
     level = Severity::ERROR; break;
   }
+
+  if (Severity::ERROR == level)
+  {
+    /*
+      If START TRANSACTION sent together with the command failed, the
+      command was not executed and the error reported for it only says
+      that. Report the error of START TRANSACTION instead.
+    */
+
+    if (m_begin_reply && m_begin_reply->failed())
+    {
+      shared_ptr<RcvTrxReply> reply;
+      reply.swap(m_begin_reply);
+      add_diagnostics(
+        level, reply->code(), reply->sql_state(), reply->message()
+      );
+      return;
+    }
+
+    // COMMIT sent after a failed command is not executed.
+
+    if (m_commit_reply && !m_commit_reply->is_completed())
+      m_commit_skipped = true;
+  }
+
   add_diagnostics(level, code, sql_state, msg);
 }
 
@@ -822,7 +1089,10 @@ void Session::add_diagnostics(Severity::value level, unsigned code,
   {
     m_current_reply->m_da.add_entry(level, new Server_error(code, sql_state, msg));
     if (Severity::ERROR == level)
+    {
       m_current_reply->m_error = true;
+      request_end();
+    }
   }
   else
   {
@@ -832,12 +1102,15 @@ void Session::add_diagnostics(Severity::value level, unsigned code,
 
 
 void Session::ok(string)
-{}
+{
+  request_end();
+}
 
 
 void Session::col_count(col_count_t nr_cols)
 {
   //When all columns metadata arrived...
+  request_end();
   m_nr_cols = nr_cols;
   m_has_results = m_nr_cols != 0;
 
@@ -951,6 +1224,7 @@ void Session::execute_ok()
 {
   // All done!
   m_executed = true;
+  request_end();
 }
 
 
@@ -998,13 +1272,142 @@ void Session::generated_document_id(const std::string& id)
 
 void Session::send_cmd()
 {
+  request_begin();
   m_executed = false;
-  m_reply_op_queue.push_back(m_cmd);
+
+  /*
+    If START TRANSACTION or COMMIT is pending, it is sent together with
+    the command inside a no_error expectation block, so that statements
+    following a failed one are not executed.
+  */
+
+  bool trx = m_cmd && (m_begin_pending || m_commit_pending);
+
+  if (trx)
+    m_reply_op_queue.push_back(
+      shared_ptr<Proto_op>(new SndExpectNoError(m_protocol))
+    );
+
+  if (trx && m_begin_pending)
+    m_reply_op_queue.push_back(
+      shared_ptr<Proto_op>(
+        new SndStmt(m_protocol, "sql", L"START TRANSACTION", NULL)
+      )
+    );
+
+  // Note: m_cmd is not set if the command was sent with send_ahead().
+
+  if (m_cmd)
+    m_reply_op_queue.push_back(m_cmd);
+  else
+  {
+    assert(0 < m_sent_ahead);
+    --m_sent_ahead;
+  }
+
   m_cmd.reset();
+
+  if (trx && m_commit_pending)
+    m_reply_op_queue.push_back(
+      shared_ptr<Proto_op>(new SndStmt(m_protocol, "sql", L"COMMIT", NULL))
+    );
+
+  if (trx)
+    m_reply_op_queue.push_back(
+      shared_ptr<Proto_op>(new SndExpectClose(m_protocol))
+    );
+
+  // Replies to messages sent after the previous command come first.
+
+  for (auto &op : m_trx_replies)
+    m_reply_op_queue.push_back(op);
+  m_trx_replies.clear();
+
+  m_begin_reply.reset();
+
+  if (trx)
+    m_reply_op_queue.push_back(
+      shared_ptr<Proto_op>(new RcvTrxReply(m_protocol, false))
+    );
+
+  if (trx && m_begin_pending)
+  {
+    m_begin_reply.reset(new RcvTrxReply(m_protocol, true));
+    m_reply_op_queue.push_back(m_begin_reply);
+  }
+
+  if (trx && m_commit_pending)
+  {
+    m_commit_reply.reset(new RcvTrxReply(m_protocol, true));
+    m_commit_skipped = false;
+    m_trx_replies.push_back(m_commit_reply);
+  }
+
+  if (trx)
+  {
+    m_trx_replies.push_back(
+      shared_ptr<Proto_op>(new RcvTrxReply(m_protocol, false))
+    );
+    m_begin_pending = false;
+    m_commit_pending = false;
+  }
+
   m_stmt_stats.clear();
 }
 
 
+void Session::send_ahead()
+{
+  if (!m_cmd)
+    throw_error("send_ahead: no command to send");
+
+  /*
+    Pending START TRANSACTION or COMMIT would have to be sent before or
+    after the command, which is not supported here.
+  */
+
+  if (m_begin_pending || m_commit_pending)
+    throw_error("send_ahead: transaction statement is pending");
+
+  shared_ptr<Proto_op> cmd;
+  cmd.swap(m_cmd);
+  cmd->wait();
+  ++m_sent_ahead;
+}
+
+
+Reply_init& Session::next_reply()
+{
+  if (0 == m_sent_ahead)
+    throw_error("next_reply: no command was sent ahead");
+
+  m_cmd.reset();
+  return *this;
+}
+
+
+/*
+  Read replies to messages sent after the last command (see send_cmd()).
+  The reply to the command itself is discarded first.
+*/
+
+void Session::read_trx_replies()
+{
+  if (m_current_reply)
+  {
+    m_current_reply->close_cursor();
+    m_current_reply->discard();
+  }
+
+  while (!m_trx_replies.empty())
+  {
+    shared_ptr<Proto_op> op = m_trx_replies.front();
+    m_trx_replies.pop_front();
+    op->wait();
+  }
+}
+
+
 void Session::start_reading_result()
 {
   m_col_metadata.reset(new Mdata_storage());
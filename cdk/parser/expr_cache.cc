@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "expr_cache.h"
+
+PUSH_SYS_WARNINGS
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+POP_SYS_WARNINGS
+
+using namespace parser;
+
+
+/*
+  Parse string of the given kind and store the result.
+*/
+
+static
+void parse_spec(Expr_cache::Kind kind, Parser_mode::value mode,
+                const cdk::string &str, Expr_cache::Parsed &parsed)
+{
+  switch (kind)
+  {
+  case Expr_cache::EXPR:
+    {
+      Expression_parser parser(mode, str);
+      parser.process(parsed.m_expr);
+    }
+    return;
+
+  case Expr_cache::ORDER:
+    {
+      struct : public cdk::api::Order_expr<Expression>::Processor
+      {
+        Expr_cache::Parsed *m_parsed;
+
+        Expr_prc* sort_key(cdk::api::Sort_direction::value dir)
+        {
+          m_parsed->m_dir = dir;
+          return &m_parsed->m_expr;
+        }
+      }
+      prc;
+
+      prc.m_parsed = &parsed;
+      Order_parser parser(mode, str);
+      parser.process(prc);
+    }
+    return;
+
+  case Expr_cache::PROJ_TBL:
+    {
+      struct : public cdk::api::Projection_expr<Expression>::Processor
+      {
+        Expr_cache::Parsed *m_parsed;
+
+        Expr_prc* expr()
+        {
+          return &m_parsed->m_expr;
+        }
+
+        void alias(const cdk::string &name)
+        {
+          m_parsed->m_has_alias = true;
+          m_parsed->m_alias = name;
+        }
+      }
+      prc;
+
+      prc.m_parsed = &parsed;
+      Projection_parser parser(mode, str);
+      parser.process(prc);
+    }
+    return;
+
+  case Expr_cache::PROJ_DOC:
+    {
+      struct : public cdk::Expression::Document::Processor
+      {
+        Expr_cache::Parsed *m_parsed;
+
+        Any_prc* key_val(const cdk::string &key)
+        {
+          m_parsed->m_has_alias = true;
+          m_parsed->m_alias = key;
+          return &m_parsed->m_expr;
+        }
+      }
+      prc;
+
+      prc.m_parsed = &parsed;
+      Projection_parser parser(mode, str);
+      parser.process(prc);
+    }
+    return;
+  }
+}
+
+
+/*
+  The cache is implemented as a list of entries, ordered from the most
+  recently used one, and a hash map which finds list elements by key.
+*/
+
+namespace {
+
+struct Key
+{
+  Expr_cache::Kind   m_kind;
+  Parser_mode::value m_mode;
+  cdk::string        m_str;
+
+  bool operator==(const Key &other) const
+  {
+    return m_kind == other.m_kind && m_mode == other.m_mode
+           && m_str == other.m_str;
+  }
+};
+
+struct Key_hash
+{
+  size_t operator()(const Key &key) const
+  {
+    return std::hash<std::wstring>()(key.m_str)
+           ^ (size_t(key.m_kind) << 1) ^ (size_t(key.m_mode) << 3);
+  }
+};
+
+struct Cache
+{
+  typedef std::list<std::pair<Key, Expr_cache::Entry>> List;
+
+  std::mutex  m_lock;
+  List        m_list;
+  std::unordered_map<Key, List::iterator, Key_hash>  m_map;
+  size_t      m_capacity = Expr_cache::default_capacity;
+  size_t      m_hits = 0;
+
+  void trim()
+  {
+    while (m_list.size() > m_capacity)
+    {
+      m_map.erase(m_list.back().first);
+      m_list.pop_back();
+    }
+  }
+
+  static Cache& instance()
+  {
+    static Cache cache;
+    return cache;
+  }
+};
+
+}  // anonymous namespace
+
+
+Expr_cache::Entry
+Expr_cache::get(Kind kind, Parser_mode::value mode, const cdk::string &str)
+{
+  Cache &cache = Cache::instance();
+  Key key{ kind, mode, str };
+
+  {
+    std::lock_guard<std::mutex> guard(cache.m_lock);
+
+    auto it = cache.m_map.find(key);
+
+    if (it != cache.m_map.end())
+    {
+      cache.m_list.splice(cache.m_list.begin(), cache.m_list, it->second);
+      ++cache.m_hits;
+      return it->second->second;
+    }
+  }
+
+  /*
+    Parsing is done without holding the lock. If the same string is parsed
+    by another thread in the meantime, the entry which is already in
+    the cache is used.
+  */
+
+  std::shared_ptr<Parsed> parsed = std::make_shared<Parsed>();
+  parse_spec(kind, mode, str, *parsed);
+
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+
+  if (0 == cache.m_capacity)
+    return parsed;
+
+  auto it = cache.m_map.find(key);
+
+  if (it != cache.m_map.end())
+    return it->second->second;
+
+  cache.m_list.emplace_front(key, parsed);
+  cache.m_map.emplace(std::move(key), cache.m_list.begin());
+  cache.trim();
+
+  return parsed;
+}
+
+
+void Expr_cache::set_capacity(size_t capacity)
+{
+  Cache &cache = Cache::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  cache.m_capacity = capacity;
+  cache.trim();
+}
+
+
+size_t Expr_cache::capacity()
+{
+  Cache &cache = Cache::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_capacity;
+}
+
+
+size_t Expr_cache::size()
+{
+  Cache &cache = Cache::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_list.size();
+}
+
+
+size_t Expr_cache::hits()
+{
+  Cache &cache = Cache::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_hits;
+}
+
+
+void Expr_cache::clear()
+{
+  Cache &cache = Cache::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  cache.m_map.clear();
+  cache.m_list.clear();
+  cache.m_hits = 0;
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef _EXPR_CACHE_H_
+#define _EXPR_CACHE_H_
+
+#include "expr_parser.h"
+
+PUSH_SYS_WARNINGS
+#include <memory>
+POP_SYS_WARNINGS
+
+
+namespace parser {
+
+
+/*
+  Cache of parsed expressions
+  ===========================
+
+  Applications typically execute the same statements many times, each time
+  parsing the same expression strings used as selection criteria, sort keys,
+  projections etc. To avoid this, parsed expressions are stored in a
+  process-wide cache, indexed by the kind of the specification, parser mode
+  and the expression string.
+
+  An expression is stored in a Stored_any tree which can be reported to any
+  expression processor. Entries of the cache are shared pointers to objects
+  which are not modified after they are stored, therefore an entry obtained
+  from the cache can be used without any locks, also by several threads at
+  the same time. Access to the cache itself is serialized by a mutex.
+
+  The cache holds a bounded number of entries and the least recently used
+  entry is removed when a new one is added to the full cache. Strings which
+  fail to parse are not stored and each attempt to use them reports
+  the parse error.
+*/
+
+class Expr_cache
+{
+public:
+
+  enum Kind
+  {
+    EXPR,       // plain expression
+    ORDER,      // sort key: "<expr> [ASC|DESC]"
+    PROJ_TBL,   // table projection: "<expr> [AS <alias>]"
+    PROJ_DOC    // document projection: "<expr> AS <alias>"
+  };
+
+  /*
+    Parsed specification. Depending on the kind, it includes the sort
+    direction or the alias.
+  */
+
+  struct Parsed
+  {
+    Stored_any  m_expr;
+    cdk::api::Sort_direction::value m_dir = cdk::api::Sort_direction::ASC;
+    bool        m_has_alias = false;
+    cdk::string m_alias;
+  };
+
+  typedef std::shared_ptr<const Parsed> Entry;
+
+  /*
+    Return parsed form of the given string, parsing it if it is not yet
+    in the cache. Parse errors are thrown from here.
+  */
+
+  static Entry get(Kind, Parser_mode::value, const cdk::string&);
+
+  /*
+    Set the maximum number of entries in the cache. Setting it to 0
+    disables caching.
+  */
+
+  static void set_capacity(size_t);
+  static size_t capacity();
+
+  // Current number of entries in the cache.
+
+  static size_t size();
+
+  // Number of requests that were served from the cache.
+
+  static size_t hits();
+
+  static void clear();
+
+  static const size_t default_capacity = 1024;
+};
+
+
+/*
+  Expressions given by strings which use the cache of parsed expressions.
+  They can be used in place of Expression_parser, Order_parser and
+  Projection_parser, respectively. The cache is consulted when expression
+  is processed for the first time.
+
+  These classes can be also created from an expression which is already
+  in parsed form (such as one built without parsing any string). Such
+  expression is used as is, regardless of the kind of the specification.
+*/
+
+class Cached_base
+{
+protected:
+
+  Parser_mode::value m_mode;
+  cdk::string        m_expr;
+  bool               m_given = false;
+
+  mutable Expr_cache::Kind  m_kind;
+  mutable Expr_cache::Entry m_entry;
+
+  Cached_base(Parser_mode::value mode, const cdk::string &expr)
+    : m_mode(mode), m_expr(expr), m_kind(Expr_cache::EXPR)
+  {}
+
+  Cached_base(const Expr_cache::Entry &entry)
+    : m_mode(Parser_mode::DOCUMENT), m_given(true)
+    , m_kind(Expr_cache::EXPR), m_entry(entry)
+  {
+    assert(entry);
+  }
+
+  const Expr_cache::Parsed& parsed(Expr_cache::Kind kind) const
+  {
+    if (m_given)
+      return *m_entry;
+
+    if (!m_entry || kind != m_kind)
+    {
+      m_entry = Expr_cache::get(kind, m_mode, m_expr);
+      m_kind = kind;
+    }
+    return *m_entry;
+  }
+};
+
+
+class Cached_expr
+  : public Expression
+  , Cached_base
+{
+public:
+
+  Cached_expr(Parser_mode::value mode, const cdk::string &expr)
+    : Cached_base(mode, expr)
+  {}
+
+  Cached_expr(const Expr_cache::Entry &entry)
+    : Cached_base(entry)
+  {}
+
+  void process(Processor &prc) const
+  {
+    parsed(Expr_cache::EXPR).m_expr.process(prc);
+  }
+};
+
+
+class Cached_order
+  : public cdk::api::Order_expr<Expression>
+  , Cached_base
+{
+public:
+
+  Cached_order(Parser_mode::value mode, const cdk::string &expr)
+    : Cached_base(mode, expr)
+  {}
+
+  Cached_order(const Expr_cache::Entry &entry)
+    : Cached_base(entry)
+  {}
+
+  void process(Processor &prc) const
+  {
+    const Expr_cache::Parsed &p = parsed(Expr_cache::ORDER);
+    p.m_expr.process_if(prc.sort_key(p.m_dir));
+  }
+};
+
+
+class Cached_projection
+  : public cdk::api::Projection_expr<Expression>
+  , public cdk::Expression::Document
+  , Cached_base
+{
+  typedef cdk::api::Projection_expr<Expression>::Processor
+          Projection_processor;
+  typedef cdk::Expression::Document::Processor Document_processor;
+
+public:
+
+  Cached_projection(Parser_mode::value mode, const cdk::string &expr)
+    : Cached_base(mode, expr)
+  {}
+
+  Cached_projection(const Expr_cache::Entry &entry)
+    : Cached_base(entry)
+  {}
+
+  void process(Projection_processor &prc) const
+  {
+    const Expr_cache::Parsed &p = parsed(Expr_cache::PROJ_TBL);
+    p.m_expr.process_if(prc.expr());
+    if (p.m_has_alias)
+      prc.alias(p.m_alias);
+  }
+
+  void process(Document_processor &prc) const
+  {
+    const Expr_cache::Parsed &p = parsed(Expr_cache::PROJ_DOC);
+    p.m_expr.process_if(prc.key_val(p.m_alias));
+  }
+};
+
+
+}  // parser
+
+#endif
@@ -50,15 +50,14 @@ using cdk::safe_prc;
 
 
 /*
-  Set up keyword and operator maps.
+  Set up operator maps.
 */
 
-Keyword::map_t  Keyword::kw_map;
-Keyword         Keyword::init;
-
-Op::tok_map_t   Op::unary_tok_map, Op::binary_tok_map;
-Op::kw_map_t    Op::unary_kw_map, Op::binary_kw_map;
-Op              Op::init;
+Op::Type  Op::unary_tok_map[Op::tok_count];
+Op::Type  Op::binary_tok_map[Op::tok_count];
+Op::Type  Op::unary_kw_map[Op::kw_count];
+Op::Type  Op::binary_kw_map[Op::kw_count];
+Op        Op::init;
 
 
 // -------------------------------------------------------------------------
@@ -1450,27 +1449,20 @@ Expr_parser_base::left_assoc_binary_op(const Op::Set &ops,
 
 Expression* Expr_parser_base::parse_mul(Processor *prc)
 {
-  Op::Set ops;
-  ops.insert(Op::MUL);
-  ops.insert(Op::DIV);
-  ops.insert(Op::MOD);
+  static const Op::Set ops{ Op::MUL, Op::DIV, Op::MOD };
   return left_assoc_binary_op(ops, ATOMIC, MUL, prc);
 }
 
 
 Expression* Expr_parser_base::parse_add(Processor *prc)
 {
-  Op::Set ops;
-  ops.insert(Op::ADD);
-  ops.insert(Op::SUB);
+  static const Op::Set ops{ Op::ADD, Op::SUB };
   return left_assoc_binary_op(ops, MUL, ADD, prc);
 }
 
 Expression* Expr_parser_base::parse_shift(Processor *prc)
 {
-  Op::Set ops;
-  ops.insert(Op::LSHIFT);
-  ops.insert(Op::RSHIFT);
+  static const Op::Set ops{ Op::LSHIFT, Op::RSHIFT };
   return left_assoc_binary_op(ops, ADD, SHIFT, prc);
 }
 
@@ -1497,33 +1489,26 @@ Expression* Expr_parser_base::parse_bit(Processor *prc)
     return parse_bit(prc);
   }
 
-  Op::Set ops;
-  ops.insert(Op::BITAND);
-  ops.insert(Op::BITOR);
-  ops.insert(Op::BITXOR);
+  static const Op::Set ops{ Op::BITAND, Op::BITOR, Op::BITXOR };
   return left_assoc_binary_op(ops, SHIFT, BIT, prc);
 }
 
 Expression* Expr_parser_base::parse_comp(Processor *prc)
 {
-  Op::Set ops;
-  ops.insert(Op::GE);
-  ops.insert(Op::GT);
-  ops.insert(Op::LE);
-  ops.insert(Op::LT);
-  ops.insert(Op::EQ);
-  ops.insert(Op::NE);
+  static const Op::Set ops{ Op::GE, Op::GT, Op::LE, Op::LT, Op::EQ, Op::NE };
   return left_assoc_binary_op(ops, BIT, COMP, prc);
 }
 
 Expression* Expr_parser_base::parse_and(Processor *prc)
 {
-  return left_assoc_binary_op({ Op::AND }, ILRI, AND, prc);
+  static const Op::Set ops{ Op::AND };
+  return left_assoc_binary_op(ops, ILRI, AND, prc);
 }
 
 Expression* Expr_parser_base::parse_or(Processor *prc)
 {
-  return left_assoc_binary_op({ Op::OR }, AND, OR, prc);
+  static const Op::Set ops{ Op::OR };
+  return left_assoc_binary_op(ops, AND, OR, prc);
 }
 
 
@@ -1559,14 +1544,10 @@ Expression* Expr_parser_base::parse_ilri(Processor *prc)
     Look for the main operator.
   */
 
-  Op::Set next;
-  next.insert(Op::IS);
-  next.insert(Op::IN);
-  next.insert(Op::LIKE);
-  next.insert(Op::RLIKE);
-  next.insert(Op::BETWEEN);
-  next.insert(Op::REGEXP);
-  next.insert(Op::SOUNDS_LIKE);
+  static const Op::Set next{
+    Op::IS, Op::IN, Op::LIKE, Op::RLIKE, Op::BETWEEN, Op::REGEXP,
+    Op::SOUNDS_LIKE
+  };
 
   const Token *t = consume_token(next);
 
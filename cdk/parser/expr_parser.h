@@ -233,60 +233,72 @@ public:
 
   /*
     Case insensitive string comparison function which is used to match
-    keywords.
+    keywords. Only ASCII characters are compared case insensitively (only
+    these characters are used in keywords).
   */
 
   static bool equal(const string &a, const string &b)
   {
-    static kw_cmp  cmp;
+    if (a.length() != b.length())
+      return false;
+
+    for (size_t i = 0; i < a.length(); ++i)
+      if (lower(a[i]) != lower(b[i]))
+        return false;
 
-    return (!cmp(a, b) && !cmp(b, a));
+    return true;
   }
 
 private:
 
-  struct kw_cmp
+  static cdk::char_t lower(cdk::char_t c)
   {
-    struct char_cmp
-    {
-      bool operator()(cdk::char_t, cdk::char_t) const;
-    };
-
-    bool operator()(const string &a, const string &b) const
-    {
-      static char_cmp cmp;
-      return std::lexicographical_compare(
-        a.begin(), a.end(),
-        b.begin(), b.end(), cmp
-      );
-    }
-  };
+    return (L'A' <= c && c <= L'Z') ? c - L'A' + L'a' : c;
+  }
 
   /*
-    Map which maps words to keyword ids. Case insensitive comparison is
-    used to locate words in this map.
+    Keywords are recognized using a perfect hash of their lower-case
+    characters (FNV-1a). Hashes of the keywords declared by KEYWORD_LIST()
+    are computed at compile time and used as case labels of a switch
+    statement in get(). This way compiler verifies that the hash function
+    has no collisions on the set of keywords (otherwise there would be
+    duplicate case labels). Since other words can have the same hash as one
+    of the keywords, a word is compared with the keyword found by the hash.
   */
 
-  typedef std::map<string, Type, kw_cmp> map_t;
-
-  static map_t kw_map;
+  static constexpr uint32_t hash(const char *kw, uint32_t h = 2166136261U)
+  {
+    return *kw ? hash(kw + 1, (h ^ (unsigned char)*kw) * 16777619U) : h;
+  }
 
   /*
-    Default ctor builds the keyword map based on keyword declarartions given
-    by KEYWORD_LIST() macro.
+    Compute hash of the given word. Returns false if the word can not be
+    a keyword because it contains non-ASCII characters.
   */
 
-  Keyword()
+  static bool hash(const string &word, uint32_t &h)
   {
+    h = 2166136261U;
 
-#define kw_add(A,B)  kw_map[B] = A;
+    for (cdk::char_t c : word)
+    {
+      if ((uint32_t)c >= 0x80)
+        return false;
+      h = (h ^ (uint32_t)lower(c)) * 16777619U;
+    }
 
-    KEYWORD_LIST(kw_add);
+    return true;
   }
 
-  // This initializer instance makes sure that the keyowrd map is built.
-
-  static Keyword init;
+  static bool match(const string &word, const char *kw)
+  {
+    for (cdk::char_t c : word)
+    {
+      if (lower(c) != (cdk::char_t)*kw++)
+        return false;
+    }
+    return 0 == *kw;
+  }
 };
 
 
@@ -298,11 +310,19 @@ Keyword::Type Keyword::get(const Token &t)
   if (Token::WORD != t.get_type())
     return NONE;
 
-  // Locate WORD in the keyword map.
+  const string &word = t.get_text();
+  uint32_t h;
+
+  if (!hash(word, h))
+    return NONE;
 
-  auto x = kw_map.find(t.get_text());
+#define kw_case(A,B)  case hash(B): return match(word, B) ? A : NONE;
 
-  return (x == kw_map.end() ? NONE : x->second);
+  switch (h)
+  {
+    KEYWORD_LIST(kw_case)
+  default: return NONE;
+  }
 }
 
 
@@ -313,24 +333,6 @@ bool operator==(Keyword::Type type, const Token &tok)
 }
 
 
-inline
-bool Keyword::kw_cmp::char_cmp::operator()(cdk::char_t a, cdk::char_t b) const
-{
-  /*
-    Since we operate on wide characters, "C" locale's ctype facet is used
-    to make lowercase conversion. "C" locale is sufficent because we care about
-    correct results only for ASCII characters (only these characters are used
-    in keywords).
-  */
-
-  static std::locale c_loc("C");
-  static const std::ctype<wchar_t> &ctf
-    = std::use_facet<std::ctype<wchar_t>>(c_loc);
-
-  return ctf.tolower(a) < ctf.tolower(b);
-}
-
-
 // --------------------------------------------------------------------------
 
 /*
@@ -392,23 +394,25 @@ public:
 private:
 
   /*
-    Maps used to recognize operators.
+    Tables used to recognize operators.
 
     Operator can be a keyword or other token. For each kind of operator (unary
-    or binary) we have two maps. One map maps keyword ids to operators. The
-    other map maps other token types to operators. These maps are filled based
-    on the information given by UNARY/BINARY_OP() macros that declare
-    operators.
+    or binary) we have two tables. One table maps keyword ids to operators.
+    The other table maps other token types to operators. Tables are indexed
+    directly by token type or keyword id and filled based on the information
+    given by UNARY/BINARY_OP() macros that declare operators.
   */
 
-  typedef std::map<Token::Type, Type>   tok_map_t;
-  typedef std::map<Keyword::Type, Type> kw_map_t;
+#define op_count(A,B)  + 1
+
+  static const size_t tok_count = 0 TOKEN_LIST(op_count);
+  static const size_t kw_count = 1 KEYWORD_LIST(op_count);
 
-  static tok_map_t  unary_tok_map;
-  static kw_map_t   unary_kw_map;
+  static Type unary_tok_map[tok_count];
+  static Type unary_kw_map[kw_count];
 
-  static tok_map_t  binary_tok_map;
-  static kw_map_t   binary_kw_map;
+  static Type binary_tok_map[tok_count];
+  static Type binary_kw_map[kw_count];
 
   Op()
   {
@@ -435,31 +439,23 @@ Op::Type Op::get_unary(const Token &tok)
 {
   // First check the token map.
 
-  auto find = unary_tok_map.find(tok.get_type());
-  if (find != unary_tok_map.end())
-    return find->second;
+  Type op = unary_tok_map[tok.get_type()];
+  if (NONE != op)
+    return op;
 
-  // If operator not found, try keyword map.
+  // If operator not found, try keyword map (note: it maps NONE to NONE).
 
-  Keyword::Type kw = Keyword::get(tok);
-  if (Keyword::NONE == kw)
-    return NONE;
-  auto find1 = unary_kw_map.find(kw);
-  return find1 == unary_kw_map.end() ? NONE : find1->second;
+  return unary_kw_map[Keyword::get(tok)];
 }
 
 
 inline
 Op::Type Op::get_binary(const Token &tok)
 {
-  auto find = binary_tok_map.find(tok.get_type());
-  if (find != binary_tok_map.end())
-    return find->second;
-  Keyword::Type kw = Keyword::get(tok);
-  if (Keyword::NONE == kw)
-    return NONE;
-  auto find1 = binary_kw_map.find(kw);
-  return find1 == binary_kw_map.end() ? NONE : find1->second;
+  Type op = binary_tok_map[tok.get_type()];
+  if (NONE != op)
+    return op;
+  return binary_kw_map[Keyword::get(tok)];
 }
 
 
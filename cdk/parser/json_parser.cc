@@ -30,9 +30,19 @@
 
 #include "json_parser.h"
 #include <mysql/cdk.h>
+#include <mysql/cdk/foundation/utf8.h>
 
 PUSH_SYS_WARNINGS
-#include <stdlib.h>
+#include <string.h>   // for memcmp
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 POP_SYS_WARNINGS
 
 
@@ -46,9 +56,12 @@ POP_SYS_WARNINGS
 
 using namespace parser;
 using cdk::string;
+using cdk::byte;
 using cdk::JSON;
 typedef  cdk::JSON::Processor Processor;
 
+namespace utf8 = cdk::foundation::utf8;
+
 
 void json_parse(const string &json, Processor &dp)
 {
@@ -57,136 +70,730 @@ void json_parse(const string &json, Processor &dp)
 }
 
 
+/*
+  Scanning string contents
+  ========================
+*/
+
+static inline
+unsigned lowest_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+  unsigned long pos;
+  _BitScanForward(&pos, mask);
+  return (unsigned)pos;
+#else
+  return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
 
-//  Clasify a token as a JSON token.
+/*
+  Return position of the first quote character `q` or backslash within
+  [p, end), or end if there is none.
+*/
 
-JSON_token_base::Token_type JSON_token_base::get_jtype(const Token &tok)
+static inline
+const byte* find_quote(const byte *p, const byte *end, byte q)
 {
-  switch (tok.get_type())
+#ifdef JSON_SSE2
+
+  const __m128i quote = _mm_set1_epi8((char)q);
+  const __m128i bslash = _mm_set1_epi8('\\');
+
+  for (; end - p >= 16; p += 16)
   {
-  case Token::PLUS:
-    return JSON_token_base::PLUS;
-  case Token::MINUS:
-    return JSON_token_base::MINUS;
-  case Token::NUMBER:
-    return JSON_token_base::NUMBER;
-  case Token::INTEGER:
-    return JSON_token_base::INTEGER;
+    __m128i in = _mm_loadu_si128((const __m128i*)p);
+    int mask = _mm_movemask_epi8(
+      _mm_or_si128(_mm_cmpeq_epi8(in, quote), _mm_cmpeq_epi8(in, bslash))
+    );
+    if (0 != mask)
+      return p + lowest_bit((unsigned)mask);
+  }
 
-  // TODO: According to JSON specs only double-quote strings are allowed?
-  case Token::QQSTRING:
-  case Token::QSTRING:
-    return JSON_token_base::STRING;
+#endif
 
-  case Token::WORD:
-    {
-      // TODO: Are these JSON literals case sensitivie?
-      const string &id = tok.get_text();
-      if (id == L"null") return JSON_token_base::T_NULL;
-      if (id == L"true") return JSON_token_base::T_TRUE;
-      if (id == L"false") return JSON_token_base::T_FALSE;
+  for (; p < end; ++p)
+    if (q == *p || '\\' == *p)
+      return p;
+
+  return end;
+}
+
+
+static inline
+bool is_digit(byte c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/*
+  Characters which can appear in a plain word, such as unquoted key name
+  or a literal like `null`. All non-ASCII characters are accepted here.
+*/
+
+static inline
+bool is_word_char(byte c)
+{
+  return is_digit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+         || '_' == c || '$' == c || c >= 0x80;
+}
+
+
+/*
+  JSON_reader
+  ===========
+
+  Recursive descent parser which reads JSON text from a range of UTF8 bytes
+  and reports it to processors. If processor for a given value is NULL, the
+  value is parsed (to find where it ends) but not reported.
+*/
+
+class JSON_reader
+{
+  typedef Processor::Any_prc   Any_prc;
+  typedef Any_prc::Scalar_prc  Scalar_prc;
+  typedef Any_prc::List_prc    List_prc;
+
+  const byte *m_beg;
+  const byte *m_cur;
+  const byte *m_end;
+
+  std::string m_esc;  // string contents after replacing escape sequences
+  string      m_str;  // string value passed to the processor
+
+public:
+
+  JSON_reader(const char *beg, const char *end)
+    : m_beg((const byte*)beg), m_cur((const byte*)beg), m_end((const byte*)end)
+  {}
+
+  void parse_doc(Processor *prc);
+  void parse_any(Any_prc *prc);
+  void index_doc(JSON_parser::Index_prc &prc);
+
+  // Check that only white-space remains after parsed value.
+
+  void finish()
+  {
+    skip_ws();
+    if (m_cur < m_end)
+      error(L"Unexpected characters after parsing JSON string");
+  }
+
+  void expect(byte c, const wchar_t *msg)
+  {
+    skip_ws();
+    if (m_cur >= m_end || c != *m_cur)
+      error(msg);
+  }
+
+private:
+
+  void parse_arr(List_prc *prc);
+  void parse_scalar(Scalar_prc *prc);
+  void parse_key(string &key);
+  void parse_string(string *out);
+  void scan_key(const byte *&beg, const byte *&end);
+  void scan_string(const byte *&beg, const byte *&end);
+  void parse_escape();
+  void parse_number(Scalar_prc *prc);
+  uint32_t parse_hex4();
+  bool literal(const char *word, size_t len);
+  void decode(const byte *beg, const byte *end, string &out);
+
+  void skip_ws()
+  {
+    while (m_cur < m_end
+           && (' ' == *m_cur || '\n' == *m_cur
+               || '\r' == *m_cur || '\t' == *m_cur))
+      ++m_cur;
+  }
+
+  bool consume(byte c)
+  {
+    if (m_cur >= m_end || c != *m_cur)
+      return false;
+    ++m_cur;
+    return true;
+  }
+
+  void error(const wchar_t *msg) const
+  {
+    throw JSON_parser::Error(
+      std::string((const char*)m_beg, (const char*)m_end),
+      (size_t)(m_cur - m_beg), msg
+    );
+  }
+};
+
+
+void JSON_reader::parse_any(Any_prc *prc)
+{
+  skip_ws();
+
+  if (m_cur >= m_end)
+    error(L"Expected JSON value");
+
+  switch (*m_cur)
+  {
+  case '{': parse_doc(prc ? prc->doc() : NULL); return;
+  case '[': parse_arr(prc ? prc->arr() : NULL); return;
+  default:  parse_scalar(prc ? prc->scalar() : NULL); return;
+  }
+}
+
+
+void JSON_reader::parse_doc(Processor *prc)
+{
+  assert('{' == *m_cur);
+  ++m_cur;
+
+  if (prc)
+    prc->doc_begin();
+
+  skip_ws();
+
+  if (!consume('}'))
+  {
+    /*
+      Note: key is stored here, not in a member, so that it stays valid
+      while the key value is parsed.
+    */
+
+    string key;
+
+    do {
+      skip_ws();
+      parse_key(key);
+      skip_ws();
+      if (!consume(':'))
+        error(L"Expected ':' after key name in a document");
+      parse_any(prc ? prc->key_val(key) : NULL);
+      skip_ws();
     }
+    while (consume(','));
 
-  default:
-    return JSON_token_base::OTHER;
+    if (!consume('}'))
+      error(L"Expected '}' closing a document");
   }
+
+  if (prc)
+    prc->doc_end();
 }
 
 
+/*
+  Like parse_doc(), but instead of reporting key values to a processor,
+  only skip them and report their positions.
+*/
 
-bool JSON_scalar_parser::do_parse(Processor *vp)
+void JSON_reader::index_doc(JSON_parser::Index_prc &prc)
 {
-  if (!tokens_available())
+  assert('{' == *m_cur);
+  ++m_cur;
+
+  skip_ws();
+
+  if (consume('}'))
+    return;
+
+  std::string key;
+
+  do {
+    skip_ws();
+    const byte *key_beg;
+    const byte *key_end;
+    scan_key(key_beg, key_end);
+    if (!utf8::valid(key_beg, key_end))
+      error(L"Invalid UTF8 string");
+    key.assign((const char*)key_beg, (const char*)key_end);
+    skip_ws();
+    if (!consume(':'))
+      error(L"Expected ':' after key name in a document");
+    skip_ws();
+    const byte *start = m_cur;
+    parse_any(NULL);
+    prc.field(key, (size_t)(start - m_beg), (size_t)(m_cur - m_beg));
+    skip_ws();
+  }
+  while (consume(','));
+
+  if (!consume('}'))
+    error(L"Expected '}' closing a document");
+}
+
+
+void JSON_reader::parse_arr(List_prc *prc)
+{
+  assert('[' == *m_cur);
+  ++m_cur;
+
+  if (prc)
+    prc->list_begin();
+
+  skip_ws();
+
+  if (!consume(']'))
+  {
+    do {
+      parse_any(prc ? prc->list_el() : NULL);
+      skip_ws();
+    }
+    while (consume(','));
+
+    if (!consume(']'))
+      error(L"Expected ']' closing an array");
+  }
+
+  if (prc)
+    prc->list_end();
+}
+
+
+void JSON_reader::parse_key(string &key)
+{
+  const byte *beg;
+  const byte *end;
+  scan_key(beg, end);
+  decode(beg, end, key);
+}
+
+
+/*
+  Scan key name at the current position and set [beg, end) to UTF8 bytes
+  of the name (which are not yet validated).
+*/
+
+void JSON_reader::scan_key(const byte *&beg, const byte *&end)
+{
+  if (m_cur < m_end && ('"' == *m_cur || '\'' == *m_cur))
+  {
+    scan_string(beg, end);
+    return;
+  }
+
+  // Note: official JSON specs do not allow plain word as key name
+
+  const byte *start = m_cur;
+
+  while (m_cur < m_end && is_word_char(*m_cur))
+    ++m_cur;
+
+  if (start == m_cur)
+    error(L"Expected a key-value pair in a document");
+
+  beg = start;
+  end = m_cur;
+}
+
+
+void JSON_reader::parse_scalar(Scalar_prc *prc)
+{
+  switch (*m_cur)
+  {
+  case '"':
+  case '\'':
+    parse_string(prc ? &m_str : NULL);
+    if (prc)
+      prc->str(m_str);
+    return;
+
+  case 'n':
+    if (!literal("null", 4))
+      break;
+    if (prc)
+      prc->null();
+    return;
+
+  case 't':
+    if (!literal("true", 4))
+      break;
+    if (prc)
+      prc->yesno(true);
+    return;
+
+  case 'f':
+    if (!literal("false", 5))
+      break;
+    if (prc)
+      prc->yesno(false);
+    return;
+
+  default:
+    parse_number(prc);
+    return;
+  }
+
+  error(L"Invalid JSON value");
+}
+
+
+bool JSON_reader::literal(const char *word, size_t len)
+{
+  if ((size_t)(m_end - m_cur) < len || 0 != memcmp(m_cur, word, len))
     return false;
+  if (m_cur + len < m_end && is_word_char(m_cur[len]))
+    return false;
+  m_cur += len;
+  return true;
+}
 
-  bool neg = false;
 
-  Token tok = *consume_token();
-  Token_type tt = get_jtype(tok);
+void JSON_reader::parse_string(string *out)
+{
+  const byte *beg;
+  const byte *end;
+  scan_string(beg, end);
+  if (out)
+    decode(beg, end, *out);
+}
 
-  switch (tt)
+
+/*
+  Scan quoted string and set [beg, end) to UTF8 bytes of its contents.
+  Common case of a string without escape sequences is left in the input
+  buffer. Otherwise contents of the string, with escape sequences replaced
+  by the characters they represent, is assembled in m_esc buffer.
+*/
+
+void JSON_reader::scan_string(const byte *&beg, const byte *&end)
+{
+  const byte *qpos = m_cur;
+  const byte q = *m_cur++;
+  const byte *start = m_cur;
+  const byte *pos = find_quote(start, m_end, q);
+
+  if (pos < m_end && q == *pos)
   {
-  case STRING:
-    if(vp)
-      vp->str(tok.get_text());
-    return true;
+    m_cur = pos + 1;
+    beg = start;
+    end = pos;
+    return;
+  }
 
-  case MINUS:
-  case PLUS:
-    neg = (MINUS == tt);
-    if (!tokens_available())
-      parse_error(L"Expected number after +/- sign");
-    tok = *consume_token();
-    tt = get_jtype(tok);
-    break;
-
-  case T_NULL:
-    if (vp)
-      vp->null();
-    return true;
+  m_esc.clear();
 
-  case T_TRUE:
-  case T_FALSE:
-    if (vp)
-      vp->yesno(T_TRUE == tt);
-    return true;
+  for (;;)
+  {
+    if (pos >= m_end)
+    {
+      m_cur = qpos;
+      error(L"Unterminated quoted string");
+    }
+
+    m_esc.append((const char*)start, (size_t)(pos - start));
+    m_cur = pos + 1;
+
+    if (q == *pos)
+      break;
+
+    parse_escape();
 
+    start = m_cur;
+    pos = find_quote(start, m_end, q);
+  }
+
+  beg = (const byte*)m_esc.data();
+  end = beg + m_esc.size();
+}
+
+
+/*
+  Replace escape sequence which starts after a backslash at the current
+  position, appending UTF8 encoding of the character it represents to
+  m_esc. Characters which do not start a known escape sequence, such as
+  quotes or backslash, stand for themselves.
+*/
+
+void JSON_reader::parse_escape()
+{
+  if (m_cur >= m_end)
+    error(L"Unterminated quoted string");
+
+  byte c = *m_cur++;
+
+  switch (c)
+  {
+  case 'b': m_esc.push_back('\b'); return;
+  case 'f': m_esc.push_back('\f'); return;
+  case 'n': m_esc.push_back('\n'); return;
+  case 'r': m_esc.push_back('\r'); return;
+  case 't': m_esc.push_back('\t'); return;
+  case 'u': break;
   default:
-    // if none of the above, then it should be a number
-    break;
+    m_esc.push_back((char)c);
+    return;
+  }
+
+  uint32_t cp = parse_hex4();
+
+  if (cp >= 0xDC00 && cp < 0xE000)
+    error(L"Invalid \\u escape sequence");
+
+  if (cp >= 0xD800 && cp < 0xDC00)
+  {
+    // High surrogate must be followed by escaped low surrogate.
+
+    if (m_end - m_cur < 2 || '\\' != m_cur[0] || 'u' != m_cur[1])
+      error(L"Invalid \\u escape sequence");
+    m_cur += 2;
+
+    uint32_t low = parse_hex4();
+    if (low < 0xDC00 || low >= 0xE000)
+      error(L"Invalid \\u escape sequence");
+
+    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+  }
+
+  if (cp < 0x80)
+    m_esc.push_back((char)cp);
+  else if (cp < 0x800)
+  {
+    m_esc.push_back((char)(0xC0 | (cp >> 6)));
+    m_esc.push_back((char)(0x80 | (cp & 0x3F)));
+  }
+  else if (cp < 0x10000)
+  {
+    m_esc.push_back((char)(0xE0 | (cp >> 12)));
+    m_esc.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    m_esc.push_back((char)(0x80 | (cp & 0x3F)));
+  }
+  else
+  {
+    m_esc.push_back((char)(0xF0 | (cp >> 18)));
+    m_esc.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+    m_esc.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    m_esc.push_back((char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+
+uint32_t JSON_reader::parse_hex4()
+{
+  if (m_end - m_cur < 4)
+    error(L"Invalid \\u escape sequence");
+
+  uint32_t val = 0;
+
+  for (unsigned i = 0; i < 4; ++i, ++m_cur)
+  {
+    byte c = *m_cur;
+    val <<= 4;
+
+    if (is_digit(c))
+      val |= (uint32_t)(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      val |= (uint32_t)(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      val |= (uint32_t)(c - 'A' + 10);
+    else
+      error(L"Invalid \\u escape sequence");
+  }
+
+  return val;
+}
+
+
+void JSON_reader::decode(const byte *beg, const byte *end, string &out)
+{
+  if (!utf8::valid(beg, end))
+    error(L"Invalid UTF8 string");
+
+  out.resize((size_t)(end - beg));
+  size_t len = (beg == end) ? 0 : utf8::decode(beg, end, &out[0]);
+  out.resize(len);
+}
+
+
+/*
+  Parse a number. Integers are reported as signed values, unless they do
+  not fit into int64_t.
+
+  Floating point numbers with at most 19 significant digits and small
+  decimal exponent are converted exactly using integer mantissa and
+  a single multiplication or division by a power of 10 (both operands
+  are exactly representable as doubles then). Other numbers are converted
+  with the generic, locale independent strtod().
+*/
+
+void JSON_reader::parse_number(Scalar_prc *prc)
+{
+  static const double pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  const byte *start = m_cur;
+  bool neg = false;
+
+  if ('-' == *m_cur || '+' == *m_cur)
+  {
+    neg = ('-' == *m_cur);
+    ++m_cur;
   }
 
-  // Numeric value
+  const byte *num_start = m_cur;
+  uint64_t ival = 0;
+  uint64_t mant = 0;
+  unsigned sig_digits = 0;
+  int exp10 = 0;
+  bool exact = true;
+  bool is_int = true;
+  bool overflow = false;
+  size_t digits = 0;
+
+  for (; m_cur < m_end && is_digit(*m_cur); ++m_cur, ++digits)
+  {
+    unsigned d = *m_cur - '0';
+
+    if (ival > (UINT64_MAX - d) / 10)
+      overflow = true;
+    ival = 10 * ival + d;
+
+    if (sig_digits < 19)
+    {
+      mant = 10 * mant + d;
+      if (mant > 0)
+        sig_digits++;
+    }
+    else
+    {
+      exact = exact && 0 == d;
+      exp10++;
+    }
+  }
 
-  switch (tt)
+  if (m_cur + 1 < m_end && '.' == *m_cur && is_digit(m_cur[1]))
   {
-  case NUMBER:
+    is_int = false;
+
+    for (++m_cur; m_cur < m_end && is_digit(*m_cur); ++m_cur, ++digits)
     {
-      if(vp)
+      unsigned d = *m_cur - '0';
+
+      if (sig_digits < 19)
       {
-        double val = strtod(tok.get_text());
-        vp->num(neg ? -val : val);
+        mant = 10 * mant + d;
+        if (mant > 0)
+          sig_digits++;
+        exp10--;
       }
-      return true;
+      else
+        exact = exact && 0 == d;
     }
+  }
 
-  case INTEGER:
-    try {
+  if (0 == digits)
+  {
+    m_cur = start;
+    error(neg || start != num_start
+          ? L"Expected number after +/- sign" : L"Invalid JSON value");
+  }
 
-      if(vp)
-      {
-        // TODO: Is this logic right? Should we report only negative values
-        // as signed integers?
-
-        uint64_t val = strtoui(tok.get_text());
-        if (val > INTEGER_ABS_MAX)
-        {
-          if (neg)
-            parse_error(L"Numeric value is too large for a signed type");
-          // Unsigned type is only returned for large values
-          vp->num(val);
-        }
-        else
-        {
-          // Absolute values of 9223372036854775808UL can only be negative
-          if (!neg && val == INTEGER_ABS_MAX)
-            parse_error(L"Numeric value is too large for a signed type");
-          // All values ABS(val) < 9223372036854775808UL are treated as signed
-          vp->num(neg ? -(int64_t)val : (int64_t)val);
-        }
-      }
+  if (m_cur < m_end && ('e' == *m_cur || 'E' == *m_cur))
+  {
+    is_int = false;
+    ++m_cur;
+
+    bool exp_neg = false;
+    if (m_cur < m_end && ('-' == *m_cur || '+' == *m_cur))
+      exp_neg = ('-' == *m_cur++);
+
+    if (m_cur >= m_end || !is_digit(*m_cur))
+      error(L"Invalid exponent in a number");
+
+    int exp = 0;
+    for (; m_cur < m_end && is_digit(*m_cur); ++m_cur)
+      if (exp < 100000)
+        exp = 10 * exp + (*m_cur - '0');
+
+    exp10 += exp_neg ? -exp : exp;
+  }
+
+  if (m_cur < m_end && (is_word_char(*m_cur) || '.' == *m_cur))
+    error(L"Invalid JSON value");
+
+  if (!prc)
+    return;
 
-      return true;
+  if (!is_int)
+  {
+    double val;
+
+    if (exact && mant <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22)
+    {
+      val = (double)mant;
+      val = exp10 < 0 ? val / pow10[-exp10] : val * pow10[exp10];
     }
-    catch (const Numeric_conversion_error &e)
+    else
     {
-      parse_error(e.msg());
+      try {
+        val = strtod(std::string((const char*)num_start, (const char*)m_cur));
+      }
+      catch (const Numeric_conversion_error &e)
+      {
+        error(e.msg().c_str());
+      }
     }
 
-  default:
-    parse_error(L"Invalid JSON value");
-    return false; // quiet compile warnings
+    prc->num(neg ? -val : val);
+    return;
   }
+
+  if (overflow)
+    error(L"Numeric value is too large");
+
+  uint64_t val = ival;
+
+  if (val > INTEGER_ABS_MAX)
+  {
+    if (neg)
+      error(L"Numeric value is too large for a signed type");
+    // Unsigned type is only returned for large values
+    prc->num(val);
+  }
+  else
+  {
+    // Absolute values of 9223372036854775808UL can only be negative
+    if (!neg && val == INTEGER_ABS_MAX)
+      error(L"Numeric value is too large for a signed type");
+    // All values ABS(val) < 9223372036854775808UL are treated as signed
+    prc->num(neg ? -(int64_t)val : (int64_t)val);
+  }
+}
+
+
+/*
+  JSON_parser
+  ===========
+*/
+
+void JSON_parser::parse(const char *beg, const char *end, Processor &prc)
+{
+  JSON_reader reader(beg, end);
+
+  reader.expect('{', L"Expected JSON document");
+  reader.parse_doc(&prc);
+  reader.finish();
 }
 
 
+void JSON_parser::parse_any(const char *beg, const char *end,
+                            Processor::Any_prc &prc)
+{
+  JSON_reader reader(beg, end);
+
+  reader.parse_any(&prc);
+  reader.finish();
+}
+
+
+void JSON_parser::index(const char *beg, const char *end, Index_prc &prc)
+{
+  JSON_reader reader(beg, end);
+
+  reader.expect('{', L"Expected JSON document");
+  reader.index_doc(prc);
+  reader.finish();
+}
@@ -37,93 +37,102 @@
 namespace parser {
 
 using cdk::JSON;
-class JSON_parser;
+
 
 /*
-  Specialization of Token_base, which can clasify base tokens as JSON tokens.
+  JSON_parser presents JSON document given as a string as cdk::JSON
+  document expression.
+
+  The parser works in a single pass directly on UTF8 bytes of the document,
+  reporting its elements to the processor as they are parsed. Only string
+  values and keys are converted to the internal wide string representation.
+  Scanning of string contents for the closing quote or escape characters
+  is done 16 bytes at a time where SSE2 instructions are available.
+
+  Apart from the standard JSON syntax, the parser accepts strings and keys
+  in single quotes, keys given as plain words without quotes and numbers
+  with explicit '+' sign or without digits before the decimal point.
 */
 
-class JSON_token_base
-  : public Token_base
+class JSON_parser
+  : public JSON
 {
-protected:
-
-  using Token_base::Error;
+  std::string m_json;  // note: UTF8 encoded
 
 public:
 
-  enum Token_type {
-    OTHER,
-    STRING, NUMBER, INTEGER,
-    PLUS, MINUS, T_NULL, T_TRUE, T_FALSE,
-  };
+  class Error;
 
-  static Token_type get_jtype(const Token&);
+  JSON_parser(const std::string &json)
+    : m_json(json)
+  {}
 
-  friend JSON_parser;
-};
+  JSON_parser(const char *json)
+    : m_json(json)
+  {}
 
+  JSON_parser(const cdk::string &json)
+    : m_json(json)
+  {}
 
+  void process(Processor &prc) const
+  {
+    parse(m_json.data(), m_json.data() + m_json.size(), prc);
+  }
 
-/*
-  JSON_parser is build using generic Doc_parser<> template and base
-  JSON_sclar_parser which parses scalar values (numbers, strings, Booleans).
-  Parsing of arrays and sub-documents is handled by Doc_parser<> logic.
-*/
+  /*
+    Parse JSON document stored as UTF8 bytes in [beg, end) and report it
+    to the given processor. The whole input must be consumed by
+    the document, except for trailing white-space.
+  */
 
+  static void parse(const char *beg, const char *end, Processor &prc);
 
-class JSON_scalar_parser
-  : public Expr_parser<cdk::JSON_processor, JSON_token_base>
-{
-public:
+  /*
+    Like parse(), but accepts any JSON value (document, array or scalar)
+    and reports it to the given "any" processor.
+  */
 
-  JSON_scalar_parser(It &first, const It &last)
-    : Expr_parser<cdk::JSON_processor, JSON_token_base>(first, last)
-  {}
+  static void parse_any(const char *beg, const char *end,
+                        Processor::Any_prc &prc);
 
-  static Processor *get_base_prc(JSON::Processor::Any_prc *prc)
-  { return prc->scalar(); }
+  class Index_prc;
 
-private:
+  /*
+    Scan JSON document stored as UTF8 bytes in [beg, end) and report its
+    top-level fields to the given index processor together with positions
+    of their values. Field values are checked for correct syntax but are
+    not decoded.
+  */
 
-  bool do_parse(Processor*);
+  static void index(const char *beg, const char *end, Index_prc &prc);
 };
 
 
+/*
+  Processor of document structure reported by JSON_parser::index(). Positions
+  are byte offsets counted from the beginning of the input.
+*/
 
-class JSON_parser
-  : public JSON
+class JSON_parser::Index_prc
 {
-  Tokenizer m_toks;
-
 public:
 
-  JSON_parser(const cdk::string &json)
-    : m_toks(json)
-  {}
+  // Note: key name is given as UTF8 string.
+
+  virtual void field(const std::string &key, size_t beg, size_t end) = 0;
+};
 
-  void process(Processor &prc) const
-  {
-    It first = m_toks.begin();
-    It last  = m_toks.end();
-
-    if (m_toks.empty())
-      throw JSON_token_base::Error(first, L"Expectiong JSON document string");
-
-    /*
-      Note: passing m_toks.end() directly as constructor argument results
-      in "incompatible iterators" exception when comparing iterators (at
-      least on win, VS2010). Problem with passing temporary object?
-    */
-
-    Doc_parser<JSON_scalar_parser> parser(first, last);
-    if (!parser.parse(prc) || first != last)
-      throw JSON_token_base::Error(
-              first,
-              L"Unexpected characters after parsing JSON string"
-            );
-  }
 
+class JSON_parser::Error
+  : public parser::Error_base<std::string>
+{
+public:
+
+  Error(const std::string &json, size_t pos,
+        const cdk::string &descr = cdk::string())
+    : Error_base<std::string>(json, pos, descr)
+  {}
 };
 
 }  // parser
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmark of expression parsing
+  ===============================
+
+  Measures speed of the expression tokenizer alone, given either a wide
+  or a UTF8 string, and of the complete expression parser, which reports
+  parsed expressions to a Stored_any processor (as the cache of parsed
+  expressions does).
+
+  Expressions are taken from the built-in list below, imitating typical
+  selection criteria, sort keys and projections used by applications,
+  and from expr_test files given on the command line (lines of the form
+  "col: <expr>", "tab: <expr>" or "all: <expr>", as in extra/exprtest/t/).
+  Expressions which can not be parsed are not included in the measurements.
+
+  Usage: expr_bench [<iterations> [<test file> ...]]
+*/
+
+#include "../expr_parser.h"
+
+PUSH_SYS_WARNINGS
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+POP_SYS_WARNINGS
+
+using namespace parser;
+using std::cout;
+using std::endl;
+
+
+struct Bench_expr
+{
+  Parser_mode::value m_mode;
+  std::string        m_utf8;
+  cdk::string        m_str;
+
+  Bench_expr(Parser_mode::value mode, const std::string &expr)
+    : m_mode(mode), m_utf8(expr), m_str(expr)
+  {}
+};
+
+typedef std::vector<Bench_expr> Bench_list;
+
+
+/*
+  Built-in expressions, in the same format as lines of expr_test files.
+*/
+
+const char *builtin_exprs[] =
+{
+  "all: name = :name",
+  "all: age > 18 AND age < 65",
+  "col: $.address.city IN ('Warszawa', 'Kraków', 'Gdańsk')",
+  "all: name LIKE 'Jo%' OR email LIKE '%@example.com'",
+  "all: NOT (score BETWEEN 10 AND 20) && active = true",
+  "all: CAST(age AS SIGNED INTEGER) + 1 >= :min_age",
+  "col: $.orders[2].total * 1.23 > 100.0e-1",
+  "tab: doc->'$.tags[1]' = 'new' AND doc->>'$.owner' IS NOT NULL",
+  "col: {'name': name, 'total': sum($.orders[1].total), 'paid': [true, false]}",
+  "all: x'ff' | 0x10 << 2 ^ ~mask",
+  "tab: `quoted column` = \"double \\\"quoted\\\" string\"",
+  "col: $**.id IN [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]",
+  "all: lower(trim(name)) REGEXP '^[a-z]+$'",
+  NULL
+};
+
+
+void add_expr(Bench_list &list, const std::string &line)
+{
+  if (line.empty() || '#' == line[0])
+    return;
+
+  size_t pos = line.find(':');
+  if (std::string::npos == pos)
+    return;
+
+  std::string tag = line.substr(0, pos);
+  std::string expr = line.substr(pos + 1);
+
+  if ("col" == tag || "all" == tag)
+    list.emplace_back(Parser_mode::DOCUMENT, expr);
+  if ("tab" == tag || "all" == tag)
+    list.emplace_back(Parser_mode::TABLE, expr);
+}
+
+
+void load_exprs(Bench_list &list, const char *file)
+{
+  std::ifstream inp(file);
+
+  if (!inp)
+  {
+    cout << "Could not open test file: " << file << endl;
+    return;
+  }
+
+  std::string line;
+
+  while (std::getline(inp, line))
+    add_expr(list, line);
+}
+
+
+/*
+  Remove expressions which can not be parsed, so that only the successful
+  parsing path is measured.
+*/
+
+size_t check_exprs(Bench_list &list)
+{
+  Bench_list good;
+
+  for (const Bench_expr &expr : list)
+  try {
+    Stored_any store;
+    Expression_parser parser(expr.m_mode, expr.m_str);
+    parser.process(store);
+    good.push_back(expr);
+  }
+  catch (const cdk::Error&)
+  {}
+
+  size_t bad = list.size() - good.size();
+  list.swap(good);
+  return bad;
+}
+
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+double since(bench_clock::time_point start)
+{
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+
+void run(const Bench_list &list, unsigned iterations)
+{
+  size_t size = 0;
+  size_t sum = 0;
+
+  for (const Bench_expr &expr : list)
+    size += expr.m_utf8.size();
+
+  bench_clock::time_point start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (const Bench_expr &expr : list)
+    {
+      Tokenizer toks(expr.m_str);
+      for (It it = toks.begin(); it != toks.end(); ++it)
+        sum += it->get_text().length();
+    }
+  double t_wide = since(start);
+
+  start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (const Bench_expr &expr : list)
+    {
+      Tokenizer toks(expr.m_utf8);
+      for (It it = toks.begin(); it != toks.end(); ++it)
+        sum += it->get_text().length();
+    }
+  double t_utf8 = since(start);
+
+  start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (const Bench_expr &expr : list)
+    {
+      Stored_any store;
+      Expression_parser parser(expr.m_mode, expr.m_str);
+      parser.process(store);
+    }
+  double t_parse = since(start);
+
+  double mb = double(size) * iterations / 1e6;
+  double kexprs = double(list.size()) * iterations / 1e3;
+
+  cout << list.size() << " expressions (avg " << size / list.size()
+       << " bytes)" << endl;
+  cout << "  tokenizer (wide): " << mb / t_wide << " MB/s, "
+       << kexprs / t_wide << " K exprs/s" << endl;
+  cout << "  tokenizer (UTF8): " << mb / t_utf8 << " MB/s, "
+       << kexprs / t_utf8 << " K exprs/s" << endl;
+  cout << "  parser:           " << mb / t_parse << " MB/s, "
+       << kexprs / t_parse << " K exprs/s" << endl;
+
+  if (0 == sum)
+    cout << "  (no tokens)" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned iterations = argc > 1 ? (unsigned)atoi(argv[1]) : 2000;
+  Bench_list list;
+
+  for (const char **expr = builtin_exprs; *expr; ++expr)
+    add_expr(list, *expr);
+
+  for (int i = 2; i < argc; ++i)
+    load_exprs(list, argv[i]);
+
+  size_t bad = check_exprs(list);
+
+  if (bad)
+    cout << "Skipping " << bad << " expressions which do not parse" << endl;
+
+  if (list.empty())
+    return 1;
+
+  run(list, iterations);
+
+  return 0;
+}
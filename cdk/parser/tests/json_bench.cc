@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmark of JSON parsing
+  =========================
+
+  Compares the previous JSON parser, which converted the whole document to
+  a wide string, split it into tokens with the generic expression tokenizer
+  and parsed the token sequence with Doc_parser<>, with the current
+  single-pass JSON_parser working on UTF8 bytes. The processor used
+  imitates building of DbDoc: it copies all keys and string values. Data
+  sets imitate typical document result sets: small flat documents, nested
+  documents with arrays and documents with long text fields.
+
+  Usage: json_bench [<iterations>]
+*/
+
+#include "../json_parser.h"
+
+PUSH_SYS_WARNINGS
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+POP_SYS_WARNINGS
+
+using namespace parser;
+using std::cout;
+using std::endl;
+
+
+/*
+  Previous implementation of JSON scalar values parser, used with
+  Doc_parser<> template.
+*/
+
+class Old_scalar_parser
+  : public Expr_parser<cdk::JSON_processor>
+{
+public:
+
+  Old_scalar_parser(It &first, const It &last)
+    : Expr_parser<cdk::JSON_processor>(first, last)
+  {}
+
+  static Processor *get_base_prc(JSON::Processor::Any_prc *prc)
+  { return prc->scalar(); }
+
+private:
+
+  bool do_parse(Processor *vp)
+  {
+    if (!tokens_available())
+      return false;
+
+    bool neg = false;
+    Token tok = *consume_token();
+
+    switch (tok.get_type())
+    {
+    case Token::QQSTRING:
+    case Token::QSTRING:
+      if (vp)
+        vp->str(tok.get_text());
+      return true;
+
+    case Token::WORD:
+      if (tok.get_text() == L"null")
+      {
+        if (vp)
+          vp->null();
+        return true;
+      }
+      if (tok.get_text() == L"true" || tok.get_text() == L"false")
+      {
+        if (vp)
+          vp->yesno(tok.get_text() == L"true");
+        return true;
+      }
+      return false;
+
+    case Token::MINUS:
+      neg = true;
+      tok = *consume_token();
+      break;
+
+    default:
+      break;
+    }
+
+    switch (tok.get_type())
+    {
+    case Token::NUMBER:
+      if (vp)
+      {
+        double val = strtod(tok.get_text());
+        vp->num(neg ? -val : val);
+      }
+      return true;
+
+    case Token::INTEGER:
+      if (vp)
+      {
+        uint64_t val = strtoui(tok.get_text());
+        vp->num(neg ? -(int64_t)val : (int64_t)val);
+      }
+      return true;
+
+    default:
+      return false;
+    }
+  }
+};
+
+
+void old_parse(const std::string &json, JSON::Processor &prc)
+{
+  cdk::string str(json);
+  Tokenizer toks(str);
+  It first = toks.begin();
+  It last = toks.end();
+  Doc_parser<Old_scalar_parser> parser(first, last);
+  parser.process(prc);
+}
+
+
+/*
+  Processor which stores copies of keys and string values, as DbDoc builder
+  does, and computes a checksum of reported values so that results of both
+  parsers can be compared.
+*/
+
+struct Builder
+  : public JSON::Processor
+  , public JSON::Processor::Any_prc
+  , public JSON::Processor::Any_prc::List_prc
+  , public cdk::JSON_processor
+{
+  cdk::string m_key;
+  cdk::string m_str;
+  uint64_t m_sum = 0;
+
+  void add(uint64_t val)
+  {
+    m_sum = m_sum * 31 + val;
+  }
+
+  // Doc_prc
+
+  void doc_begin() override { add(1); }
+  void doc_end() override { add(2); }
+
+  Any_prc* key_val(const cdk::string &key) override
+  {
+    m_key = key;
+    add(m_key.length());
+    return this;
+  }
+
+  // Any_prc
+
+  Scalar_prc* scalar() override { return this; }
+  List_prc* arr() override { return this; }
+  Doc_prc* doc() override { return this; }
+
+  // List_prc
+
+  void list_begin() override { add(3); }
+  void list_end() override { add(4); }
+  Any_prc* list_el() override { return this; }
+
+  // Scalar_prc
+
+  void null() override { add(5); }
+
+  void str(const cdk::string &val) override
+  {
+    m_str = val;
+    for (wchar_t c : m_str)
+      add((uint64_t)c);
+  }
+
+  void num(uint64_t val) override { add(val); }
+  void num(int64_t val) override { add((uint64_t)val); }
+  void num(float val) override { add((uint64_t)(int64_t)val); }
+  void num(double val) override { add((uint64_t)(int64_t)(val * 1000)); }
+  void yesno(bool val) override { add(val ? 6 : 7); }
+};
+
+
+/*
+  Generate documents of given kind, formatted as the server formats JSON
+  values.
+*/
+
+std::vector<std::string> make_docs(const char *kind, size_t count)
+{
+  static const char *names[] = {
+    "Anna", "Bartosz", "Céline", "Dmitrij", "Ewa", "François", "Grzegorz",
+    "Håkon"
+  };
+  static const char *words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+    "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore"
+  };
+
+  std::vector<std::string> docs;
+  unsigned seed = 1;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    std::ostringstream doc;
+    seed = seed * 1103515245 + 12345;
+    const char *name = names[(seed >> 16) % 8];
+
+    doc << "{\"_id\": \"00005b0d5a2a0000000000" << std::setfill('0')
+        << std::setw(6) << i << "\", \"age\": " << (seed >> 16) % 90
+        << ", \"name\": \"" << name << "\"";
+
+    if (0 == strcmp(kind, "flat"))
+    {
+      doc << ", \"email\": \"" << name << i << "@example.com\""
+          << ", \"active\": " << ((seed & 0x100) ? "true" : "false")
+          << ", \"score\": " << ((seed >> 8) % 10000) / 100.0
+          << ", \"manager\": null}";
+    }
+    else if (0 == strcmp(kind, "nested"))
+    {
+      doc << ", \"address\": {\"city\": \"Kraków\", \"zip\": \"30-"
+          << (seed >> 16) % 1000 << "\", \"geo\": [50.06, 19.94]}"
+          << ", \"tags\": [\"a\", \"b\", \"c\"]"
+          << ", \"orders\": [";
+      for (unsigned j = 0; j < 4; ++j)
+      {
+        seed = seed * 1103515245 + 12345;
+        doc << (j ? ", " : "") << "{\"id\": " << (seed >> 16)
+            << ", \"total\": " << ((seed >> 4) % 100000) / 100.0
+            << ", \"paid\": " << ((seed & 0x10) ? "true" : "false") << "}";
+      }
+      doc << "]}";
+    }
+    else
+    {
+      doc << ", \"text\": \"";
+      for (unsigned j = 0; j < 200; ++j)
+      {
+        seed = seed * 1103515245 + 12345;
+        doc << words[(seed >> 16) % 15]
+            << (0 == (seed & 0x1F0) ? ". \\\"Quote\\\" " : " ");
+      }
+      doc << "\"}";
+    }
+
+    docs.push_back(doc.str());
+  }
+
+  return docs;
+}
+
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+
+void run(const char *kind, unsigned iterations)
+{
+  const size_t count = 2000;
+  std::vector<std::string> docs = make_docs(kind, count);
+  size_t size = 0;
+  size_t mismatch = 0;
+
+  for (const std::string &doc : docs)
+  {
+    Builder old_bld, new_bld;
+    old_parse(doc, old_bld);
+    JSON_parser::parse(doc.data(), doc.data() + doc.size(), new_bld);
+    if (old_bld.m_sum != new_bld.m_sum)
+      ++mismatch;
+    size += doc.size();
+  }
+
+  Builder bld;
+
+  bench_clock::time_point start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (const std::string &doc : docs)
+      old_parse(doc, bld);
+  double t_old = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+  start = bench_clock::now();
+  for (unsigned i = 0; i < iterations; ++i)
+    for (const std::string &doc : docs)
+      JSON_parser::parse(doc.data(), doc.data() + doc.size(), bld);
+  double t_new = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+  double mb = double(size) * iterations / 1e6;
+  double kdocs = double(count) * iterations / 1e3;
+
+  cout << kind << " documents (avg " << size / count << " bytes)" << endl;
+  cout << "  tokenizer: " << mb / t_old << " MB/s, "
+       << kdocs / t_old << " K docs/s" << endl;
+  cout << "  UTF8 SAX:  " << mb / t_new << " MB/s, "
+       << kdocs / t_new << " K docs/s (x" << t_old / t_new << ")" << endl;
+
+  if (mismatch)
+    cout << "  " << mismatch << " documents parsed differently" << endl;
+
+  if (0 == bld.m_sum)
+    cout << "  (no data)" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned iterations = argc > 1 ? (unsigned)atoi(argv[1]) : 10;
+
+  run("flat", iterations);
+  run("nested", iterations);
+  run("text", iterations);
+
+  return 0;
+}
@@ -31,6 +31,7 @@
 #include <gtest/gtest.h>
 #include "../json_parser.h"
 #include "../expr_parser.h"
+#include "../expr_cache.h"
 #include "../uri_parser.h"
 
 #include <cstdarg>  // va_arg()
@@ -320,6 +321,82 @@ TEST(Parser, json)
 
 
 
+/*
+  Check how JSON parser handles escape sequences, non-ASCII characters
+  and large numbers.
+*/
+
+TEST(Parser, json_utf8)
+{
+  struct : public JSON::Processor
+         , public JSON::Processor::Any_prc
+         , public JSON::Processor::Any_prc::Scalar_prc
+  {
+    std::map<cdk::string, cdk::string> m_str;
+    std::map<cdk::string, uint64_t> m_uint;
+    std::map<cdk::string, int64_t> m_int;
+    cdk::string m_key;
+
+    void null() {}
+    void str(const cdk::string &val) { m_str[m_key] = val; }
+    void num(uint64_t val) { m_uint[m_key] = val; }
+    void num(int64_t val) { m_int[m_key] = val; }
+    void num(float) {}
+    void num(double) {}
+    void yesno(bool) {}
+
+    Scalar_prc* scalar() { return this; }
+    Doc_prc* doc() { return this; }
+    List_prc* arr() { return NULL; }
+
+    Any_prc* key_val(const cdk::string &key)
+    {
+      m_key = key;
+      return this;
+    }
+  }
+  prc;
+
+  std::string json =
+    "{\"esc\": \"a\\\"b\\\\c\\nd\\u00e9\\ud83d\\ude00\","
+    " \"k\xc3\xa9y\": \"za\xc5\xbc\xc3\xb3\xc5\x82\xc4\x87\","
+    " \"sub\": {\"skip\": [1, \"two\", {\"three\": 3}]},"
+    " \"long\": \"0123456789abcdef0123456789abcdef\","
+    " \"max\": 18446744073709551615, \"min\": -9223372036854775808}";
+
+  JSON_parser parser(json);
+  parser.process(prc);
+
+  EXPECT_EQ(cdk::string(L"a\"b\\c\nd\u00e9\U0001F600"),
+            prc.m_str[L"esc"]);
+  EXPECT_EQ(cdk::string(L"za\u017c\u00f3\u0142\u0107"),
+            prc.m_str[L"k\u00e9y"]);
+  EXPECT_EQ(cdk::string(L"0123456789abcdef0123456789abcdef"),
+            prc.m_str[L"long"]);
+  EXPECT_EQ(UINT64_MAX, prc.m_uint[L"max"]);
+  EXPECT_EQ(INT64_MIN, prc.m_int[L"min"]);
+
+  // negative tests
+
+  const char *invalid[] = {
+    "{\"a\": \"unterminated}",
+    "{\"a\": \"\\ud800\"}",
+    "{\"a\": \"\xff\"}",
+    "{\"a\": 12abc}",
+    "{\"a\": 18446744073709551616}",
+    "{\"a\": [1, 2}",
+    "{\"a\": 1,}",
+    "{\"a\": 1} tail",
+  };
+
+  for (const char *doc : invalid)
+  {
+    JSON_parser parser(doc);
+    EXPECT_THROW(parser.process(prc), JSON_parser::Error);
+  }
+}
+
+
 class Expr_printer
   : public cdk::Expression::Processor
 {
@@ -583,6 +660,84 @@ public:
 };
 
 
+TEST(Parser, tokenizer)
+{
+  // Tokens of a UTF8 string, including longest match of symbols.
+
+  {
+    Tokenizer toks(std::string(
+      "a->>'$.x'<>Not 1.5e+3 `Kraków` \"żółw \\\"x\\\"\" x'0aF' 0x1f **"
+    ));
+
+    struct { Token::Type type; const wchar_t *text; } expected[] =
+    {
+      { Token::WORD, L"a" },
+      { Token::ARROW2, L"->>" },
+      { Token::QSTRING, L"$.x" },
+      { Token::DF, L"<>" },
+      { Token::WORD, L"Not" },
+      { Token::NUMBER, L"1.5e+3" },
+      { Token::QWORD, L"Krak\u00f3w" },
+      { Token::QQSTRING, L"\u017c\u00f3\u0142w \"x\"" },
+      { Token::HEX, L"0aF" },
+      { Token::HEX, L"1f" },
+      { Token::DOUBLESTAR, L"**" },
+    };
+
+    It it = toks.begin();
+
+    for (auto &tok : expected)
+    {
+      ASSERT_NE(toks.end(), it);
+      EXPECT_EQ(tok.type, it->get_type());
+      EXPECT_EQ(cdk::string(tok.text), it->get_text());
+      ++it;
+    }
+
+    EXPECT_EQ(toks.end(), it);
+
+    // Keywords are matched case insensitively.
+
+    EXPECT_EQ(Keyword::NOT, Keyword::get(*(toks.begin() + 4)));
+    EXPECT_EQ(Keyword::NONE, Keyword::get(*toks.begin()));
+  }
+
+  // Wide string input gives the same tokens.
+
+  {
+    Tokenizer toks(cdk::string(L"`Krak\u00f3w` >= 'x'"));
+    It it = toks.begin();
+    EXPECT_EQ(Token::QWORD, it->get_type());
+    EXPECT_EQ(cdk::string(L"Krak\u00f3w"), it->get_text());
+    EXPECT_EQ(Token::GE, (++it)->get_type());
+  }
+
+  /*
+    Tokens are produced on demand: error in the string is reported
+    only when tokenizer reaches it.
+  */
+
+  {
+    Tokenizer toks(std::string("a + b #"));
+    It it = toks.begin();
+    EXPECT_FALSE(toks.empty());
+    ++it;
+    ++it;
+    EXPECT_EQ(cdk::string(L"b"), it->get_text());
+    EXPECT_ERROR(++it; (void)(it == toks.end()));
+  }
+
+  {
+    Tokenizer toks(std::string("  \t"));
+    EXPECT_TRUE(toks.empty());
+    EXPECT_EQ(toks.end(), toks.begin());
+  }
+
+  EXPECT_ERROR(Tokenizer(std::string("'abc")).empty());
+  EXPECT_ERROR(Tokenizer(std::string("a = '\xff'")));
+}
+
+
 // TODO: more extensive testing when expr parser is completed
 // TODO: check if parsing is correct
 
@@ -1056,6 +1211,109 @@ TEST(Parser, projection_expr)
 }
 
 
+/*
+  Expressions obtained from the cache of parsed expressions should be
+  reported in the same way as by the parsers.
+*/
+
+TEST(Parser, expr_cache)
+{
+  Expr_cache::clear();
+  Expr_cache::set_capacity(Expr_cache::default_capacity);
+
+  size_t size = 0;
+  size_t hits = 0;
+
+  for (unsigned round = 0; round < 2; ++round)
+  {
+    for (const Expr_Test &test : exprs)
+    {
+      ostringstream parsed, cached;
+      Expr_printer pp(parsed), cp(cached);
+
+      Expression_parser(test.mode, test.txt).process(pp);
+      Cached_expr(test.mode, test.txt).process(cp);
+      EXPECT_EQ(parsed.str(), cached.str()) << "expr: " << cdk::string(test.txt);
+    }
+
+    for (const Expr_Test &test : order_exprs)
+    {
+      ostringstream parsed, cached;
+      Order_printer pp(parsed), cp(cached);
+
+      Order_parser(test.mode, test.txt).process(pp);
+      Cached_order(test.mode, test.txt).process(cp);
+      EXPECT_EQ(parsed.str(), cached.str()) << "sort: " << cdk::string(test.txt);
+    }
+
+    for (const Expr_Test &test : proj_exprs)
+    {
+      ostringstream parsed, cached;
+
+      if (parser::Parser_mode::DOCUMENT == test.mode)
+      {
+        Proj_Document_printer pp(parsed), cp(cached);
+        Projection_parser(test.mode, test.txt).process(pp);
+        Cached_projection(test.mode, test.txt).process(cp);
+      }
+      else
+      {
+        Proj_Table_printer pp(parsed), cp(cached);
+        Projection_parser(test.mode, test.txt).process(pp);
+        Cached_projection(test.mode, test.txt).process(cp);
+      }
+
+      EXPECT_EQ(parsed.str(), cached.str())
+        << "projection: " << cdk::string(test.txt);
+    }
+
+    if (0 == round)
+    {
+      size = Expr_cache::size();
+      hits = Expr_cache::hits();
+      EXPECT_LT(0U, size);
+    }
+  }
+
+  // Second round should be served from the cache.
+
+  size_t count = sizeof(exprs)/sizeof(Expr_Test)
+                 + sizeof(order_exprs)/sizeof(Expr_Test)
+                 + sizeof(proj_exprs)/sizeof(Expr_Test);
+
+  EXPECT_EQ(size, Expr_cache::size());
+  EXPECT_EQ(hits + count, Expr_cache::hits());
+
+  // Errors are reported each time and not cached.
+
+  {
+    Expr_printer printer(cout);
+    EXPECT_ERROR(Cached_expr(parser::Parser_mode::DOCUMENT, L"1 +").process(printer));
+    EXPECT_ERROR(Cached_expr(parser::Parser_mode::DOCUMENT, L"1 +").process(printer));
+    EXPECT_EQ(size, Expr_cache::size());
+  }
+
+  // Least recently used entries are removed when capacity is reduced.
+
+  Expr_cache::set_capacity(2);
+  EXPECT_EQ(2U, Expr_cache::size());
+
+  Expr_cache::clear();
+  Expr_cache::set_capacity(0);
+
+  {
+    ostringstream out;
+    Expr_printer printer(out);
+    Cached_expr(parser::Parser_mode::DOCUMENT, L"a + b").process(printer);
+    Cached_expr(parser::Parser_mode::DOCUMENT, L"a + b").process(printer);
+    EXPECT_EQ(0U, Expr_cache::size());
+    EXPECT_EQ(0U, Expr_cache::hits());
+  }
+
+  Expr_cache::set_capacity(Expr_cache::default_capacity);
+}
+
+
 TEST(Parser, doc_path)
 {
   {
@@ -29,95 +29,142 @@
  */
 
 #include <mysql/cdk/common.h>
+#include <mysql/cdk/foundation/utf8.h>
 
 PUSH_SYS_WARNINGS
 #include <stdexcept>
 #include <memory>
 #include <cstdlib>
-#include <cctype>
 #include <cstring>
-#include <cstdlib>
+#include <algorithm>
 POP_SYS_WARNINGS
 
 #include "tokenizer.h"
 
 
 using namespace parser;
+namespace utf8 = cdk::foundation::utf8;
 
 
 namespace {
 
-  std::locale c_loc("C");
-  const std::ctype<char_t> &ctf = std::use_facet<std::ctype<char_t>>(c_loc);
+  /*
+    Character classes of bytes of the input string. Classes are bit flags,
+    a character can be in several classes. Bytes >= 0x80, which are parts
+    of non-ASCII characters, do not belong to any class.
+  */
 
-}
+  enum Char_class
+  {
+    SPACE = 0x01,
+    DIGIT = 0x02,
+    ALPHA = 0x04,   // letter or '_'
+    HEX   = 0x08,   // hexadecimal digit
+    WORD  = DIGIT | ALPHA
+  };
+
+  #define S   SPACE
+  #define D   DIGIT
+  #define W   ALPHA
+  #define H   HEX
+
+  const unsigned char char_class[256] =
+  {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   S,   S,   S,   S,   S,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      S,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    D|H, D|H, D|H, D|H, D|H, D|H, D|H, D|H, D|H, D|H,   0,   0,   0,   0,   0,   0,
+      0, W|H, W|H, W|H, W|H, W|H, W|H,   W,   W,   W,   W,   W,   W,   W,   W,   W,
+      W,   W,   W,   W,   W,   W,   W,   W,   W,   W,   W,   0,   0,   0,   0,   W,
+      0, W|H, W|H, W|H, W|H, W|H, W|H,   W,   W,   W,   W,   W,   W,   W,   W,   W,
+      W,   W,   W,   W,   W,   W,   W,   W,   W,   W,   W,   0,   0,   0,   0,   0,
+  };
+
+  #undef S
+  #undef D
+  #undef W
+  #undef H
 
 
-bool Tokenizer::cur_char_is_space() const
-{
-  return ctf.is(ctf.space, cur_char());
-}
+  /*
+    Symbol tokens are recognized with a switch over a key formed from
+    the first 1, 2 or 3 characters of the token. Case labels are generated
+    from SYMBOL_LISTn() declarations with keys computed at compile time.
+  */
+
+  constexpr uint32_t sym_key(const char *str, size_t len)
+  {
+    return len ? ((uint32_t)(unsigned char)str[0] << (8 * (len - 1)))
+                 | sym_key(str + 1, len - 1)
+               : 0;
+  }
 
-bool Tokenizer::cur_char_is_word() const
-{
-  if (cur_char_is(L'_'))
-    return true;
-  return ctf.is(ctf.alnum, cur_char());
 }
 
 
-void Tokenizer::get_tokens()
+Tokenizer::Tokenizer(const std::string &input)
+  : _input(input)
+  , _in_pos(0)
+  , _tok_pos(0)
+  , _done(false)
 {
-  while (chars_available())
-  {
-    if (0 == cur_char())
-      return;
-
-    while (chars_available() && cur_char_is_space())
-      consume_char();
+  const cdk::byte *beg = (const cdk::byte*)_input.data();
 
-    if (!chars_available())
-      return;
+  if (!utf8::valid(beg, beg + _input.size()))
+    throw_error(cdk::cdkerrc::parse_error, L"Invalid UTF8 string");
+}
 
-    if (parse_string())
-      continue;
 
-    if (parse_hex())
-      continue;
+Tokenizer::Tokenizer(const string &input)
+  : _in_pos(0)
+  , _tok_pos(0)
+  , _done(false)
+{
+  const cdk::char_t *beg = input.data();
+  const cdk::char_t *end = beg + input.size();
+  size_t len = utf8::measure(beg, end);
 
-    if (parse_number())
-      continue;
+  if (size_t(-1) == len)
+    throw_error(cdk::cdkerrc::parse_error, L"Invalid characters in the string");
 
-    // check symbol tokens
+  if (0 == len)
+    return;
 
-    set_token_start();
+  _input.resize(len);
+  cdk::byte *out = (cdk::byte*)&_input[0];
+  utf8::encode(beg, end, out, out + len);
+}
 
-#define  symbol_check(T,X) \
-    if (consume_chars(L##X)) \
-    { \
-      add_token(Token::T, L##X); \
-      continue; \
-    } \
 
-    SYMBOL_LIST2(symbol_check)
+bool Tokenizer::cur_char_is_a(unsigned cls) const
+{
+  return chars_available()
+         && 0 != (cls & char_class[(unsigned char)_input[_in_pos]]);
+}
 
-#define  symbol_check1(T,X) \
-    if (c == (L##X)[0]) { consume_char(); add_token(Token::T,L##X); continue; }
 
-    char_t c = cur_char();
-    SYMBOL_LIST1(symbol_check1)
+bool Tokenizer::next_token()
+{
+  while (chars_available() && cur_char_is_a(SPACE))
+    consume_char();
 
-    /*
-      Note: it is important to parse word last as some words can qualify as
-      other tokens.
-    */
+  if (!chars_available() || 0 == cur_char())
+    return false;
 
-    if (parse_word())
-      continue;
+  /*
+    Note: it is important to parse word last as some words can qualify as
+    other tokens.
+  */
 
-    token_error(L"Could not recognize next token");
+  if (parse_string()
+      || parse_hex()
+      || parse_number()
+      || parse_symbol()
+      || parse_word())
+    return true;
 
-  } // while
+  token_error(L"Could not recognize next token");
+  return false;
 }
 
 
@@ -146,18 +193,14 @@ void Tokenizer::get_tokens()
     FLOAT ::= DIGIT* '.' DIGIT+ ('E' ('+'|'-')? DIGIT+)? | DIGIT+ 'E' ('+'|'-')? DIGIT+
 */
 
-bool Tokenizer::parse_digits(string *out)
+bool Tokenizer::parse_digits()
 {
   bool has_digits = false;
 
-  while (chars_available() && cur_char_in(L"0123456789"))
+  while (cur_char_is_a(DIGIT))
   {
     has_digits = true;
-
-    if (out)
-      out->push_back(consume_char());
-    else
-      consume_char();
+    consume_char();
   }
 
   return has_digits;
@@ -175,19 +218,23 @@ bool Tokenizer::parse_number()
     Otherwise it is a single DOT token.
   */
 
-  if (cur_char_is(L'.') && !next_char_in(L"0123456789"))
-    return false;
+  if (cur_char_is('.'))
+  {
+    if (!(_in_pos + 1 < _input.size()
+          && (DIGIT & char_class[(unsigned char)_input[_in_pos + 1]])))
+      return false;
+  }
 
   // Parse leading digits, if any
 
-  if (!parse_digits() && !cur_char_is(L'.'))
+  else if (!parse_digits())
   {
     return false;
   }
 
   // Handle decimal point, if any
 
-  if (consume_char(L'.'))
+  if (consume_char('.'))
   {
     is_float = true;
     if (!parse_digits())
@@ -196,7 +243,7 @@ bool Tokenizer::parse_number()
 
   // See if we have exponent (but it is not parsed yet)
 
-  if (consume_char(L"Ee"))
+  if (consume_char('E') || consume_char('e'))
   {
     is_float = true;
     exponent = true;
@@ -218,7 +265,8 @@ bool Tokenizer::parse_number()
 
   if (exponent)
   {
-    consume_char(L"+-");
+    if (!consume_char('+'))
+      consume_char('-');
 
     if (!parse_digits())
       token_error(L"No digits in the exponent");
@@ -242,17 +290,16 @@ bool Tokenizer::parse_number()
 
 bool Tokenizer::parse_hex()
 {
-  string val;
+  std::string val;
 
-  if (!chars_available())
-    return false;
+  set_token_start();
 
   switch (cur_char())
   {
 
-  case L'X': case L'x':
+  case 'X': case 'x':
   {
-    if (!next_char_is(L'\''))
+    if (!next_char_is('\''))
       return false;
 
     consume_char();
@@ -261,15 +308,15 @@ bool Tokenizer::parse_hex()
     if (!parse_hex_digits(val))
       token_error(L"Unexpected character inside hex literal");
 
-    if (!consume_char(L'\''))
+    if (!consume_char('\''))
       token_error(L"Unexpected character inside hex literal");
 
     break;
   }
 
-  case L'0':
+  case '0':
   {
-    if (!next_char_in(L"Xx"))
+    if (!next_char_is('X') && !next_char_is('x'))
       return false;
 
     consume_char();
@@ -289,15 +336,59 @@ bool Tokenizer::parse_hex()
   return true;
 }
 
-bool Tokenizer::parse_hex_digits(string &digits)
+bool Tokenizer::parse_hex_digits(std::string &digits)
 {
-  bool ret = cur_char_in(L"0123456789ABCDEFabcdef");
-  while (cur_char_in(L"0123456789ABCDEFabcdef"))
+  bool ret = cur_char_is_a(HEX);
+  while (cur_char_is_a(HEX))
     digits.push_back(consume_char());
   return ret;
 }
 
 
+/*
+  See if next token is a symbol declared by one of SYMBOL_LISTn() macros.
+  The longest matching symbol is used.
+*/
+
+bool Tokenizer::parse_symbol()
+{
+  const char *pos = _input.data() + _in_pos;
+  size_t avail = _input.size() - _in_pos;
+  Token::Type type = Token::WORD;
+  size_t len = 0;
+
+  set_token_start();
+
+#define symbol_case(T,X) \
+  case sym_key(X, sizeof(X) - 1): type = Token::T; len = sizeof(X) - 1; break;
+
+  if (avail >= 3)
+    switch (sym_key(pos, 3))
+    {
+      SYMBOL_LIST3(symbol_case)
+      default: break;
+    }
+
+  if (!len && avail >= 2)
+    switch (sym_key(pos, 2))
+    {
+      SYMBOL_LIST2(symbol_case)
+      default: break;
+    }
+
+  if (!len)
+    switch (sym_key(pos, 1))
+    {
+      SYMBOL_LIST1(symbol_case)
+      default: return false;
+    }
+
+  _in_pos += len;
+  add_token(type);
+  return true;
+}
+
+
 /*
   See if next token is:
 
@@ -307,22 +398,19 @@ bool Tokenizer::parse_hex_digits(string &digits)
 
 bool Tokenizer::parse_word()
 {
-  if (!chars_available())
-    return false;
-
   set_token_start();
 
-  if (cur_char_is(L'`'))
+  if (cur_char_is('`'))
   {
-    string word;
-    parse_quotted_string(L'`', &word);
+    std::string word;
+    parse_quotted_string('`', word);
     add_token(Token::QWORD, word);
     return true;
   }
 
   bool has_word = false;
 
-  while (chars_available() && cur_char_is_word())
+  while (cur_char_is_a(WORD))
   {
     consume_char();
     has_word = true;
@@ -346,58 +434,54 @@ bool Tokenizer::parse_word()
 bool Tokenizer::parse_string()
 {
   set_token_start();
-  string val;
-  char_t quote = cur_char();
+  std::string val;
+  char quote = cur_char();
 
-  if (!(L'\"' == quote || L'\'' == quote))
+  if (!('\"' == quote || '\'' == quote))
     return false;
 
-  if (!parse_quotted_string(quote, &val))
+  if (!parse_quotted_string(quote, val))
     return false;
 
-  add_token(L'\"' == quote ? Token::QQSTRING : Token::QSTRING, val);
+  add_token('\"' == quote ? Token::QQSTRING : Token::QSTRING, val);
   return true;
 }
 
 
-bool Tokenizer::parse_quotted_string(char_t qchar, string *val)
+/*
+  Parse string in quotes storing its characters (after removing escapes)
+  in `val`. Note that bytes of multi-byte UTF8 characters never equal
+  quote or escape characters, so the string can be processed byte by byte.
+*/
+
+bool Tokenizer::parse_quotted_string(char qchar, std::string &val)
 {
   if (!consume_char(qchar))
     return false;
 
-  // Store first few characters for use in error message.
-
-  static const size_t start_len = 8;
-  char_t start[start_len] = { qchar };
-  size_t pos = 1;
-
   while (chars_available())
   {
     // if we do not have escaped char, look at the end of the string
 
-    if (!consume_char(L'\\'))
+    if (!consume_char('\\'))
     {
       // if qute char is repeated, then it does not terminate string
       if (consume_char(qchar) && !cur_char_is(qchar))
         return true;
     }
 
-    char_t c = consume_char();
-
-    if (val)
-      val->push_back(c);
-
-    if (pos < start_len)
-      start[pos++] = c;
+    val.push_back(consume_char());
   }
 
-  if (pos < start_len)
-    start[pos] = '\0';
-  start[start_len - 1] = '\0';
+  // Show first few characters of the string in the error message.
+
+  string start(val);
+  start.resize(std::min<size_t>(start.size(), 6));
+  start.insert(start.begin(), (cdk::char_t)qchar);
 
   token_error(
     string(L"Unterminated quoted string starting with ")
-    + string(start) + string(L"...")
+    + start + string(L"...")
   );
 
   return false;  // quiet compile warnings
@@ -416,13 +500,33 @@ size_t Tokenizer::set_token_start()
 void Tokenizer::add_token(Token::Type tt)
 {
   assert(_in_pos > _tok_pos);
-  add_token(tt, _input.substr(_tok_pos, _in_pos - _tok_pos));
-  _tok_pos = _in_pos;
+  add_token(tt, _input.data() + _tok_pos, _input.data() + _in_pos);
 }
 
-void Tokenizer::add_token(Token::Type tt, const string &val)
+void Tokenizer::add_token(Token::Type tt, const std::string &val)
 {
-  _tokens.emplace_back(tt, val, _tok_pos, _in_pos);
+  add_token(tt, val.data(), val.data() + val.size());
+}
+
+/*
+  Add token whose characters are given by UTF8 bytes in [beg, end) (which
+  are known to be valid UTF8).
+*/
+
+void Tokenizer::add_token(Token::Type tt, const char *beg, const char *end)
+{
+  string text;
+
+  if (beg != end)
+  {
+    text.resize((size_t)(end - beg));
+    text.resize(
+      utf8::decode((const cdk::byte*)beg, (const cdk::byte*)end, &text[0])
+    );
+  }
+
+  _tokens.emplace_back(tt, std::move(text), _tok_pos, _in_pos);
+  _tok_pos = _in_pos;
 }
 
 
@@ -434,11 +538,11 @@ bool Tokenizer::chars_available() const
   return _in_pos < _input.size();
 }
 
-char_t   Tokenizer::cur_char() const
+char   Tokenizer::cur_char() const
 {
   if (!chars_available())
     token_error(L"More characters expected");
-  return _input.at(_in_pos);
+  return _input[_in_pos];
 }
 
 size_t Tokenizer::get_char_pos() const
@@ -447,47 +551,23 @@ size_t Tokenizer::get_char_pos() const
 }
 
 
-bool Tokenizer::next_char_is(char_t c, size_t off) const
+bool Tokenizer::next_char_is(char c, size_t off) const
 {
   return _in_pos + off < _input.size() && _input[_in_pos + off] == c;
 }
 
-bool Tokenizer::next_char_in(const char_t *set, size_t off) const
-{
-  if (_in_pos + off >= _input.size())
-    return false;
-  char_t c = _input[_in_pos + off];
 
-  return (0 != c) && (NULL != std::wcschr(set, c));
-}
-
-
-char_t Tokenizer::consume_char()
+char Tokenizer::consume_char()
 {
-  char_t c = cur_char();
+  char c = cur_char();
   _in_pos++;
   return c;
 }
 
-bool Tokenizer::consume_char(char_t c)
+bool Tokenizer::consume_char(char c)
 {
   if (!cur_char_is(c))
     return false;
   consume_char();
   return true;
 }
-
-char_t Tokenizer::consume_char(const char_t *set)
-{
-  if (!cur_char_in(set))
-    return '\0';
-  return consume_char();
-}
-
-bool Tokenizer::consume_chars(const char_t *str)
-{
-  if (_in_pos != _input.find(str, _in_pos))
-    return false;
-  _in_pos += wcslen(str);
-  return true;
-}
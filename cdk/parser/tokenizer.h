@@ -36,11 +36,13 @@
 PUSH_SYS_WARNINGS
 #include <string>
 #include <vector>
+#include <deque>
 #include <map>
 #include <set>
 #include <memory>
 #include <stdexcept>
 #include <sstream>
+#include <cstring>
 POP_SYS_WARNINGS
 
 #undef WORD
@@ -48,8 +50,8 @@ POP_SYS_WARNINGS
 /*
   Definitions of tokens recognized by tokenizer.
 
-  Each macro TOKEN_LIST(), SYMBOL_LIST1() and SYMBOL_LSIT2() defines list
-  of tokens with the following entry for each token:
+  Each macro TOKEN_LIST(), SYMBOL_LIST1(), SYMBOL_LIST2() and SYMBOL_LIST3()
+  defines list of tokens with the following entry for each token:
 
     X(NNN,SSS)
 
@@ -68,6 +70,12 @@ POP_SYS_WARNINGS
     X(HEX, NULL)      /* hexadecimal number*/\
     SYMBOL_LIST1(X) \
     SYMBOL_LIST2(X) \
+    SYMBOL_LIST3(X) \
+
+// 3 char symbols
+
+#define SYMBOL_LIST3(X) \
+    X(ARROW2, "->>")
 
 // 2 char symbols
 
@@ -79,7 +87,6 @@ POP_SYS_WARNINGS
     X(LSHIFT, "<<") \
     X(RSHIFT, ">>") \
     X(DOUBLESTAR, "**") \
-    X(ARROW2, "->>") \
     X(ARROW, "->") \
     X(AMPERSTAND2, "&&") \
     X(BAR2, "||") \
@@ -254,7 +261,8 @@ namespace parser {
     Class representing a single token.
 
     It stores token type, characters which make the token and its position
-    within the parsed string (begin and end position).
+    within the parsed string (begin and end position). For tokens created by
+    Tokenizer, positions are byte offsets in the UTF8 input string.
 
     Note: For tokens such as quotted string, the characters of the token do
     not include the quotes. For that reason characters of the token are not
@@ -276,10 +284,10 @@ namespace parser {
     typedef std::set<Type>  Set;
 
     Token(
-      Type type, const string& text,
+      Type type, string text,
       size_t begin, size_t end
     )
-      : _type(type), _text(text)
+      : _type(type), _text(std::move(text))
       , _pos_begin(begin), _pos_end(end)
     {}
 
@@ -351,11 +359,17 @@ namespace parser {
     Tokenizer::iterator returned by method begin() to iterate through the
     sequence of tokens.
 
-    Any errors in converting a string into a token sequence are thrown upon
-    construction of a tokenizer.
-
-    TODO: Avoid storing all tokens in memory.
-    Idea: have it working on istream instead.
+    Tokenizer works on UTF8 bytes. If it is created from a wide string, the
+    string is converted to UTF8 first. Characters are classified using
+    a table indexed by byte values. Only ASCII characters can be part of
+    tokens other than quoted strings and words.
+
+    Tokens are produced on demand, when an iterator moves past the last
+    token found so far. Tokens which were produced are kept in the tokenizer
+    so that references to them stay valid while the parser moves forward,
+    and so that the token sequence can be iterated again. Consequently, any
+    errors in converting a string into a token sequence are thrown when
+    an iterator reaches the place where the error is.
   */
 
   class Tokenizer
@@ -365,19 +379,18 @@ namespace parser {
     class Error;
     class  iterator;
 
-    Tokenizer(const string& input)
-      : _input(input)
-      , _in_pos(0)
-      , _tok_pos(0)
-      //, _pos(0)
-    {
-      get_tokens();
-    }
+    // Create tokenizer for a UTF8 string.
+
+    Tokenizer(const std::string& input);
+
+    // Create tokenizer for a wide string (it is converted to UTF8).
+
+    Tokenizer(const string& input);
 
 
     bool empty() const
     {
-      return _tokens.empty();
+      return !has_token(0);
     }
 
     iterator begin() const;
@@ -385,67 +398,55 @@ namespace parser {
 
   protected:
 
-    // Build token sequence from the input string.
+    /*
+      Check if there is a token at given position in the token sequence,
+      producing more tokens if needed.
+    */
+
+    bool has_token(size_t pos) const;
 
-    void get_tokens();
+    /*
+      Parse next token from the input string and add it to the sequence.
+      Returns false if there are no more tokens in the string.
+    */
+
+    bool next_token();
 
     // Methods that parse characters into various kinds of tokens.
 
     bool parse_number();
-    bool parse_digits(string *digits = NULL);
+    bool parse_digits();
     bool parse_hex();
-    bool parse_hex_digits(string &digits);
+    bool parse_hex_digits(std::string &digits);
     bool parse_string();
+    bool parse_symbol();
     bool parse_word();
-    bool parse_quotted_string(char_t, string *val = NULL);
+    bool parse_quotted_string(char, std::string &val);
 
     // access underlying sequence of characters
 
-    const string& get_input() const { return _input; }
+    const std::string& get_input() const { return _input; }
 
-    char_t cur_char() const;
+    char cur_char() const;
     size_t get_char_pos() const;
     bool chars_available() const;
 
-    bool next_char_is(char_t, size_t off=1) const;
-    bool next_char_in(const char_t*, size_t off=1) const;
+    bool next_char_is(char, size_t off=1) const;
 
-    bool cur_char_is(char_t c) const
+    bool cur_char_is(char c) const
     {
       return next_char_is(c, 0);
     }
 
-    bool cur_char_is_space() const;
-
-    // Return true if current character can be part of a WORD token.
+    // Return true if character class of the current character is `cls`.
 
-    bool cur_char_is_word() const;
-
-    bool cur_char_in(const char_t *set) const
-    {
-      return next_char_in(set, 0);
-    }
+    bool cur_char_is_a(unsigned cls) const;
 
-
-    char_t consume_char();
+    char consume_char();
 
     // Consume next character if it equals given one.
 
-    bool   consume_char(char_t);
-
-    /*
-      Consume next character if it is one of the character in the given
-      string. Returns consumed character, '\0' otherwise.
-    */
-
-    char_t consume_char(const char_t*);
-
-    /*
-      Consume given sequence of characters. Returns true if it was possible.
-      If not, the position within input string is not changed.
-    */
-
-    bool   consume_chars(const char_t*);
+    bool   consume_char(char);
 
     // Error reporting
 
@@ -475,17 +476,24 @@ namespace parser {
       from the input string).
     */
 
-    void add_token(Token::Type, const string&);
+    void add_token(Token::Type, const std::string&);
+
+    void add_token(Token::Type, const char*, const char*);
 
 
     // Storage for tokens and the input string
 
-    string _input;
+    std::string _input;
     size_t _in_pos;   // current position in the input string
     size_t _tok_pos;  // start position of a token in the input string
 
-    std::vector<Token> _tokens;
-    //tokens_t::size_type _pos;
+    /*
+      Note: std::deque does not move elements when new ones are appended,
+      so that pointers to tokens returned by iterators stay valid.
+    */
+
+    std::deque<Token> _tokens;
+    bool _done;       // true if all tokens are in _tokens
 
     friend Error;
   };
@@ -493,6 +501,9 @@ namespace parser {
 
   /*
     Iterator for accessing a sequence of tokens of a tokenizer.
+
+    Note: end iterator equals any iterator of the same tokenizer that is
+    positioned after the last token.
   */
 
   class Tokenizer::iterator
@@ -504,6 +515,11 @@ namespace parser {
       : _toks(toks), _pos(pos)
     {}
 
+    bool at_end() const
+    {
+      return !_toks || size_t(-1) == _pos || !_toks->has_token(_pos);
+    }
+
   public:
 
     iterator()
@@ -511,11 +527,8 @@ namespace parser {
     {}
 
     iterator(const Tokenizer &toks, bool at_end = false)
-      : _toks(&toks), _pos(0)
-    {
-      if (at_end)
-        _pos = toks._tokens.size();
-    }
+      : _toks(&toks), _pos(at_end ? size_t(-1) : 0)
+    {}
 
     iterator(const iterator &other)
       : _toks(other._toks), _pos(other._pos)
@@ -525,26 +538,30 @@ namespace parser {
     {
       if (!_toks)
         THROW("token iterator: accessing null iterator");
+      if (!_toks->has_token(_pos))
+        THROW("token iterator: accessing end iterator");
       return _toks->_tokens[_pos];
     }
 
     const Token* operator->() const
     {
-      if (!_toks)
-        THROW("token iterator: accessing null iterator");
-      return &(_toks->_tokens[_pos]);
+      return &**this;
     }
 
     iterator& operator++()
     {
-      if (_toks && _pos < _toks->_tokens.size())
+      if (!at_end())
         ++_pos;
       return *this;
     }
 
     bool operator==(const iterator &other) const
     {
-      return _toks == other._toks && _pos == other._pos;
+      if (_toks != other._toks)
+        return false;
+      if (_pos == other._pos)
+        return true;
+      return at_end() && other.at_end();
     }
 
     bool operator!=(const iterator &other) const
@@ -554,13 +571,35 @@ namespace parser {
 
     iterator operator+(size_t diff) const
     {
-      return iterator(_toks, _pos + diff > 0 ? _pos + diff : 0);
+      return iterator(_toks, _pos + diff);
     }
 
     friend Tokenizer::Error;
   };
 
 
+  inline
+  bool Tokenizer::has_token(size_t pos) const
+  {
+    /*
+      Producing tokens does not change the logical state of the tokenizer,
+      only reveals more of it.
+    */
+
+    Tokenizer *self = const_cast<Tokenizer*>(this);
+
+    while (pos >= _tokens.size())
+    {
+      if (_done || !self->next_token())
+      {
+        self->_done = true;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   inline
   Tokenizer::iterator Tokenizer::begin() const
   {
@@ -582,18 +621,18 @@ namespace parser {
   */
 
   class Tokenizer::Error
-    : public parser::Error_base<string>
+    : public parser::Error_base<std::string>
   {
   public:
 
     Error(const Tokenizer *p, const string &descr = string())
-      : parser::Error_base<string>(p->_input, p->_in_pos, descr)
+      : parser::Error_base<std::string>(p->_input, p->_in_pos, descr)
     {}
 
     Error(const Tokenizer::iterator &it, const string &msg = string())
-      : parser::Error_base<string>(
+      : parser::Error_base<std::string>(
           it._toks->_input,
-          it != it._toks->end() ? &(*it) : NULL,
+          it.at_end() ? NULL : &(*it),
           msg
         )
     {}
@@ -620,6 +659,51 @@ namespace parser {
     used below because it is considered unsafe.
   */
 
+  /*
+    When parsing UTF8 strings, fragments copied to the error buffers can
+    start or end in the middle of a multi-byte character, which would make
+    them invalid UTF8 strings. These helpers remove such incomplete
+    characters from the beginning or the end of a (null terminated) fragment.
+    For wide strings there is nothing to do.
+  */
+
+  inline void utf8_trim_head(wchar_t*) {}
+  inline void utf8_trim_tail(wchar_t*) {}
+
+  inline
+  void utf8_trim_head(char *str)
+  {
+    size_t skip = 0;
+
+    while (0x80 == (str[skip] & 0xC0))
+      ++skip;
+
+    if (skip)
+      memmove(str, str + skip, strlen(str + skip) + 1);
+  }
+
+  inline
+  void utf8_trim_tail(char *str)
+  {
+    size_t len = strlen(str);
+    size_t pos = len;
+
+    // Find the lead byte of the last character.
+
+    while (pos > 0 && 0x80 == (str[pos - 1] & 0xC0))
+      --pos;
+
+    if (0 == pos)
+      return;
+
+    unsigned char lead = (unsigned char)str[--pos];
+    size_t char_len = lead < 0x80 ? 1 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+
+    if (len - pos < char_len)
+      str[pos] = '\0';
+  }
+
+
   DIAGNOSTIC_PUSH
   #if _MSC_VER
   DISABLE_WARNING(4996)
@@ -663,7 +747,10 @@ namespace parser {
       */
 
       if (m_pos > seen_buf_len - 1)
+      {
         m_seen[0] = 0;
+        utf8_trim_head(m_seen + 1);
+      }
 
       /*
         Similar, if remainder of the string does not fit in
@@ -675,7 +762,10 @@ namespace parser {
       ctx.copy(m_ahead, ahead_buf_len - 2, m_pos);
 
       if (ctx.length() > m_pos + ahead_buf_len - 2)
+      {
+        utf8_trim_tail(m_ahead);
         m_ahead[ahead_buf_len - 1] = 1;
+      }
     }
   }
 
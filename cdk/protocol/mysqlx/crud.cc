@@ -324,6 +324,11 @@ public:
     m_map[name] = pos;
   }
 
+  const map<string, unsigned>& get_map() const
+  {
+    return m_map;
+  }
+
 };
 
 template <class MSG>
@@ -439,10 +444,9 @@ struct Group_by_traits
 };
 
 void set_find(Mysqlx::Crud::Find &msg,
-              Data_model dm, const Find_spec &fs, const api::Args_map *args)
+              Data_model dm, const Find_spec &fs, const api::Args_map *args,
+              Placeholder_conv_imp &conv)
 {
-  Placeholder_conv_imp conv;
-
   set_data_model(dm, msg);
 
   if (args)
@@ -502,14 +506,97 @@ void set_find(Mysqlx::Crud::Find &msg,
 }
 
 
+void set_find(Mysqlx::Crud::Find &msg,
+              Data_model dm, const Find_spec &fs, const api::Args_map *args)
+{
+  Placeholder_conv_imp conv;
+  set_find(msg, dm, fs, args, conv);
+}
+
+
+/*
+  If cache is given, the `find` message holds only parameter values and
+  the limit, the rest of the command is taken from the cache. If cache is not
+  valid or parameter names are different than when the cache was filled,
+  then the whole command is built and all but these two fields are
+  serialized into the cache.
+*/
+
+template <>
+void Protocol::set_find_cached(Mysqlx::Crud::Find &find,
+                               Data_model dm, const Find_spec &fs,
+                               const api::Args_map *args, Find_cache &cache)
+{
+  if (cache.m_valid)
+  {
+    Placeholder_conv_imp conv;
+
+    if (args)
+      set_args(*args, find, conv);
+
+    if (conv.get_map() != cache.m_params)
+    {
+      find.Clear();
+      cache.reset();
+    }
+  }
+
+  if (!cache.m_valid)
+  {
+    Mysqlx::Crud::Find full;
+    Placeholder_conv_imp conv;
+
+    set_find(full, dm, fs, args, conv);
+    find.mutable_args()->Swap(full.mutable_args());
+    full.clear_limit();
+
+    cache.m_prefix = full.SerializeAsString();
+    cache.m_params = conv.get_map();
+    cache.m_valid = true;
+  }
+
+  if (fs.limit())
+    set_limit(*fs.limit(), find);
+}
+
+
 Protocol::Op&
-Protocol::snd_Find(Data_model dm, const Find_spec &fs, const api::Args_map *args)
+Protocol::snd_Find(Data_model dm, const Find_spec &fs,
+                   const api::Args_map *args, Find_cache *cache)
 {
   Mysqlx::Crud::Find find;
 
-  set_find(find, dm, fs, args);
+  if (!cache)
+  {
+    set_find(find, dm, fs, args);
+    return get_impl().snd_start(find, msg_type::cli_CrudFind);
+  }
+
+  set_find_cached(find, dm, fs, args, *cache);
+
+  return get_impl().snd_start(cache->m_prefix, find, msg_type::cli_CrudFind);
+}
+
+
+void Protocol::ser_Find(std::string &buf,
+                        Data_model dm, const Find_spec &fs,
+                        const api::Args_map *args, Find_cache *cache)
+{
+  Mysqlx::Crud::Find find;
+
+  if (!cache)
+  {
+    set_find(find, dm, fs, args);
+    buf = find.SerializeAsString();
+    return;
+  }
+
+  set_find_cached(find, dm, fs, args, *cache);
+
+  // Note: the protocol merges fields of concatenated messages.
 
-  return get_impl().snd_start(find, msg_type::cli_CrudFind);
+  buf = cache->m_prefix;
+  find.AppendToString(&buf);
 }
 
 
@@ -213,6 +213,15 @@ Protocol::Op& Protocol_impl::snd_start(Message &msg, msg_type_t msg_type)
 }
 
 
+Protocol::Op& Protocol_impl::snd_start(const std::string &prefix,
+                                       Message &msg, msg_type_t msg_type)
+{
+  m_snd_op.reset();
+  m_snd_op.reset(new Op_snd(*this, msg_type, msg, &prefix));
+  return *m_snd_op;
+}
+
+
 /*
   Helper function which creates protobuf message object of type
   indicated by msg_type identifier. Interpretation of msg_type_t
@@ -303,12 +312,15 @@ static void log_handler(LogLevel level, const char* filename, int line, const st
 */
 
 
-void Protocol_impl::write_msg(msg_type_t msg_type, Message &msg)
+void Protocol_impl::write_msg(msg_type_t msg_type, Message &msg,
+                              const std::string *prefix)
 {
   if (m_wr_op)
     THROW("Can't write message while another one is written");
 
-  msg_size_t net_size = static_cast<unsigned>(msg.ByteSize()) + 1;
+  size_t prefix_size = prefix ? prefix->size() : 0;
+  msg_size_t net_size
+    = static_cast<unsigned>(prefix_size + msg.ByteSize()) + 1;
 
   if (!resize_buf(CLIENT, header_length + net_size))
     THROW("Not enough memory for output buffer");
@@ -327,8 +339,24 @@ void Protocol_impl::write_msg(msg_type_t msg_type, Message &msg)
 
   assert(m_wr_size < (size_t)std::numeric_limits<int>::max());
 
-  if (!msg.SerializeToArray((void*)(m_wr_buf + header_length),
-                            (int)(m_wr_size - header_length)))
+  void *data = m_wr_buf + header_length + prefix_size;
+  int data_size = (int)(m_wr_size - header_length - prefix_size);
+  bool ok;
+
+  /*
+    If prefix is given, the message completes it and can miss required
+    fields which are already present in the prefix.
+  */
+
+  if (prefix_size)
+  {
+    memcpy(m_wr_buf + header_length, prefix->data(), prefix_size);
+    ok = msg.SerializePartialToArray(data, data_size);
+  }
+  else
+    ok = msg.SerializeToArray(data, data_size);
+
+  if (!ok)
     throw_error(cdkerrc::protobuf_error, "Serialization error!");
 
   // Create write operation to send message payload
@@ -824,6 +852,40 @@ Protocol::Op& Protocol::rcv_Reply(Reply_processor &prc)
 }
 
 
+class Rcv_capabilities : public Op_rcv
+{
+public:
+
+  Rcv_capabilities(Protocol_impl &proto) : Op_rcv(proto)
+  {}
+
+  void resume(Reply_processor &prc)
+  {
+    read_msg(prc);
+  }
+
+  Next_msg do_next_msg(msg_type_t type)
+  {
+    return msg_type::Capabilities == type ? EXPECTED : UNEXPECTED;
+  }
+
+  void do_process_msg(msg_type_t type, Message&)
+  {
+    if (msg_type::Capabilities != type)
+      THROW("wrong message type");
+
+    static_cast<Reply_processor&>(*m_prc).ok(string());
+  };
+
+};
+
+
+Protocol::Op& Protocol::rcv_Capabilities(Reply_processor &prc)
+{
+  return get_impl().rcv_start<Rcv_capabilities>(prc);
+}
+
+
 // Server-side API
 // ===============
 // TODO: Complete and adapt to protocol changes.
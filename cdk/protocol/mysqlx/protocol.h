@@ -153,6 +153,14 @@ public:
 
   virtual Protocol::Op& snd_start(Message &msg, msg_type_t msg_type);
 
+  /**
+    Variant of snd_start() which sends given bytes, which are already
+    serialized part of the message, followed by serialized `msg`.
+  */
+
+  virtual Protocol::Op& snd_start(const std::string &prefix, Message &msg,
+                                  msg_type_t msg_type);
+
   /**
     Start (next stage of) an async op that processes incoming message(s).
 
@@ -220,13 +228,14 @@ protected:
 
     Method write_msg() starts asynchronous operation which serializes given
     message and sends it to the other end after wrapping in correct message
-    frame.
+    frame. If prefix is given, these bytes are placed in the frame before the
+    serialized message.
 
     To complete writing operation one has to call method wr_cont() until it
     returns true.
   */
 
-  void write_msg(msg_type_t, Message&);
+  void write_msg(msg_type_t, Message&, const std::string *prefix = NULL);
   bool wr_cont();
   void wr_wait();
 
@@ -393,10 +402,11 @@ class Op_snd : public Op_base
 {
 public:
 
-  Op_snd(Protocol_impl &proto, msg_type_t type, Message &msg)
+  Op_snd(Protocol_impl &proto, msg_type_t type, Message &msg,
+         const std::string *prefix = NULL)
     : Op_base(proto)
   {
-    m_proto.write_msg(type, msg);
+    m_proto.write_msg(type, msg, prefix);
   }
 
   bool do_cont()
@@ -87,6 +87,13 @@ struct Cap_builder : api::Any::Document::Processor
 };
 
 
+Protocol::Op& Protocol::snd_CapabilitiesGet()
+{
+  Mysqlx::Connection::CapabilitiesGet msg;
+  return get_impl().snd_start(msg, msg_type::cli_CapabilitiesGet);
+}
+
+
 Protocol::Op& Protocol::snd_CapabilitiesSet(const api::Any::Document& caps)
 {
   Mysqlx::Connection::CapabilitiesSet msg;
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmark of sending Find command
+  =================================
+
+  Measures client CPU time spent on building and serializing a Find command
+  with 10 conditions in its criteria, each comparing a column to a named
+  parameter. The command is written to an in-memory stream, as it would
+  be when a prepared statement is executed many times with different
+  parameter values. Command is sent without a cache, which builds the whole
+  message each time, and with a Find_cache, which re-encodes only parameter
+  values and the limit.
+
+  Usage: find_bench [<iterations>]
+*/
+
+#include <mysql/cdk.h>
+#include <mysql/cdk/foundation/stream.h>
+#include <mysql/cdk/protocol/mysqlx.h>
+
+PUSH_SYS_WARNINGS
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+POP_SYS_WARNINGS
+
+using cdk::string;
+using namespace cdk::protocol::mysqlx;
+using std::cout;
+using std::endl;
+
+const unsigned cond_count = 10;
+
+
+/*
+  Criteria of the form:
+
+    (...((col0 = :p0) && (col1 = :p1)) && ...) && (col9 = :p9)
+*/
+
+class Criteria
+  : public api::Expression
+{
+  string m_col[cond_count];
+  string m_param[cond_count];
+
+public:
+
+  Criteria()
+  {
+    for (unsigned i = 0; i < cond_count; ++i)
+    {
+      std::ostringstream col, param;
+      col << "col" << i;
+      param << "p" << i;
+      m_col[i] = col.str();
+      m_param[i] = param.str();
+    }
+  }
+
+  void process(Processor &prc) const override
+  {
+    process_and(cond_count, prc);
+  }
+
+private:
+
+  void process_cond(unsigned pos, Processor &prc) const
+  {
+    Processor::Scalar_prc *sprc = prc.scalar();
+    if (!sprc)
+      return;
+
+    Processor::Scalar_prc::Args_prc *aprc = sprc->op("==");
+    if (!aprc)
+      return;
+
+    aprc->list_begin();
+    Processor *el = aprc->list_el();
+    if (el && el->scalar())
+      el->scalar()->id(m_col[pos], NULL);
+    el = aprc->list_el();
+    if (el && el->scalar())
+      el->scalar()->placeholder(m_param[pos]);
+    aprc->list_end();
+  }
+
+  void process_and(unsigned count, Processor &prc) const
+  {
+    if (1 == count)
+      return process_cond(0, prc);
+
+    Processor::Scalar_prc *sprc = prc.scalar();
+    if (!sprc)
+      return;
+
+    Processor::Scalar_prc::Args_prc *aprc = sprc->op("&&");
+    if (!aprc)
+      return;
+
+    aprc->list_begin();
+    Processor *el = aprc->list_el();
+    if (el)
+      process_and(count - 1, *el);
+    el = aprc->list_el();
+    if (el)
+      process_cond(count - 1, *el);
+    aprc->list_end();
+  }
+};
+
+
+/*
+  Values of parameters p0 ... p9, which change with each execution.
+*/
+
+class Args
+  : public api::Args_map
+{
+  string m_name[cond_count];
+
+public:
+
+  int64_t m_seed = 0;
+
+  Args()
+  {
+    for (unsigned i = 0; i < cond_count; ++i)
+    {
+      std::ostringstream name;
+      name << "p" << i;
+      m_name[i] = name.str();
+    }
+  }
+
+  void process(Processor &prc) const override
+  {
+    prc.doc_begin();
+    for (unsigned i = 0; i < cond_count; ++i)
+    {
+      Processor::Any_prc *aprc = prc.key_val(m_name[i]);
+      if (aprc && aprc->scalar())
+        aprc->scalar()->num(m_seed + i);
+    }
+    prc.doc_end();
+  }
+};
+
+
+class Find
+  : public Find_spec
+{
+  cdk::protocol::mysqlx::Db_obj m_obj;
+  Criteria m_criteria;
+
+public:
+
+  cdk::protocol::mysqlx::Limit m_limit;
+
+  Find()
+    : m_obj("bench_table", "bench_db")
+    , m_limit(100)
+  {}
+
+  const Db_obj&     obj() const override { return m_obj; }
+  const Expression* select() const override { return &m_criteria; }
+  const Order_by*   order() const override { return NULL; }
+  const Limit*      limit() const override { return &m_limit; }
+  const Projection* project() const override { return NULL; }
+  const Expr_list*  group_by() const override { return NULL; }
+  const Expression* having() const override { return NULL; }
+
+  Lock_mode_value locking() const override
+  {
+    return Lock_mode_value::NONE;
+  }
+
+  Lock_contention_value contention() const override
+  {
+    return Lock_contention_value::DEFAULT;
+  }
+};
+
+
+typedef std::chrono::high_resolution_clock bench_clock;
+typedef cdk::foundation::test::Mem_stream<16*1024> Stream;
+
+
+void run(const char *name, bool use_cache, unsigned iterations)
+{
+  Stream conn;
+  Protocol proto(conn);
+  Find find;
+  Args args;
+  Find_cache cache;
+
+  auto start = bench_clock::now();
+
+  for (unsigned i = 0; i < iterations; ++i)
+  {
+    conn.reset();
+    args.m_seed = i;
+    proto.snd_Find(TABLE, find, &args, use_cache ? &cache : NULL).wait();
+  }
+
+  std::chrono::duration<double, std::nano> time = bench_clock::now() - start;
+
+  cout << name << ": " << time.count() / iterations << " ns/execute" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned iterations = 100000;
+
+  if (argc > 1)
+    iterations = (unsigned)atoi(argv[1]);
+
+  if (0 == iterations)
+    iterations = 1;
+
+  cout << "Find with " << cond_count << " conditions, "
+       << iterations << " executions" << endl;
+
+  run("without cache", false, iterations);
+  run("with cache   ", true, iterations);
+
+  return 0;
+}
@@ -0,0 +1,797 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include <mysql/cdk.h>
+#include <mysql/cdk/foundation/varint.h>
+
+#include "arrow.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <sstream>
+
+
+/*
+  Implementation of Arrow C Data Interface export (see arrow.h).
+*/
+
+using namespace ::mysqlx::common;
+
+
+namespace {
+
+/*
+  Memory block allocated with malloc(), as buffers of exported arrays are
+  freed by release callbacks with free(). New bytes are zero-filled when
+  the buffer grows.
+*/
+
+struct Arrow_buffer
+{
+  byte   *m_data = nullptr;
+  size_t  m_size = 0;
+  size_t  m_capacity = 0;
+
+  ~Arrow_buffer()
+  {
+    free(m_data);
+  }
+
+  byte* resize(size_t size)
+  {
+    if (size > m_capacity || !m_data)
+    {
+      size_t cap = 2 * m_capacity;
+      if (cap < size)
+        cap = size;
+      if (cap < 64)
+        cap = 64;
+
+      void *data = realloc(m_data, cap);
+      if (!data)
+        throw std::bad_alloc();
+
+      m_data = static_cast<byte*>(data);
+      memset(m_data + m_capacity, 0, cap - m_capacity);
+      m_capacity = cap;
+    }
+
+    m_size = size;
+    return m_data;
+  }
+
+  // Pass ownership of the memory block to the caller.
+
+  void* release()
+  {
+    void *data = m_data;
+    m_data = nullptr;
+    m_size = m_capacity = 0;
+    return data;
+  }
+};
+
+
+/*
+  Private data of exported ArrowSchema and ArrowArray structures. Children
+  are allocated with new and released together with their parent, unless
+  they were moved by the consumer (in which case their release callback
+  is null).
+*/
+
+struct Schema_data
+{
+  std::string m_format;
+  std::string m_name;
+  std::vector<ArrowSchema*> m_children;
+};
+
+struct Array_data
+{
+  std::vector<const void*>  m_buffers;
+  std::vector<ArrowArray*>  m_children;
+
+  ~Array_data()
+  {
+    for (const void *buf : m_buffers)
+      free(const_cast<void*>(buf));
+  }
+};
+
+
+void release_schema(ArrowSchema *schema)
+{
+  Schema_data *data = static_cast<Schema_data*>(schema->private_data);
+
+  for (ArrowSchema *child : data->m_children)
+  {
+    if (child->release)
+      child->release(child);
+    delete child;
+  }
+
+  delete data;
+  schema->release = nullptr;
+}
+
+
+void release_array(ArrowArray *array)
+{
+  Array_data *data = static_cast<Array_data*>(array->private_data);
+
+  for (ArrowArray *child : data->m_children)
+  {
+    if (child->release)
+      child->release(child);
+    delete child;
+  }
+
+  delete data;
+  array->release = nullptr;
+}
+
+
+void init_schema(
+  ArrowSchema *schema, Schema_data *data, int64_t flags
+)
+{
+  schema->format = data->m_format.c_str();
+  schema->name = data->m_name.c_str();
+  schema->metadata = nullptr;
+  schema->flags = flags;
+  schema->n_children = (int64_t)data->m_children.size();
+  schema->children = data->m_children.empty() ?
+                     nullptr : data->m_children.data();
+  schema->dictionary = nullptr;
+  schema->release = release_schema;
+  schema->private_data = data;
+}
+
+
+void init_array(ArrowArray *array, Array_data *data, int64_t length,
+                int64_t null_count)
+{
+  array->length = length;
+  array->null_count = null_count;
+  array->offset = 0;
+  array->n_buffers = (int64_t)data->m_buffers.size();
+  array->n_children = (int64_t)data->m_children.size();
+  array->buffers = data->m_buffers.data();
+  array->children = data->m_children.empty() ?
+                    nullptr : data->m_children.data();
+  array->dictionary = nullptr;
+  array->release = release_array;
+  array->private_data = data;
+}
+
+
+/*
+  Precision of exported DECIMAL column. If it is not known from the column
+  meta-data, the maximal precision of decimal128 is used.
+*/
+
+unsigned decimal_precision(const Arrow_column &col)
+{
+  unsigned prec = col.m_precision;
+
+  if (0 == prec || prec < col.m_scale)
+    prec = 38;
+  if (prec > 76)
+    prec = 76;
+
+  return prec;
+}
+
+
+std::string arrow_format(const Arrow_column &col)
+{
+  switch (col.m_enc)
+  {
+  case Encoding::SINT:        return "l";
+  case Encoding::UINT:        return "L";
+  case Encoding::FLOAT:       return "f";
+  case Encoding::DOUBLE:      return "g";
+  case Encoding::DATE:        return "tdD";
+  case Encoding::DATETIME:    return "tsu:";
+  case Encoding::TIME:        return "tDu";
+
+  case Encoding::DECIMAL:
+    {
+      unsigned prec = decimal_precision(col);
+      return "d:" + std::to_string(prec) + "," + std::to_string(col.m_scale)
+             + (prec > 38 ? ",256" : "");
+    }
+
+  case Encoding::STRING:
+  case Encoding::STRING_UTF8:
+  case Encoding::DOCUMENT:
+    return "u";
+
+  default:
+    return "z";
+  }
+}
+
+
+// Size of fixed-width values of given column, 0 for variable-length ones.
+
+size_t arrow_width(const Arrow_column &col)
+{
+  switch (col.m_enc)
+  {
+  case Encoding::SINT:
+  case Encoding::UINT:
+  case Encoding::DOUBLE:
+  case Encoding::DATETIME:
+  case Encoding::TIME:
+    return 8;
+
+  case Encoding::FLOAT:
+  case Encoding::DATE:
+    return 4;
+
+  case Encoding::DECIMAL:
+    return decimal_precision(col) > 38 ? 32 : 16;
+
+  default:
+    return 0;
+  }
+}
+
+
+/*
+  Fields of a temporal value decoded from the sequence of varints in which
+  X protocol sends it: year, month, day, hour, minute, second, microseconds
+  for DATE and DATETIME values, a sign byte followed by hours, minutes,
+  seconds and microseconds for TIME values. Missing trailing fields are 0.
+*/
+
+struct Temporal
+{
+  uint64_t m_field[7] = { 0, 0, 0, 0, 0, 0, 0 };
+  bool     m_negative = false;
+
+  Temporal(cdk::bytes data, bool time)
+  {
+    namespace varint = cdk::foundation::varint;
+
+    const byte *pos = data.begin();
+    const byte *end = data.end();
+    unsigned first = 0;
+
+    if (time)
+    {
+      if (pos == end || *pos > 1)
+        THROW("invalid TIME value");
+      m_negative = (1 == *pos++);
+      first = 3;
+    }
+
+    for (unsigned i = first; i < 7 && pos < end; ++i)
+    {
+      size_t sz = varint::decode(pos, end, m_field[i]);
+      if (0 == sz)
+        THROW("temporal value conversion error");
+      pos += sz;
+    }
+
+    if (pos < end
+        || m_field[0] > 9999 || m_field[1] > 12 || m_field[2] > 31
+        || m_field[3] > (time ? 0xFFFF : 23) || m_field[4] > 59
+        || m_field[5] > 59 || m_field[6] > 999999)
+      THROW("invalid temporal value");
+  }
+
+  // Number of days since 1970-01-01 (see common::Datetime::days()).
+
+  int64_t days() const
+  {
+    int64_t y = int64_t(m_field[0]);
+    unsigned m = unsigned(m_field[1]);
+    unsigned d = unsigned(m_field[2]);
+
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = unsigned(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + int64_t(doe) - 719468;
+  }
+
+  // Time part (or TIME value) in microseconds.
+
+  int64_t usecs() const
+  {
+    int64_t us = int64_t((m_field[3] * 3600 + m_field[4] * 60 + m_field[5])
+                         * 1000000 + m_field[6]);
+    return m_negative ? -us : us;
+  }
+};
+
+
+/*
+  Multiply unsigned integer stored in n 64-bit limbs (least significant
+  first) by 10 and add a digit. Returns false if the result does not fit
+  into n limbs with the highest bit clear (so that it can be negated).
+*/
+
+bool mul10_add(uint64_t *limbs, size_t n, unsigned digit)
+{
+  uint64_t carry = digit;
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    // Compute limbs[i] * 10 + carry in 32-bit pieces.
+
+    uint64_t low = (limbs[i] & 0xFFFFFFFF) * 10 + carry;
+    uint64_t high = (limbs[i] >> 32) * 10 + (low >> 32);
+    limbs[i] = (high << 32) | (low & 0xFFFFFFFF);
+    carry = high >> 32;
+  }
+
+  return 0 == carry && 0 == (limbs[n - 1] >> 63);
+}
+
+}  // anonymous namespace
+
+
+void mysqlx::common::export_schema(
+  const Arrow_columns &cols, ArrowSchema *out
+)
+{
+  std::unique_ptr<Schema_data> data(new Schema_data());
+  data->m_format = "+s";
+  data->m_children.reserve(cols.size());
+
+  try {
+
+    for (const Arrow_column &col : cols)
+    {
+      std::unique_ptr<Schema_data> child_data(new Schema_data());
+      child_data->m_format = arrow_format(col);
+      child_data->m_name = col.m_name;
+
+      ArrowSchema *child = new ArrowSchema();
+      init_schema(child, child_data.release(), ARROW_FLAG_NULLABLE);
+      data->m_children.push_back(child);
+    }
+  }
+  catch (...)
+  {
+    ArrowSchema tmp;
+    init_schema(&tmp, data.release(), 0);
+    tmp.release(&tmp);
+    throw;
+  }
+
+  init_schema(out, data.release(), 0);
+}
+
+
+/*
+  Arrow arrays of a single column being built by Arrow_batch. Value in row
+  i is stored at position i of the arrays, so that storing a row which was
+  not completely stored before overwrites its previous data.
+
+  Variable-length values are stored one after another in m_data, with
+  int32 offsets in m_offsets.
+*/
+
+struct Arrow_batch::Column
+{
+  Encoding      m_enc;
+  void         *m_fmt;
+  unsigned      m_scale;
+  size_t        m_width;
+
+  Arrow_buffer  m_valid;
+  Arrow_buffer  m_offsets;
+  Arrow_buffer  m_data;
+
+  Column(const Arrow_column &col, void *fmt)
+    : m_enc(col.m_enc), m_fmt(fmt), m_scale(col.m_scale)
+    , m_width(arrow_width(col))
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    m_valid.resize(0);
+    m_data.resize(0);
+    if (!m_width)
+      m_offsets.resize(sizeof(int32_t));  // first offset is 0
+  }
+
+  int32_t* offsets()
+  {
+    return reinterpret_cast<int32_t*>(m_offsets.m_data);
+  }
+
+  void set_valid(row_count_t row, bool valid)
+  {
+    byte *bits = m_valid.resize(row / 8 + 1);
+    byte mask = byte(1u << (row % 8));
+    if (valid)
+      bits[row / 8] |= mask;
+    else
+      bits[row / 8] &= byte(~mask);
+  }
+
+  byte* slot(row_count_t row)
+  {
+    return m_data.resize((row + 1) * m_width) + row * m_width;
+  }
+
+  bool store_null(row_count_t row);
+  bool store(row_count_t row, cdk::bytes);
+  bool store_bytes(row_count_t row, const byte *data, size_t len);
+  void store_decimal(row_count_t row, cdk::bytes);
+
+  void export_to(ArrowArray*, row_count_t count);
+};
+
+
+bool Arrow_batch::Column::store_null(row_count_t row)
+{
+  set_valid(row, false);
+
+  if (m_width)
+    memset(slot(row), 0, m_width);
+  else
+    store_bytes(row, nullptr, 0);
+
+  return true;
+}
+
+
+/*
+  Returns false if the value does not fit into the arrays (because
+  of int32 offsets), throws error if it can not be converted.
+*/
+
+bool Arrow_batch::Column::store(row_count_t row, cdk::bytes data)
+{
+  namespace varint = cdk::foundation::varint;
+
+  set_valid(row, true);
+
+  switch (m_enc)
+  {
+  case Encoding::SINT:
+  case Encoding::UINT:
+    {
+      uint64_t val;
+
+      if (0 == varint::decode(data.begin(), data.end(), val))
+        THROW("integer conversion error");
+
+      if (Encoding::SINT == m_enc)
+      {
+        int64_t sval = varint::zigzag_decode(val);
+        memcpy(slot(row), &sval, sizeof(sval));
+      }
+      else
+        memcpy(slot(row), &val, sizeof(val));
+
+      return true;
+    }
+
+  case Encoding::FLOAT:
+    {
+      auto &fd = *static_cast<Format_descr<cdk::TYPE_FLOAT>*>(m_fmt);
+      float val;
+      fd.m_codec.from_bytes(data, val);
+      memcpy(slot(row), &val, sizeof(val));
+      return true;
+    }
+
+  case Encoding::DOUBLE:
+    {
+      auto &fd = *static_cast<Format_descr<cdk::TYPE_FLOAT>*>(m_fmt);
+      double val;
+      fd.m_codec.from_bytes(data, val);
+      memcpy(slot(row), &val, sizeof(val));
+      return true;
+    }
+
+  case Encoding::DECIMAL:
+    store_decimal(row, data);
+    return true;
+
+  case Encoding::DATE:
+    {
+      Temporal tv(data, false);
+      int32_t days = (int32_t)tv.days();
+      memcpy(slot(row), &days, sizeof(days));
+      return true;
+    }
+
+  case Encoding::DATETIME:
+    {
+      Temporal tv(data, false);
+      int64_t us = tv.days() * 86400 * 1000000 + tv.usecs();
+      memcpy(slot(row), &us, sizeof(us));
+      return true;
+    }
+
+  case Encoding::TIME:
+    {
+      Temporal tv(data, true);
+      int64_t us = tv.usecs();
+      memcpy(slot(row), &us, sizeof(us));
+      return true;
+    }
+
+  case Encoding::STRING:
+    {
+      // Convert to utf8, as required by Arrow utf8 type.
+
+      auto &fd = *static_cast<Format_descr<cdk::TYPE_STRING>*>(m_fmt);
+      cdk::string str;
+      fd.m_codec.from_bytes(cdk::bytes(data.begin(), data.end() - 1), str);
+      std::string utf8 = str;
+      return store_bytes(row, (const byte*)utf8.data(), utf8.length());
+    }
+
+  case Encoding::STRING_UTF8:
+    {
+      /*
+        Skip the trailing 0x00 byte and strip 0x00 byte at the end, as
+        done when decoding values (see decode<Encoding::STRING_UTF8>).
+      */
+
+      const byte *end = data.end() - 1;
+      if (end > data.begin() && '\0' == *(end - 1))
+        --end;
+      return store_bytes(row, data.begin(), size_t(end - data.begin()));
+    }
+
+  default:
+
+    // Note: Trailing '\0' byte is not part of the data.
+
+    return store_bytes(row, data.begin(), data.size() - 1);
+  }
+}
+
+
+bool Arrow_batch::Column::store_bytes(
+  row_count_t row, const byte *data, size_t len
+)
+{
+  m_offsets.resize((row + 2) * sizeof(int32_t));
+  size_t off = size_t(offsets()[row]);
+
+  if (len > size_t(std::numeric_limits<int32_t>::max()) - off)
+    return false;
+
+  offsets()[row + 1] = int32_t(off + len);
+  byte *buf = m_data.resize(off + len);
+  if (len)
+    memcpy(buf + off, data, len);
+  return true;
+}
+
+
+/*
+  Store DECIMAL value as 128-bit or 256-bit (depending on column precision)
+  two's complement integer scaled to the number of decimals of the column.
+  The value is decoded directly from its packed BCD form: a byte with
+  the scale followed by digits, one per nibble, and a sign nibble (0xC for
+  positive and 0xD for negative values).
+*/
+
+void Arrow_batch::Column::store_decimal(row_count_t row, cdk::bytes data)
+{
+  if (data.size() < 2)
+    THROW("invalid DECIMAL value");
+
+  const byte *digits = data.begin() + 1;
+  unsigned scale = *data.begin();
+  byte sign = *(data.end() - 1);
+  unsigned count = 2 * unsigned(data.size() - 2);
+  bool negative;
+
+  if (0x0C == (sign & 0x0C))
+  {
+    // The high nibble of the sign byte holds the last digit.
+    ++count;
+    negative = 0x0D == (sign & 0x0D);
+  }
+  else if (0xC0 == (sign & 0xC0))
+    negative = 0xD0 == (sign & 0xD0);
+  else
+    THROW("invalid DECIMAL value");
+
+  if (scale > m_scale)
+    THROW("DECIMAL value has more decimal digits than its column");
+
+  uint64_t limbs[4] = { 0, 0, 0, 0 };
+  size_t n = m_width / sizeof(uint64_t);
+
+  for (unsigned pos = 0; pos < count; ++pos)
+  {
+    byte b = digits[pos / 2];
+    unsigned digit = (pos % 2) ? (b & 0x0F) : (b >> 4);
+
+    if (digit > 9)
+      THROW("invalid DECIMAL value");
+    if (!mul10_add(limbs, n, digit))
+      THROW("DECIMAL value out of range");
+  }
+
+  for (; scale < m_scale; ++scale)
+    if (!mul10_add(limbs, n, 0))
+      THROW("DECIMAL value out of range");
+
+  if (negative)
+  {
+    bool carry = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+      limbs[i] = ~limbs[i] + (carry ? 1 : 0);
+      carry = carry && 0 == limbs[i];
+    }
+  }
+
+  // Note: Arrow uses native byte order, here we assume little-endian.
+
+  memcpy(slot(row), limbs, m_width);
+}
+
+
+void Arrow_batch::Column::export_to(ArrowArray *out, row_count_t count)
+{
+  int64_t null_count = 0;
+
+  m_valid.resize(count / 8 + 1);
+  for (row_count_t row = 0; row < count; ++row)
+    if (!(m_valid.m_data[row / 8] & (1u << (row % 8))))
+      ++null_count;
+
+  std::unique_ptr<Array_data> data(new Array_data());
+
+  data->m_buffers.push_back(null_count ? m_valid.release() : nullptr);
+
+  if (!m_width)
+  {
+    m_offsets.resize((count + 1) * sizeof(int32_t));
+    data->m_buffers.push_back(m_offsets.release());
+  }
+
+  m_data.resize(m_width ? count * m_width : m_data.m_size);
+  data->m_buffers.push_back(m_data.release());
+
+  init_array(out, data.release(), (int64_t)count, null_count);
+  reset();
+}
+
+
+Arrow_batch::Arrow_batch(const Meta_data_base &md, const Arrow_columns &cols)
+{
+  const Decoder_plan<Value> &plan = md.get_plan<Value>();
+
+  assert(cols.size() == md.col_count());
+  m_cols.reserve(cols.size());
+
+  for (col_count_t pos = 0; pos < cols.size(); ++pos)
+    m_cols.emplace_back(new Column(cols[pos], plan.m_cols[pos].m_fmt));
+}
+
+
+Arrow_batch::~Arrow_batch()
+{}
+
+
+bool Arrow_batch::error(col_count_t pos, const char *msg)
+{
+  std::ostringstream buf;
+  buf << "Column #" << pos + 1 << ": " << msg;
+  m_error = buf.str();
+  return false;
+}
+
+
+bool Arrow_batch::store(const Row_data &row)
+{
+  /*
+    Note: Row_data is ordered by column position. Columns not present
+    in it hold NULL values, as do fields with empty data.
+  */
+
+  auto field = row.begin();
+
+  for (col_count_t pos = 0; pos < m_cols.size(); ++pos)
+  {
+    while (field != row.end() && field->first < pos)
+      ++field;
+
+    Column &col = *m_cols[pos];
+
+    try {
+
+      bool ok;
+
+      if (field == row.end() || field->first != pos
+          || 0 == field->second.size())
+        ok = col.store_null(m_count);
+      else
+        ok = col.store(m_count, field->second.data());
+
+      if (!ok)
+        return false;
+    }
+    catch (const std::bad_alloc&)
+    {
+      return error(pos, "not enough memory to store the value");
+    }
+    catch (const std::exception &err)
+    {
+      return error(pos, err.what());
+    }
+  }
+
+  ++m_count;
+  return true;
+}
+
+
+void Arrow_batch::export_to(ArrowArray *out)
+{
+  std::unique_ptr<Array_data> data(new Array_data());
+
+  // Struct array has only the validity buffer, which is not needed.
+
+  data->m_buffers.push_back(nullptr);
+  data->m_children.reserve(m_cols.size());
+
+  try {
+
+    for (auto &col : m_cols)
+    {
+      std::unique_ptr<ArrowArray> child(new ArrowArray());
+      col->export_to(child.get(), m_count);
+      data->m_children.push_back(child.release());
+    }
+  }
+  catch (...)
+  {
+    ArrowArray tmp;
+    init_array(&tmp, data.release(), 0, 0);
+    tmp.release(&tmp);
+    throw;
+  }
+
+  init_array(out, data.release(), (int64_t)m_count, 0);
+  m_count = 0;
+}
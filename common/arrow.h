@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_COMMON_ARROW_INT_H
+#define MYSQLX_COMMON_ARROW_INT_H
+
+#include <mysqlx/common/arrow.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "result.h"
+
+
+namespace mysqlx {
+namespace common {
+
+/*
+  Export of result sets through Arrow C Data Interface
+  ====================================================
+
+  Schema of a result is exported as a struct ("+s") with one nullable child
+  field per column. Rows are exported in batches, each batch being a struct
+  array with one child array per column. Column types are mapped to Arrow
+  types as follows:
+
+  - signed/unsigned integers: int64 ("l") / uint64 ("L"),
+  - FLOAT and DOUBLE: float32 ("f") and float64 ("g"),
+  - DECIMAL: decimal128 with precision and scale of the column, or
+    decimal256 if precision is greater than 38,
+  - strings and documents: utf8 ("u"), strings in other character sets are
+    converted to utf8,
+  - SET values and other types: binary ("z") holding the raw bytes,
+  - DATE: date32 ("tdD"), DATETIME and TIMESTAMP: timestamp in microseconds
+    without time zone ("tsu:"), TIME: duration in microseconds ("tDu").
+
+  Arrow structures returned to the caller own all their memory, which is
+  freed by the release callbacks. They remain valid after the result is
+  destroyed.
+*/
+
+/*
+  Information about a result column needed to export it.
+*/
+
+struct Arrow_column
+{
+  std::string m_name;    // utf8 encoded column label
+  Encoding    m_enc;
+  unsigned    m_scale;      // number of decimals (for DECIMAL columns)
+  unsigned    m_precision;  // number of digits (for DECIMAL columns)
+};
+
+using Arrow_columns = std::vector<Arrow_column>;
+
+
+/*
+  Store description of given columns in the ArrowSchema structure.
+*/
+
+void export_schema(const Arrow_columns&, ArrowSchema*);
+
+
+/*
+  Row sink which builds Arrow arrays from rows passed to it by
+  Result_impl_base::fetch_into(). Once rows are stored, method export_to()
+  moves the arrays to the caller provided ArrowArray structure, after which
+  the batch is empty again.
+*/
+
+class Arrow_batch
+  : public Row_sink
+{
+public:
+
+  Arrow_batch(const Meta_data_base&, const Arrow_columns&);
+  ~Arrow_batch();
+
+  bool store(const Row_data&) override;
+
+  const char* error() const override
+  {
+    return m_error.empty() ? nullptr : m_error.c_str();
+  }
+
+  row_count_t count() const
+  {
+    return m_count;
+  }
+
+  void export_to(ArrowArray*);
+
+private:
+
+  struct Column;
+
+  std::vector<std::unique_ptr<Column>> m_cols;
+  row_count_t m_count = 0;
+  std::string m_error;
+
+  bool error(col_count_t pos, const char *msg);
+};
+
+
+template <typename STR>
+Arrow_columns get_arrow_columns(const Result_impl<STR> &res)
+{
+  if (!res.get_mdata())
+    THROW("No result set");
+
+  const Meta_data_base &md = *res.get_mdata();
+  Arrow_columns cols;
+
+  for (col_count_t pos = 0; pos < md.col_count(); ++pos)
+  {
+    const Column_info<STR> &ci = res.get_column(pos);
+    std::string name = ci.m_label;
+    Encoding enc = get_encoding(ci);
+    unsigned precision = 0;
+
+    /*
+      Display length of DECIMAL(M,D) column is M plus one position for
+      the decimal point (if D > 0) and one for the sign (unless UNSIGNED).
+    */
+
+    if (Encoding::DECIMAL == enc)
+    {
+      unsigned long extra = (ci.m_decimals ? 1 : 0)
+        + (ci.template get<cdk::TYPE_FLOAT>().m_format.is_unsigned() ? 0 : 1);
+      if (ci.m_length > extra)
+        precision = unsigned(ci.m_length - extra);
+    }
+
+    cols.push_back({ name, enc, ci.m_decimals, precision });
+  }
+
+  return cols;
+}
+
+
+/*
+  Describe columns of the current result set in the ArrowSchema structure.
+*/
+
+template <typename STR>
+void get_arrow_schema(const Result_impl<STR> &res, ArrowSchema *out)
+{
+  export_schema(get_arrow_columns(res), out);
+}
+
+
+/*
+  Fetch at most batch_size rows from the current result set and store them
+  in the ArrowArray structure. Returns the number of rows fetched. If there
+  are no more rows, 0 is returned and out->release is set to null.
+*/
+
+template <typename STR>
+row_count_t fetch_arrow(
+  Result_impl<STR> &res, ArrowArray *out, row_count_t batch_size
+)
+{
+  Arrow_columns cols = get_arrow_columns(res);
+  Arrow_batch batch(*res.get_mdata(), cols);
+  row_count_t cnt = res.fetch_into(batch, batch_size);
+
+  if (0 == cnt)
+  {
+    out->release = nullptr;
+    return 0;
+  }
+
+  batch.export_to(out);
+  return cnt;
+}
+
+}}  // mysqlx::common
+
+#endif
@@ -328,11 +328,7 @@ void Op_idx_create::process(cdk::Any::Document::Processor &prc) const
 {
   prc.doc_begin();
 
-  for (auto it : m_map)
-  {
-    Value_scalar val(it.second);
-    val.process_if(prc.key_val(it.first));
-  }
+  process_params(prc);
 
   // Remove this later
   safe_prc(prc)->key_val("unique")->scalar()->yesno(false);
@@ -32,6 +32,7 @@
 #define MYSQLX_COMMON_DB_OBJECT_H
 
 #include <mysql/cdk.h>
+#include <chrono>
 
 
 namespace mysqlx {
@@ -40,6 +41,114 @@ namespace mysqlx {
 
 namespace common {
 
+  enum class Object_type
+  {
+    SCHEMA,
+    COLLECTION,
+    TABLE,
+    VIEW
+  };
+
+
+  /*
+    Cache of database catalog information
+    =====================================
+
+    Checking whether a schema, collection or table exists requires a round
+    trip to the server. To avoid repeating these queries, their results are
+    stored in a process-wide cache which is shared by all sessions connected
+    to the same server. Entries are indexed by a string which identifies the
+    server (see Session_impl::set_catalog()), the schema name and the object
+    name, which is empty for an entry describing the schema itself.
+
+    An entry is a set of Object_type bits: for a schema it is either empty
+    (schema does not exist) or contains SCHEMA bit; for other objects it
+    tells whether the name refers to a collection, a table or a view (note
+    that a collection is also reported by the server as a table). An empty
+    set means that the object does not exist.
+
+    Each entry remembers when it was stored and get() ignores entries which
+    are older than the time-to-live given by the caller. Entries are
+    invalidated when objects are created or dropped through this connector.
+    Changes done by other clients or by plain SQL statements are seen only
+    after the entries expire.
+
+    To avoid storing information obtained before a concurrent invalidation,
+    the caller takes the current epoch() before querying the server and
+    passes it to put(), which ignores the information if any invalidation
+    happened in the meantime.
+
+    The cache holds a bounded number of entries and the least recently used
+    entry is removed when a new one is added to the full cache.
+  */
+
+  class Catalog_cache
+  {
+  public:
+
+    using Types = unsigned;
+    using Epoch = unsigned long long;
+
+    static Types type_bit(Object_type type)
+    {
+      return 1U << unsigned(type);
+    }
+
+    /*
+      Find information about the given object (or schema, if the name is
+      empty) stored less than `ttl` ago. Returns false if there is no such
+      information.
+    */
+
+    static bool get(
+      const std::string &server,
+      const cdk::string &schema, const cdk::string &name,
+      std::chrono::milliseconds ttl, Types &types
+    );
+
+    static void put(
+      const std::string &server,
+      const cdk::string &schema, const cdk::string &name,
+      Types types, Epoch epoch
+    );
+
+    /*
+      Remove information about the given object. If the name is empty,
+      information about the schema and all objects in it is removed.
+
+      Entries for all servers and users are removed: a session can not tell
+      whether another user, host list or socket leads to the same server,
+      and removing too much only costs an extra query.
+    */
+
+    static void invalidate(
+      const cdk::string &schema, const cdk::string &name
+    );
+
+    static Epoch epoch();
+
+    /*
+      Set the maximum number of entries in the cache. Setting it to 0
+      disables caching.
+    */
+
+    static void set_capacity(size_t);
+    static size_t capacity();
+
+    // Current number of entries in the cache.
+
+    static size_t size();
+
+    // Number of lookups that were served from the cache.
+
+    static size_t hits();
+
+    static void clear();
+
+    static const size_t default_capacity = 4096;
+  };
+
+
   class Object_ref;
 
   class Schema_ref : public cdk::api::Schema_ref
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include <mysqlx/common.h>
+#include <mysql/cdk.h>
+
+#include "op_impl.h"
+
+#include <vector>
+#include <cstring>
+
+
+using namespace ::mysqlx::common;
+
+
+/*
+  Expression processor which translates expression reported by Expr_if
+  interface to calls of CDK expression processor.
+
+  Arguments of operators and function calls are reported to the CDK
+  argument list processors which are kept on a stack (a null entry on
+  the stack means that the processor ignores the arguments).
+*/
+
+class Expr_builder
+  : public Expr_if::Processor
+{
+  using Any_prc = cdk::Expression::Processor;
+  using Scalar_prc = cdk::Expression::Scalar::Processor;
+  using Args_prc = Scalar_prc::Args_prc;
+  using string = cdk::string;
+
+  parser::Parser_mode::value m_mode;
+  Any_prc  *m_prc;
+  std::vector<Args_prc*> m_args;
+
+public:
+
+  Expr_builder(parser::Parser_mode::value mode, Any_prc &prc)
+    : m_mode(mode), m_prc(&prc)
+  {}
+
+private:
+
+  /*
+    Return processor for the next reported expression, which is either
+    the top-level expression or the next argument of the current operator
+    or function call.
+  */
+
+  Scalar_prc* scalar()
+  {
+    Any_prc *prc = nullptr;
+
+    if (m_args.empty())
+      std::swap(prc, m_prc);
+    else if (m_args.back())
+      prc = m_args.back()->list_el();
+
+    return prc ? prc->scalar() : nullptr;
+  }
+
+  void begin(Args_prc *args)
+  {
+    if (args)
+      args->list_begin();
+    m_args.push_back(args);
+  }
+
+  // Expr_if::Processor
+
+  void field(const char *name) override;
+
+  void param(const char *name) override
+  {
+    Scalar_prc *sprc = scalar();
+    if (sprc)
+      sprc->param(string(name));
+  }
+
+  void val(const Value &val) override
+  {
+    Scalar_prc *sprc = scalar();
+    cdk::Value_processor *vprc = sprc ? sprc->val() : nullptr;
+    if (vprc)
+      Value::Access::process_val(val, *vprc);
+  }
+
+  void op_begin(const char *name) override
+  {
+    Scalar_prc *sprc = scalar();
+    begin(sprc ? sprc->op(name) : nullptr);
+  }
+
+  void call_begin(const char *name) override
+  {
+    Scalar_prc *sprc = scalar();
+    if (!sprc)
+      return begin(nullptr);
+
+    std::vector<string> parts = split(name);
+    parser::Table_ref func;
+
+    switch (parts.size())
+    {
+    case 1: func.set(parts[0]); break;
+    case 2: func.set(parts[1], parts[0]); break;
+    default:
+      throw_error("Invalid function name");
+    }
+
+    begin(sprc->call(func));
+  }
+
+  void args_end() override
+  {
+    assert(!m_args.empty());
+    if (m_args.back())
+      m_args.back()->list_end();
+    m_args.pop_back();
+  }
+
+  /*
+    Split name into components separated by dots. Empty components are
+    not allowed.
+  */
+
+  static std::vector<string> split(const char *name)
+  {
+    std::vector<string> parts;
+
+    for (const char *beg = name;; )
+    {
+      const char *end = strchr(beg, '.');
+      std::string part(beg, end ? end : beg + strlen(beg));
+      if (part.empty())
+        throw_error("Invalid name in expression");
+      parts.emplace_back(part);
+      if (!end)
+        break;
+      beg = end + 1;
+    }
+
+    return parts;
+  }
+};
+
+
+/*
+  In document mode field name is a document path "a.b.c" (optionally
+  starting with "$."), in table mode it is a column name "[[s.]t.]c".
+*/
+
+void Expr_builder::field(const char *name)
+{
+  Scalar_prc *sprc = scalar();
+  if (!sprc)
+    return;
+
+  if (parser::Parser_mode::DOCUMENT == m_mode)
+  {
+    cdk::Doc_path_storage path;
+
+    if ('$' == name[0])
+    {
+      if (!name[1])
+      {
+        static_cast<cdk::Doc_path::Processor&>(path).whole_document();
+        sprc->ref(path);
+        return;
+      }
+      if ('.' != name[1])
+        throw_error("Invalid document path in expression");
+      name += 2;
+    }
+
+    for (const string &member : split(name))
+      path.list_el()->member(member);
+
+    sprc->ref(path);
+    return;
+  }
+
+  std::vector<string> parts = split(name);
+  parser::Column_ref col;
+
+  switch (parts.size())
+  {
+  case 1: col.set(parts[0]); break;
+  case 2: col.set(parts[1], parts[0]); break;
+  case 3: col.set(parts[2], parts[1], parts[0]); break;
+  default:
+    throw_error("Invalid column name in expression");
+  }
+
+  sprc->ref(col, nullptr);
+}
+
+
+std::shared_ptr<parser::Expr_cache::Parsed>
+mysqlx::common::store_expr(
+  parser::Parser_mode::value mode, const Expr_if &expr
+)
+{
+  std::shared_ptr<parser::Expr_cache::Parsed>
+    stored(new parser::Expr_cache::Parsed());
+
+  Expr_builder builder(mode, stored->m_expr);
+  expr.process(builder);
+
+  return stored;
+}
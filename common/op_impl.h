@@ -50,15 +50,6 @@
 namespace mysqlx {
 namespace common {
 
-enum class Object_type
-{
-  SCHEMA,
-  COLLECTION,
-  TABLE,
-  VIEW
-};
-
-
 /*
   Base for CRUD operation implementation classes.
 
@@ -103,6 +94,27 @@ protected:
   bool m_inited = false;
   bool m_completed = false;
 
+  /*
+    Serialized form of the find command sent by this operation, reused
+    by subsequent executions which differ only in parameter values or
+    limits. Methods that change other parts of the operation definition
+    must reset it. The cache is not copied to clones of the operation.
+  */
+
+  cdk::mysqlx::Find_cache m_find_cache;
+
+  /*
+    Client-side cache for results of this operation, if set (see
+    Result_cache). The cache is used only if the operation is read-only and
+    it can build a key which identifies its result (see cache_key()). If
+    result is found in the cache, m_cached holds the cache entry and no
+    command is sent to the server.
+  */
+
+  Shared_result_cache        m_result_cache;
+  std::string                m_cache_key;
+  Result_cache::Shared_entry m_cached;
+
 public:
 
   Op_base(const Shared_session_impl &sess)
@@ -118,17 +130,58 @@ public:
 
   Op_base(const Op_base& other)
     : m_sess(other.m_sess)
+    , m_result_cache(other.m_result_cache)
   {}
 
   virtual ~Op_base()
   {}
 
+  /*
+    Return CDK session over which this operation should be sent. With
+    read/write splitting this depends on whether the operation is read-only.
+  */
+
   cdk::Session& get_cdk_session()
+  {
+    assert(m_sess);
+    return m_sess->get_cdk_session(is_read_only());
+  }
+
+  /*
+    Return CDK session used to build cache keys (see cache_key()). Unlike
+    get_cdk_session(), this does not take part in read/write splitting, so
+    that building a key does not open a replica connection nor affect
+    the sticky window.
+  */
+
+  cdk::Session& get_key_session()
   {
     assert(m_sess);
     return m_sess->m_sess;
   }
 
+  /*
+    Operations which do not modify data and can be executed on a replica
+    should override this method.
+  */
+
+  virtual bool is_read_only() const
+  {
+    return false;
+  }
+
+  /*
+    Operations which can use client-side result cache should override this
+    method to store in `key` the serialized command that would be sent to
+    the server, including values of bound parameters. Returns false if such
+    key can not be built.
+  */
+
+  virtual bool cache_key(std::string&)
+  {
+    return false;
+  }
+
   // Async execution
 
   /*
@@ -158,6 +211,21 @@ public:
     */
 
     m_sess->prepare_for_cmd();
+
+    m_cached.reset();
+    m_cache_key.clear();
+
+    if (m_result_cache && is_read_only() && cache_key(m_cache_key))
+    {
+      const std::string &server = m_sess->server_key();
+      m_cache_key.insert(0, std::to_string(server.size()) + ':' + server);
+      m_cached = m_result_cache->get(m_cache_key);
+      if (m_cached)
+        return;
+    }
+    else
+      m_cache_key.clear();
+
     m_reply.reset(send_command());
   }
 
@@ -331,6 +399,17 @@ protected:
 
     return m_reply.release();
   }
+
+  void init_cache(Result_impl_base &res) override
+  {
+    if (m_cached)
+      res.replay(m_cached);
+    else if (!m_cache_key.empty())
+      res.cache_into(m_result_cache, m_cache_key);
+
+    m_cached.reset();
+    m_cache_key.clear();
+  }
 };
 
 
@@ -339,6 +418,14 @@ protected:
   interface methods which handle storing values of named parameters. It
   works only for named parameters.
 
+  Values are stored in a vector of slots, one slot per parameter name. A slot
+  is created when a parameter is bound for the first time and is kept for
+  the lifetime of the operation, also when parameters are cleared. Binding
+  a parameter again overwrites the value in its slot, which for scalar values
+  does not allocate memory. Since parameters are usually bound in the same
+  order before each execution, the slot following the last one used is
+  checked first when looking for a parameter name.
+
   Method get_params() returns stored parameter values in the form expected by
   CDK (cdk::Param_source). It returns NULL if no parameter values were defined.
 */
@@ -356,19 +443,46 @@ protected:
   Op_bind(Shared_session_impl sess) : Base(sess)
   {}
 
-  typedef std::map<cdk::string, Value> param_map_t;
-  param_map_t m_map;
+  struct Param_slot
+  {
+    string      m_name;   // name used for lookups in add_param()
+    cdk::string m_key;    // name reported to CDK
+    Value       m_val;
+    bool        m_bound;
+
+    Param_slot(const string &name, const Value &val)
+      : m_name(name), m_key(name), m_val(val), m_bound(true)
+    {}
+  };
+
+  std::vector<Param_slot> m_params;
+  size_t m_bound_count = 0;
+  size_t m_next_slot = 0;
 
   // Parameters
 
   void add_param(const string &name, const Value &val) override
   {
-    auto el = m_map.emplace(name, val);
-    //substitute if exists
-    if (!el.second)
+    size_t pos = find_slot(name);
+
+    if (pos == m_params.size())
+    {
+      m_params.emplace_back(name, val);
+      ++m_bound_count;
+    }
+    else
     {
-      el.first->second = val;
+      Param_slot &slot = m_params[pos];
+      //substitute if exists
+      slot.m_val = val;
+      if (!slot.m_bound)
+      {
+        slot.m_bound = true;
+        ++m_bound_count;
+      }
     }
+
+    m_next_slot = pos + 1;
   }
 
   void add_param(Value) override
@@ -378,21 +492,53 @@ protected:
 
   void clear_params() override
   {
-    m_map.clear();
+    for (Param_slot &slot : m_params)
+      slot.m_bound = false;
+    m_bound_count = 0;
+    m_next_slot = 0;
   }
 
-  // cdk::Param_source
+  /*
+    Return position of the slot for parameter with the given name or
+    m_params.size() if there is no such slot.
+  */
 
-  void process(Processor &prc) const override
+  size_t find_slot(const string &name) const
   {
-    prc.doc_begin();
+    size_t count = m_params.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      size_t pos = (m_next_slot + i) % count;
+      if (m_params[pos].m_name == name)
+        return pos;
+    }
+
+    return count;
+  }
+
+  /*
+    Report values of bound parameters as keys of a document, without
+    the surrounding doc_begin()/doc_end() callbacks.
+  */
 
-    for (auto it : m_map)
+  void process_params(Processor &prc) const
+  {
+    for (const Param_slot &slot : m_params)
     {
-      Value_scalar val(it.second);
-      val.process_if(prc.key_val(it.first));
+      if (!slot.m_bound)
+        continue;
+      Value_scalar val(slot.m_val);
+      val.process_if(prc.key_val(slot.m_key));
     }
+  }
+
+  // cdk::Param_source
 
+  void process(Processor &prc) const override
+  {
+    prc.doc_begin();
+    process_params(prc);
     prc.doc_end();
   }
 
@@ -400,7 +546,7 @@ public:
 
   cdk::Param_source* get_params()
   {
-    return m_map.empty() ? nullptr : this;
+    return 0 == m_bound_count ? nullptr : this;
   }
 
 };
@@ -476,6 +622,21 @@ protected:
 };
 
 
+/*
+  Convert expression given by Expr_if interface (see op_if.h) to the form
+  in which parsed expressions are stored (see parser::Expr_cache). Field
+  references are interpreted as document paths or column references,
+  depending on the parser mode. The returned object can be used to create
+  parser::Cached_expr and other such objects.
+
+  Note: The expression is reported only once and no parsing is done, but
+  field names are split into path or column name components here.
+*/
+
+std::shared_ptr<parser::Expr_cache::Parsed>
+store_expr(parser::Parser_mode::value, const Expr_if&);
+
+
 /*
   This template adds to the given Base class implementations of Sort_if
   interface methods which specify sorting of a query results.
@@ -490,6 +651,7 @@ protected:
 template <parser::Parser_mode::value PM, class Base>
 class Op_sort
   : public Base
+  , public common::Sort_expr_if
   , cdk::Order_by
 {
 protected:
@@ -506,6 +668,7 @@ protected:
       PARSE = ASC + DESC + 1
     } m_dir;
     string m_expr;
+    parser::Expr_cache::Entry m_stored;
 
     order_item(const string &expr)
       : m_dir(PARSE), m_expr(expr)
@@ -514,22 +677,40 @@ protected:
     order_item(const string &expr, direction_t dir)
       : m_dir(Base::ASC == dir ? ASC : DESC), m_expr(expr)
     {}
+
+    // Note: stored sort key includes the direction.
+
+    order_item(const parser::Expr_cache::Entry &stored)
+      : m_dir(PARSE), m_stored(stored)
+    {}
   };
 
   std::list<order_item> m_order;
 
   void add_sort(const string &expr, direction_t dir) override
   {
+    this->m_find_cache.reset();
     m_order.emplace_back(expr, dir);
   }
 
   void add_sort(const string &sort) override
   {
+    this->m_find_cache.reset();
     m_order.emplace_back(sort);
   }
 
+  void add_sort(const Expr_if &expr, direction_t dir) override
+  {
+    auto stored = store_expr(PM, expr);
+    stored->m_dir = (Base::ASC == dir ? cdk::api::Sort_direction::ASC
+                                      : cdk::api::Sort_direction::DESC);
+    this->m_find_cache.reset();
+    m_order.emplace_back(std::move(stored));
+  }
+
   void clear_sort() override
   {
+    this->m_find_cache.reset();
     m_order.clear();
   }
 
@@ -562,17 +743,23 @@ private:
       case order_item::ASC:
       case order_item::DESC:
         {
-          parser::Expression_parser parser(PM, item.m_expr);
-          parser.process_if(el->sort_key(
+          parser::Cached_expr expr(PM, item.m_expr);
+          expr.process_if(el->sort_key(
             cdk::api::Sort_direction::value(item.m_dir)
           ));
         }
         break;
 
       case order_item::PARSE:
+        if (item.m_stored)
+        {
+          parser::Cached_order order(item.m_stored);
+          order.process_if(el);
+        }
+        else
         {
-          parser::Order_parser order_parser(PM, item.m_expr);
-          order_parser.process_if(el);
+          parser::Cached_order order(PM, item.m_expr);
+          order.process_if(el);
         }
         break;
       }
@@ -614,11 +801,13 @@ public:
 
   void set_having(const string &having) override
   {
+    this->m_find_cache.reset();
     m_having = having;
   }
 
   void clear_having() override
   {
+    this->m_find_cache.reset();
     m_having.clear();
   }
 
@@ -633,8 +822,8 @@ private:
 
   void process(cdk::Expression::Processor& prc) const override
   {
-    parser::Expression_parser expr_parser(PM, m_having);
-    expr_parser.process(prc);
+    parser::Cached_expr expr(PM, m_having);
+    expr.process(prc);
   }
 };
 
@@ -664,11 +853,13 @@ public:
 
   void add_group_by(const string &group_by) override
   {
+    this->m_find_cache.reset();
     m_group_by.push_back(group_by);
   }
 
   void clear_group_by() override
   {
+    this->m_find_cache.reset();
     m_group_by.clear();
   }
 
@@ -690,8 +881,8 @@ private:
 
     for (string el : m_group_by)
     {
-      parser::Expression_parser expr_parser(PM, el);
-      expr_parser.process_if(prc.list_el());
+      parser::Cached_expr expr(PM, el);
+      expr.process_if(prc.list_el());
     }
 
     prc.list_end();
@@ -709,11 +900,15 @@ private:
   returns projection specified for a document query as a single document
   specification expected by CDK. These methods return NULL if no projections
   were specified.
+
+  The PM template parameter tells in which mode the projection expressions
+  passed via Expr_if interface should be interpreted.
 */
 
-template <class Base>
+template <parser::Parser_mode::value PM, class Base>
 class Op_projection
     : public Base
+    , public common::Proj_expr_if
     , cdk::Projection
     , cdk::Expression::Document
 {
@@ -721,7 +916,35 @@ protected:
 
   using string = std::wstring;
 
-  std::vector<string> m_projections;
+  /*
+    Projections given as strings or, if m_stored is set, as expressions
+    converted by store_expr().
+  */
+
+  struct proj_item
+  {
+    string m_proj;
+    parser::Expr_cache::Entry m_stored;
+
+    proj_item(const string &proj)
+      : m_proj(proj)
+    {}
+
+    proj_item(const parser::Expr_cache::Entry &stored)
+      : m_stored(stored)
+    {}
+
+    template <class Proj>
+    void process(parser::Parser_mode::value pm, Proj &prc) const
+    {
+      if (m_stored)
+        parser::Cached_projection(m_stored).process(prc);
+      else
+        parser::Cached_projection(pm, m_proj).process(prc);
+    }
+  };
+
+  std::vector<proj_item> m_projections;
   string  m_doc_proj;
 
   using Shared_session_impl = typename Base::Shared_session_impl;
@@ -733,16 +956,31 @@ public:
 
   void set_proj(const string& doc) override
   {
+    this->m_find_cache.reset();
     m_doc_proj = doc;
   }
 
   void add_proj(const string& field) override
   {
-    m_projections.push_back(field);
+    this->m_find_cache.reset();
+    m_projections.emplace_back(field);
+  }
+
+  void add_proj(const Expr_if &expr, const string &alias) override
+  {
+    if (alias.empty() && parser::Parser_mode::DOCUMENT == PM)
+      throw_error("Document projection requires an alias");
+
+    auto stored = store_expr(PM, expr);
+    stored->m_has_alias = !alias.empty();
+    stored->m_alias = alias;
+    this->m_find_cache.reset();
+    m_projections.emplace_back(std::move(stored));
   }
 
   void clear_proj() override
   {
+    this->m_find_cache.reset();
     m_projections.clear();
   }
 
@@ -798,25 +1036,16 @@ private:
 
       eprc.m_prc = &prc;
 
-      parser::Expression_parser parser(
-        parser::Parser_mode::DOCUMENT, m_doc_proj
-      );
-
-      parser.process(eprc);
+      parser::Cached_expr expr(parser::Parser_mode::DOCUMENT, m_doc_proj);
+      expr.process(eprc);
 
       return;
     }
 
     prc.doc_begin();
 
-    for (string field : m_projections)
-    {
-      parser::Projection_parser parser(
-        parser::Parser_mode::DOCUMENT, field
-      );
-
-      parser.process(prc);
-    }
+    for (const proj_item &field : m_projections)
+      field.process(parser::Parser_mode::DOCUMENT, prc);
 
     prc.doc_end();
 
@@ -828,13 +1057,12 @@ private:
   {
     prc.list_begin();
 
-    for (string el : m_projections)
+    for (const proj_item &el : m_projections)
     {
 
-      parser::Projection_parser order_parser(parser::Parser_mode::TABLE, el);
       auto prc_el = prc.list_el();
       if (prc_el)
-        order_parser.process(*prc_el);
+        el.process(parser::Parser_mode::TABLE, *prc_el);
 
     }
 
@@ -858,7 +1086,9 @@ private:
 */
 
 template <parser::Parser_mode::value PM, class Base>
-class Op_select : public Base
+class Op_select
+  : public Base
+  , public common::Select_expr_if
 {
 protected:
 
@@ -867,19 +1097,20 @@ protected:
 
   string m_where_expr;
   bool   m_where_set = false;
-  std::unique_ptr<parser::Expression_parser> m_expr;
+  parser::Expr_cache::Entry m_where_stored;
+  std::unique_ptr<parser::Cached_expr> m_expr;
   cdk::Lock_mode_value        m_lock_mode = cdk::api::Lock_mode::NONE;
   cdk::Lock_contention_value
     m_lock_contention = cdk::api::Lock_contention::DEFAULT;
 
 
-  // Note: we do not copy m_expr to avoid invoking copy ctor
-  // for Expression_parser
+  // Note: we do not copy m_expr, it is re-created by get_where()
 
   Op_select(const Op_select &other)
     : Base(other)
     , m_where_expr(other.m_where_expr)
     , m_where_set(other.m_where_set)
+    , m_where_stored(other.m_where_stored)
     , m_lock_mode(other.m_lock_mode)
     , m_lock_contention(other.m_lock_contention)
   {}
@@ -891,7 +1122,17 @@ public:
 
   void set_where(const string &expr) override
   {
+    this->m_find_cache.reset();
     m_where_expr = expr;
+    m_where_stored.reset();
+    m_where_set = true;
+  }
+
+  void set_where(const Expr_if &expr) override
+  {
+    this->m_find_cache.reset();
+    m_where_expr.clear();
+    m_where_stored = store_expr(PM, expr);
     m_where_set = true;
   }
 
@@ -899,18 +1140,28 @@ public:
   {
     // Note: assumes the cdk::Lock_mode enum uses the same values as
     // common::Select_if::Lock_mode.
+    this->m_find_cache.reset();
     m_lock_mode = cdk::Lock_mode_value(lm);
     m_lock_contention = cdk::Lock_contention_value(int(contention));
   }
 
   void clear_lock_mode() override
   {
+    this->m_find_cache.reset();
     m_lock_mode = cdk::api::Lock_mode::NONE;
     m_lock_contention = cdk::api::Lock_contention::DEFAULT;
   }
 
   cdk::Expression* get_where() const
   {
+    auto *self = const_cast<Op_select*>(this);
+
+    if (m_where_stored)
+    {
+      self->m_expr.reset(new parser::Cached_expr(m_where_stored));
+      return m_expr.get();
+    }
+
     if (m_where_expr.empty())
     {
       if (m_where_set)
@@ -918,9 +1169,7 @@ public:
       return NULL;
     }
 
-    auto *self = const_cast<Op_select*>(this);
-
-    self->m_expr.reset(new parser::Expression_parser(PM, m_where_expr));
+    self->m_expr.reset(new parser::Cached_expr(PM, m_where_expr));
     return m_expr.get();
   }
 };
@@ -941,12 +1190,27 @@ struct Op_sql
 
   string m_query;
 
-  typedef std::list<Value> param_list_t;
+  /*
+    Note: the vector keeps its capacity when parameters are cleared after
+    execution, so that binding the same number of scalar values for the next
+    execution does not allocate memory.
+  */
+
+  typedef std::vector<Value> param_list_t;
+
+  // Kind of the query, used for read/write splitting.
+
+  Sql_kind m_kind;
 
   Op_sql(Shared_session_impl sess, const string &query)
-    : Op_base(sess), m_query(query)
+    : Op_base(sess), m_query(query), m_kind(get_sql_kind(query))
   {}
 
+  bool is_read_only() const override
+  {
+    return Sql_kind::READ == m_kind;
+  }
+
   /*
     An object which presents parameter values as CDK list.
   */
@@ -1010,6 +1274,20 @@ struct Op_sql
 
   cdk::Reply* send_command() override
   {
+    switch (m_kind)
+    {
+    case Sql_kind::TRX_BEGIN: m_sess->m_sql_trx_open = true;  break;
+    case Sql_kind::TRX_END:   m_sess->m_sql_trx_open = false; break;
+    case Sql_kind::AUTOCOMMIT_OFF: m_sess->m_autocommit_off = true; break;
+    case Sql_kind::AUTOCOMMIT_ON:
+      // Switching autocommit on commits the open transaction.
+      if (m_sess->m_autocommit_off)
+        m_sess->m_sql_trx_open = false;
+      m_sess->m_autocommit_off = false;
+      break;
+    default: break;
+    }
+
     return new cdk::Reply(
       get_cdk_session().sql(
         m_query,
@@ -1058,7 +1336,7 @@ struct Op_admin
 */
 
 enum class Trx_op {
-  BEGIN, COMMIT, ROLLBACK, SAVEPOINT_SET, SAVEPOINT_REMOVE
+  BEGIN, COMMIT, COMMIT_AFTER_NEXT, ROLLBACK, SAVEPOINT_SET, SAVEPOINT_REMOVE
 };
 
 
@@ -1084,6 +1362,7 @@ inline
 cdk::Reply* Op_trx<Trx_op::BEGIN>::send_command()
 {
   get_cdk_session().begin();
+  m_sess->m_trx_open = true;
   return nullptr;
 }
 
@@ -1092,6 +1371,20 @@ inline
 cdk::Reply* Op_trx<Trx_op::COMMIT>::send_command()
 {
   get_cdk_session().commit();
+  m_sess->m_trx_open = false;
+  return nullptr;
+}
+
+/*
+  The transaction remains open until commit() reports whether COMMIT sent
+  with the next statement succeeded.
+*/
+
+template<>
+inline
+cdk::Reply* Op_trx<Trx_op::COMMIT_AFTER_NEXT>::send_command()
+{
+  get_cdk_session().commit_after_next();
   return nullptr;
 }
 
@@ -1117,6 +1410,13 @@ struct Op_trx<Trx_op::ROLLBACK>
 
   cdk::Reply* send_command() override
   {
+    /*
+      The transaction is closed also if rollback reports that it was
+      already committed by COMMIT sent after the last statement.
+    */
+
+    if (m_name.empty())
+      m_sess->m_trx_open = false;
     get_cdk_session().rollback(m_name);
     return nullptr;
   }
@@ -1193,7 +1493,8 @@ struct Op_trx<Trx_op::SAVEPOINT_REMOVE>
   Operations which create database objects.
 
   They are implemented as Op_create<> template parametrized by the type of the
-  object to create.
+  object to create. After execution, information about the object is removed
+  from the catalog cache (see Catalog_cache).
 */
 
 template <Object_type T>
@@ -1204,6 +1505,8 @@ template<>
 struct Op_create<Object_type::SCHEMA>
   : public Op_sql
 {
+  cdk::string m_schema;
+
   /*
     Note: Using ? placeholder in CREATE query did not work - server error
     about wrong SQL syntax.
@@ -1216,7 +1519,14 @@ struct Op_create<Object_type::SCHEMA>
         std::wstring(L"CREATE SCHEMA") + (reuse ? L" IF NOT EXISTS " : L" ")
         + L"`" + schema.name() + L"`"
       )
+    , m_schema(schema.name())
   {}
+
+  void execute_cleanup() override
+  {
+    Op_sql::execute_cleanup();
+    m_sess->catalog_invalidate(m_schema, cdk::string());
+  }
 };
 
 
@@ -1224,12 +1534,15 @@ template<>
 struct Op_create<Object_type::COLLECTION>
   : public Op_admin
 {
+  Object_ref m_coll;
+
   Op_create(
     Shared_session_impl sess,
     const cdk::api::Object_ref &coll,
     bool reuse = true
   )
     : Op_admin(sess, "create_collection")
+    , m_coll(coll)
   {
     if (coll.schema())
       add_param(L"schema", Value(coll.schema()->name()));
@@ -1240,6 +1553,12 @@ struct Op_create<Object_type::COLLECTION>
     if (reuse)
       skip_error(cdk::server_error(1050));
   }
+
+  void execute_cleanup() override
+  {
+    Op_admin::execute_cleanup();
+    m_sess->catalog_invalidate(m_coll.schema()->name(), m_coll.name());
+  }
 };
 
 
@@ -1264,15 +1583,19 @@ void create_object(
   Operations which drop database objects.
 
   They are implemented as Op_drop<> template parametrized by the type of the
-  object to create.
+  object to create. As with Op_create<>, the object is removed from the
+  catalog cache after execution.
 */
 
 template <Object_type T>
 struct Op_drop
   : public Op_admin
 {
+  Object_ref m_obj;
+
   Op_drop(Shared_session_impl sess, const cdk::api::Object_ref &obj)
     : Op_admin(sess, "drop_collection")
+    , m_obj(obj)
   {
     if (!obj.schema())
       throw_error("No schema specified for drop collection/table operation");
@@ -1281,6 +1604,12 @@ struct Op_drop
     // 1051 = collection doesn't exist
     skip_error(cdk::server_error(1051));
   }
+
+  void execute_cleanup() override
+  {
+    Op_admin::execute_cleanup();
+    m_sess->catalog_invalidate(m_obj.schema()->name(), m_obj.name());
+  }
 };
 
 
@@ -1319,6 +1648,11 @@ struct Op_drop<Object_type::VIEW>
   {
     return new Op_drop(*this);
   }
+
+  void execute_cleanup() override
+  {
+    m_sess->catalog_invalidate(m_view.schema()->name(), m_view.name());
+  }
 };
 
 
@@ -1326,11 +1660,20 @@ template <>
 struct Op_drop<Object_type::SCHEMA>
   : public Op_sql
 {
+  cdk::string m_schema;
+
   Op_drop(Shared_session_impl sess, const cdk::api::Schema_ref &schema)
     : Op_sql(sess,
         std::wstring(L"DROP SCHEMA IF EXISTS `") + schema.name() + L"`"
       )
+    , m_schema(schema.name())
   {}
+
+  void execute_cleanup() override
+  {
+    Op_sql::execute_cleanup();
+    m_sess->catalog_invalidate(m_schema, cdk::string());
+  }
 };
 
 
@@ -1443,12 +1786,19 @@ const char* obj_name<Object_type::TABLE>() { return "TABLE"; }
 
   In the returned result first column contains object name and second column
   contains its type.
+
+  If catalog cache is enabled for the session, types of the listed objects
+  are stored in the cache as rows pass through the row filter.
 */
 
 struct Op_list_objects
   : public Op_admin
 {
   using string = std::wstring;
+  using Row_filter_t = Result_impl_base::Row_filter_t;
+
+  cdk::string m_schema;
+  Catalog_cache::Epoch m_epoch = 0;
 
   Op_list_objects(
     Shared_session_impl sess,
@@ -1456,6 +1806,7 @@ struct Op_list_objects
     const string &pattern
   )
     : Op_admin(sess, "list_objects")
+    , m_schema(schema.name())
   {
     add_param(L"schema", Value(schema.name()));
     add_param(L"pattern", Value(pattern));
@@ -1470,6 +1821,56 @@ struct Op_list_objects
     std::string name(name_col.begin(), name_col.end()-1);
     return name == obj_name<T>();
   }
+
+  // Catalog cache bit for the type of the object in the given row.
+
+  static Catalog_cache::Types row_type(const Row_data &row)
+  {
+    if (check_type<Object_type::COLLECTION>(row))
+      return Catalog_cache::type_bit(Object_type::COLLECTION);
+    if (check_type<Object_type::TABLE>(row))
+      return Catalog_cache::type_bit(Object_type::TABLE);
+    if (check_type<Object_type::VIEW>(row))
+      return Catalog_cache::type_bit(Object_type::VIEW);
+    return 0;
+  }
+
+protected:
+
+  /*
+    Note: the epoch is taken before the command is sent so that information
+    is not stored in the catalog cache if objects were created or dropped
+    while the list was being computed.
+  */
+
+  void execute_prepare() override
+  {
+    Op_admin::execute_prepare();
+    m_epoch = Catalog_cache::epoch();
+  }
+
+  /*
+    Return row filter which stores listed objects in the catalog cache and
+    then applies the given filter.
+  */
+
+  Row_filter_t catalog_filter(Row_filter_t filter) const
+  {
+    if (!m_sess->use_catalog())
+      return filter;
+
+    Shared_session_impl sess = m_sess;
+    cdk::string schema = m_schema;
+    Catalog_cache::Epoch epoch = m_epoch;
+
+    return [sess, schema, epoch, filter](const Row_data &row) -> bool
+    {
+      cdk::bytes  name_col = row.at(0).data();
+      std::string name(name_col.begin(), name_col.end()-1);
+      sess->catalog_put(schema, cdk::string(name), row_type(row), epoch);
+      return filter(row);
+    };
+  }
 };
 
 
@@ -1489,7 +1890,7 @@ struct Op_list
 
   void init_result(Result_impl_base &res) override
   {
-    res.m_row_filter = check_type<T>;
+    res.m_row_filter = catalog_filter(check_type<T>);
   }
 };
 
@@ -1521,15 +1922,15 @@ struct Op_list<Object_type::TABLE>
 
     if (m_include_views)
     {
-      res.m_row_filter = [](const Row_data &row) -> bool
+      res.m_row_filter = catalog_filter([](const Row_data &row) -> bool
       {
         return Op_list_objects::check_type<Object_type::TABLE>(row)
             || Op_list_objects::check_type<Object_type::VIEW>(row);
-      };
+      });
     }
     else
     {
-      res.m_row_filter = check_type<Object_type::TABLE>;
+      res.m_row_filter = catalog_filter(check_type<Object_type::TABLE>);
     }
   }
 
@@ -1555,70 +1956,225 @@ struct Op_list<Object_type::SCHEMA>
 
 /*
   Helper functions which use object list queries to check existence of objects
-  in the database.
+  in the database. If catalog cache is enabled for the session, it is
+  consulted first and the query results are stored in it.
 */
 
 inline
 bool check_schema_exists(
-  Shared_session_impl sess, cdk::api::Schema_ref &schema
+  Shared_session_impl sess, const cdk::api::Schema_ref &schema
 )
 {
+  Catalog_cache::Types types = 0;
+
+  if (sess->catalog_get(schema.name(), cdk::string(), types))
+    return 0 != types;
+
+  Catalog_cache::Epoch epoch = Catalog_cache::epoch();
   Op_list<Object_type::SCHEMA> find(sess, schema.name());
   Result_impl<std::string> res(find.execute());
-  return 0 < res.count();
+  bool exists = 0 < res.count();
+
+  sess->catalog_put(schema.name(), cdk::string(),
+    exists ? Catalog_cache::type_bit(Object_type::SCHEMA) : 0, epoch
+  );
+  return exists;
 }
 
-template <Object_type T>
+
+/*
+  Return the set of types of objects that match the given name (which is
+  used as a pattern, as in Op_list). Empty set means that there is no such
+  object.
+*/
+
 inline
-bool check_object_exists(
+Catalog_cache::Types get_object_types(
   Shared_session_impl sess,
   const cdk::api::Object_ref &obj
 )
 {
   assert(obj.schema());
-  Op_list<T> find(sess, *obj.schema(), obj.name());
+
+  Catalog_cache::Types types = 0;
+
+  if (sess->catalog_get(obj.schema()->name(), obj.name(), types))
+    return types;
+
+  Catalog_cache::Epoch epoch = Catalog_cache::epoch();
+  Op_list_objects find(sess, *obj.schema(), obj.name());
   Result_impl<std::string> res(find.execute());
-  return 0 < res.count();
+
+  while (const Row_data *row = res.get_row())
+    types |= Op_list_objects::row_type(*row);
+
+  sess->catalog_put(obj.schema()->name(), obj.name(), types, epoch);
+  return types;
 }
 
 
+/*
+  Note: As in Op_list<Object_type::TABLE>, views are also considered tables
+  when checking for existence of a table.
+*/
 
-// ----------------------------------------------------------------------------
+template <Object_type T>
+inline
+bool check_object_exists(
+  Shared_session_impl sess,
+  const cdk::api::Object_ref &obj
+)
+{
+  Catalog_cache::Types mask = Catalog_cache::type_bit(T);
 
+  if (Object_type::TABLE == T)
+    mask |= Catalog_cache::type_bit(Object_type::VIEW);
 
-/*
-  Implementation for collection CRUD add operation (Collection_add_if
-  interface).
+  return 0 != (get_object_types(sess, obj) & mask);
+}
 
-  Such operation can add (or update) a single document or several documents
-  given by a list of JSON strings. If upsert flag is set to true, the operation
-  should be used with a single document and then it updates the document if it
-  already exists in the database.
 
-  If documents to be added do not have defined ids, the ids are generated for
-  them. These generated ids are then passed to the result object
-  (in init_result() method).
 
-  Implementation object stores list of JSON strings describing documents
-  to be added and passed with `add_json` method. It presents this list
-  of documents via cdk::Doc_source interface. See method `process` for
-  details.
+// ----------------------------------------------------------------------------
 
-  Overriden method Op_base::send_command() sends the collection add
-  command to the CDK session.
+
+/*
+  Sends commands which execute chunks of a large operation back-to-back,
+  without waiting for the reply to one chunk before sending the next one
+  (see cdk::Session::send_ahead()). The first command is sent as usual, so
+  that START TRANSACTION or COMMIT pending in the CDK session is sent with
+  it. Such command is queued in the session and actually sent only when its
+  reply is read, so we wait for the reply before sending other chunks -
+  otherwise they would reach the server first. Replies must be read, in
+  order, with read(). To keep socket buffers
+  of the client and the server from filling up, which would block both of
+  them, callers should read a reply whenever max_pending replies are not
+  read yet.
 */
 
-class Op_collection_add
-  : public Op_base<common::Collection_add_if>
-  , public cdk::Doc_source
+class Chunk_sender
 {
-  using string = std::wstring;
-
-  Object_ref    m_coll;
-  std::vector<std::string> m_json;  // note: UTF8 JSON strings
-  unsigned m_pos;
-  const cdk::Expression *m_expr = nullptr;
-  bool m_upsert = false;
+  cdk::Session &m_sess;
+  std::unique_ptr<cdk::Reply> m_reply;
+  unsigned m_sent = 0;
+  unsigned m_read = 0;
+
+public:
+
+  static const unsigned max_pending = 16;
+
+  Chunk_sender(cdk::Session &sess)
+    : m_sess(sess)
+  {}
+
+  ~Chunk_sender()
+  {
+    discard();
+  }
+
+  // Send command that was just created in the CDK session.
+
+  void send(cdk::mysqlx::Reply_init &init)
+  {
+    if (0 == m_sent)
+    {
+      m_reply.reset(new cdk::Reply(init));
+      m_reply->wait();
+    }
+    else
+      m_sess.send_ahead();
+    ++m_sent;
+  }
+
+  unsigned pending() const
+  {
+    return m_sent - m_read;
+  }
+
+  // Wait for and return the reply to the oldest command not read yet.
+
+  cdk::Reply& read()
+  {
+    assert(0 < pending());
+    if (0 < m_read)
+      m_reply.reset(new cdk::Reply(m_sess.next_reply()));
+    ++m_read;
+    m_reply->wait();
+    return *m_reply;
+  }
+
+  /*
+    Read and ignore all pending replies. If reading fails, for example
+    because of a connection error, the remaining replies are abandoned.
+  */
+
+  void discard()
+  {
+    try {
+      while (0 < pending())
+        read();
+    }
+    catch (...)
+    {
+      m_read = m_sent;
+    }
+  }
+
+  // Pass ownership of the reply returned by the last read().
+
+  cdk::Reply* release()
+  {
+    return m_reply.release();
+  }
+};
+
+
+/*
+  Implementation for collection CRUD add operation (Collection_add_if
+  interface).
+
+  Such operation can add (or update) a single document or several documents
+  given by a list of JSON strings. If upsert flag is set to true, the operation
+  should be used with a single document and then it updates the document if it
+  already exists in the database.
+
+  If documents to be added do not have defined ids, the ids are generated for
+  them. These generated ids are then passed to the result object
+  (in init_result() method).
+
+  Implementation object stores list of JSON strings describing documents
+  to be added and passed with `add_json` method. It presents this list
+  of documents via cdk::Doc_source interface. See method `process` for
+  details.
+
+  Overriden method Op_base::send_command() sends the collection add
+  command to the CDK session.
+
+  If chunk size is set, documents are split into several add commands, each
+  of approximately at most the given size. The commands are sent
+  back-to-back using Chunk_sender and their replies are read as they
+  arrive. Affected rows and generated ids from all the commands are
+  aggregated in the final result. If atomic flag is set, the commands are
+  wrapped in a transaction, or in a savepoint if a transaction is already
+  open, which is rolled back if one of them fails.
+*/
+
+class Op_collection_add
+  : public Op_base<common::Collection_add_if>
+  , public cdk::Doc_source
+{
+  using string = std::wstring;
+
+  Object_ref    m_coll;
+  std::vector<std::string> m_json;  // note: UTF8 JSON strings
+  unsigned m_pos;
+  const cdk::Expression *m_expr = nullptr;
+  bool m_upsert = false;
+  size_t m_chunk_size = 0;
+  bool m_atomic = true;
+  unsigned m_end = 0;  // end of the chunk of m_json being sent
+  cdk::row_count_t m_prior_affected_rows = 0;
+  std::vector<std::string> m_generated_ids;
 
 public:
 
@@ -1664,6 +2220,12 @@ public:
     m_json.clear();
   }
 
+  void set_chunk_size(size_t chunk_size, bool atomic) override
+  {
+    m_chunk_size = chunk_size;
+    m_atomic = atomic;
+  }
+
 
   void execute_prepare() override
   {
@@ -1684,12 +2246,211 @@ public:
     if (!m_expr && m_json.empty())
       return NULL;
 
+    m_end = (unsigned)m_json.size();
+    m_prior_affected_rows = 0;
+    m_generated_ids.clear();
+
     // Issue coll_add statement where documents are described by list
     // of expressions defined by this instance.
 
-    return new cdk::Reply(
-      get_cdk_session().coll_add(m_coll, *this, NULL, m_upsert)
-    );
+    if (m_expr || 0 == m_chunk_size || chunk_end(0) == m_json.size())
+      return new cdk::Reply(
+        get_cdk_session().coll_add(m_coll, *this, NULL, m_upsert)
+      );
+
+    cdk::Session &sess = get_cdk_session();
+    cdk::string savepoint;
+    bool trx = false;
+
+    if (m_atomic)
+    {
+      /*
+        If a transaction is open, also one started with plain SQL, a new
+        one can not be started as that would commit it.
+      */
+
+      if (m_sess->trx_open())
+      {
+        std::wstringstream name;
+        name << L"SP" << m_sess->next_savepoint();
+        savepoint = name.str();
+        sess.savepoint_set(savepoint);
+      }
+      else
+      {
+        sess.begin();
+        trx = true;
+      }
+    }
+
+    /*
+      Rolls back changes made by the chunks sent so far. Rolling back sends
+      a new command, so replies to all chunks must be read before.
+    */
+
+    bool rolled_back = false;
+
+    auto rollback = [&]()
+    {
+      if (!m_atomic || rolled_back)
+        return;
+
+      rolled_back = true;
+
+      try {
+        if (trx)
+          sess.rollback();
+        else
+          sess.rollback(savepoint);
+      }
+      catch (...)
+      {}
+    };
+
+    Chunk_sender chunks(sess);
+    std::unique_ptr<cdk::Error> error;
+
+    // Read reply to the oldest chunk sent.
+
+    auto read_chunk = [&]()
+    {
+      cdk::Reply &reply = chunks.read();
+
+      if (0 < reply.entry_count())
+      {
+        if (!error)
+          error.reset(reply.get_error().clone());
+        return;
+      }
+
+      m_generated_ids.insert(m_generated_ids.end(),
+        reply.generated_ids().begin(), reply.generated_ids().end());
+      m_prior_affected_rows += reply.affected_rows();
+    };
+
+    try {
+
+      // Documents of a chunk are consumed when it is sent.
+
+      while (m_pos < m_json.size() && !error)
+      {
+        m_end = chunk_end(m_pos);
+        chunks.send(sess.coll_add(m_coll, *this, NULL, m_upsert));
+
+        if (Chunk_sender::max_pending <= chunks.pending())
+          read_chunk();
+      }
+
+      while (0 < chunks.pending())
+        read_chunk();
+    }
+    catch (...)
+    {
+      /*
+        Errors thrown on the client side, such as document processing or
+        connection errors, must not leave the transaction open.
+      */
+
+      chunks.discard();
+      rollback();
+      throw;
+    }
+
+    /*
+      Note: without atomic mode, chunks sent before an error was seen
+      might have been applied after the failed one.
+    */
+
+    if (error)
+    {
+      rollback();
+      error->rethrow();
+    }
+
+    if (!m_atomic)
+    {
+      /*
+        The reply to the last chunk becomes the result of the operation.
+        It reports its own affected rows.
+      */
+
+      cdk::Reply *reply = chunks.release();
+      m_prior_affected_rows -= reply->affected_rows();
+      return reply;
+    }
+
+    // The reply to the final COMMIT becomes the result of the operation.
+
+    return new cdk::Reply(sess.sql(
+      trx ? cdk::string(L"COMMIT")
+          : L"RELEASE SAVEPOINT `" + savepoint + L"`",
+      NULL
+    ));
+  }
+
+  void init_result(Result_impl_base &res) override
+  {
+    res.m_prior_affected_rows = m_prior_affected_rows;
+    res.m_generated_ids = std::move(m_generated_ids);
+  }
+
+  /*
+    Return end of the chunk of documents that starts at the given position.
+    A chunk has at least one document.
+  */
+
+  unsigned chunk_end(unsigned begin) const
+  {
+    size_t size = 0;
+    unsigned end = begin;
+
+    for (; end < m_json.size(); ++end)
+    {
+      size += doc_size(m_json[end]);
+      if (size > m_chunk_size && end > begin)
+        break;
+    }
+
+    return end;
+  }
+
+  /*
+    Upper bound for the number of bytes which a document adds to the insert
+    command.
+
+    A document is sent as a string literal nested in several protobuf
+    messages (String, Scalar, Expr, field of a row and the row itself), each
+    of which adds a tag, a length prefix and possibly a type field.
+
+    A document without "_id" field gets a generated id. When the id is
+    added on the client side, the document is wrapped in
+    JSON_INSERT(<doc>, '$._id', <id>) (see Insert_id). The size of such
+    wrapper is counted for these documents, so that the bound holds in
+    either case.
+  */
+
+  static size_t doc_size(const std::string &json)
+  {
+    // Upper bound for JSON_INSERT() call with '$._id' and 32 character id.
+
+    const size_t id_wrapper = 96;
+
+    auto field = [](size_t len, size_t extra) {
+      size_t prefix = 1;
+      for (size_t n = len; n >= 0x80; n >>= 7)
+        ++prefix;
+      return extra + 1 + prefix + len;
+    };
+
+    size_t size = field(json.length(), 0);  // String.value
+    size = field(size, 2);                   // Scalar (with type)
+    size = field(size, 2);                   // Expr (with type)
+
+    if (std::string::npos == json.find("\"_id\""))
+      size += id_wrapper;
+
+    size = field(size, 0);                   // TypedRow.field
+    return field(size, 0);                   // Insert.row
   }
 
 
@@ -1702,7 +2463,7 @@ public:
       if (m_pos > 0)
         return false;
     }
-    else if (m_pos >= m_json.size())
+    else if (m_pos >= m_end)
       return false;
     ++m_pos;
     return true;
@@ -1812,7 +2573,7 @@ parser::Parser_mode::value tbl_mode = parser::Parser_mode::TABLE;
 
 class Op_collection_find
     : public  Op_select< doc_mode,
-              Op_projection<
+              Op_projection< doc_mode,
               Op_group_by< doc_mode,
               Op_having< doc_mode,
               Op_sort< doc_mode,
@@ -1846,6 +2607,13 @@ public:
     return new Op_collection_find(*this);
   }
 
+  // Note: locking reads must be executed on the primary.
+
+  bool is_read_only() const override
+  {
+    return cdk::api::Lock_mode::NONE == m_lock_mode;
+  }
+
   cdk::Reply* send_command() override
   {
     return
@@ -1860,10 +2628,35 @@ public:
                           get_limit(),
                           get_params(),
                           m_lock_mode,
-                          m_lock_contention
+                          m_lock_contention,
+                          &m_find_cache
                     ));
   }
 
+  bool cache_key(std::string &key) override
+  {
+    get_key_session().coll_find_key(
+                          key,
+                          m_coll,
+                          get_where(),
+                          get_doc_proj(),
+                          get_order_by(),
+                          get_group_by(),
+                          get_having(),
+                          get_limit(),
+                          get_params(),
+                          m_lock_mode,
+                          m_lock_contention,
+                          &m_find_cache
+                        );
+    return true;
+  }
+
+  void set_result_cache(const Shared_result_cache &cache) override
+  {
+    m_result_cache = cache;
+  }
+
 };
 
 
@@ -2172,7 +2965,7 @@ public:
 
 class Op_table_select
     : public  Op_select< tbl_mode,
-              Op_projection<
+              Op_projection< tbl_mode,
               Op_group_by< tbl_mode,
               Op_having< tbl_mode,
               Op_sort< tbl_mode,
@@ -2198,15 +2991,50 @@ class Op_table_select
                          get_limit(),
                          get_params(),
                          m_lock_mode,
-                         m_lock_contention
+                         m_lock_contention,
+                         &m_find_cache
                        ));
   }
 
+  // Note: a select used to define a view is never cached (not read-only).
+
+  bool cache_key(std::string &key) override
+  {
+    get_key_session().table_select_key(
+                         key,
+                         m_table,
+                         get_where(),
+                         get_tbl_proj(),
+                         get_order_by(),
+                         get_group_by(),
+                         get_having(),
+                         get_limit(),
+                         get_params(),
+                         m_lock_mode,
+                         m_lock_contention,
+                         &m_find_cache
+                       );
+    return true;
+  }
+
+  void set_result_cache(const Shared_result_cache &cache) override
+  {
+    m_result_cache = cache;
+  }
+
   void set_view(const cdk::View_spec *view)
   {
+    m_find_cache.reset();
     m_view = view;
   }
 
+  // Note: a select used to define a view is sent as part of a DDL command.
+
+  bool is_read_only() const override
+  {
+    return !m_view && cdk::api::Lock_mode::NONE == m_lock_mode;
+  }
+
   Executable_if* clone() const override
   {
     return new Op_table_select(*this);
@@ -2222,6 +3050,35 @@ public:
 };
 
 
+/*
+  Format_info describing utf8 encoded strings.
+*/
+
+class Utf8_format_info
+  : public cdk::Format_info
+{
+  bool for_type(cdk::Type_info ti) const override
+  {
+    return cdk::TYPE_STRING == ti;
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_STRING> &fmt) const override
+  {
+    cdk::Format<cdk::TYPE_STRING>::Access::set_cs(fmt, cdk::Charset::utf8mb4);
+  }
+
+  using cdk::Format_info::get_info;
+
+public:
+
+  static const Utf8_format_info& get()
+  {
+    static const Utf8_format_info fi;
+    return fi;
+  }
+};
+
+
 /*
   Internal implementation for table CRUD insert operation (Table_insert_if
   interface).
@@ -2230,6 +3087,18 @@ public:
   that are to be inserted by the operation (m_rows list). By default this is
   class common::Value but a different class, handling more/different types
   of values can be used.
+
+  Rows can be also given as column arrays (m_batches list), in which case
+  values are described to CDK directly from the arrays, without building
+  Row_impl objects. Such rows are inserted after rows from m_rows list.
+
+  If chunk size is set, rows are sent in several insert commands whose
+  (estimated) size does not exceed the chunk size. The commands are sent
+  back-to-back using Chunk_sender and counts of affected rows from their
+  replies are aggregated in the final result (see init_result()). Note that
+  in this case the insert is not atomic: if one of the commands fails, rows
+  sent by other commands remain inserted (unless in a transaction). This
+  includes commands sent before the error was seen.
 */
 
 template <class VAL = common::Value>
@@ -2244,14 +3113,38 @@ class Op_table_insert
   using Row_list = std::list < Row_impl<VAL> >;
   using Col_list = std::list < string >;
 
+  struct Batch
+  {
+    std::vector<Column_array> m_cols;
+    size_t m_rows;
+  };
+
+  using Batch_list = std::vector<Batch>;
+
+  /*
+    Position of a row that is being sent: either an element of m_rows list
+    or row m_pos of batch m_batch.
+  */
+
+  struct Cursor
+  {
+    bool m_started = false;
+    typename Row_list::iterator m_row;
+    size_t m_batch = 0;
+    size_t m_pos = 0;
+  };
+
   Object_ref m_table;
 
   Row_list   m_rows;
-  typename Row_list::iterator m_cur_row;
+  Batch_list m_batches;
+  Cursor     m_cur;
 
   Col_list m_cols;
   col_count_t  m_col_count = 0;
 
+  size_t m_chunk_size = 0;
+
 public:
 
   Op_table_insert(Shared_session_impl sess, const Object_ref &tbl)
@@ -2263,10 +3156,10 @@ public:
     : Base(other)
     , m_table(other.m_table)
     , m_rows(other.m_rows)
+    , m_batches(other.m_batches)
     , m_cols(other.m_cols)
-  {
-    m_cur_row = m_rows.begin();
-  }
+    , m_chunk_size(other.m_chunk_size)
+  {}
 
   Executable_if* clone() const override
   {
@@ -2297,9 +3190,42 @@ public:
     m_rows.emplace_back(row);
   }
 
+  void add_rows(const Column_array *cols, size_t col_count,
+                size_t row_count) override
+  {
+    if (m_col_count > 0 && col_count != m_col_count)
+      throw_error("Number of column arrays does not match number of columns");
+
+    if (0 == col_count)
+      throw_error("No column arrays given");
+
+    for (size_t pos = 0; pos < col_count; ++pos)
+    {
+      const Column_array &col = cols[pos];
+
+      if (Column_array::SKIP == col.m_type)
+        throw_error("Column array of invalid type");
+
+      if (!col.m_data
+          || (Column_array::BYTES == col.m_type && !col.m_offsets))
+        throw_error("Null array pointer in column array");
+    }
+
+    if (0 == row_count)
+      return;
+
+    m_batches.push_back({ { cols, cols + col_count }, row_count });
+  }
+
   void clear_rows() override
   {
     m_rows.clear();
+    m_batches.clear();
+  }
+
+  void set_chunk_size(size_t chunk_size) override
+  {
+    m_chunk_size = chunk_size;
   }
 
   void clear()
@@ -2312,31 +3238,191 @@ private:
 
   // Executable
 
-  bool m_started = false;
+  size_t m_chunk_bytes = 0;
+  size_t m_chunk_rows = 0;
+  cdk::row_count_t m_prior_affected_rows = 0;
+  cdk::row_count_t m_prior_auto_increment = 0;
 
   cdk::Reply* send_command() override
   {
     // Do nothing if no rows were specified.
 
-    if (m_rows.empty())
+    if (m_rows.empty() && m_batches.empty())
       return NULL;
 
-    // Prepare iterators to make a pass through m_rows list.
-    m_started = false;
+    // Prepare cursor to make a pass through all rows.
+
+    m_cur = Cursor();
+    m_prior_affected_rows = 0;
+    m_prior_auto_increment = 0;
+    m_chunk_bytes = 0;
+    m_chunk_rows = 0;
 
     /*
-      Note: gcc complained if get_cdk_session() was used without Base:: prefix.
-      I actually do not understand why...
+      Note: gcc complained if get_cdk_session() was used without Base::
+      prefix. I actually do not understand why...
     */
 
-    return new cdk::Reply(
-      Base::get_cdk_session().table_insert(
-        m_table,
-        *this,
-        m_cols.empty() ? nullptr : this,
-        nullptr
-      )
-    );
+    cdk::Session &sess = Base::get_cdk_session();
+
+    if (0 == m_chunk_size)
+      return new cdk::Reply(sess.table_insert(
+        m_table, *this, m_cols.empty() ? nullptr : this, nullptr
+      ));
+
+    Chunk_sender chunks(sess);
+    std::unique_ptr<cdk::Error> error;
+
+    // Read reply to the oldest chunk sent.
+
+    auto read_chunk = [&]()
+    {
+      cdk::Reply &reply = chunks.read();
+
+      if (0 < reply.entry_count())
+      {
+        if (!error)
+          error.reset(reply.get_error().clone());
+        return;
+      }
+
+      m_prior_affected_rows += reply.affected_rows();
+      if (!m_prior_auto_increment)
+        m_prior_auto_increment = reply.last_insert_id();
+    };
+
+    try {
+
+      /*
+        Rows are read from this Row_source when a command is sent. After
+        that we know if all rows were sent. If not, the next chunk is sent
+        right away, unless an error was already reported for one of the
+        previous chunks.
+      */
+
+      Cursor next;
+
+      do {
+        m_chunk_bytes = 0;
+        m_chunk_rows = 0;
+
+        chunks.send(sess.table_insert(
+          m_table, *this, m_cols.empty() ? nullptr : this, nullptr
+        ));
+
+        if (Chunk_sender::max_pending <= chunks.pending())
+          read_chunk();
+
+        next = m_cur;
+      }
+      while (!error && advance(next));
+
+      while (0 < chunks.pending())
+        read_chunk();
+    }
+    catch (...)
+    {
+      chunks.discard();
+      throw;
+    }
+
+    if (error)
+      error->rethrow();
+
+    /*
+      The reply to the last chunk becomes the result of the operation.
+      It reports its own affected rows.
+    */
+
+    cdk::Reply *reply = chunks.release();
+    m_prior_affected_rows -= reply->affected_rows();
+    return reply;
+  }
+
+  void init_result(Result_impl_base &res) override
+  {
+    res.m_prior_affected_rows = m_prior_affected_rows;
+    res.m_prior_auto_increment = m_prior_auto_increment;
+  }
+
+
+  // Move cursor to the next row, return false if there are no more rows.
+
+  bool advance(Cursor &cur)
+  {
+    if (!cur.m_started)
+    {
+      cur.m_started = true;
+      cur.m_row = m_rows.begin();
+    }
+    else if (cur.m_row != m_rows.end())
+      ++cur.m_row;
+    else
+      ++cur.m_pos;
+
+    if (cur.m_row != m_rows.end())
+      return true;
+
+    while (cur.m_batch < m_batches.size()
+           && cur.m_pos >= m_batches[cur.m_batch].m_rows)
+    {
+      ++cur.m_batch;
+      cur.m_pos = 0;
+    }
+
+    return cur.m_batch < m_batches.size();
+  }
+
+
+  /*
+    Estimate size of the protocol message describing the row at the given
+    position. Each value is sent as a literal expression which adds a few
+    bytes of framing.
+  */
+
+  size_t row_size(const Cursor &cur) const
+  {
+    const size_t overhead = 8;
+    size_t size = 4;
+
+    if (cur.m_row != m_rows.end())
+    {
+      Row_impl<VAL> &row = *cur.m_row;
+
+      for (col_count_t pos = 0; pos < row.col_count(); ++pos)
+        size += overhead + value_size((const common::Value&)row.get(pos));
+
+      return size;
+    }
+
+    for (const Column_array &col : m_batches[cur.m_batch].m_cols)
+    {
+      size += overhead;
+      if (col.m_nulls && col.m_nulls[cur.m_pos])
+        continue;
+      if (Column_array::BYTES == col.m_type)
+        size += col.m_offsets[cur.m_pos + 1] - col.m_offsets[cur.m_pos];
+      else
+        size += 8;
+    }
+
+    return size;
+  }
+
+  static size_t value_size(const common::Value &val)
+  {
+    switch (val.get_type())
+    {
+    case common::Value::STRING:
+    case common::Value::RAW:
+      return val.get_string().length();
+    case common::Value::WSTRING:
+    case common::Value::EXPR:
+    case common::Value::JSON:
+      return val.get_wstring().length();
+    default:
+      return 8;
+    }
   }
 
 
@@ -2344,13 +3430,23 @@ private:
 
   bool next() override
   {
-    if (!m_started)
-      m_cur_row = m_rows.begin();
-    else
-      ++m_cur_row;
+    Cursor next = m_cur;
+
+    if (!advance(next))
+      return false;
+
+    // End current chunk if the next row would make it too big.
+
+    size_t size = m_chunk_size ? row_size(next) : 0;
 
-    m_started = true;
-    return m_cur_row != m_rows.end();
+    if (m_chunk_size && 0 < m_chunk_rows
+        && m_chunk_bytes + size > m_chunk_size)
+      return false;
+
+    m_cur = next;
+    m_chunk_bytes += size;
+    ++m_chunk_rows;
+    return true;
   }
 
 
@@ -2370,20 +3466,86 @@ private:
 
   void process(cdk::Expr_list::Processor &lp) const override
   {
+    if (m_cur.m_row == m_rows.end())
+    {
+      process_batch_row(lp);
+      return;
+    }
+
     lp.list_begin();
 
-    for (col_count_t pos = 0; pos < m_cur_row->col_count(); ++pos)
+    for (col_count_t pos = 0; pos < m_cur.m_row->col_count(); ++pos)
     {
       auto *el = lp.list_el();
       if (el)
         Value::Access::process(
-          parser::Parser_mode::TABLE, m_cur_row->get(pos), *el
+          parser::Parser_mode::TABLE, m_cur.m_row->get(pos), *el
         );
     }
 
     lp.list_end();
   }
 
+  /*
+    Describe values of the current row taken from column arrays. Strings
+    are passed in their utf8 encoding, without conversions.
+  */
+
+  void process_batch_row(cdk::Expr_list::Processor &lp) const
+  {
+    const Batch &batch = m_batches[m_cur.m_batch];
+    size_t row = m_cur.m_pos;
+
+    lp.list_begin();
+
+    for (const Column_array &col : batch.m_cols)
+    {
+      auto *el = lp.list_el();
+      if (!el)
+        continue;
+
+      cdk::Value_processor *vprc = el->scalar()->val();
+      if (!vprc)
+        continue;
+
+      if (col.m_nulls && col.m_nulls[row])
+      {
+        vprc->null();
+        continue;
+      }
+
+      switch (col.m_type)
+      {
+      case Column_array::INT64:
+        vprc->num(static_cast<const int64_t*>(col.m_data)[row]);
+        break;
+
+      case Column_array::UINT64:
+        vprc->num(static_cast<const uint64_t*>(col.m_data)[row]);
+        break;
+
+      case Column_array::DOUBLE:
+        vprc->num(static_cast<const double*>(col.m_data)[row]);
+        break;
+
+      case Column_array::BYTES:
+        {
+          cdk::byte *data = (cdk::byte*)col.m_data;
+          vprc->value(
+            cdk::TYPE_STRING, Utf8_format_info::get(),
+            cdk::bytes(data + col.m_offsets[row], data + col.m_offsets[row + 1])
+          );
+        }
+        break;
+
+      default:
+        assert(false);
+      }
+    }
+
+    lp.list_end();
+  }
+
 };
 
 
@@ -2407,6 +3569,7 @@ class Op_table_update
             Op_bind<
               Op_base<common::Table_update_if>
             >>>>
+  , public common::Update_expr_if
   , public cdk::Update_spec
   , public cdk::api::Column_ref
 {
@@ -2417,7 +3580,25 @@ class Op_table_update
                   Op_base<common::Table_update_if>
                 >>>>;
   using string = std::wstring;
-  typedef std::map<string, Value> SetValues;
+
+  /*
+    New value of a column: either a Value or, if m_stored is set,
+    an expression converted by store_expr().
+  */
+
+  struct Set_value
+  {
+    Value m_val;
+    parser::Expr_cache::Entry m_stored;
+
+    Set_value(const Value &val) : m_val(val)
+    {}
+
+    Set_value(const parser::Expr_cache::Entry &stored) : m_stored(stored)
+    {}
+  };
+
+  typedef std::map<string, Set_value> SetValues;
 
   Object_ref m_table;
   std::unique_ptr<parser::Table_field_parser> m_table_field;
@@ -2445,6 +3626,13 @@ public:
     m_set_values.emplace(field, val);
   }
 
+  void add_set(const string &field, const Expr_if &expr) override
+  {
+    m_set_values.emplace(
+      field, store_expr(parser::Parser_mode::TABLE, expr)
+    );
+  }
+
   void clear_modifications() override
   {
     m_set_values.clear();
@@ -2500,10 +3688,15 @@ protected:
 
     auto *vprc
       = prc.set(m_table_field->has_path() ? m_table_field.get() : NULL);
-    if (vprc)
-      Value::Access::process(
-        parser::Parser_mode::TABLE, m_set_it->second, *vprc
-      );
+    if (!vprc)
+      return;
+
+    const Set_value &val = m_set_it->second;
+
+    if (val.m_stored)
+      parser::Cached_expr(val.m_stored).process(*vprc);
+    else
+      Value::Access::process(parser::Parser_mode::TABLE, val.m_val, *vprc);
   }
 
 
@@ -29,6 +29,7 @@
  */
 
 #include <mysql/cdk.h>
+#include <mysql/cdk/foundation/varint.h>
 
 #include "result.h"
 #include "session.h"
@@ -114,8 +115,19 @@ mysqlx::common::convert(cdk::bytes data, Format_descr<cdk::TYPE_FLOAT> &fd)
     return Value(val);
   }
 
-  // For other formats (DOUBLE, DECIMAL), try storing in double
-  // TODO: exact representation for DECIMAL values?
+  /*
+    DECIMAL value is stored together with its raw bytes, which are
+    decoded to an exact representation by Value::get_decimal(). The
+    double approximation is computed here, as it is most often needed.
+  */
+
+  if (fmt.DECIMAL == fmt.type())
+  {
+    double val;
+    fd.m_codec.from_bytes(data, val);
+    return Value::Access::mk_decimal(data, val);
+  }
+
   {
     double val;
     fd.m_codec.from_bytes(data, val);
@@ -124,6 +136,25 @@ mysqlx::common::convert(cdk::bytes data, Format_descr<cdk::TYPE_FLOAT> &fd)
 }
 
 
+Value
+mysqlx::common::convert(cdk::bytes data, Format_descr<cdk::TYPE_DATETIME> &fd)
+{
+  auto &fmt = fd.m_format;
+
+  switch (fmt.type())
+  {
+  case cdk::Format<cdk::TYPE_DATETIME>::TIME:
+    return Value::Access::mk_datetime(data, Datetime::TIME);
+  case cdk::Format<cdk::TYPE_DATETIME>::TIMESTAMP:
+    return Value::Access::mk_datetime(data, Datetime::DATETIME);
+  case cdk::Format<cdk::TYPE_DATETIME>::DATETIME:
+  default:
+    return Value::Access::mk_datetime(data,
+      fmt.has_time() ? Datetime::DATETIME : Datetime::DATE);
+  }
+}
+
+
 Value
 mysqlx::common::convert(cdk::bytes data, Format_descr<cdk::TYPE_DOCUMENT>&)
 {
@@ -152,6 +183,223 @@ mysqlx::common::convert(cdk::bytes data, Format_descr<cdk::TYPE_DOCUMENT>&)
 
 
 
+/*
+  Decoders used by decoding plans
+  ===============================
+
+  These are the specialized variants of the convert() functions above, one
+  for each value encoding. The checks of the encoding format are done once
+  per result in get_encoding(), so decoders do not repeat them.
+*/
+
+
+Encoding mysqlx::common::get_encoding(const Format_info &fi)
+{
+  switch (fi.m_type)
+  {
+  case cdk::TYPE_STRING:
+    {
+      auto &fmt = fi.get<cdk::TYPE_STRING>().m_format;
+
+      if (fmt.is_set())
+        return Encoding::SET;
+
+      switch (fmt.charset())
+      {
+      case cdk::Charset::utf8:
+      case cdk::Charset::utf8mb4:
+        return Encoding::STRING_UTF8;
+      default:
+        return Encoding::STRING;
+      }
+    }
+
+  case cdk::TYPE_INTEGER:
+    return fi.get<cdk::TYPE_INTEGER>().m_format.is_unsigned() ?
+           Encoding::UINT : Encoding::SINT;
+
+  case cdk::TYPE_FLOAT:
+    {
+      auto &fmt = fi.get<cdk::TYPE_FLOAT>().m_format;
+
+      switch (fmt.type())
+      {
+      case cdk::Format<cdk::TYPE_FLOAT>::FLOAT:   return Encoding::FLOAT;
+      case cdk::Format<cdk::TYPE_FLOAT>::DECIMAL: return Encoding::DECIMAL;
+      default:                                    return Encoding::DOUBLE;
+      }
+    }
+
+  case cdk::TYPE_DATETIME:
+    {
+      auto &fmt = fi.get<cdk::TYPE_DATETIME>().m_format;
+
+      switch (fmt.type())
+      {
+      case cdk::Format<cdk::TYPE_DATETIME>::TIME:
+        return Encoding::TIME;
+      case cdk::Format<cdk::TYPE_DATETIME>::TIMESTAMP:
+        return Encoding::DATETIME;
+      case cdk::Format<cdk::TYPE_DATETIME>::DATETIME:
+      default:
+        return fmt.has_time() ? Encoding::DATETIME : Encoding::DATE;
+      }
+    }
+
+  case cdk::TYPE_DOCUMENT:
+    return Encoding::DOCUMENT;
+
+  default:
+    return Encoding::RAW;
+  }
+}
+
+
+namespace mysqlx {
+namespace common {
+
+template<>
+Value decode<Encoding::RAW>(cdk::bytes data, void*)
+{
+  // Note: see generic convert() template
+
+  return{ data.begin(), data.size()-1 };
+}
+
+
+template<>
+Value decode<Encoding::SET>(cdk::bytes data, void*)
+{
+  return{ data.begin(), data.size()-1 };
+}
+
+
+template<>
+Value decode<Encoding::STRING>(cdk::bytes data, void *fmt)
+{
+  auto &fd = *static_cast<Format_descr<cdk::TYPE_STRING>*>(fmt);
+  cdk::string str;
+  fd.m_codec.from_bytes(cdk::bytes(data.begin(), data.end() - 1), str);
+  Value ret(std::move(str));
+  Value::Access::set_raw(ret, data);
+  return ret;
+}
+
+
+/*
+  For utf8 strings we use the utf8 codec directly, bypassing selection
+  of the codec by Codec<TYPE_STRING> which is done for each value.
+*/
+
+static cdk::foundation::String_codec<cdk::foundation::codecvt_utf8>
+utf8_codec;
+
+template<>
+Value decode<Encoding::STRING_UTF8>(cdk::bytes data, void*)
+{
+  // Skip the trailing 0x00 byte (see convert()).
+
+  byte *end = data.end() - 1;
+
+  // Strip 0x00 byte at the end, as Codec<TYPE_STRING>::from_bytes() does.
+
+  if (end > data.begin() && '\0' == *(end - 1))
+    --end;
+
+  cdk::string str;
+  utf8_codec.from_bytes(cdk::bytes(data.begin(), end), str);
+  Value ret(std::move(str));
+  Value::Access::set_raw(ret, data);
+  return ret;
+}
+
+
+template<>
+Value decode<Encoding::SINT>(cdk::bytes data, void*)
+{
+  uint64_t val;
+
+  if (0 == cdk::foundation::varint::decode(data.begin(), data.end(), val))
+    THROW("Codec<TYPE_INTEGER>: integer conversion error");
+
+  Value ret(cdk::foundation::varint::zigzag_decode(val));
+  Value::Access::set_raw(ret, data);
+  return ret;
+}
+
+
+template<>
+Value decode<Encoding::UINT>(cdk::bytes data, void*)
+{
+  uint64_t val;
+
+  if (0 == cdk::foundation::varint::decode(data.begin(), data.end(), val))
+    THROW("Codec<TYPE_INTEGER>: integer conversion error");
+
+  Value ret(val);
+  Value::Access::set_raw(ret, data);
+  return ret;
+}
+
+
+template<>
+Value decode<Encoding::FLOAT>(cdk::bytes data, void *fmt)
+{
+  auto &fd = *static_cast<Format_descr<cdk::TYPE_FLOAT>*>(fmt);
+  float val;
+  fd.m_codec.from_bytes(data, val);
+  Value ret(val);
+  Value::Access::set_raw(ret, data);
+  return ret;
+}
+
+
+template<>
+Value decode<Encoding::DOUBLE>(cdk::bytes data, void *fmt)
+{
+  auto &fd = *static_cast<Format_descr<cdk::TYPE_FLOAT>*>(fmt);
+  double val;
+  fd.m_codec.from_bytes(data, val);
+  Value ret(val);
+  Value::Access::set_raw(ret, data);
+  return ret;
+}
+
+
+template<>
+Value decode<Encoding::DECIMAL>(cdk::bytes data, void *fmt)
+{
+  auto &fd = *static_cast<Format_descr<cdk::TYPE_FLOAT>*>(fmt);
+  double val;
+  fd.m_codec.from_bytes(data, val);
+  return Value::Access::mk_decimal(data, val);
+}
+
+
+template<>
+Value decode<Encoding::DATE>(cdk::bytes data, void*)
+{
+  return Value::Access::mk_datetime(data, Datetime::DATE);
+}
+
+
+template<>
+Value decode<Encoding::DATETIME>(cdk::bytes data, void*)
+{
+  return Value::Access::mk_datetime(data, Datetime::DATETIME);
+}
+
+
+template<>
+Value decode<Encoding::TIME>(cdk::bytes data, void*)
+{
+  return Value::Access::mk_datetime(data, Datetime::TIME);
+}
+
+}}  // mysqlx::common
+
+
+
 /*
   Result implementation
   =====================
@@ -163,6 +411,7 @@ Result_impl_base::Result_impl_base(Result_init &init)
 {
   // Note: init.get_reply() can be NULL in the case of ignored server error
   m_sess->register_result(this);
+  init.init_cache(*this);
   init.init_result(*this);
 }
 
@@ -204,6 +453,40 @@ bool Result_impl_base::next_result()
   m_pending_rows = false;
   m_inited = true;
 
+  /*
+    Entry which was not completed is not stored in the cache. Then the cache
+    is not used for the remaining results of the reply either.
+  */
+
+  if (m_store)
+  {
+    m_store.reset();
+    m_store_cache.reset();
+  }
+
+  if (m_replay)
+  {
+    if (m_replay_done)
+      return false;
+
+    // Move all rows from the cache entry to the row cache.
+
+    m_replay_done = true;
+    m_sess->deregister_result(this);
+    m_mdata.reset(copy_meta_data(m_replay->get_mdata()));
+
+    m_cache_it = m_row_cache.before_begin();
+
+    for (row_count_t pos = 0; pos < m_replay->row_count(); ++pos)
+    {
+      Row_data row;
+      m_replay->get_row(pos, row);
+      m_cache_it = m_row_cache.emplace_after(m_cache_it, std::move(row));
+      m_row_cache_size++;
+    }
+
+    return true;
+  }
 
   if (!m_reply)
     return false;
@@ -230,6 +513,9 @@ bool Result_impl_base::next_result()
   m_cursor->wait();
   m_mdata.reset(fetch_meta_data(*m_cursor));
 
+  if (m_store_cache)
+    m_store = std::make_shared<Result_cache::Entry>(copy_meta_data(*m_mdata));
+
   m_pending_rows = true;
 
   return true;
@@ -242,7 +528,7 @@ const Row_data* Result_impl_base::get_row()
 
   if (!load_cache(16))
   {
-    if (m_reply->entry_count() > 0)
+    if (m_reply && m_reply->entry_count() > 0)
       m_reply->get_error().rethrow();
     return nullptr;
   }
@@ -283,10 +569,23 @@ bool Result_impl_base::load_cache(row_count_t prefetch_size)
   if (m_row_cache.empty())
     m_cache_it = m_row_cache.before_begin();
 
+  read_rows(prefetch_size);
+
+  return !m_row_cache.empty();
+}
+
+
+/*
+  Read given number of rows from the cursor (all remaining rows if
+  count is 0) passing them to Row_processor callbacks below.
+*/
+
+void Result_impl_base::read_rows(row_count_t count)
+{
   // Initiate row reading operation
 
-  if (0 < prefetch_size)
-    m_cursor->get_rows(*this, prefetch_size);
+  if (0 < count)
+    m_cursor->get_rows(*this, count);
   else
     m_cursor->get_rows(*this);  // this reads all remaining rows
 
@@ -303,9 +602,397 @@ bool Result_impl_base::load_cache(row_count_t prefetch_size)
     m_cursor->close();
     m_sess->deregister_result(this);
     m_pending_rows = false;
+    store_done();
   }
+}
 
-  return !m_row_cache.empty();
+
+/*
+  Fetching rows into caller-provided arrays
+  -----------------------------------------
+
+  Method fetch_into() passes rows to a Row_sink object as they are read
+  from the cursor (see row_end()). Rows that are already in the row cache
+  are passed to the sink first.
+
+  Result_impl_base::Batch is a Row_sink which stores rows in the arrays
+  described by Column_buffer objects. Whether and how values of each column
+  can be stored in the requested array is determined once when Batch is
+  created, based on the encoding of the column values (see get_encoding()).
+
+  Method store() stores a single row and returns false if it could not be
+  done. Values are written at the next free position of the arrays which
+  becomes used only after all values of the row were successfully stored.
+  Thus, if a row can not be stored, it can be put into the row cache and
+  the arrays remain unchanged.
+*/
+
+struct Result_impl_base::Batch
+  : public Row_sink
+{
+  struct Column
+  {
+    const Column_buffer *m_buf;
+    Encoding             m_enc;
+    void                *m_fmt;
+  };
+
+  std::vector<Column> m_cols;
+  row_count_t         m_count = 0;
+  std::string         m_error;
+
+  Batch(const Meta_data_base&, const Column_buffer*);
+
+  bool store(const Row_data&) override;
+
+  const char* error() const override
+  {
+    return m_error.empty() ? nullptr : m_error.c_str();
+  }
+
+private:
+
+  bool store(col_count_t pos, const Column&, cdk::bytes);
+  bool store_null(col_count_t pos, const Column&);
+
+  bool error(col_count_t pos, const char *msg)
+  {
+    std::ostringstream buf;
+    buf << "Column #" << pos + 1 << ": " << msg;
+    m_error = buf.str();
+    return false;
+  }
+};
+
+
+Result_impl_base::Batch::Batch(
+  const Meta_data_base &md, const Column_buffer *cols
+)
+{
+  const Decoder_plan<Value> &plan = md.get_plan<Value>();
+
+  m_cols.reserve(md.col_count());
+
+  for (col_count_t pos = 0; pos < md.col_count(); ++pos)
+  {
+    const Column_buffer &buf = cols[pos];
+    Column col = { &buf, get_encoding(md.get_format(pos)),
+                   plan.m_cols[pos].m_fmt };
+    bool ok = false;
+
+    switch (buf.m_type)
+    {
+    case Column_buffer::SKIP:
+      ok = true;
+      break;
+
+    case Column_buffer::INT64:
+    case Column_buffer::UINT64:
+      ok = (Encoding::SINT == col.m_enc || Encoding::UINT == col.m_enc);
+      break;
+
+    case Column_buffer::DOUBLE:
+      switch (col.m_enc)
+      {
+      case Encoding::SINT:
+      case Encoding::UINT:
+      case Encoding::FLOAT:
+      case Encoding::DOUBLE:
+      case Encoding::DECIMAL:
+        ok = true;
+        break;
+      default:
+        break;
+      }
+      break;
+
+    case Column_buffer::BYTES:
+      switch (col.m_enc)
+      {
+      case Encoding::RAW:
+      case Encoding::STRING:
+      case Encoding::STRING_UTF8:
+      case Encoding::SET:
+      case Encoding::DOCUMENT:
+        ok = (nullptr != buf.m_offsets);
+        break;
+      default:
+        break;
+      }
+      break;
+    }
+
+    if (!ok)
+    {
+      std::ostringstream msg;
+      msg << "Column #" << pos + 1
+          << " can not be stored in array of the requested type";
+      throw_error(msg.str().c_str());
+    }
+
+    if (Column_buffer::SKIP != buf.m_type && !buf.m_data)
+      throw_error("Null array pointer in column buffer");
+
+    if (Column_buffer::BYTES == buf.m_type)
+      buf.m_offsets[0] = 0;
+
+    m_cols.push_back(col);
+  }
+}
+
+
+bool Result_impl_base::Batch::store(const Row_data &row)
+{
+  /*
+    Note: Row_data is ordered by column position. Columns not present
+    in it hold NULL values, as do fields with empty data.
+  */
+
+  auto field = row.begin();
+
+  for (col_count_t pos = 0; pos < m_cols.size(); ++pos)
+  {
+    while (field != row.end() && field->first < pos)
+      ++field;
+
+    const Column &col = m_cols[pos];
+    bool ok;
+
+    if (field == row.end() || field->first != pos
+        || 0 == field->second.size())
+      ok = store_null(pos, col);
+    else
+      ok = store(pos, col, field->second.data());
+
+    if (!ok)
+      return false;
+  }
+
+  ++m_count;
+  return true;
+}
+
+
+bool Result_impl_base::Batch::store_null(col_count_t pos, const Column &col)
+{
+  const Column_buffer &buf = *col.m_buf;
+
+  if (Column_buffer::SKIP == buf.m_type)
+    return true;
+
+  if (!buf.m_nulls)
+    return error(pos, "NULL value but no null indicators were given");
+
+  buf.m_nulls[m_count] = true;
+
+  switch (buf.m_type)
+  {
+  case Column_buffer::INT64:
+    static_cast<int64_t*>(buf.m_data)[m_count] = 0;
+    break;
+  case Column_buffer::UINT64:
+    static_cast<uint64_t*>(buf.m_data)[m_count] = 0;
+    break;
+  case Column_buffer::DOUBLE:
+    static_cast<double*>(buf.m_data)[m_count] = 0;
+    break;
+  case Column_buffer::BYTES:
+    buf.m_offsets[m_count + 1] = buf.m_offsets[m_count];
+    break;
+  default:
+    break;
+  }
+
+  return true;
+}
+
+
+bool Result_impl_base::Batch::store(
+  col_count_t pos, const Column &col, cdk::bytes data
+)
+{
+  const Column_buffer &buf = *col.m_buf;
+
+  if (Column_buffer::SKIP == buf.m_type)
+    return true;
+
+  if (buf.m_nulls)
+    buf.m_nulls[m_count] = false;
+
+  if (Column_buffer::BYTES == buf.m_type)
+  {
+    /*
+      Note: Trailing '\0' byte is used for NULL value detection and is not
+      part of the data
+    */
+
+    size_t len = data.size() - 1;
+    size_t off = buf.m_offsets[m_count];
+
+    // If the row does not fit, stop filling this batch.
+
+    if (len > buf.m_data_size - off)
+      return false;
+
+    memcpy(static_cast<byte*>(buf.m_data) + off, data.begin(), len);
+    buf.m_offsets[m_count + 1] = off + len;
+    return true;
+  }
+
+  namespace varint = cdk::foundation::varint;
+
+  switch (col.m_enc)
+  {
+  case Encoding::SINT:
+  case Encoding::UINT:
+    {
+      uint64_t raw;
+
+      if (0 == varint::decode(data.begin(), data.end(), raw))
+        return error(pos, "integer conversion error");
+
+      bool is_signed = (Encoding::SINT == col.m_enc);
+      int64_t sval = is_signed ? varint::zigzag_decode(raw) : 0;
+
+      switch (buf.m_type)
+      {
+      case Column_buffer::INT64:
+        if (!is_signed && raw > uint64_t(std::numeric_limits<int64_t>::max()))
+          return error(pos, "value does not fit into int64_t");
+        static_cast<int64_t*>(buf.m_data)[m_count]
+          = is_signed ? sval : int64_t(raw);
+        break;
+
+      case Column_buffer::UINT64:
+        if (is_signed && sval < 0)
+          return error(pos, "negative value can not be stored as uint64_t");
+        static_cast<uint64_t*>(buf.m_data)[m_count]
+          = is_signed ? uint64_t(sval) : raw;
+        break;
+
+      case Column_buffer::DOUBLE:
+        static_cast<double*>(buf.m_data)[m_count]
+          = is_signed ? double(sval) : double(raw);
+        break;
+
+      default:
+        assert(false);
+      }
+
+      return true;
+    }
+
+  default:
+    {
+      assert(Column_buffer::DOUBLE == buf.m_type);
+
+      auto &fd = *static_cast<Format_descr<cdk::TYPE_FLOAT>*>(col.m_fmt);
+
+      try {
+        fd.m_codec.from_bytes(data, static_cast<double*>(buf.m_data)[m_count]);
+      }
+      catch (const std::exception &err)
+      {
+        return error(pos, err.what());
+      }
+
+      return true;
+    }
+  }
+}
+
+
+row_count_t
+Result_impl_base::fetch_into(
+  const Column_buffer *cols, col_count_t count, row_count_t batch_size
+)
+{
+  if (!m_inited)
+    next_result();
+
+  if (!m_mdata)
+    return 0;
+
+  if (count != m_mdata->col_count())
+    THROW("Number of column buffers does not match the number of columns");
+
+  Batch batch(*m_mdata, cols);
+  return fetch_into(batch, batch_size);
+}
+
+
+row_count_t
+Result_impl_base::fetch_into(Row_sink &sink, row_count_t batch_size)
+{
+  if (!m_inited)
+    next_result();
+
+  if (!m_mdata || 0 == batch_size)
+    return 0;
+
+  m_sink = &sink;
+  m_sink_count = 0;
+  m_sink_limit = batch_size;
+
+  try {
+
+    // First store rows that are already in the cache, if any.
+
+    while (!m_row_cache.empty() && sink_row(m_row_cache.front()))
+    {
+      m_row_cache.pop_front();
+      m_row_cache_size--;
+    }
+
+    // Read more rows if all cached rows were stored and more are needed.
+
+    if (m_row_cache.empty() && m_pending_rows && m_sink_count < batch_size)
+    {
+      m_cache_it = m_row_cache.before_begin();
+      m_row.clear();
+      read_rows(batch_size - m_sink_count);
+      m_row.clear();
+    }
+  }
+  catch (...)
+  {
+    m_sink = nullptr;
+    throw;
+  }
+
+  m_sink = nullptr;
+
+  if (m_reply && m_reply->entry_count() > 0)
+    m_reply->get_error().rethrow();
+
+  if (sink.error())
+    throw_error(sink.error());
+
+  if (0 == m_sink_count && !m_row_cache.empty())
+    THROW("Buffers are too small to store a single row");
+
+  return m_sink_count;
+}
+
+
+/*
+  Pass row to the sink, unless it has already stored batch_size rows
+  or refused to store a previous row. Returns true if row was stored.
+*/
+
+bool Result_impl_base::sink_row(const Row_data &row)
+{
+  assert(m_sink);
+
+  if (m_sink_count >= m_sink_limit || !m_sink->store(row))
+  {
+    // Do not pass any more rows to the sink.
+    m_sink_limit = m_sink_count;
+    return false;
+  }
+
+  ++m_sink_count;
+  return true;
 }
 
 
@@ -329,10 +1016,26 @@ size_t Result_impl_base::field_data(col_count_t pos, bytes data)
 
 void Result_impl_base::row_end(row_count_t)
 {
-  if (!m_row_filter(m_row))
+  if (m_row_filter && !m_row_filter(m_row))
     return;
 
-  m_cache_it = m_row_cache.emplace_after(m_cache_it, std::move(m_row));
+  if (m_store)
+    store_row(m_row);
+
+  /*
+    When storing rows into a sink, m_row is re-used for the next row and
+    it is copied to the cache only if it could not be stored by the sink.
+  */
+
+  if (m_sink)
+  {
+    if (sink_row(m_row))
+      return;
+    m_cache_it = m_row_cache.emplace_after(m_cache_it, m_row);
+  }
+  else
+    m_cache_it = m_row_cache.emplace_after(m_cache_it, std::move(m_row));
+
   m_row_cache_size++;
 }
 
@@ -340,3 +1043,178 @@ void Result_impl_base::end_of_data()
 {
   m_pending_rows = false;
 }
+
+
+/*
+  Client-side result cache
+  ------------------------
+*/
+
+
+void Result_cache::Entry::add_row(const Row_data &row)
+{
+  col_count_t cols = m_mdata->col_count();
+
+  for (col_count_t pos = 0; pos < cols; ++pos)
+  {
+    auto it = row.find(pos);
+    if (it != row.end())
+    {
+      cdk::bytes data = it->second.data();
+      m_data.append((const char*)data.begin(), data.size());
+    }
+    m_ends.push_back(m_data.size());
+  }
+
+  m_rows++;
+}
+
+
+void Result_cache::Entry::get_row(row_count_t row, Row_data &data) const
+{
+  col_count_t cols = m_mdata->col_count();
+  size_t pos = row*cols;
+  size_t begin = pos > 0 ? m_ends[pos - 1] : 0;
+
+  data.clear();
+
+  for (col_count_t col = 0; col < cols; ++col, ++pos)
+  {
+    size_t end = m_ends[pos];
+
+    // Note: empty field is NULL and is not present in Row_data.
+
+    if (end > begin)
+      data[col].append(
+        cdk::bytes((byte*)m_data.data() + begin, end - begin)
+      );
+
+    begin = end;
+  }
+}
+
+
+Result_cache::Shared_entry Result_cache::get(const std::string &key)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto it = m_index.find(key);
+
+  if (it != m_index.end() && clock::now() >= it->second.m_expires)
+  {
+    remove(it);
+    it = m_index.end();
+  }
+
+  if (it == m_index.end())
+  {
+    m_misses++;
+    return Shared_entry();
+  }
+
+  m_hits++;
+  m_lru.splice(m_lru.begin(), m_lru, it->second.m_lru);
+  return it->second.m_entry;
+}
+
+
+void Result_cache::put(const std::string &key, const Shared_entry &entry)
+{
+  size_t size = key.size() + entry->size();
+
+  if (size > m_max_bytes)
+    return;
+
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+    remove(it);
+
+  while (!m_lru.empty() && m_bytes + size > m_max_bytes)
+  {
+    remove(m_index.find(*m_lru.back()));
+    m_evictions++;
+  }
+
+  it = m_index.emplace(key, Slot()).first;
+
+  Slot &slot = it->second;
+  slot.m_entry = entry;
+  slot.m_size = size;
+  slot.m_expires = clock::now() + m_ttl;
+  slot.m_lru = m_lru.insert(m_lru.begin(), &it->first);
+
+  m_bytes += size;
+  m_entries++;
+}
+
+
+void Result_cache::clear()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  m_index.clear();
+  m_lru.clear();
+  m_bytes = 0;
+  m_entries = 0;
+}
+
+
+void Result_cache::remove(Index::iterator it)
+{
+  m_bytes -= it->second.m_size;
+  m_entries--;
+  m_lru.erase(it->second.m_lru);
+  m_index.erase(it);
+}
+
+
+void Result_impl_base::replay(const Result_cache::Shared_entry &entry)
+{
+  m_replay = entry;
+}
+
+
+void Result_impl_base::cache_into(
+  const Shared_result_cache &cache, const std::string &key
+)
+{
+  m_store_cache = cache;
+  m_store_key = key;
+}
+
+
+void Result_impl_base::store_row(const Row_data &row)
+{
+  assert(m_store);
+
+  m_store->add_row(row);
+
+  // Give up if the result would not fit into the cache.
+
+  if (m_store->size() + m_store_key.size() > m_store_cache->max_bytes())
+  {
+    m_store.reset();
+    m_store_cache.reset();
+  }
+}
+
+
+void Result_impl_base::store_done()
+{
+  if (!m_store)
+    return;
+
+  /*
+    Note: only the first result of a reply is stored and only if it has
+    no errors or warnings (a replayed result has no diagnostics).
+  */
+
+  if (0 == m_reply->entry_count(cdk::api::Severity::ERROR) &&
+      0 == m_reply->entry_count(cdk::api::Severity::WARNING))
+    m_store_cache->put(m_store_key, m_store);
+
+  m_store.reset();
+  m_store_cache.reset();
+}
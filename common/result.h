@@ -37,6 +37,11 @@
 #include <mysql/cdk/converters.h>
 #include <expr_parser.h>
 #include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 
 #include "../global.h"
 #include "session.h"
@@ -103,11 +108,11 @@ using cdk::foundation::variant;
   is used to interpret raw bytes returned by CDK in the reply to a query.
   This interpretation is done by Row_impl class which takes (shared pointer
   to) Meta_data instance as its constructor parameter and stores it in its
-  m_mdata member. Encoding format information for a given column is extracted
-  from this Meta_data instance in Row_impl::get() which then passes it
-  to Row_impl::conver_at() and eventually to the static Value::Access::mk()
-  functions which construct value from raw bytes using the format encoding
-  information.
+  m_mdata member. From this Meta_data instance Row_impl obtains a decoding
+  plan (see Decoder_plan<VAL>) which, for each column, gives a decoder
+  function specialized for the encoding of the column values. The plan is
+  built only once per result and it is used by Row_impl::convert_at() to
+  construct values from raw bytes.
 
   Row_impl is actually a template parametrized by the exact VAL class used
   to decode and store data received from the server. Normally this should be
@@ -116,8 +121,10 @@ using cdk::foundation::variant;
   X DevAPI uses a specialization to handle storage of structured data such
   as documents and arrays.
 
-  The common::Value::Access::mk() functions are defined in terms of convert()
-  function overloads defined in result.cc. They look at the encoding format
+  The decoders are defined in result.cc. Values of documents are constructed
+  by static VAL::Access::mk() function. The common::Value::Access::mk()
+  functions are defined in terms of convert() function overloads defined
+  in result.cc. They look at the encoding format
   information and use the encoder instance inside Format_descr<> object to
   convert raw bytes into a value of appropriate type.
 */
@@ -161,8 +168,9 @@ struct Format_descr<cdk::TYPE_DOCUMENT>
 
 
 /*
-  Note: we do not decode temporal values yet, thus there is
-  no codec in Format_descr class.
+  Note: temporal values are stored in their raw form and decoded only
+  when requested (see Value::get_datetime()), thus there is no codec
+  in Format_descr class.
 */
 
 template<>
@@ -358,6 +366,10 @@ public:
 };
 
 
+template <class VAL>
+struct Decoder_plan;
+
+
 /*
   Base for Meta_data<STR> template with members that do not depend on the
   tempalte parameter STR.
@@ -376,9 +388,50 @@ struct Meta_data_base
     return get_format(pos).m_type;
   }
 
+  /*
+    Return decoding plan used to build values of class VAL from raw bytes
+    of columns described by this meta-data (see Decoder_plan<VAL> below).
+    The plan is built on first request and then shared by all rows of
+    the result.
+
+    Meta-data can be shared by results used from different threads (see
+    Result_cache), so this method is thread-safe. Plans for different VAL
+    classes are kept in a list which is only appended to, under a mutex.
+    The list head is published atomically, so that finding an existing plan
+    does not take the mutex. Once created, a plan lives as long as
+    the meta-data.
+  */
+
+  template <class VAL>
+  const Decoder_plan<VAL>& get_plan() const;
+
 protected:
 
   cdk::col_count_t  m_col_count = 0;
+
+  Meta_data_base() = default;
+
+  /*
+    Note: the decoding plan refers to format descriptors of this instance
+    and thus it is not copied - the copy builds its own plan.
+  */
+
+  Meta_data_base(const Meta_data_base &other)
+    : m_col_count(other.m_col_count)
+  {}
+
+private:
+
+  struct Plan
+  {
+    const void *m_tag;
+    std::shared_ptr<void> m_plan;
+    std::unique_ptr<Plan> m_next;
+  };
+
+  mutable std::unique_ptr<Plan> m_plans;
+  mutable std::atomic<const Plan*> m_plans_head{ nullptr };
+  mutable std::mutex m_plans_lock;
 };
 
 
@@ -522,6 +575,10 @@ public:
 
   size_t size() const { return m_impl.size(); }
 
+  // Note: storage allocated for the data is kept for reuse.
+
+  void clear() { m_impl.clear(); }
+
   cdk::bytes data() const
   {
     return cdk::bytes((byte*)m_impl.data(), m_impl.size());
@@ -537,6 +594,59 @@ public:
 typedef std::map<col_count_t, Buffer> Row_data;
 
 
+/*
+  Describes a caller-provided array into which values of a single column
+  are stored by Result_impl_base::fetch_into(). The array has one element
+  per row of the batch:
+
+  - INT64, UINT64 and DOUBLE: m_data points at an array of int64_t, uint64_t
+    or double values, respectively,
+
+  - BYTES: raw bytes of the values (such as utf8 encoded strings) are stored
+    one after another in the buffer of size m_data_size pointed by m_data;
+    the value for row i occupies bytes from m_offsets[i] to m_offsets[i+1]
+    (thus m_offsets array must have one element more than the batch size).
+
+  If m_nulls is not null, then m_nulls[i] tells if value in row i is NULL
+  (in which case its array element is set to 0 or empty bytes). Column of
+  type SKIP is not stored.
+*/
+
+struct Column_buffer
+{
+  enum Type { SKIP, INT64, UINT64, DOUBLE, BYTES };
+
+  Type    m_type = SKIP;
+  void   *m_data = nullptr;
+  size_t  m_data_size = 0;
+  size_t *m_offsets = nullptr;
+  bool   *m_nulls = nullptr;
+};
+
+
+/*
+  Interface of objects which store rows read by Result_impl_base::fetch_into()
+  in some caller-defined way.
+
+  Method store() returns false if the given row could not be stored. Then no
+  more rows are passed to the sink and the row remains in the result. If this
+  is due to an error, then error() returns its description (otherwise null).
+
+  Note: store() is called from Row_processor callbacks and it should not
+  throw errors.
+*/
+
+class Row_sink
+{
+public:
+
+  virtual ~Row_sink() {}
+
+  virtual bool store(const Row_data&) = 0;
+  virtual const char* error() const = 0;
+};
+
+
 /*
   Given encoding format information, convert raw bytes to the corresponding
   value.
@@ -546,6 +656,7 @@ Value convert(cdk::bytes, Format_descr<cdk::TYPE_STRING>&);
 Value convert(cdk::bytes, Format_descr<cdk::TYPE_INTEGER>&);
 Value convert(cdk::bytes, Format_descr<cdk::TYPE_FLOAT>&);
 Value convert(cdk::bytes, Format_descr<cdk::TYPE_DOCUMENT>&);
+Value convert(cdk::bytes, Format_descr<cdk::TYPE_DATETIME>&);
 
 /*
   Generic template used when no type-specific specialization is defined.
@@ -585,6 +696,8 @@ Value Value::Access::mk(bytes data, common::Format_descr<T> &format)
   {
   case Value::RAW:
   case Value::STRING:
+  case Value::DECIMAL:
+  case Value::DATETIME:
   case Value::VNULL:
     break;
 
@@ -601,6 +714,218 @@ Value Value::Access::mk(bytes data, common::Format_descr<T> &format)
 }
 
 
+/*
+  Decoding plans
+  --------------
+
+  Decoding a value with Value::Access::mk() requires looking up column
+  format in the meta-data, extracting the Format_descr<T> from the Format_info
+  variant and then checking the encoding format (signedness, FLOAT vs. DOUBLE
+  vs. DECIMAL etc.) each time a value is decoded. Since all values in a column
+  use the same encoding, these decisions are made only once per result, when
+  a Decoder_plan is built from the meta-data.
+
+  A plan is a flat array of (decoder, format descriptor) pairs, one for
+  each column. Each decoder is specialized for one of the encodings listed
+  by Encoding enumeration and decoding a (non-null) field is a single call
+  through the decoder pointer.
+*/
+
+enum class Encoding
+{
+  RAW,            // value is presented as raw bytes
+  STRING,         // string in a character set other than utf8
+  STRING_UTF8,
+  SET,            // SET values are presented as raw bytes
+  SINT,
+  UINT,
+  FLOAT,
+  DOUBLE,
+  DECIMAL,
+  DATE,
+  DATETIME,
+  TIME,
+  DOCUMENT
+};
+
+/*
+  Return encoding used by values of a column with given format.
+*/
+
+Encoding get_encoding(const Format_info&);
+
+/*
+  Decoders for the encodings. Parameter fmt points at the Format_descr<T>
+  object of the column (where T is the CDK type of the encoding), or is null
+  for RAW encoding.
+*/
+
+template <Encoding E>
+Value decode(cdk::bytes data, void *fmt);
+
+#define DECODE_DECL(E) \
+  template<> Value decode<Encoding::E>(cdk::bytes, void*);
+
+DECODE_DECL(RAW)
+DECODE_DECL(STRING)
+DECODE_DECL(STRING_UTF8)
+DECODE_DECL(SET)
+DECODE_DECL(SINT)
+DECODE_DECL(UINT)
+DECODE_DECL(FLOAT)
+DECODE_DECL(DOUBLE)
+DECODE_DECL(DECIMAL)
+DECODE_DECL(DATE)
+DECODE_DECL(DATETIME)
+DECODE_DECL(TIME)
+
+#undef DECODE_DECL
+
+
+/*
+  Decoder<VAL,E>::decode() builds value of class VAL from raw bytes encoded
+  using encoding E. Documents are decoded by VAL::Access::mk() so that
+  VAL class can handle them in its own way (see Row_impl).
+*/
+
+template <class VAL, Encoding E>
+struct Decoder
+{
+  static VAL decode(cdk::bytes data, void *fmt)
+  {
+    return common::decode<E>(data, fmt);
+  }
+};
+
+template <class VAL>
+struct Decoder<VAL, Encoding::DOCUMENT>
+{
+  static VAL decode(cdk::bytes data, void *fmt)
+  {
+    return VAL::Access::mk(data,
+      *static_cast<Format_descr<cdk::TYPE_DOCUMENT>*>(fmt)
+    );
+  }
+};
+
+
+template <class VAL>
+struct Decoder_plan
+{
+  typedef VAL (*decoder_t)(cdk::bytes, void*);
+
+  struct Entry
+  {
+    decoder_t m_decode;
+    void     *m_fmt;
+  };
+
+  std::vector<Entry> m_cols;
+
+  Decoder_plan(const Meta_data_base &md);
+
+  VAL decode(col_count_t pos, cdk::bytes data) const
+  {
+    const Entry &col = m_cols[pos];
+    return col.m_decode(data, col.m_fmt);
+  }
+
+  // Address of this member identifies plans for VAL class.
+
+  static const char tag;
+};
+
+template <class VAL>
+const char Decoder_plan<VAL>::tag = 0;
+
+
+template <class VAL>
+inline
+Decoder_plan<VAL>::Decoder_plan(const Meta_data_base &md)
+{
+  m_cols.reserve(md.col_count());
+
+  for (col_count_t pos = 0; pos < md.col_count(); ++pos)
+  {
+    const Format_info &fi = md.get_format(pos);
+    Entry col = { nullptr, nullptr };
+
+#define FMT(T) \
+    (void*)&fi.get<cdk::TYPE_##T>()
+
+#define DECODER(E) \
+    case Encoding::E: col.m_decode = Decoder<VAL, Encoding::E>::decode; break;
+
+    switch (get_encoding(fi))
+    {
+    DECODER(RAW)
+    DECODER(STRING)
+    DECODER(STRING_UTF8)
+    DECODER(SET)
+    DECODER(SINT)
+    DECODER(UINT)
+    DECODER(FLOAT)
+    DECODER(DOUBLE)
+    DECODER(DECIMAL)
+    DECODER(DATE)
+    DECODER(DATETIME)
+    DECODER(TIME)
+    DECODER(DOCUMENT)
+    }
+
+    switch (fi.m_type)
+    {
+    case cdk::TYPE_STRING:   col.m_fmt = FMT(STRING);   break;
+    case cdk::TYPE_INTEGER:  col.m_fmt = FMT(INTEGER);  break;
+    case cdk::TYPE_FLOAT:    col.m_fmt = FMT(FLOAT);    break;
+    case cdk::TYPE_DATETIME: col.m_fmt = FMT(DATETIME); break;
+    case cdk::TYPE_DOCUMENT: col.m_fmt = FMT(DOCUMENT); break;
+    default:
+      // Note: RAW decoder does not use format descriptor.
+      break;
+    }
+
+#undef FMT
+#undef DECODER
+
+    m_cols.push_back(col);
+  }
+}
+
+
+template <class VAL>
+inline
+const Decoder_plan<VAL>& Meta_data_base::get_plan() const
+{
+  const void *tag = &Decoder_plan<VAL>::tag;
+
+  auto find = [tag](const Plan *plan) -> const Decoder_plan<VAL>* {
+    for (; plan; plan = plan->m_next.get())
+      if (tag == plan->m_tag)
+        return static_cast<const Decoder_plan<VAL>*>(plan->m_plan.get());
+    return nullptr;
+  };
+
+  auto *found = find(m_plans_head.load(std::memory_order_acquire));
+  if (found)
+    return *found;
+
+  std::lock_guard<std::mutex> guard(m_plans_lock);
+
+  found = find(m_plans.get());
+  if (found)
+    return *found;
+
+  std::unique_ptr<Plan> plan(new Plan{
+    tag, std::make_shared<Decoder_plan<VAL>>(*this), std::move(m_plans)
+  });
+  m_plans = std::move(plan);
+  m_plans_head.store(m_plans.get(), std::memory_order_release);
+
+  return *static_cast<const Decoder_plan<VAL>*>(m_plans->m_plan.get());
+}
+
+
 /*
   Implementation for a single Row instance. It holds a copy of row
   raw data and a shared pointer to row set meta-data.
@@ -615,11 +940,11 @@ Value Value::Access::mk(bytes data, common::Format_descr<T> &format)
   of VAL class in m_vals map and method get() returns references to these
   instances.
 
-  Note: VAL class must define static method template used for converting raw
-  bytes into values:
+  Values are decoded using Decoder_plan<VAL> obtained from the meta-data.
+  Note: VAL class must be constructible from common::Value and must define
+  static method used for converting raw bytes of documents into values:
 
-    template <cdk::Type_info T>
-    Value Value::Access::mk(cdk::bytes data, mysqlx::Format_descr<T>&)
+    Value Value::Access::mk(cdk::bytes data, Format_descr<TYPE_DOCUMENT>&)
 */
 
 template <class VAL = Value>
@@ -635,12 +960,17 @@ public:
 
   Row_impl(const Row_data &data, const std::shared_ptr<Meta_data_base> &md)
     : m_data(data), m_mdata(md)
+    , m_plan(md ? &md->get_plan<VAL>() : nullptr)
   {}
 
 protected:
 
   Row_data m_data;
   std::shared_ptr<Meta_data_base> m_mdata;
+
+  // Note: the plan is owned by m_mdata.
+
+  const Decoder_plan<VAL>        *m_plan = nullptr;
   std::map<col_count_t, Value>    m_vals;
   col_count_t                     m_col_count = 0;
 
@@ -651,6 +981,7 @@ public:
     m_data.clear();
     m_vals.clear();
     m_mdata.reset();
+    m_plan = nullptr;
   }
 
   col_count_t col_count() const
@@ -690,9 +1021,7 @@ public:
     {
       if (!m_mdata)
         throw;
-      const Format_info &fi = m_mdata->get_format(pos);
-      convert_at(pos, fi);
-      return m_vals.at(pos);
+      return convert_at(pos);
     }
   }
 
@@ -705,39 +1034,25 @@ public:
 
 private:
 
-  void convert_at(col_count_t pos, const Format_info &fi)
+  Value& convert_at(col_count_t pos)
   {
-    Buffer *raw = nullptr;
+    auto raw = m_data.find(pos);
 
-    try {
-      raw = &m_data.at(pos);
-    }
-    catch (const std::out_of_range&)
-    {}
-
-    if (!raw || 0 == raw->size())
+    if (raw == m_data.end() || 0 == raw->second.size())
     {
       // Null value
-      m_vals.emplace(pos, Value());
-      return;
+      return m_vals.emplace(pos, Value()).first->second;
     }
 
     /*
-      Call static function VAL::Access:mk() to construct VAL instance from
-      raw bytes and put it into m_vals map. Aprropriate encoding format
-      information is extracted from fi.
+      Use decoder from the decoding plan to construct VAL instance from
+      raw bytes and put it into m_vals map.
     */
 
-#define CONVERT(T) case cdk::TYPE_##T: \
-    m_vals.emplace(pos, \
-      VAL::Access::mk(raw->data(), fi.get<cdk::TYPE_##T>()) \
-    ); \
-    break;
-
-    switch (fi.m_type)
-    {
-      CDK_TYPE_LIST(CONVERT)
-    }
+    assert(m_plan);
+    return m_vals.emplace(pos,
+      m_plan->decode(pos, raw->second.data())
+    ).first->second;
   }
 
 };
@@ -771,6 +1086,131 @@ using Shared_meta_data = std::shared_ptr<Meta_data_base>;
 class Result_impl_base;
 
 
+/*
+  Client-side cache of results of read-only operations
+  ====================================================
+
+  Result_cache maps keys, which are serialized commands sent to the server
+  (including values of bound parameters), to results of these commands.
+  Each entry stores a private copy of result meta-data and the raw bytes of
+  all rows in a compact form: bytes of all fields concatenated in a single
+  buffer plus end offset of each field (an empty field is NULL). When an
+  operation finds its key in the cache, the stored rows are replayed by
+  Result_impl_base instead of sending the command (see Op_base::init()).
+
+  Entries expire after a time-to-live given when the cache is created.
+  The total size of stored entries is limited and when new entry does not
+  fit, the least recently used entries are evicted. Results larger than the
+  whole cache, or which have warnings, are not stored.
+
+  A cache can be shared by many operations and sessions, possibly used from
+  different threads. Entries are immutable once stored and only the cache
+  structure itself is guarded by a mutex. Operations prefix their keys with
+  the server key of the session (see Session_impl::server_key()), so that
+  sessions which connect to different servers or as different users, and
+  thus can see different data, do not get each other's results.
+*/
+
+class Result_cache
+{
+public:
+
+  using clock = std::chrono::steady_clock;
+
+  class Entry
+  {
+    Shared_meta_data     m_mdata;
+    row_count_t          m_rows = 0;
+    std::string          m_data;
+    std::vector<size_t>  m_ends;
+
+  public:
+
+    // Note: Entry takes ownership of the meta-data.
+
+    Entry(Meta_data_base *mdata)
+      : m_mdata(mdata)
+    {}
+
+    void add_row(const Row_data&);
+    void get_row(row_count_t pos, Row_data&) const;
+
+    row_count_t row_count() const { return m_rows; }
+    const Meta_data_base& get_mdata() const { return *m_mdata; }
+
+    // Approximate memory used by the entry.
+
+    size_t size() const
+    {
+      return sizeof(Entry) + m_data.size() + m_ends.size()*sizeof(size_t);
+    }
+  };
+
+  using Shared_entry = std::shared_ptr<const Entry>;
+
+  Result_cache(size_t max_bytes, std::chrono::milliseconds ttl)
+    : m_max_bytes(max_bytes), m_ttl(ttl)
+  {}
+
+  /*
+    Return entry stored under given key, or null pointer if there is no
+    such entry or it has expired. Updates hit/miss counters.
+  */
+
+  Shared_entry get(const std::string &key);
+
+  /*
+    Store entry under given key, replacing the previous one (if any) and
+    evicting least recently used entries if needed.
+  */
+
+  void put(const std::string &key, const Shared_entry&);
+
+  void clear();
+
+  size_t   max_bytes() const { return m_max_bytes; }
+  uint64_t hits() const      { return m_hits; }
+  uint64_t misses() const    { return m_misses; }
+  uint64_t evictions() const { return m_evictions; }
+  uint64_t bytes() const     { return m_bytes; }
+  uint64_t entries() const   { return m_entries; }
+
+private:
+
+  struct Slot;
+  using Index = std::unordered_map<std::string, Slot>;
+
+  // Note: pointers to keys stored in the index, most recently used first.
+
+  using Lru_list = std::list<const std::string*>;
+
+  struct Slot
+  {
+    Shared_entry        m_entry;
+    size_t              m_size;
+    clock::time_point   m_expires;
+    Lru_list::iterator  m_lru;
+  };
+
+  std::mutex  m_lock;
+  Index       m_index;
+  Lru_list    m_lru;
+
+  const size_t  m_max_bytes;
+  const std::chrono::milliseconds  m_ttl;
+
+  std::atomic<uint64_t>  m_hits{0};
+  std::atomic<uint64_t>  m_misses{0};
+  std::atomic<uint64_t>  m_evictions{0};
+  std::atomic<uint64_t>  m_bytes{0};
+  std::atomic<uint64_t>  m_entries{0};
+
+  void remove(Index::iterator);
+};
+
+using Shared_result_cache = std::shared_ptr<Result_cache>;
+
+
 /*
   An abstract interface used to initialize result of an operation.
 
@@ -798,6 +1238,15 @@ public:
   */
 
   virtual void init_result(Result_impl_base&) {} // GCOV_EXCL_LINE
+
+  /*
+    A hook called before init_result() which connects the result object with
+    client-side result cache, if the operation uses one. Depending on whether
+    the operation found its result in the cache, it calls replay() or
+    cache_into() on the result object (see Result_cache).
+  */
+
+  virtual void init_cache(Result_impl_base&) {} // GCOV_EXCL_LINE
 };
 
 
@@ -869,6 +1318,29 @@ public:
 
   row_count_t count();
 
+  /*
+    Fetch at most batch_size rows from the result, storing values of
+    the columns directly in the arrays described by cols (which should
+    contain one Column_buffer for each result column). Returns the number
+    of rows stored, which is 0 if there are no more rows.
+
+    Rows are decoded as they are received from the server without creating
+    intermediate Row_data for each of them. Fewer rows than requested are
+    stored if they do not fit into a BYTES buffer - these rows remain in
+    the result. Throws error if not even a single row can be stored or
+    if a column can not be stored in an array of the requested type.
+  */
+
+  row_count_t fetch_into(const Column_buffer *cols, col_count_t count,
+                         row_count_t batch_size);
+
+  /*
+    Generic variant of fetch_into() which passes at most batch_size rows to
+    the given Row_sink. Returns the number of rows stored by the sink.
+  */
+
+  row_count_t fetch_into(Row_sink &sink, row_count_t batch_size);
+
   /*
     Discard the reply. TODO: Implement it when needed.
   */
@@ -889,12 +1361,45 @@ public:
   */
 
   using Row_filter_t = std::function<bool(const Row_data&)>;
-  Row_filter_t m_row_filter = [](const Row_data&) { return true; };
+  Row_filter_t m_row_filter;
+
+  /*
+    If an operation is executed as several commands, only the reply to
+    the last one is handled by the result. These members hold the number of
+    rows affected by the previous commands, which is added to the count
+    reported in the reply, and the first auto-increment value generated by
+    them (0 if none).
+  */
+
+  cdk::row_count_t m_prior_affected_rows = 0;
+  cdk::row_count_t m_prior_auto_increment = 0;
+
+  /*
+    If not empty, document ids generated by all the commands, including
+    the last one. Otherwise ids reported in the reply are used.
+  */
+
+  std::vector<std::string> m_generated_ids;
 
   // Get generated document id information.
 
   const std::vector<std::string>& get_generated_ids() const;
 
+  /*
+    Client-side result cache (see Result_cache).
+
+    After replay(), the result presents rows stored in the given cache entry
+    instead of reading server reply. It has no diagnostic entries and
+    reports no affected rows or generated ids.
+
+    After cache_into(), rows read from the server reply are also stored in
+    a new cache entry. The entry is put into the cache under the given key
+    when the whole result has been read without errors and warnings.
+  */
+
+  void replay(const Result_cache::Shared_entry&);
+  void cache_into(const Shared_result_cache&, const std::string &key);
+
 protected:
 
 
@@ -935,6 +1440,13 @@ protected:
 
   virtual Meta_data_base* fetch_meta_data(cdk::Meta_data&) = 0;
 
+  /*
+    Create a copy of meta-data of this result. Copies are used to store
+    meta-data in and replay it from client-side result cache.
+  */
+
+  virtual Meta_data_base* copy_meta_data(const Meta_data_base&) = 0;
+
 
   // -- Result data
 
@@ -968,6 +1480,7 @@ protected:
   */
 
   bool load_cache(row_count_t prefetch_size = 0);
+  void read_rows(row_count_t count);
 
   void clear_cache()
   {
@@ -975,6 +1488,22 @@ protected:
     m_row_cache_size = 0;
   }
 
+  // -- Client-side result cache
+
+  Result_cache::Shared_entry  m_replay;
+  bool  m_replay_done = false;
+
+  Shared_result_cache  m_store_cache;
+  std::string          m_store_key;
+  std::shared_ptr<Result_cache::Entry>  m_store;
+
+  // Note: used to report (empty) diagnostics of a replayed result.
+
+  cdk::Diagnostic_arena  m_no_diag;
+
+  void store_row(const Row_data&);
+  void store_done();
+
 public:
 
   // -- Diagnostic information
@@ -982,6 +1511,9 @@ public:
   // Return number of diagnostic entries with given error level (defaults to ERROR).
   unsigned int entry_count(Severity::value level=Severity::ERROR) override
   {
+    if (m_replay)
+      return 0;
+
     if (!m_reply)
       THROW("Attempt to get warning count for empty result");
 
@@ -994,6 +1526,9 @@ public:
   // Iterator interface with single Error_iterator::error() method that returns the current error entry from the sequence.
   Iterator& get_entries(Severity::value level=Severity::ERROR) override
   {
+    if (m_replay)
+      return m_no_diag.get_entries(level);
+
     if (!m_reply)
       THROW("Attempt to get warning count for empty result");
 
@@ -1016,9 +1551,29 @@ private:
 
   Row_data    m_row;
 
+  /*
+    Sink which stores rows read by fetch_into(). While it is set, m_row is
+    re-used for all rows and a row is moved to the cache only if it can not
+    be stored by the sink (or batch_size rows were already stored).
+  */
+
+  struct Batch;
+  Row_sink     *m_sink = nullptr;
+  row_count_t   m_sink_count = 0;
+  row_count_t   m_sink_limit = 0;
+
+  bool sink_row(const Row_data&);
+
   bool row_begin(row_count_t) override
   {
-    m_row.clear();
+    if (!m_sink)
+    {
+      m_row.clear();
+      return true;
+    }
+
+    for (auto &field : m_row)
+      field.second.clear();
     return true;
   }
 
@@ -1036,6 +1591,8 @@ private:
 inline
 col_count_t Result_impl_base::get_col_count() const
 {
+  if (m_replay && m_mdata)
+    return m_mdata->col_count();
   if (!m_cursor)
     THROW("No result set");
   return m_cursor->col_count();
@@ -1044,16 +1601,22 @@ col_count_t Result_impl_base::get_col_count() const
 inline
 cdk::row_count_t Result_impl_base::get_affected_rows() const
 {
+  if (m_replay)
+    return m_prior_affected_rows;
   if (!m_reply)
     THROW("Attempt to get affected rows count on empty result");
-  return m_reply->affected_rows();
+  return m_prior_affected_rows + m_reply->affected_rows();
 }
 
 inline
 cdk::row_count_t Result_impl_base::get_auto_increment() const
 {
+  if (m_replay)
+    return m_prior_auto_increment;
   if (!m_reply)
     THROW("Attempt to get auto increment value on empty result");
+  if (m_prior_auto_increment)
+    return m_prior_auto_increment;
   return m_reply->last_insert_id();
 }
 
@@ -1067,8 +1630,12 @@ unsigned Result_impl_base::get_warning_count() const
 inline
 const std::vector<std::string>& Result_impl_base::get_generated_ids() const
 {
+  if (m_replay)
+    return m_generated_ids;
   if (!m_reply)
     THROW("Attempt to get generated ids for empty result");
+  if (!m_generated_ids.empty())
+    return m_generated_ids;
   return m_reply->generated_ids();
 }
 
@@ -1111,6 +1678,16 @@ class Result_impl
     return new Meta_data<STR>(md);
   }
 
+  /*
+    Note: meta-data passed here comes from results of the same kind (such as
+    DevAPI results) which all use the same STR type.
+  */
+
+  Meta_data_base* copy_meta_data(const Meta_data_base &md) override
+  {
+    return new Meta_data<STR>(static_cast<const Meta_data<STR>&>(md));
+  }
+
 public:
 
   Result_impl(Result_init &init)
@@ -1127,7 +1704,7 @@ public:
 
   const Column_info<STR>& get_column(col_count_t pos) const
   {
-    if (!m_cursor || !m_mdata)
+    if (!(m_cursor || m_replay) || !m_mdata)
       THROW("No result set");
     return static_cast<Meta_data<STR>*>(m_mdata.get())->get_column(pos);
   }
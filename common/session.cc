@@ -37,6 +37,15 @@
 #include "session.h"
 #include "result.h"
 
+#include <sstream>
+#include <cwctype>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <tuple>
+
 
 using namespace ::mysqlx::common;
 using TCPIP_options = cdk::ds::TCPIP::Options;
@@ -100,6 +109,27 @@ TLS_options::SSL_MODE get_ssl_mode(unsigned m)
 }
 
 
+cdk::ds::Load_balancing::value get_load_balancing(unsigned m)
+{
+  using DevAPI_type = Settings_impl::Load_balancing;
+  using CDK_type = cdk::ds::Load_balancing;
+
+  switch (DevAPI_type(m))
+  {
+#define LB_TO_CDK(X,N) \
+  case DevAPI_type::X: return CDK_type::X;
+
+    LOAD_BALANCING_LIST(LB_TO_CDK)
+
+  default:
+    // Note: caller should ensure that argument has correct value
+    assert(false);
+  }
+
+  return CDK_type::FAILOVER; // quiet compiler warnings
+}
+
+
 /*
   Initialize CDK connection options based on session settings.
   If socket is true, we are preparing options for a connection
@@ -192,9 +222,45 @@ void prepare_options(
 */
 
 void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
+{
+  cdk::ds::Multi_source replicas;
+  get_data_sources(src, &replicas);
+}
+
+
+bool Settings_impl::get_read_source(cdk::ds::Multi_source &src)
+{
+  if (!has_option(Option::ROUTING)
+    || Routing::READ_WRITE_SPLIT
+       != Routing(get(Option::ROUTING).get_uint())
+  )
+    return false;
+
+  cdk::ds::Multi_source primary;
+  get_data_sources(primary, &src);
+  return true;
+}
+
+
+/*
+  Initialize primary data source and, if read/write splitting is enabled,
+  the replica data source. Without read/write splitting all hosts are added
+  to the primary data source.
+*/
+
+void Settings_impl::get_data_sources(
+  cdk::ds::Multi_source &src,
+  cdk::ds::Multi_source *replicas
+)
 {
   cdk::ds::TCPIP::Options opts;
 
+  bool split = replicas && has_option(Option::ROUTING)
+    && Routing::READ_WRITE_SPLIT == Routing(get(Option::ROUTING).get_uint());
+
+  if (split && 2 > m_data.m_host_cnt)
+    throw_error("READ_WRITE_SPLIT routing requires at least two hosts");
+
   /*
     A single-host connection over Unix domain socket is considered secure.
     Otherwise SSL connection will be configured by default.
@@ -207,7 +273,75 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
 
   src.clear();
 
-  // if priorities were not set explicitly, assign decreasing starting from 100
+  src.set_policy(
+    has_option(Option::LOAD_BALANCING) ?
+    get_load_balancing((unsigned)get(Option::LOAD_BALANCING).get_uint()) :
+    cdk::ds::Load_balancing::FAILOVER
+  );
+
+  /*
+    With read/write splitting the host with the highest priority (the first
+    one if priorities are implicit) is the primary. Replicas use the same
+    load balancing policy as given in the settings, but by default new
+    sessions are spread over all replicas instead of using the first one.
+  */
+
+  unsigned primary = 0;
+  unsigned pos = 0;
+
+  if (split)
+  {
+    replicas->clear();
+    replicas->set_policy(
+      has_option(Option::LOAD_BALANCING) ?
+      get_load_balancing((unsigned)get(Option::LOAD_BALANCING).get_uint()) :
+      cdk::ds::Load_balancing::ROUND_ROBIN
+    );
+
+    if (m_data.m_user_priorities)
+    {
+      int host = -1;
+      int max_prio = -1;
+
+      for (auto it = begin(); it != end(); ++it)
+      {
+        switch (it->first)
+        {
+        case Option::HOST:
+        case Option::SOCKET:
+          ++host;
+          break;
+
+        case Option::PRIORITY:
+          if ((int)it->second.get_uint() > max_prio)
+          {
+            max_prio = (int)it->second.get_uint();
+            primary = (unsigned)host;
+          }
+          break;
+
+        default:
+          break;
+        }
+      }
+    }
+  }
+
+  auto target = [&src, replicas, split, primary, &pos]()
+    -> cdk::ds::Multi_source&
+  {
+    return (split && pos++ != primary) ? *replicas : src;
+  };
+
+  /*
+    If priorities were not set explicitly, assign decreasing starting from 100.
+
+    Note: CDK treats priority 0 as no priority and does not accept it in
+    a list with priorities, while 0 is a valid user priority. Therefore
+    priorities are passed to CDK increased by one. This also gives hosts with
+    priority 0 a non-zero weight in random load balancing.
+  */
+
   int prio = m_data.m_user_priorities ? -1 : 100;
 
   /*
@@ -242,7 +376,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
     TCPIP host with optional priority to the data source.
   */
 
-  auto add_host = [this, &src, &opts, check_prio](iterator &it, int prio) {
+  auto add_host = [this, &target, &opts, check_prio](iterator &it, int prio) {
 
     string host("localhost");
     unsigned short  port = DEFAULT_MYSQLX_PORT;
@@ -283,7 +417,9 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
     }
 #endif
 
-    src.add(cdk::ds::TCPIP(host, port), opts, (unsigned short)prio);
+    target().add(
+      cdk::ds::TCPIP(host, port), opts, (unsigned short)(prio + 1)
+    );
   };
 
   /*
@@ -296,7 +432,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
     throw_error("Unix socket connections not supported on Windows platform.");
   };
 #else
-  auto add_socket = [this, &src, &opts, check_prio](iterator &it, int prio) {
+  auto add_socket = [this, &target, &opts, check_prio](iterator &it, int prio) {
 
     assert(Option::SOCKET == it->first);
 
@@ -305,9 +441,9 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
 
     check_prio(it, prio);
 
-    src.add(cdk::ds::Unix_socket(socket),
+    target().add(cdk::ds::Unix_socket(socket),
       (cdk::ds::Unix_socket::Options&)opts,
-      (unsigned short)prio);
+      (unsigned short)(prio + 1));
 
   };
 #endif
@@ -355,3 +491,574 @@ void Session_impl::prepare_for_cmd()
     m_current_result->store();
   m_current_result = nullptr;
 }
+
+
+void Session_impl::set_routing(Settings_impl &settings)
+{
+  using Option = Settings_impl::Option;
+
+  m_routing = settings.get_read_source(m_read_source);
+
+  if (!m_routing)
+    return;
+
+  m_sticky_window = std::chrono::milliseconds(
+    settings.has_option(Option::STICKY_WINDOW) ?
+    settings.get(Option::STICKY_WINDOW).get_uint() :
+    DEFAULT_STICKY_WINDOW
+  );
+}
+
+
+void Session_impl::set_trx_begin(Settings_impl &settings)
+{
+  using Option = Settings_impl::Option;
+  using Trx_begin = Settings_impl::Trx_begin;
+
+  m_sess.set_lazy_begin(
+    settings.has_option(Option::TRX_BEGIN)
+    && Trx_begin::LAZY
+       == Trx_begin(settings.get(Option::TRX_BEGIN).get_uint())
+  );
+}
+
+
+cdk::Session& Session_impl::get_cdk_session(bool read_only)
+{
+  if (!m_routing)
+    return m_sess;
+
+  auto now = std::chrono::steady_clock::now();
+
+  if (!read_only)
+  {
+    m_last_write = now;
+    return m_sess;
+  }
+
+  if (trx_open() || now - m_last_write < m_sticky_window)
+    return m_sess;
+
+  if (!m_read_sess)
+  {
+    if (now < m_read_retry)
+      return m_sess;
+
+    try {
+      m_read_sess.reset(new cdk::Session(m_read_source));
+    }
+    catch (const cdk::Error&)
+    {}
+
+    if (!m_read_sess || !m_read_sess->is_valid())
+    {
+      m_read_sess.reset();
+      unsigned shift = std::min(m_read_failures++, 6U);
+      m_read_retry = now + std::min<std::chrono::steady_clock::duration>(
+        std::chrono::seconds(1u << shift), std::chrono::seconds(60)
+      );
+      return m_sess;
+    }
+
+    m_read_failures = 0;
+  }
+
+  return *m_read_sess;
+}
+
+
+/*
+  Catalog cache entries are shared by sessions which use the same list of
+  hosts and the same user (who might not see all objects in a schema). The
+  server key is built from these settings. Invalidation does not use it,
+  see Catalog_cache::invalidate().
+*/
+
+void Session_impl::set_catalog(Settings_impl &settings)
+{
+  using Option = Settings_impl::Option;
+
+  std::ostringstream key;
+
+  for (auto it = settings.begin(); it != settings.end(); ++it)
+  {
+    switch (it->first)
+    {
+    case Option::PORT:
+      key << unsigned(it->first) << '=' << it->second.get_uint() << ';';
+      break;
+
+    case Option::HOST:
+    case Option::SOCKET:
+    case Option::USER:
+      key << unsigned(it->first) << '=' << it->second.get_string() << ';';
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  m_server_key = key.str();
+
+  m_catalog_ttl = std::chrono::milliseconds(
+    settings.has_option(Option::CATALOG_TTL) ?
+    settings.get(Option::CATALOG_TTL).get_uint() : 0
+  );
+}
+
+
+bool Session_impl::catalog_get(
+  const string &schema, const string &name, Catalog_cache::Types &types
+) const
+{
+  if (!use_catalog())
+    return false;
+  return Catalog_cache::get(m_server_key, schema, name, m_catalog_ttl, types);
+}
+
+
+void Session_impl::catalog_put(
+  const string &schema, const string &name,
+  Catalog_cache::Types types, Catalog_cache::Epoch epoch
+) const
+{
+  if (!use_catalog())
+    return;
+  Catalog_cache::put(m_server_key, schema, name, types, epoch);
+}
+
+
+void Session_impl::catalog_invalidate(
+  const string &schema, const string &name
+) const
+{
+  Catalog_cache::invalidate(schema, name);
+}
+
+
+// ---------------------------------------------------------------------------
+
+
+/*
+  The catalog cache is implemented as a list of entries, ordered from the
+  most recently used one, and an ordered map which finds list elements by
+  key. The key is (schema, name, server). Ordering of the map puts entries
+  for a schema before entries for all objects in that schema, and entries
+  for all servers next to each other, so that they can be removed together.
+*/
+
+namespace {
+
+using Catalog_key = std::tuple<cdk::string, cdk::string, std::string>;
+
+struct Catalog_entry
+{
+  Catalog_cache::Types  m_types;
+  std::chrono::steady_clock::time_point m_stored;
+};
+
+struct Catalog
+{
+  typedef std::list<std::pair<Catalog_key, Catalog_entry>> List;
+
+  std::mutex  m_lock;
+  List        m_list;
+  std::map<Catalog_key, List::iterator>  m_map;
+  size_t      m_capacity = Catalog_cache::default_capacity;
+  size_t      m_hits = 0;
+  Catalog_cache::Epoch m_epoch = 0;
+
+  void erase(std::map<Catalog_key, List::iterator>::iterator it)
+  {
+    m_list.erase(it->second);
+    m_map.erase(it);
+  }
+
+  void trim()
+  {
+    while (m_list.size() > m_capacity)
+    {
+      m_map.erase(m_list.back().first);
+      m_list.pop_back();
+    }
+  }
+
+  static Catalog& instance()
+  {
+    static Catalog catalog;
+    return catalog;
+  }
+};
+
+}  // anonymous namespace
+
+
+bool Catalog_cache::get(
+  const std::string &server,
+  const cdk::string &schema, const cdk::string &name,
+  std::chrono::milliseconds ttl, Types &types
+)
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+
+  auto it = cache.m_map.find(Catalog_key(schema, name, server));
+
+  if (it == cache.m_map.end())
+    return false;
+
+  const Catalog_entry &entry = it->second->second;
+
+  if (std::chrono::steady_clock::now() - entry.m_stored >= ttl)
+  {
+    cache.erase(it);
+    return false;
+  }
+
+  cache.m_list.splice(cache.m_list.begin(), cache.m_list, it->second);
+  ++cache.m_hits;
+  types = entry.m_types;
+  return true;
+}
+
+
+void Catalog_cache::put(
+  const std::string &server,
+  const cdk::string &schema, const cdk::string &name,
+  Types types, Epoch epoch
+)
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+
+  if (0 == cache.m_capacity || epoch != cache.m_epoch)
+    return;
+
+  Catalog_key key(schema, name, server);
+  Catalog_entry entry{ types, std::chrono::steady_clock::now() };
+
+  auto it = cache.m_map.find(key);
+
+  if (it != cache.m_map.end())
+  {
+    it->second->second = entry;
+    cache.m_list.splice(cache.m_list.begin(), cache.m_list, it->second);
+    return;
+  }
+
+  cache.m_list.emplace_front(key, entry);
+  cache.m_map.emplace(std::move(key), cache.m_list.begin());
+  cache.trim();
+}
+
+
+void Catalog_cache::invalidate(
+  const cdk::string &schema, const cdk::string &name
+)
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+
+  ++cache.m_epoch;
+
+  auto it = cache.m_map.lower_bound(Catalog_key(schema, name, std::string()));
+
+  while (it != cache.m_map.end()
+    && std::get<0>(it->first) == schema
+    && (name.empty() || std::get<1>(it->first) == name))
+  {
+    cache.erase(it++);
+  }
+}
+
+
+Catalog_cache::Epoch Catalog_cache::epoch()
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_epoch;
+}
+
+
+void Catalog_cache::set_capacity(size_t capacity)
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  cache.m_capacity = capacity;
+  cache.trim();
+}
+
+
+size_t Catalog_cache::capacity()
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_capacity;
+}
+
+
+size_t Catalog_cache::size()
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_list.size();
+}
+
+
+size_t Catalog_cache::hits()
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  return cache.m_hits;
+}
+
+
+void Catalog_cache::clear()
+{
+  Catalog &cache = Catalog::instance();
+  std::lock_guard<std::mutex> guard(cache.m_lock);
+  cache.m_list.clear();
+  cache.m_map.clear();
+  cache.m_hits = 0;
+}
+
+
+/*
+  Split SQL statement into upper-cased words, skipping white space, comments,
+  string literals and quoted identifiers, so that words which appear inside
+  these are not taken for keywords. Other characters, such as '@', form
+  single-character tokens. The contents of executable comments (starting
+  with "/*!") is not skipped, because it is executed by the server.
+*/
+
+static void sql_tokens(
+  const std::wstring &query, std::vector<std::wstring> &tokens
+)
+{
+  auto is_word = [](wchar_t c) {
+    return (L'A' <= c && c <= L'Z') || (L'a' <= c && c <= L'z')
+        || (L'0' <= c && c <= L'9') || L'_' == c || L'$' == c || c > 0x7F;
+  };
+
+  size_t pos = 0;
+  const size_t len = query.size();
+
+  while (pos < len)
+  {
+    wchar_t c = query[pos];
+
+    if (L' ' == c || L'\t' == c || L'\r' == c || L'\n' == c)
+    {
+      ++pos;
+      continue;
+    }
+
+    if (0 == query.compare(pos, 3, L"/*!"))
+    {
+      // Skip the optional version number.
+      pos += 3;
+      while (pos < len && L'0' <= query[pos] && query[pos] <= L'9')
+        ++pos;
+      continue;
+    }
+
+    if (0 == query.compare(pos, 2, L"/*"))
+    {
+      pos = query.find(L"*/", pos + 2);
+      pos = (std::wstring::npos == pos) ? len : pos + 2;
+      continue;
+    }
+
+    if (0 == query.compare(pos, 2, L"*/"))
+    {
+      // End of "/*!" comment.
+      pos += 2;
+      continue;
+    }
+
+    if (L'#' == c || (0 == query.compare(pos, 2, L"--")
+        && (pos + 2 == len || std::iswspace(query[pos + 2]))))
+    {
+      pos = query.find(L'\n', pos);
+      if (std::wstring::npos == pos)
+        pos = len;
+      continue;
+    }
+
+    if (L'\'' == c || L'"' == c || L'`' == c)
+    {
+      // Note: doubled quote character is seen as two adjacent literals.
+
+      for (++pos; pos < len && c != query[pos]; ++pos)
+        if (L'\\' == query[pos] && L'`' != c)
+          ++pos;
+      ++pos;
+      continue;
+    }
+
+    if (!is_word(c))
+    {
+      tokens.emplace_back(1, c);
+      ++pos;
+      continue;
+    }
+
+    size_t end = pos;
+    while (end < len && is_word(query[end]))
+      ++end;
+
+    tokens.push_back(query.substr(pos, end - pos));
+    for (auto &ch : tokens.back())
+      if (L'a' <= ch && ch <= L'z')
+        ch = wchar_t(ch - L'a' + L'A');
+
+    pos = end;
+  }
+}
+
+
+/*
+  Classify SQL statement by looking at its first keyword. This is
+  conservative: anything which is not recognized as a plain read is treated
+  as a write. Reads which lock rows, store results in variables or files,
+  or depend on per-session state of the primary (user variables,
+  LAST_INSERT_ID() etc.) are also treated as writes. Statements which start
+  or end a transaction, including XA ones, and SET statements which change
+  autocommit mode are reported as such.
+
+  Other keywords are matched as whole words outside of comments, string
+  literals and quoted identifiers (see sql_tokens()).
+*/
+
+Sql_kind mysqlx::common::get_sql_kind(const std::wstring &query)
+{
+  using std::wstring;
+
+  std::vector<wstring> tokens;
+  sql_tokens(query, tokens);
+
+  if (tokens.empty())
+    return Sql_kind::WRITE;
+
+  const wstring &keyword = tokens[0];
+
+  // Check if the statement contains given sequence of words.
+
+  using Words = std::vector<const wchar_t*>;
+
+  auto contains = [&tokens](const Words &words) {
+    for (size_t pos = 1; pos + words.size() <= tokens.size(); ++pos)
+    {
+      size_t i = 0;
+      for (const wchar_t *word : words)
+      {
+        if (tokens[pos + i] != word)
+          break;
+        ++i;
+      }
+      if (words.size() == i)
+        return true;
+    }
+    return false;
+  };
+
+  if (L"START" == keyword)
+    return contains({ L"TRANSACTION" }) ? Sql_kind::TRX_BEGIN : Sql_kind::WRITE;
+
+  if (L"BEGIN" == keyword)
+    return Sql_kind::TRX_BEGIN;
+
+  if (L"XA" == keyword && 1 < tokens.size())
+  {
+    /*
+      After XA END no statements other than XA PREPARE, COMMIT or ROLLBACK
+      can be executed on the primary, so reads can go to a replica.
+    */
+
+    if (L"START" == tokens[1] || L"BEGIN" == tokens[1])
+      return Sql_kind::TRX_BEGIN;
+    if (L"END" == tokens[1] || L"COMMIT" == tokens[1]
+        || L"ROLLBACK" == tokens[1])
+      return Sql_kind::TRX_END;
+    return Sql_kind::WRITE;
+  }
+
+  if (L"SET" == keyword)
+  {
+    /*
+      Look for assignment to session autocommit variable, given as
+      [SESSION|LOCAL] autocommit, @@autocommit or @@session.autocommit.
+      A value other than a plain on/off literal is taken as off, so that
+      statements keep going to the primary if in doubt.
+    */
+
+    for (size_t pos = 1; pos + 1 < tokens.size(); ++pos)
+    {
+      if (L"AUTOCOMMIT" != tokens[pos])
+        continue;
+
+      size_t scope = (L"." == tokens[pos - 1]) ? pos - 2 : pos - 1;
+      if (L"GLOBAL" == tokens[scope] || L"PERSIST" == tokens[scope]
+          || L"PERSIST_ONLY" == tokens[scope])
+        continue;
+
+      size_t val = pos + 1;
+      while (val < tokens.size()
+             && (L"=" == tokens[val] || L":" == tokens[val]))
+        ++val;
+
+      if (val >= tokens.size())
+        break;
+
+      bool end = val + 1 == tokens.size() || L"," == tokens[val + 1];
+      const wstring &v = tokens[val];
+
+      if (end && (L"1" == v || L"ON" == v || L"TRUE" == v))
+        return Sql_kind::AUTOCOMMIT_ON;
+      return Sql_kind::AUTOCOMMIT_OFF;
+    }
+
+    return Sql_kind::WRITE;
+  }
+
+  if (L"COMMIT" == keyword || L"ROLLBACK" == keyword)
+  {
+    // ROLLBACK TO SAVEPOINT and ... AND CHAIN keep the transaction open.
+    if (contains({ L"TO" })
+        || (contains({ L"CHAIN" }) && !contains({ L"NO", L"CHAIN" })))
+      return Sql_kind::WRITE;
+    return Sql_kind::TRX_END;
+  }
+
+  if (L"SELECT" != keyword && L"SHOW" != keyword && L"DESC" != keyword
+      && L"DESCRIBE" != keyword && L"EXPLAIN" != keyword)
+    return Sql_kind::WRITE;
+
+  // SHOW statements which report per-session information.
+
+  if (L"SHOW" == keyword && 1 < tokens.size())
+  {
+    static const wchar_t *session_show[] = {
+      L"WARNINGS", L"ERRORS", L"COUNT", L"SESSION", L"LOCAL", L"STATUS",
+      L"VARIABLES"
+    };
+
+    for (const wchar_t *word : session_show)
+      if (tokens[1] == word)
+        return Sql_kind::WRITE;
+  }
+
+  static const Words write_markers[] = {
+    { L"FOR", L"UPDATE" }, { L"FOR", L"SHARE" },
+    { L"LOCK", L"IN", L"SHARE", L"MODE" }, { L"INTO" }, { L"@" },
+    { L"LAST_INSERT_ID" }, { L"FOUND_ROWS" }, { L"ROW_COUNT" },
+    { L"GET_LOCK" }, { L"RELEASE_LOCK" }
+  };
+
+  for (const auto &marker : write_markers)
+    if (contains(marker))
+      return Sql_kind::WRITE;
+
+  return Sql_kind::READ;
+}
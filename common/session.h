@@ -37,6 +37,9 @@
 
 #include <mysqlx/common.h>
 #include <mysql/cdk.h>
+#include "db_object.h"
+#include <chrono>
+#include <memory>
 
 
 namespace mysqlx {
@@ -44,6 +47,22 @@ namespace common {
 
 class Result_impl_base;
 class Result_init;
+class Settings_impl;
+
+/*
+  Kind of SQL statement as seen by read/write splitting logic. Statements
+  which start or end a transaction are recognized so that the session can
+  keep sending statements to the primary while a transaction is open.
+  The same holds for statements which switch autocommit mode off and on,
+  because a transaction is always open while autocommit is off.
+*/
+
+enum class Sql_kind {
+  READ, WRITE, TRX_BEGIN, TRX_END, AUTOCOMMIT_OFF, AUTOCOMMIT_ON
+};
+
+Sql_kind get_sql_kind(const std::wstring &query);
+
 
 /*
   Internal implementation for Session objects.
@@ -114,10 +133,137 @@ public:
 
   unsigned long m_savepoint = 0;
 
+  /*
+    Set when a transaction was started with the transaction API and not yet
+    committed or rolled back. Transactions started by plain SQL statements
+    are not tracked.
+  */
+
+  bool m_trx_open = false;
+
+  /*
+    Set transaction begin mode of the session as given by TRX_BEGIN option
+    (see cdk::Session::set_lazy_begin()).
+  */
+
+  void set_trx_begin(Settings_impl&);
+
   unsigned long next_savepoint()
   {
     return ++m_savepoint;
   }
+
+  /*
+    Read/write splitting
+    --------------------
+    If enabled with ROUTING option, m_sess is connected to the primary host
+    and read-only statements are sent over a second session connected to one
+    of the replicas. The replica session is created when the first read-only
+    statement is routed to it. If this fails, all statements go to the
+    primary and connecting to a replica is tried again after a delay (see
+    m_read_retry).
+
+    Statements are sent to the primary regardless of their kind while
+    a transaction is open (started either with the transaction API or with
+    plain SQL, including XA transactions), while autocommit is switched off
+    with SET statement, and for STICKY_WINDOW milliseconds after the last
+    write so that the session sees its own writes even if replicas lag
+    behind.
+
+    Note: The replica session does not see changes of session state done on
+    the primary, such as session variables or default schema changed with
+    USE statement.
+  */
+
+  void set_routing(Settings_impl&);
+
+  /*
+    Return CDK session to be used for the next command, which is read-only
+    if the flag is set.
+  */
+
+  cdk::Session& get_cdk_session(bool read_only);
+
+  /*
+    Set when a transaction was started or finished with plain SQL statement.
+  */
+
+  bool m_sql_trx_open = false;
+
+  // Set while autocommit is switched off with plain SQL statement.
+
+  bool m_autocommit_off = false;
+
+  // Check if a transaction is open, started either way.
+
+  bool trx_open() const
+  {
+    return m_trx_open || m_sql_trx_open || m_autocommit_off;
+  }
+
+  /*
+    Catalog cache
+    -------------
+    If enabled with CATALOG_TTL option, information about existence and
+    type of schemas and objects is looked up in the process-wide
+    Catalog_cache before querying the server, and query results are stored
+    there. Entries are shared with other sessions which connect to the same
+    hosts as the same user.
+
+    Objects created or dropped through this session are invalidated in the
+    cache even if caching is not enabled for it, so that other sessions do
+    not see stale information. This removes entries of all sessions,
+    whichever hosts and user they use.
+  */
+
+  void set_catalog(Settings_impl&);
+
+  bool catalog_get(
+    const string &schema, const string &name, Catalog_cache::Types &types
+  ) const;
+
+  void catalog_put(
+    const string &schema, const string &name,
+    Catalog_cache::Types types, Catalog_cache::Epoch epoch
+  ) const;
+
+  void catalog_invalidate(const string &schema, const string &name) const;
+
+  bool use_catalog() const
+  {
+    return 0 < m_catalog_ttl.count();
+  }
+
+  /*
+    Key which identifies the hosts and the user of this session (set by
+    set_catalog()). It is also used to separate entries of a Result_cache
+    shared by different sessions.
+  */
+
+  const std::string& server_key() const
+  {
+    return m_server_key;
+  }
+
+private:
+
+  bool m_routing = false;
+
+  /*
+    After a failed attempt to connect to a replica, reads are sent to
+    the primary until m_read_retry. The delay doubles with each consecutive
+    failure, from 1s up to 1 min.
+  */
+
+  unsigned m_read_failures = 0;
+  std::chrono::steady_clock::time_point m_read_retry;
+  cdk::ds::Multi_source m_read_source;
+  std::unique_ptr<cdk::Session> m_read_sess;
+  std::chrono::milliseconds m_sticky_window{ 0 };
+  std::chrono::steady_clock::time_point m_last_write;
+
+  std::string m_server_key;
+  std::chrono::milliseconds m_catalog_ttl{ 0 };
 };
 
 
@@ -161,6 +161,10 @@ private:
     set_option<OPT>((unsigned)val);
   }
 
+  // Set option whose string value is a number of milliseconds.
+
+  void set_msec_option(Option, const std::string &val, const char *what);
+
 
   // Any processor
 
@@ -528,6 +532,205 @@ Settings_impl::Setter::set_option<Settings_impl::Option::AUTH>(
 }
 
 
+// Load balancing policy.
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::LOAD_BALANCING>(
+  const unsigned &val
+)
+{
+  if (0 == val || val >= size_t(Load_balancing::LAST))
+    throw_error("Invalid load balancing policy");
+  add_option(Option::LOAD_BALANCING, val);
+}
+
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::LOAD_BALANCING>(
+  const std::string &val
+)
+{
+  using std::map;
+
+#define LOAD_BALANCING_MAP(X,N) { #X, Load_balancing::X },
+
+  static map< std::string, Load_balancing > policy_map{
+    LOAD_BALANCING_LIST(LOAD_BALANCING_MAP)
+  };
+
+  try {
+
+    Load_balancing p = policy_map.at(to_upper(val));
+
+    if (Load_balancing::LAST == p)
+      throw std::out_of_range("");
+
+    set_option<Option::LOAD_BALANCING>(unsigned(p));
+    return;
+  }
+  catch (const std::out_of_range&)
+  {
+    std::string msg = "Invalid load balancing policy: " + val;
+    throw_error(msg.c_str());
+    // Quiet compiler warnings
+    return;
+  }
+}
+
+
+// Statement routing.
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::ROUTING>(
+  const unsigned &val
+)
+{
+  if (0 == val || val >= size_t(Routing::LAST))
+    throw_error("Invalid routing mode");
+  add_option(Option::ROUTING, val);
+}
+
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::ROUTING>(
+  const std::string &val
+)
+{
+  using std::map;
+
+#define ROUTING_MAP(X,N) { #X, Routing::X },
+
+  static map< std::string, Routing > routing_map{
+    ROUTING_LIST(ROUTING_MAP)
+  };
+
+  try {
+
+    Routing r = routing_map.at(to_upper(val));
+
+    if (Routing::LAST == r)
+      throw std::out_of_range("");
+
+    set_option<Option::ROUTING>(unsigned(r));
+    return;
+  }
+  catch (const std::out_of_range&)
+  {
+    std::string msg = "Invalid routing mode: " + val;
+    throw_error(msg.c_str());
+    // Quiet compiler warnings
+    return;
+  }
+}
+
+
+// Transaction begin mode.
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::TRX_BEGIN>(
+  const unsigned &val
+)
+{
+  if (0 == val || val >= size_t(Trx_begin::LAST))
+    throw_error("Invalid transaction begin mode");
+  add_option(Option::TRX_BEGIN, val);
+}
+
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::TRX_BEGIN>(
+  const std::string &val
+)
+{
+  using std::map;
+
+#define TRX_BEGIN_MAP(X,N) { #X, Trx_begin::X },
+
+  static map< std::string, Trx_begin > trx_begin_map{
+    TRX_BEGIN_LIST(TRX_BEGIN_MAP)
+  };
+
+  try {
+
+    Trx_begin m = trx_begin_map.at(to_upper(val));
+
+    if (Trx_begin::LAST == m)
+      throw std::out_of_range("");
+
+    set_option<Option::TRX_BEGIN>(unsigned(m));
+    return;
+  }
+  catch (const std::out_of_range&)
+  {
+    std::string msg = "Invalid transaction begin mode: " + val;
+    throw_error(msg.c_str());
+    // Quiet compiler warnings
+    return;
+  }
+}
+
+
+/*
+  Sticky window and catalog cache TTL given in a connection string are
+  strings which must contain a number of milliseconds.
+*/
+
+inline void
+Settings_impl::Setter::set_msec_option(
+  Option opt, const std::string &val, const char *what
+)
+{
+  if (val.empty() || std::string::npos != val.find_first_not_of("0123456789"))
+  {
+    std::string msg = std::string("Invalid ") + what + ": " + val;
+    throw_error(msg.c_str());
+    return;
+  }
+
+  uint64_t ms = 0;
+
+  try {
+    ms = std::stoull(val);
+  }
+  catch (const std::out_of_range&)
+  {
+    ms = UINT64_MAX;
+  }
+
+  if (!check_num_limits<unsigned>(ms))
+  {
+    std::string msg = std::string("Value of ") + what + " too big";
+    throw_error(msg.c_str());
+  }
+
+  add_option(opt, (unsigned)ms);
+}
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::STICKY_WINDOW>(
+  const std::string &val
+)
+{
+  set_msec_option(Option::STICKY_WINDOW, val, "sticky window");
+}
+
+template<>
+inline void
+Settings_impl::Setter::set_option<Settings_impl::Option::CATALOG_TTL>(
+  const std::string &val
+)
+{
+  set_msec_option(Option::CATALOG_TTL, val, "catalog TTL");
+}
+
+
 // Other options that need special handling.
 // TODO: support std::string for PWD and other options that are ascii only?
 
@@ -55,11 +55,179 @@ void Value::print(std::ostream &out) const
   case STRING: out << (std::string)m_str; return;
   case WSTRING: out << cdk::string(m_wstr); return;
   case RAW: out << "<" << m_str.length() << " raw bytes>"; return;
+  case DECIMAL: out << get_decimal(); return;
+  case DATETIME: out << get_datetime(); return;
   default:  out << "<unknown value>"; return;
   }
 }
 
 
+// Format_info describing DECIMAL values
+
+class Decimal_format_info
+  : public cdk::Format_info
+{
+  bool for_type(cdk::Type_info ti) const override
+  {
+    return cdk::TYPE_FLOAT == ti;
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_FLOAT> &fmt) const override
+  {
+    cdk::Format<cdk::TYPE_FLOAT>::Access::set_fmt(
+      fmt, cdk::Format<cdk::TYPE_FLOAT>::DECIMAL
+    );
+  }
+
+  using cdk::Format_info::get_info;
+};
+
+
+Decimal Value::get_decimal() const
+{
+  switch (m_type)
+  {
+  case DECIMAL:
+    {
+      static const Decimal_format_info fi;
+      cdk::Codec<cdk::TYPE_FLOAT> codec(fi);
+      cdk::Decimal val;
+      codec.from_bytes(bytes((byte*)m_str.data(), m_str.length()), val);
+      return { val.lo, val.hi, val.scale, val.negative };
+    }
+
+  case UINT64:
+  case BOOL:
+    return { get_uint(), 0, 0, false };
+
+  case INT64:
+    if (0 > m_val.v_sint)
+      return { 0 - (uint64_t)m_val.v_sint, 0, 0, true };
+    return { (uint64_t)m_val.v_sint, 0, 0, false };
+
+  default:
+    throw Error("Value cannot be converted to decimal number");
+  }
+}
+
+
+std::string Decimal::str() const
+{
+  cdk::Decimal val;
+  val.lo = m_lo;
+  val.hi = m_hi;
+  val.scale = m_scale;
+  val.negative = m_negative;
+  return val.str();
+}
+
+
+double Decimal::to_double() const
+{
+  cdk::Decimal val;
+  val.lo = m_lo;
+  val.hi = m_hi;
+  val.scale = m_scale;
+  val.negative = m_negative;
+  return val.to_double();
+}
+
+
+// Format_info describing temporal values of given type
+
+class Datetime_format_info
+  : public cdk::Format_info
+{
+  Datetime::Type m_type;
+
+public:
+
+  Datetime_format_info(Datetime::Type type)
+    : m_type(type)
+  {}
+
+private:
+
+  bool for_type(cdk::Type_info ti) const override
+  {
+    return cdk::TYPE_DATETIME == ti;
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_DATETIME> &fmt) const override
+  {
+    typedef cdk::Format<cdk::TYPE_DATETIME> Format;
+
+    switch (m_type)
+    {
+    case Datetime::TIME:
+      Format::Access::set_fmt(fmt, Format::TIME, true); break;
+    case Datetime::DATE:
+      Format::Access::set_fmt(fmt, Format::DATETIME, false); break;
+    case Datetime::DATETIME:
+      Format::Access::set_fmt(fmt, Format::DATETIME, true); break;
+    }
+  }
+
+  using cdk::Format_info::get_info;
+};
+
+
+Value::Value(const Datetime &val)
+  : m_type(DATETIME)
+{
+  m_val.v_uint = val.type();
+
+  cdk::Datetime dt;
+  dt.year = val.year();
+  dt.month = val.month();
+  dt.day = val.day();
+  dt.hour = val.hour();
+  dt.minute = val.minute();
+  dt.second = val.second();
+  dt.usec = val.usec();
+  dt.negative = val.is_negative();
+
+  byte buf[cdk::Codec<cdk::TYPE_DATETIME>::max_size];
+  Datetime_format_info fi(val.type());
+  cdk::Codec<cdk::TYPE_DATETIME> codec(fi);
+  size_t len = codec.to_bytes(dt, bytes(buf, sizeof(buf)));
+  m_str.assign((const char*)buf, len);
+}
+
+
+Datetime Value::get_datetime() const
+{
+  if (DATETIME != m_type)
+    throw Error("Value cannot be converted to temporal value");
+
+  Datetime::Type type = (Datetime::Type)m_val.v_uint;
+  Datetime_format_info fi(type);
+  cdk::Codec<cdk::TYPE_DATETIME> codec(fi);
+  cdk::Datetime dt;
+  codec.from_bytes(bytes((byte*)m_str.data(), m_str.length()), dt);
+
+  return {
+    type, dt.negative, dt.year, dt.month, dt.day,
+    dt.hour, dt.minute, dt.second, dt.usec
+  };
+}
+
+
+std::string Datetime::str() const
+{
+  cdk::Datetime dt;
+  dt.year = m_year;
+  dt.month = m_month;
+  dt.day = m_day;
+  dt.hour = m_hour;
+  dt.minute = m_minute;
+  dt.second = m_second;
+  dt.usec = m_usec;
+  dt.negative = m_negative;
+  return dt.str(TIME != m_type, DATE != m_type);
+}
+
+
 // Trivial Format_info for raw byte values
 
 class Raw_format_info
@@ -87,6 +255,18 @@ void Value::Access::process_val(
     case Value::UINT64:    prc.num(val.get_uint()); break;
     case Value::FLOAT:   prc.num(val.get_float()); break;
     case Value::DOUBLE:  prc.num(val.get_double()); break;
+    case Value::DECIMAL: prc.num(val.get_double()); break;
+    case Value::DATETIME:
+    {
+      size_t size;
+      const byte*  ptr = val.get_bytes(&size);
+      prc.value(
+        cdk::TYPE_DATETIME,
+        Datetime_format_info((Datetime::Type)val.m_val.v_uint),
+        bytes((byte*)ptr, size)
+      );
+      break;
+    }
     case Value::BOOL:    prc.yesno(val.get_bool()); break;
     case Value::STRING:  prc.str(val.get_string()); break;
     case Value::WSTRING:  prc.str(val.get_wstring()); break;
@@ -120,8 +300,8 @@ void Value::Access::process(
 {
   if (Value::EXPR == val.get_type())
   {
-    parser::Expression_parser parser{ pm, val.get_wstring() };
-    parser.process(prc);
+    parser::Cached_expr expr{ pm, val.get_wstring() };
+    expr.process(prc);
     return;
   }
 
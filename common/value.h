@@ -35,6 +35,7 @@
 #include <mysqlx/common.h>
 #include <mysql/cdk.h>
 #include <expr_parser.h>
+#include <expr_cache.h>
 
 
 namespace mysqlx {
@@ -58,6 +59,47 @@ struct Value::Access
     return { Value::JSON, json };
   }
 
+  /*
+    Create DECIMAL value from its raw bytes and the approximation
+    used by get_double(). The raw bytes are kept for exact decoding.
+  */
+
+  static Value mk_decimal(bytes data, double approx)
+  {
+    Value val(approx);
+    val.m_type = Value::DECIMAL;
+    val.m_str.assign(data.begin(), data.end());
+    return val;
+  }
+
+  /*
+    Create temporal value of given type from its X protocol encoding,
+    which is kept in the value and decoded when requested.
+  */
+
+  static Value mk_datetime(bytes data, Datetime::Type type)
+  {
+    Value val;
+    val.m_type = Value::DATETIME;
+    val.m_val.v_uint = type;
+    val.m_str.assign(data.begin(), data.end());
+    return val;
+  }
+
+  /*
+    Store raw representation of a value decoded from given bytes
+    (as done by mk() below).
+  */
+
+  static void set_raw(Value &val, bytes data)
+  {
+    /*
+      Note: Trailing '\0' byte is used for NULL value detection and is not
+      part of the data
+    */
+    val.m_str.assign(data.begin(), data.end()-1);
+  }
+
   // Create value from raw bytes, given CDK format description.
 
   template<cdk::Type_info T>
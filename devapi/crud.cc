@@ -55,6 +55,56 @@ auto internal::Crud_factory::mk_sql(mysqlx::Session &sess, const string &query)
 
 
 
+// --------------------------------------------------------------------
+
+/*
+  Client-side result cache
+  ========================
+*/
+
+
+ResultCache::ResultCache(std::chrono::milliseconds ttl, size_t max_bytes)
+{
+  try {
+    m_impl = std::make_shared<common::Result_cache>(max_bytes, ttl);
+  }
+  CATCH_AND_WRAP
+}
+
+uint64_t ResultCache::getHits() const
+{
+  return m_impl->hits();
+}
+
+uint64_t ResultCache::getMisses() const
+{
+  return m_impl->misses();
+}
+
+uint64_t ResultCache::getEvictions() const
+{
+  return m_impl->evictions();
+}
+
+uint64_t ResultCache::getBytes() const
+{
+  return m_impl->bytes();
+}
+
+uint64_t ResultCache::getEntries() const
+{
+  return m_impl->entries();
+}
+
+void ResultCache::clear()
+{
+  try {
+    m_impl->clear();
+  }
+  CATCH_AND_WRAP
+}
+
+
 // --------------------------------------------------------------------
 
 /*
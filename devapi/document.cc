@@ -31,6 +31,7 @@
 #include <mysql/cdk.h>
 #include <mysqlx/xdevapi.h>
 #include <json_parser.h>
+#include <mysql/cdk/foundation/utf8.h>
 
 /**
   @file
@@ -43,6 +44,7 @@
 #include <sstream>
 #include <iomanip>
 #include <memory>
+#include <algorithm>
 
 using namespace ::mysqlx;
 using std::endl;
@@ -127,13 +129,14 @@ struct DbDoc::Impl::Builder
   , public cdk::JSON::Processor::Any_prc
   , public cdk::JSON::Processor::Any_prc::Scalar_prc
 {
+  DbDoc::Impl &m_impl;
   Map  &m_map;
   mysqlx::string m_key;
 
 public:
 
   Builder(DbDoc::Impl &doc)
-    : m_map(doc.m_map)
+    : m_impl(doc), m_map(doc.m_map)
   {}
 
   // JSON processor (to build the docuemnt)
@@ -144,7 +147,9 @@ public:
   }
 
   void doc_end()
-  {}
+  {
+    m_impl.sort_fields();
+  }
 
   cdk::JSON::Processor::Any_prc*
   key_val(const cdk::string &key)
@@ -257,7 +262,8 @@ public:
   arr()
   {
     using mysqlx::Value;
-    Value &arr = m_map[m_key];
+    m_map.emplace_back(m_key, Value());
+    Value &arr = m_map.back().second;
 
     // Turn the value to one storing an array.
 
@@ -277,7 +283,8 @@ public:
   doc()
   {
     using mysqlx::Value;
-    Value &sub = m_map[m_key];
+    m_map.emplace_back(m_key, Value());
+    Value &sub = m_map.back().second;
 
     // Turn the value to one storing a document.
 
@@ -301,49 +308,162 @@ public:
     key given by m_key.
   */
 
-  void null() { m_map.emplace(m_key, Value()); }
+  void null() { m_map.emplace_back(m_key, Value()); }
   void str(const cdk::string &val)
   {
-    m_map.emplace(m_key, mysqlx::string(val));
+    m_map.emplace_back(m_key, mysqlx::string(val));
   }
-  void num(uint64_t val)  { m_map.emplace(m_key, val); }
-  void num(int64_t val)   { m_map.emplace(m_key, val); }
-  void num(float val)     { m_map.emplace(m_key, val); }
-  void num(double val)    { m_map.emplace(m_key, val); }
-  void yesno(bool val)    { m_map.emplace(m_key, val); }
+  void num(uint64_t val)  { m_map.emplace_back(m_key, val); }
+  void num(int64_t val)   { m_map.emplace_back(m_key, val); }
+  void num(float val)     { m_map.emplace_back(m_key, val); }
+  void num(double val)    { m_map.emplace_back(m_key, val); }
+  void yesno(bool val)    { m_map.emplace_back(m_key, val); }
 
 };
 
 
+/*
+  Build structural index of the document, if not yet done. If a field
+  appears several times in the document, only the first occurrence is kept.
+
+  Note: Sorting by UTF8 representation of field names gives the same order
+  as sorting Field values, which compare code points.
+*/
+
 void DbDoc::Impl::JSONDoc::prepare()
 {
-  if (m_parsed)
+  if (m_indexed)
     return;
 
-  cdk::Codec<cdk::TYPE_DOCUMENT> codec;
-  Builder bld(*this);
-  codec.from_bytes(cdk::bytes(m_json), bld);
-  m_parsed = true;
+  struct Indexer : public parser::JSON_parser::Index_prc
+  {
+    Index  &m_index;
+    size_t m_offset;
+
+    Indexer(Index &index, size_t offset)
+      : m_index(index), m_offset(offset)
+    {}
+
+    void field(const std::string &key, size_t beg, size_t end)
+    {
+      m_index.push_back(
+        { key, Field(), m_offset + beg, m_offset + end, nullptr }
+      );
+    }
+  }
+  indexer(m_index, m_beg);
+
+  m_index.clear();
+  m_values.clear();
+  parser::JSON_parser::index(m_buf->data() + m_beg, m_buf->data() + m_end,
+                             indexer);
+
+  std::stable_sort(m_index.begin(), m_index.end(),
+    [](const Field_pos &a, const Field_pos &b) {
+      return a.m_key < b.m_key;
+    });
+
+  m_index.erase(
+    std::unique(m_index.begin(), m_index.end(),
+      [](const Field_pos &a, const Field_pos &b) {
+        return a.m_key == b.m_key;
+      }),
+    m_index.end()
+  );
+
+  m_indexed = true;
+}
+
+
+auto DbDoc::Impl::JSONDoc::find(const Field &fld) -> Field_pos*
+{
+  std::string key = static_cast<const mysqlx::string&>(fld);
+
+  auto it = std::lower_bound(m_index.begin(), m_index.end(), key,
+    [](const Field_pos &pos, const std::string &key) {
+      return pos.m_key < key;
+    });
+
+  if (it == m_index.end() || it->m_key != key)
+    return nullptr;
+
+  return &(*it);
+}
+
+
+const Field& DbDoc::Impl::JSONDoc::get_current_fld()
+{
+  if (static_cast<const mysqlx::string&>(m_pos->m_fld).empty())
+    m_pos->m_fld = Field(mysqlx::string(m_pos->m_key));
+  return m_pos->m_fld;
+}
+
+
+const Value& DbDoc::Impl::JSONDoc::get(const Field &fld) const
+{
+  JSONDoc *self = const_cast<JSONDoc*>(this);
+
+  self->prepare();
+
+  Field_pos *pos = self->find(fld);
+
+  if (!pos)
+    throw std::out_of_range("document field not found");
+
+  if (pos->m_val)
+    return *pos->m_val;
+
+  return self->decode(*pos);
 }
 
 
 /*
-  Parse JSON string and build a corresponding Value.
+  Decode value of a field from the JSON string. Sub-documents are not
+  decoded here but stored as another JSONDoc instance. Strings without
+  escape sequences are copied to the value as UTF8 bytes.
 */
 
-Value Value::Access::mk_from_json(const std::string &json)
+const Value& DbDoc::Impl::JSONDoc::decode(Field_pos &pos)
 {
-  typedef parser::Any_parser<
-    parser::JSON_scalar_parser,
-    cdk::JSON_processor
-  > Parser;
+  const char *beg = m_buf->data() + pos.m_beg;
+  const char *end = m_buf->data() + pos.m_end;
+
+  m_values.emplace_front();
+  Value &val = m_values.front();
+
+  switch (*beg)
+  {
+  case '{':
+    val = DbDoc(std::make_shared<JSONDoc>(m_buf, pos.m_beg, pos.m_end));
+    break;
+
+  case '"':
+  case '\'':
+    if (end - 1 == std::find(beg + 1, end - 1, '\\')
+        && cdk::foundation::utf8::valid(
+             (const cdk::byte*)beg + 1, (const cdk::byte*)end - 1))
+    {
+      val = Value(std::string(beg + 1, end - 1));
+      break;
+    }
+    FALLTHROUGH;
+
+  default:
+    val = Value::Access::mk_from_json(std::string(beg, end));
+    break;
+  }
+
+  pos.m_val = &val;
+  return val;
+}
 
-  // Create parser for the JSON string.
 
-  parser::Tokenizer toks(json);
-  auto first = toks.begin();
-  Parser parser(first, toks.end());
+/*
+  Parse JSON string and build a corresponding Value.
+*/
 
+Value Value::Access::mk_from_json(const std::string &json)
+{
   /*
     Define builder which acts as JSON value processor and
     builds the corresponding Value object.
@@ -399,7 +519,8 @@ Value Value::Access::mk_from_json(const std::string &json)
 
   Value val;
   builder.m_val = &val;
-  parser.process(builder);
+  parser::JSON_parser::parse_any(json.data(), json.data() + json.size(),
+                                 builder);
 
   return std::move(val);
 }
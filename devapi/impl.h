@@ -44,6 +44,9 @@
 #include <memory>
 #include <stack>
 #include <list>
+#include <vector>
+#include <forward_list>
+#include <algorithm>
 
 #include "../global.h"
 #include "../common/result.h"
@@ -270,7 +273,9 @@ struct Object_ref : public common::Object_ref
 
 
 /*
-  DbDoc implementation which stores document data in std::map.
+  DbDoc implementation which stores document data in a vector of fields
+  sorted by field names. Unlike a node based map, this keeps all fields of
+  a document in a single memory block.
 */
 
 class DbDoc::Impl
@@ -286,19 +291,56 @@ class DbDoc::Impl
 
   // Data storage
 
-  typedef std::map<Field, Value> Map;
+  typedef std::pair<Field, Value> Field_val;
+  typedef std::vector<Field_val> Map;
   Map m_map;
 
-  bool has_field(const Field &fld)
+  Map::iterator find(const Field &fld)
+  {
+    auto it = std::lower_bound(m_map.begin(), m_map.end(), fld,
+      [](const Field_val &el, const Field &fld) {
+        return el.first < fld;
+      });
+
+    if (it != m_map.end() && it->first == fld)
+      return it;
+    return m_map.end();
+  }
+
+  /*
+    Sort fields after they were appended to m_map. Only the first
+    occurrence of a field which is repeated in the document is kept.
+  */
+
+  void sort_fields()
+  {
+    std::stable_sort(m_map.begin(), m_map.end(),
+      [](const Field_val &a, const Field_val &b) {
+        return a.first < b.first;
+      });
+    m_map.erase(
+      std::unique(m_map.begin(), m_map.end(),
+        [](const Field_val &a, const Field_val &b) {
+          return a.first == b.first;
+        }),
+      m_map.end()
+    );
+  }
+
+  virtual bool has_field(const Field &fld)
   {
     prepare();
-    return m_map.end() != m_map.find(fld);
+    return m_map.end() != find(fld);
   }
 
-  const Value& get(const Field &fld) const
+  virtual const Value& get(const Field &fld) const
   {
-    const_cast<Impl*>(this)->prepare();
-    return m_map.at(fld);
+    Impl *self = const_cast<Impl*>(this);
+    self->prepare();
+    auto it = self->find(fld);
+    if (it == m_map.end())
+      throw std::out_of_range("document field not found");
+    return it->second;
   }
 
   virtual const char* get_json() const
@@ -310,11 +352,11 @@ class DbDoc::Impl
 
   Map::iterator m_it;
 
-  void reset() { prepare(); m_it = m_map.begin(); }
+  virtual void reset() { prepare(); m_it = m_map.begin(); }
 
-  const Field& get_current_fld() { return m_it->first; }
-  void next() { ++m_it; }
-  bool at_end() const { return m_it == m_map.end(); }
+  virtual const Field& get_current_fld() { return m_it->first; }
+  virtual void next() { ++m_it; }
+  virtual bool at_end() const { return m_it == m_map.end(); }
 
   struct Builder;
 
@@ -328,30 +370,116 @@ class DbDoc::Impl
 /*
   DbDoc::Impl specialization which takes document data from
   a JSON string.
+
+  The JSON string is not parsed as a whole. Instead, on first access to
+  document fields, a structural index is built which holds, for each
+  top-level field, its name and the range of bytes in the JSON string where
+  its value is stored. The index is sorted by field names. Field names are
+  kept as UTF8 strings, which for typical names fit in the string object
+  itself, and converted to Field only when fields are enumerated.
+
+  A field value is decoded only when it is requested for the first time
+  and then stored in m_values. Values which are sub-documents are again
+  represented by JSONDoc instances which share the JSON string with the
+  parent document, so that their fields are decoded lazily as well and
+  without copying the JSON text. String values without escape sequences
+  are copied directly from the JSON string as UTF8 strings. Conversion to
+  wide string happens only if such value is requested in this form.
 */
 
 class DbDoc::Impl::JSONDoc
   : public DbDoc::Impl
 {
-  std::string m_json;
-  bool m_parsed;
+  /*
+    The JSON string, shared with JSONDoc instances of sub-documents, and
+    the range [m_beg, m_end) in it which holds this document.
+  */
+
+  std::shared_ptr<const std::string> m_buf;
+  size_t m_beg;
+  size_t m_end;
+
+  // Null terminated copy of a sub-document, created by get_json().
+
+  mutable std::string m_json;
+
+  bool m_indexed;
+
+  struct Field_pos
+  {
+    std::string m_key;
+    Field       m_fld;    // set when field is enumerated
+    size_t      m_beg;
+    size_t      m_end;
+    Value      *m_val;    // NULL until the value is decoded
+  };
+
+  typedef std::vector<Field_pos> Index;
+
+  Index m_index;
+  Index::iterator m_pos;
+
+  // Note: values stored in a list do not move when new ones are added.
+
+  std::forward_list<Value> m_values;
+
+  Field_pos* find(const Field&);
+  const Value& decode(Field_pos&);
 
 public:
 
   JSONDoc(const std::string &json)
-    : m_json(json)
-    , m_parsed(false)
+    : m_buf(std::make_shared<const std::string>(json))
+    , m_beg(0)
+    , m_end(json.size())
+    , m_indexed(false)
+  {
+    // Note: the JSON string can be terminated by null byte.
+
+    if (m_end > 0 && '\0' == json[m_end - 1])
+      --m_end;
+  }
+
+  JSONDoc(const std::shared_ptr<const std::string> &buf,
+          size_t beg, size_t end)
+    : m_buf(buf)
+    , m_beg(beg)
+    , m_end(end)
+    , m_indexed(false)
   {}
 
   void prepare();
 
+  bool has_field(const Field &fld)
+  {
+    prepare();
+    return nullptr != find(fld);
+  }
+
+  const Value& get(const Field &fld) const;
+
+  void reset()
+  {
+    prepare();
+    m_pos = m_index.begin();
+  }
+
+  const Field& get_current_fld();
+  void next() { ++m_pos; }
+  bool at_end() const { return m_pos == m_index.end(); }
+
   void print(std::ostream &out) const
   {
-    out << m_json;
+    out.write(m_buf->data() + m_beg, (std::streamsize)(m_end - m_beg));
   }
 
   const char* get_json() const
   {
+    if (0 == m_beg && m_buf->size() == m_end)
+      return m_buf->c_str();
+
+    if (m_json.empty())
+      m_json.assign(*m_buf, m_beg, m_end - m_beg);
     return m_json.c_str();
   }
 };
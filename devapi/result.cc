@@ -32,6 +32,7 @@
 #include <mysqlx/xdevapi.h>
 
 #include "impl.h"
+#include "../common/arrow.h"
 
 #include <vector>
 #include <sstream>
@@ -615,6 +616,49 @@ row_count_t internal::Row_result_detail<Columns>::row_count()
 }
 
 
+template<>
+row_count_t internal::Row_result_detail<Columns>::fetch_into(
+  const ColumnBuffer *cols, col_count_t count, row_count_t batch_size
+)
+{
+  std::vector<common::Column_buffer> bufs(count);
+
+  for (col_count_t pos = 0; pos < count; ++pos)
+  {
+    common::Column_buffer &buf = bufs[pos];
+    buf.m_type = common::Column_buffer::Type(cols[pos].type);
+    buf.m_data = cols[pos].data;
+    buf.m_data_size = cols[pos].size;
+    buf.m_offsets = cols[pos].offsets;
+    buf.m_nulls = cols[pos].nulls;
+  }
+
+  auto cnt = get_impl().fetch_into(bufs.data(), count, batch_size);
+  ASSERT_NUM_LIMITS(row_count_t, cnt);
+  return (row_count_t)cnt;
+}
+
+
+template<>
+void internal::Row_result_detail<Columns>::get_arrow_schema(
+  ArrowSchema *schema
+)
+{
+  common::get_arrow_schema(get_impl(), schema);
+}
+
+
+template<>
+row_count_t internal::Row_result_detail<Columns>::fetch_arrow(
+  ArrowArray *array, row_count_t batch_size
+)
+{
+  auto cnt = common::fetch_arrow(get_impl(), array, batch_size);
+  ASSERT_NUM_LIMITS(row_count_t, cnt);
+  return (row_count_t)cnt;
+}
+
+
 /*
   DocResult
   =========
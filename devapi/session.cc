@@ -94,6 +94,9 @@ internal::Session_detail::Session_detail(common::Settings_impl &settings)
     cdk::ds::Multi_source source;
     settings.get_data_source(source);
     m_impl = std::make_shared<Impl>(source);
+    m_impl->set_routing(settings);
+    m_impl->set_catalog(settings);
+    m_impl->set_trx_begin(settings);
 
   }
   CATCH_AND_WRAP
@@ -153,6 +156,13 @@ void internal::Session_detail::commit()
 }
 
 
+void internal::Session_detail::commit_after_next()
+{
+  common::Op_trx<common::Trx_op::COMMIT_AFTER_NEXT> cmd(m_impl);
+  cmd.execute();
+}
+
+
 void internal::Session_detail::rollback(const string &sp)
 {
   common::Op_trx<common::Trx_op::ROLLBACK> cmd(m_impl, sp);
@@ -260,6 +270,42 @@ void internal::Schema_detail::drop_collection(const mysqlx::string& name)
 }
 
 
+bool internal::Schema_detail::check_exists() const
+{
+  Schema_ref schema(m_name);
+  return common::check_schema_exists(m_sess, schema);
+}
+
+
+bool internal::Schema_detail::check_exists(
+  Obj_type type, const string &name, bool *is_view
+) const
+{
+  using common::Catalog_cache;
+
+  Object_ref obj(m_name, name);
+  Catalog_cache::Types types = common::get_object_types(m_sess, obj);
+
+  switch (type)
+  {
+  case COLLECTION:
+    return 0 != (types & Catalog_cache::type_bit(Object_type::COLLECTION));
+
+  case TABLE:
+    {
+      Catalog_cache::Types table = Catalog_cache::type_bit(Object_type::TABLE);
+      Catalog_cache::Types view = Catalog_cache::type_bit(Object_type::VIEW);
+
+      if (is_view)
+        *is_view = !(types & table) && (types & view);
+      return 0 != (types & (table | view));
+    }
+  }
+
+  return false;
+}
+
+
 
 internal::Schema_detail::Name_src::Name_src(
   const Schema &sch,
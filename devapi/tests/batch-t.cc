@@ -332,3 +332,68 @@ TEST_F(Batch, table_insert)
   }
 }
 
+
+
+TEST_F(Batch, chunked_add)
+{
+  SKIP_IF_NO_XPLUGIN;
+
+  Collection coll = getSchema("test").createCollection("chunked_add", true);
+  coll.remove("true").execute();
+
+  std::vector<string> docs;
+
+  for (unsigned i = 0; i < 100; ++i)
+  {
+    std::ostringstream buf;
+    buf << "{ \"pos\": " << i << ", \"name\": \"chunked add test\" }";
+    docs.push_back(buf.str());
+  }
+
+  cout << endl << "1. Adding documents in chunks" << endl;
+
+  Result res = coll.add(docs).chunkSize(512).execute();
+
+  EXPECT_EQ(100, res.getAffectedItemsCount());
+  std::vector<std::string> ids = res.getGeneratedIds();
+  EXPECT_EQ(100, ids.size());
+  EXPECT_EQ(100, coll.find().execute().count());
+
+  cout << endl << "2. Atomic chunked add" << endl;
+
+  // The last document has duplicate id - nothing should be added.
+
+  coll.remove("true").execute();
+  docs.push_back("{ \"_id\": \"dup\" }");
+  docs.insert(docs.begin(), "{ \"_id\": \"dup\" }");
+
+  EXPECT_THROW(coll.add(docs).chunkSize(512).execute(), Error);
+  EXPECT_EQ(0, coll.find().execute().count());
+
+  cout << endl << "3. Atomic chunked add within a transaction" << endl;
+
+  get_sess().startTransaction();
+  coll.add("{ \"_id\": \"trx\" }").execute();
+  EXPECT_THROW(coll.add(docs).chunkSize(512).execute(), Error);
+  get_sess().commit();
+  EXPECT_EQ(1, coll.find().execute().count());
+
+  /*
+    A transaction started with SQL must not be committed by the add
+    operation, so rolling it back removes the document added before.
+  */
+
+  cout << endl << "3a. Atomic chunked add within SQL transaction" << endl;
+
+  sql("START TRANSACTION");
+  coll.add("{ \"_id\": \"sql_trx\" }").execute();
+  EXPECT_THROW(coll.add(docs).chunkSize(512).execute(), Error);
+  sql("ROLLBACK");
+  EXPECT_EQ(1, coll.find().execute().count());
+
+  cout << endl << "4. Non-atomic chunked add" << endl;
+
+  coll.remove("true").execute();
+  EXPECT_THROW(coll.add(docs).chunkSize(512, false).execute(), Error);
+  EXPECT_EQ(101, coll.find().execute().count());
+}
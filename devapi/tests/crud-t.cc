@@ -2526,3 +2526,502 @@ TEST_F(Crud, merge_patch)
   }
 
 }
+
+
+TEST_F(Crud, fetch_into)
+{
+  SKIP_IF_NO_XPLUGIN;
+
+  sql("DROP TABLE IF EXISTS test.fetch_into");
+  sql("CREATE TABLE test.fetch_into(id INT, val DOUBLE, name VARCHAR(32))");
+
+  Table tbl = get_sess().getSchema("test").getTable("fetch_into");
+
+  auto insert = tbl.insert("id", "val", "name");
+
+  for (int i = 0; i < 100; ++i)
+  {
+    std::stringstream name;
+    name << "row" << i;
+    insert.values(i, i/2.0, 0 == i % 10 ? Value() : Value(name.str()));
+  }
+
+  insert.execute();
+
+  RowResult res = tbl.select("id", "val", "name").orderBy("id").execute();
+
+  // Rows fetched with fetchOne() are not seen by fetchInto().
+
+  EXPECT_EQ(0, res.fetchOne()[0].get<int>());
+
+  int64_t ids[16];
+  double  vals[16];
+  char    names[64];
+  size_t  offsets[17];
+  bool    nulls[16];
+
+  std::vector<ColumnBuffer> cols = {
+    ColumnBuffer(ids),
+    ColumnBuffer(vals),
+    ColumnBuffer(names, sizeof(names), offsets, nulls)
+  };
+
+  /*
+    Note: names buffer can not hold 16 names, so some batches are cut short
+    when it becomes full.
+  */
+
+  int64_t id = 1;
+  row_count_t cnt;
+
+  while (0 < (cnt = res.fetchInto(cols, 16)))
+  {
+    EXPECT_GE(16U, cnt);
+
+    for (row_count_t i = 0; i < cnt; ++i, ++id)
+    {
+      EXPECT_EQ(id, ids[i]);
+      EXPECT_EQ(id/2.0, vals[i]);
+
+      if (0 == id % 10)
+      {
+        EXPECT_TRUE(nulls[i]);
+        EXPECT_EQ(offsets[i], offsets[i+1]);
+        continue;
+      }
+
+      std::stringstream name;
+      name << "row" << id;
+      EXPECT_FALSE(nulls[i]);
+      EXPECT_EQ(name.str(),
+                std::string(names + offsets[i], offsets[i+1] - offsets[i]));
+    }
+  }
+
+  EXPECT_EQ(100, id);
+  EXPECT_FALSE(res.fetchOne());
+
+  // Column buffers must match result columns.
+
+  res = tbl.select("id", "name").execute();
+  EXPECT_THROW(res.fetchInto(cols, 16), Error);
+
+  std::vector<ColumnBuffer> bad = { ColumnBuffer(ids), ColumnBuffer(vals) };
+  EXPECT_THROW(res.fetchInto(bad, 16), Error);
+
+  // NULL values can not be fetched without null indicators.
+
+  std::vector<ColumnBuffer> no_nulls = {
+    ColumnBuffer(ids), ColumnBuffer(names, sizeof(names), offsets)
+  };
+  EXPECT_THROW(
+    while (0 < res.fetchInto(no_nulls, 16));,
+    Error
+  );
+
+  // Column values can be skipped.
+
+  res = tbl.select("id", "name").orderBy("id").execute();
+
+  std::vector<ColumnBuffer> skip = { ColumnBuffer(ids), ColumnBuffer() };
+  EXPECT_EQ(16U, res.fetchInto(skip, 16));
+  EXPECT_EQ(15, ids[15]);
+}
+
+
+TEST_F(Crud, fetch_arrow)
+{
+  SKIP_IF_NO_XPLUGIN;
+
+  sql("DROP TABLE IF EXISTS test.fetch_arrow");
+  sql("CREATE TABLE test.fetch_arrow("
+      "id INT, price DECIMAL(10,2), day DATE, name VARCHAR(32))");
+  sql("INSERT INTO test.fetch_arrow VALUES"
+      " (1, 1.50, '1970-01-02', 'one'), (2, -2.25, '1969-12-31', NULL),"
+      " (3, NULL, '2018-03-11', 'three')");
+
+  RowResult res = get_sess().sql(
+    "SELECT id, price, day, name FROM test.fetch_arrow ORDER BY id"
+  ).execute();
+
+  ArrowSchema schema;
+  res.getArrowSchema(&schema);
+
+  EXPECT_EQ(string("+s"), string(schema.format));
+  EXPECT_EQ(4, schema.n_children);
+
+  const char *formats[] = { "l", "d:10,2", "tdD", "u" };
+  const char *names[] = { "id", "price", "day", "name" };
+
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(string(formats[i]), string(schema.children[i]->format));
+    EXPECT_EQ(string(names[i]), string(schema.children[i]->name));
+    EXPECT_EQ(ARROW_FLAG_NULLABLE, schema.children[i]->flags);
+  }
+
+  schema.release(&schema);
+  EXPECT_FALSE(schema.release);
+
+  ArrowArray array;
+  EXPECT_EQ(2U, res.fetchArrow(&array, 2));
+  EXPECT_EQ(2, array.length);
+  EXPECT_EQ(4, array.n_children);
+
+  const int64_t *ids = (const int64_t*)array.children[0]->buffers[1];
+  EXPECT_EQ(1, ids[0]);
+  EXPECT_EQ(2, ids[1]);
+
+  // DECIMAL values are 128-bit integers scaled by 10^2.
+
+  const int64_t *prices = (const int64_t*)array.children[1]->buffers[1];
+  EXPECT_EQ(150, prices[0]);
+  EXPECT_EQ(0, prices[1]);
+  EXPECT_EQ(-225, prices[2]);
+  EXPECT_EQ(-1, prices[3]);
+
+  const int32_t *days = (const int32_t*)array.children[2]->buffers[1];
+  EXPECT_EQ(1, days[0]);
+  EXPECT_EQ(-1, days[1]);
+
+  ArrowArray *name = array.children[3];
+  const int32_t *offsets = (const int32_t*)name->buffers[1];
+  const char *data = (const char*)name->buffers[2];
+  EXPECT_EQ(1, name->null_count);
+  EXPECT_EQ(std::string("one"),
+            std::string(data + offsets[0], offsets[1] - offsets[0]));
+  EXPECT_EQ(offsets[1], offsets[2]);
+
+  array.release(&array);
+
+  EXPECT_EQ(1U, res.fetchArrow(&array, 2));
+  EXPECT_EQ(1, array.children[1]->null_count);
+  EXPECT_EQ(17601, ((const int32_t*)array.children[2]->buffers[1])[0]);
+  array.release(&array);
+
+  EXPECT_EQ(0U, res.fetchArrow(&array, 2));
+  EXPECT_FALSE(array.release);
+
+  cout << "Wide DECIMAL and temporal values" << endl;
+
+  RowResult wide = get_sess().sql(
+    "SELECT CAST(-1.5 AS DECIMAL(50,5)) AS big,"
+    " CAST('1970-01-02 00:00:01' AS DATETIME) AS dt,"
+    " CAST('-12:30:00.5' AS TIME(1)) AS t"
+  ).execute();
+
+  wide.getArrowSchema(&schema);
+  EXPECT_EQ(string("d:50,5,256"), string(schema.children[0]->format));
+  EXPECT_EQ(string("tsu:"), string(schema.children[1]->format));
+  EXPECT_EQ(string("tDu"), string(schema.children[2]->format));
+  schema.release(&schema);
+
+  EXPECT_EQ(1U, wide.fetchArrow(&array, 2));
+
+  // DECIMAL(50,5) values are 256-bit integers scaled by 10^5.
+
+  const int64_t *big = (const int64_t*)array.children[0]->buffers[1];
+  EXPECT_EQ(-150000, big[0]);
+  EXPECT_EQ(-1, big[1]);
+  EXPECT_EQ(-1, big[2]);
+  EXPECT_EQ(-1, big[3]);
+
+  EXPECT_EQ(86401000000,
+            ((const int64_t*)array.children[1]->buffers[1])[0]);
+  EXPECT_EQ(-45000500000,
+            ((const int64_t*)array.children[2]->buffers[1])[0]);
+
+  array.release(&array);
+}
+
+
+TEST_F(Crud, insert_columns)
+{
+  SKIP_IF_NO_XPLUGIN;
+
+  sql("DROP TABLE IF EXISTS test.insert_columns");
+  sql("CREATE TABLE test.insert_columns(id INT, val DOUBLE, name VARCHAR(32))");
+
+  Table tbl = get_sess().getSchema("test").getTable("insert_columns");
+
+  const row_count_t rows = 1000;
+  std::vector<int64_t> ids(rows);
+  std::vector<double>  vals(rows);
+  std::unique_ptr<bool[]> nulls(new bool[rows]);
+  std::string names;
+  std::vector<size_t> offsets(1, 0);
+
+  for (row_count_t i = 0; i < rows; ++i)
+  {
+    ids[i] = i;
+    vals[i] = i / 2.0;
+    nulls[i] = (0 == i % 10);
+    if (!nulls[i])
+      names += "row" + std::to_string(i);
+    offsets.push_back(names.size());
+  }
+
+  std::vector<ColumnBuffer> cols = {
+    ColumnBuffer(ids.data()),
+    ColumnBuffer(vals.data()),
+    ColumnBuffer(&names[0], names.size(), offsets.data(), nulls.get())
+  };
+
+  // Insert one row given explicitly followed by rows from column arrays,
+  // split into commands of at most 1KB.
+
+  Result res = tbl.insert("id", "val", "name")
+                  .values(-1, 0, "first")
+                  .columnValues(cols, rows)
+                  .chunkSize(1024)
+                  .execute();
+
+  EXPECT_EQ(rows + 1, res.getAffectedItemsCount());
+
+  RowResult rr = tbl.select("id", "val", "name").orderBy("id").execute();
+
+  Row row = rr.fetchOne();
+  EXPECT_EQ(-1, row[0].get<int>());
+  EXPECT_EQ(string("first"), row[2].get<string>());
+
+  int id = 0;
+
+  for (row = rr.fetchOne(); row; row = rr.fetchOne(), ++id)
+  {
+    EXPECT_EQ(id, row[0].get<int>());
+    EXPECT_EQ(id / 2.0, row[1].get<double>());
+
+    if (0 == id % 10)
+      EXPECT_TRUE(row[2].isNull());
+    else
+      EXPECT_EQ(string("row" + std::to_string(id)), row[2].get<string>());
+  }
+
+  EXPECT_EQ(int(rows), id);
+
+  // Error in one of the chunks is reported.
+
+  sql("DELETE FROM test.insert_columns");
+  sql("ALTER TABLE test.insert_columns ADD PRIMARY KEY (id)");
+  ids[rows - 1] = 0;
+
+  EXPECT_THROW(
+    tbl.insert("id", "val", "name").columnValues(cols, rows)
+       .chunkSize(1024).execute(),
+    Error
+  );
+
+  // Number of column arrays must match the columns.
+
+  EXPECT_THROW(tbl.insert("id", "val").columnValues(cols, rows), Error);
+}
+
+
+TEST_F(Crud, dsl)
+{
+  SKIP_IF_NO_XPLUGIN;
+
+  using namespace mysqlx::dsl;
+
+  Schema sch = getSchema("test");
+  Collection coll = sch.createCollection("c1", true);
+
+  add_data(coll);
+
+  // Expressions built without parsing should give the same results as
+  // the equivalent strings.
+
+  constexpr auto crit
+    = field("age") > param("a") && field("name").like(param("n"));
+
+  DocResult docs = coll.find(crit)
+    .fields(field("name").as("name"), (field("age") + 1).as("age1"))
+    .sort(field("age").desc())
+    .bind("a", 1).bind("n", "b%")
+    .execute();
+
+  DocResult expected = coll.find("age > :a AND name LIKE :n")
+    .fields("name AS name", "age + 1 AS age1")
+    .sort("age DESC")
+    .bind("a", 1).bind("n", "b%")
+    .execute();
+
+  unsigned count = 0;
+
+  for (DbDoc doc : expected)
+  {
+    DbDoc doc1 = docs.fetchOne();
+    ASSERT_TRUE(doc1);
+    cout << doc1 << endl;
+    EXPECT_EQ(string(doc["name"]), string(doc1["name"]));
+    EXPECT_EQ(int(doc["age1"]), int(doc1["age1"]));
+    count++;
+  }
+
+  EXPECT_EQ(3U, count);
+  EXPECT_FALSE(docs.fetchOne());
+
+  EXPECT_EQ(3U, coll.find(field("age").in(1, 7)).execute().count());
+  EXPECT_EQ(6U, coll.find(field("name").is_not_null()).execute().count());
+
+  cout << "Table..." << endl;
+
+  sql("DROP TABLE IF EXISTS test.crud_dsl");
+  sql("CREATE TABLE test.crud_dsl(name VARCHAR(32), age INT)");
+
+  Table tbl = sch.getTable("crud_dsl");
+  tbl.insert("name", "age")
+     .values("foo", 10).values("bar", 5).values("baz", 3)
+     .execute();
+
+  tbl.update()
+     .set("age", field("age") * 2)
+     .where(field("name") != "bar")
+     .execute();
+
+  RowResult rows = tbl.select(field("name"), (field("age") % 7).as("rem"))
+    .where(!(field("age") < param("min")))
+    .orderBy(field("test.crud_dsl.age").asc())
+    .bind("min", 5)
+    .execute();
+
+  Row row = rows.fetchOne();
+  ASSERT_TRUE(row);
+  EXPECT_EQ(string("bar"), row[0].get<string>());
+  EXPECT_EQ(5, row[1].get<int>());
+  row = rows.fetchOne();
+  ASSERT_TRUE(row);
+  EXPECT_EQ(string("baz"), row[0].get<string>());
+  EXPECT_EQ(6, row[1].get<int>());
+  row = rows.fetchOne();
+  ASSERT_TRUE(row);
+  EXPECT_EQ(string("foo"), row[0].get<string>());
+  EXPECT_EQ(6, row[1].get<int>());
+  EXPECT_FALSE(rows.fetchOne());
+
+  // Invalid names are reported when expression is passed to an operation.
+
+  EXPECT_THROW(
+    tbl.remove().where(field("a..b") == 1).execute(), Error
+  );
+}
+
+
+TEST_F(Crud, result_cache)
+{
+  ResultCache cache(std::chrono::seconds(60));
+
+  EXPECT_EQ(0U, cache.getHits());
+  EXPECT_EQ(0U, cache.getMisses());
+  EXPECT_EQ(0U, cache.getEntries());
+  EXPECT_EQ(0U, cache.getBytes());
+
+  SKIP_IF_NO_XPLUGIN;
+
+  Schema sch = getSchema("test");
+  Collection coll = sch.createCollection("c1", true);
+
+  add_data(coll);
+
+  CollectionFind find = coll.find("age > :a").sort("age");
+  find.cache(cache);
+
+  std::vector<string> names;
+
+  for (DbDoc doc : find.bind("a", 1).execute())
+    names.push_back(doc["name"]);
+
+  EXPECT_EQ(0U, cache.getHits());
+  EXPECT_EQ(1U, cache.getMisses());
+  EXPECT_EQ(1U, cache.getEntries());
+  EXPECT_LT(0U, cache.getBytes());
+
+  // Cached result is returned even after data has changed.
+
+  coll.remove("true").execute();
+
+  DocResult docs = find.bind("a", 1).execute();
+
+  EXPECT_EQ(1U, cache.getHits());
+  EXPECT_EQ(0U, docs.getWarningsCount());
+  EXPECT_EQ(names.size(), docs.count());
+
+  for (const string &name : names)
+    EXPECT_EQ(name, string(docs.fetchOne()["name"]));
+  EXPECT_FALSE(docs.fetchOne());
+
+  // Different parameter value gives different key.
+
+  EXPECT_EQ(0U, find.bind("a", 2).execute().count());
+  EXPECT_EQ(2U, cache.getMisses());
+  EXPECT_EQ(2U, cache.getEntries());
+
+  // Locking reads do not use the cache.
+
+  coll.find("age > :a").sort("age")
+    .bind("a", 1)
+    .lockShared().cache(cache)
+    .execute();
+  EXPECT_EQ(1U, cache.getHits());
+  EXPECT_EQ(2U, cache.getMisses());
+
+  cout << "Table..." << endl;
+
+  sql("DROP TABLE IF EXISTS test.result_cache");
+  sql("CREATE TABLE test.result_cache(id INT, name VARCHAR(32))");
+
+  Table tbl = sch.getTable("result_cache");
+  tbl.insert("id", "name")
+     .values(1, "foo").values(2, Value()).values(3, "baz")
+     .execute();
+
+  // The cache can be shared by sessions.
+
+  Session sess(this);
+  Table tbl1 = sess.getSchema("test").getTable("result_cache");
+
+  tbl.select("id", "name").orderBy("id").cache(cache).execute().count();
+  tbl.remove().execute();
+
+  RowResult rows = tbl1.select("id", "name").orderBy("id")
+                       .cache(cache).execute();
+
+  EXPECT_EQ(2U, cache.getHits());
+  EXPECT_EQ(2U, rows.getColumnCount());
+  EXPECT_EQ(string("name"), rows.getColumn(1).getColumnName());
+
+  Row row = rows.fetchOne();
+  EXPECT_EQ(1, row[0].get<int>());
+  EXPECT_EQ(string("foo"), row[1].get<string>());
+  row = rows.fetchOne();
+  EXPECT_EQ(2, row[0].get<int>());
+  EXPECT_TRUE(row[1].isNull());
+  row = rows.fetchOne();
+  EXPECT_EQ(3, row[0].get<int>());
+  EXPECT_EQ(string("baz"), row[1].get<string>());
+  EXPECT_FALSE(rows.fetchOne());
+
+  /*
+    Results are not shared with sessions connected to another server or as
+    another user. Here the same server is reached under a different host
+    name, which gives a different server key.
+  */
+
+  {
+    mysqlx::Session other(SessionOption::HOST, "127.0.0.1",
+                          SessionOption::PORT, get_port(),
+                          SessionOption::USER, get_user(),
+                          SessionOption::PWD, get_password());
+    Table tbl2 = other.getSchema("test").getTable("result_cache");
+
+    EXPECT_EQ(0U, tbl2.select("id", "name").orderBy("id")
+                      .cache(cache).execute().count());
+    EXPECT_EQ(2U, cache.getHits());
+  }
+
+  cache.clear();
+  EXPECT_EQ(0U, cache.getEntries());
+  EXPECT_EQ(0U, cache.getBytes());
+
+  EXPECT_EQ(0U, tbl1.select().cache(cache).execute().count());
+}
@@ -370,3 +370,108 @@ TEST_F(Ddl, bugs)
     r = result.fetchOne();
   }
 }
+
+
+TEST_F(Ddl, catalog_cache)
+{
+  cout << "Invalid catalog cache settings" << endl;
+
+  EXPECT_THROW(SessionSettings("mysqlx://user@host/?catalog-ttl=1s"), Error);
+  EXPECT_THROW(SessionSettings("mysqlx://user@host/?catalog-ttl="), Error);
+  EXPECT_NO_THROW(SessionSettings("mysqlx://user@host/?catalog-ttl=60000"));
+
+  SKIP_IF_NO_XPLUGIN;
+
+  SessionSettings settings(
+    SessionOption::USER, get_user(),
+    SessionOption::PWD, get_password(),
+    SessionOption::PORT, get_port(),
+    SessionOption::CATALOG_TTL, 60000
+  );
+
+  mysqlx::Session sess1(settings);
+  mysqlx::Session sess2(settings);
+
+  Schema sch1 = sess1.getSchema("test");
+  Schema sch2 = sess2.getSchema("test");
+
+  EXPECT_TRUE(sch1.existsInDatabase());
+  EXPECT_FALSE(sch1.getCollection("coll").existsInDatabase());
+  EXPECT_FALSE(sch2.getCollection("coll").existsInDatabase());
+
+  cout << "Objects created with the connector are seen by other sessions"
+       << endl;
+
+  sch1.createCollection("coll");
+  EXPECT_TRUE(sch2.getCollection("coll").existsInDatabase());
+  EXPECT_NO_THROW(sch2.getCollection("coll", true));
+
+  sch2.dropCollection("coll");
+  EXPECT_FALSE(sch1.getCollection("coll").existsInDatabase());
+  EXPECT_THROW(sch1.getCollection("coll", true), Error);
+
+  /*
+    Another user, connecting through a different host name, uses separate
+    cache entries, but objects it creates or drops are invalidated for all
+    sessions.
+  */
+
+  cout << "Objects created by another user are seen by other sessions"
+       << endl;
+
+  sess1.sql("DROP USER IF EXISTS 'catalog_user'@'%'").execute();
+  sess1.sql("CREATE USER 'catalog_user'@'%' IDENTIFIED BY 'catalog_pass'")
+       .execute();
+  sess1.sql("GRANT ALL ON test.* TO 'catalog_user'@'%'").execute();
+
+  {
+    mysqlx::Session sess3(
+      SessionOption::USER, "catalog_user",
+      SessionOption::PWD, "catalog_pass",
+      SessionOption::HOST, "127.0.0.1",
+      SessionOption::PORT, get_port(),
+      SessionOption::CATALOG_TTL, 60000
+    );
+
+    Schema sch3 = sess3.getSchema("test");
+
+    EXPECT_FALSE(sch3.getCollection("coll").existsInDatabase());
+    EXPECT_FALSE(sch1.getCollection("coll").existsInDatabase());
+
+    sch3.createCollection("coll");
+    EXPECT_TRUE(sch1.getCollection("coll").existsInDatabase());
+    EXPECT_NO_THROW(sch1.getCollection("coll", true));
+
+    sch3.dropCollection("coll");
+    EXPECT_FALSE(sch1.getCollection("coll").existsInDatabase());
+    EXPECT_THROW(sch2.getCollection("coll", true), Error);
+  }
+
+  sess1.sql("DROP USER 'catalog_user'@'%'").execute();
+
+  cout << "Objects created with SQL are seen after they are listed" << endl;
+
+  EXPECT_FALSE(sch2.getTable("vw").existsInDatabase());
+
+  sess1.sql("CREATE TABLE test.tbl (c INT)").execute();
+  sess1.sql("CREATE VIEW test.vw AS SELECT * FROM test.tbl").execute();
+
+  EXPECT_FALSE(sch2.getTable("vw").existsInDatabase());
+  std::list<Table> tables = sch2.getTables();
+  EXPECT_EQ(2U, tables.size());
+  EXPECT_TRUE(sch2.getTable("vw").existsInDatabase());
+  EXPECT_TRUE(sch1.getTable("vw").isView());
+  EXPECT_FALSE(sch1.getTable("tbl", true).isView());
+
+  cout << "Dropping schema invalidates its objects" << endl;
+
+  sess2.dropSchema("test");
+  EXPECT_FALSE(sch1.existsInDatabase());
+  EXPECT_FALSE(sch1.getTable("tbl").existsInDatabase());
+
+  cout << "Sessions without catalog cache do not use it" << endl;
+
+  sql("CREATE SCHEMA test");
+  EXPECT_TRUE(get_sess().getSchema("test").existsInDatabase());
+  EXPECT_FALSE(sch1.existsInDatabase());
+}
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmark of memory used by DbDoc
+  =================================
+
+  Measures heap memory (bytes and number of allocations) held by documents
+  created from JSON strings, as received in a document result set. Three
+  cases are measured for documents with 50 fields:
+
+  - after reading a single field,
+  - after reading all fields,
+  - a copy of all fields in std::map<Field, Value> with strings stored as
+    wide strings, which is how documents were stored before.
+
+  Memory is counted by replacing the global operator new and delete.
+
+  Usage: doc_bench [<documents>]
+*/
+
+#include <mysqlx/xdevapi.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <new>
+#include <cstdlib>
+
+using namespace mysqlx;
+using std::cout;
+using std::endl;
+
+
+/*
+  Allocation counting
+  -------------------
+  Each block is prefixed by a header which stores its size.
+*/
+
+static size_t alloc_bytes = 0;
+static size_t alloc_count = 0;
+
+static const size_t header_size = 16;
+
+void* operator new(size_t size)
+{
+  char *ptr = (char*)malloc(size + header_size);
+  if (!ptr)
+    throw std::bad_alloc();
+  *(size_t*)ptr = size;
+  alloc_bytes += size;
+  ++alloc_count;
+  return ptr + header_size;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  if (!ptr)
+    return;
+  char *block = (char*)ptr - header_size;
+  alloc_bytes -= *(size_t*)block;
+  --alloc_count;
+  free(block);
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  operator delete(ptr);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  try {
+    return operator new(size);
+  }
+  catch (...)
+  {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void *ptr, const std::nothrow_t&) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+
+/*
+  Generate JSON document with the given number of fields: a mix of short
+  and longer strings, numbers, booleans and small sub-documents.
+*/
+
+std::string make_doc(unsigned id, unsigned fields)
+{
+  std::ostringstream doc;
+  unsigned seed = id + 1;
+
+  doc << "{\"_id\": \"00005b0d5a2a00000000" << 100000 + id << "\"";
+
+  for (unsigned i = 1; i < fields; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    doc << ", \"field_" << i << "\": ";
+
+    switch (i % 5)
+    {
+    case 0: doc << "\"v" << (seed >> 16) % 1000 << "\""; break;
+    case 1: doc << (seed >> 16); break;
+    case 2: doc << "\"description of item " << (seed >> 16)
+                << " in the catalog\""; break;
+    case 3: doc << ((seed & 0x100) ? "true" : "false"); break;
+    case 4: doc << "{\"x\": " << (seed >> 20) << ", \"y\": \"z\"}"; break;
+    }
+  }
+
+  doc << "}";
+  return doc.str();
+}
+
+
+/*
+  Enumerate and read all fields of a document, including fields of
+  sub-documents.
+*/
+
+size_t read_all(DbDoc &doc)
+{
+  size_t sum = 0;
+
+  for (Field fld : doc)
+  {
+    const Value &val = doc[fld];
+    sum += (size_t)val.getType();
+    if (Value::DOCUMENT == val.getType())
+    {
+      DbDoc sub = val;
+      sum += read_all(sub);
+    }
+  }
+
+  return sum;
+}
+
+
+/*
+  Copy fields of a document to a new map appended to `maps`, recursively
+  for sub-documents.
+*/
+
+void copy_fields(DbDoc &doc, std::vector<std::map<Field, Value>> &maps)
+{
+  maps.emplace_back();
+  std::map<Field, Value> &map = maps.back();
+
+  for (Field fld : doc)
+  {
+    const Value &val = doc[fld];
+    switch (val.getType())
+    {
+    case Value::STRING:
+      map.emplace(fld, val.get<mysqlx::string>());
+      break;
+
+    case Value::DOCUMENT:
+      {
+        DbDoc sub = val;
+        copy_fields(sub, maps);
+        map.emplace(fld, Value());
+      }
+      break;
+
+    default:
+      map.emplace(fld, val);
+    }
+  }
+}
+
+
+struct Usage
+{
+  size_t m_bytes;
+  size_t m_count;
+};
+
+
+/*
+  Create documents from the given JSON strings, apply `touch` to each of
+  them and report memory held by the documents, per document.
+*/
+
+template <class Touch>
+Usage measure(const std::vector<std::string> &json, Touch touch)
+{
+  size_t bytes = alloc_bytes;
+  size_t count = alloc_count;
+
+  std::vector<DbDoc> docs;
+  docs.reserve(json.size());
+
+  size_t vec_bytes = alloc_bytes - bytes;
+  size_t vec_count = alloc_count - count;
+
+  for (const std::string &str : json)
+  {
+    docs.emplace_back(str);
+    touch(docs.back());
+  }
+
+  Usage usage;
+  usage.m_bytes = (alloc_bytes - bytes - vec_bytes) / json.size();
+  usage.m_count = (alloc_count - count - vec_count) / json.size();
+  return usage;
+}
+
+
+void report(const char *name, const Usage &usage)
+{
+  cout << "  " << name << usage.m_bytes << " bytes, "
+       << usage.m_count << " allocations per document" << endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+  unsigned count = argc > 1 ? (unsigned)atoi(argv[1]) : 1000;
+  const unsigned fields = 50;
+
+  std::vector<std::string> json;
+  size_t size = 0;
+
+  for (unsigned i = 0; i < count; ++i)
+  {
+    json.push_back(make_doc(i, fields));
+    size += json.back().size();
+  }
+
+  cout << count << " documents with " << fields << " fields (avg "
+       << size / count << " bytes of JSON)" << endl;
+
+  size_t sum = 0;
+
+  std::vector<Field> names;
+  names.push_back("_id");
+  for (unsigned i = 1; i < fields; ++i)
+    names.push_back(Field(mysqlx::string("field_" + std::to_string(i))));
+
+  Usage one = measure(json, [&sum](DbDoc &doc) {
+    sum += doc["_id"].get<std::string>().size();
+  });
+
+  Usage by_name = measure(json, [&sum, &names](DbDoc &doc) {
+    for (const Field &fld : names)
+      sum += (int)doc[fld].getType();
+  });
+
+  Usage all = measure(json, [&sum](DbDoc &doc) {
+    sum += read_all(doc);
+  });
+
+  /*
+    Copy of the JSON string and document fields stored as before: in
+    std::map, with strings converted to wide strings and sub-documents
+    stored in maps as well. Memory used by the source documents, which
+    are fully read in the process, is subtracted.
+  */
+
+  std::vector<std::string> copies;
+  std::vector<std::map<Field, Value>> maps;
+  copies.reserve(count);
+  maps.reserve(count * (1 + fields / 5));
+
+  Usage old = measure(json, [&copies, &maps, &json](DbDoc &doc) {
+    copies.push_back(json[copies.size()]);
+    copy_fields(doc, maps);
+  });
+
+  old.m_bytes -= all.m_bytes;
+  old.m_count -= all.m_count;
+
+  report("one field read:         ", one);
+  report("all fields read:        ", by_name);
+  report("all fields enumerated:  ", all);
+  report("map based (before):     ", old);
+
+  if (0 == sum)
+    cout << "  (no data)" << endl;
+
+  return 0;
+}
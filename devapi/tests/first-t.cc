@@ -230,6 +230,56 @@ TEST_F(First, value)
 }
 
 
+TEST_F(First, doc_fields)
+{
+  // Fields of a document created from JSON string are decoded on demand.
+
+  DbDoc doc(R"({"zoo": "z", "\u0061b": [1, {"x": 2}],)"
+            R"( "mid" : { "day": 20, "month" : "Apr" }, "num": -7.5,)"
+            R"( "zoo": "dup", "nil": null, "esc": "a\"b",)"
+            " \"txt\": \"\xC5\xBC\xC3\xB3\xC5\x82w\" }");
+
+  EXPECT_TRUE(doc.hasField("ab"));
+  EXPECT_TRUE(doc.hasField("mid"));
+  EXPECT_FALSE(doc.hasField("month"));
+  EXPECT_THROW(doc["month"], std::out_of_range);
+
+  EXPECT_EQ(string("z"), (string)doc["zoo"]);
+  EXPECT_EQ(-7.5, (double)doc["num"]);
+  EXPECT_EQ(Value::VNULL, doc["nil"].getType());
+  EXPECT_EQ(2, (int)doc["ab"][1]["x"]);
+  EXPECT_EQ(string("a\"b"), (string)doc["esc"]);
+  EXPECT_EQ(string(L"\u017c\u00f3\u0142w"), (string)doc["txt"]);
+  EXPECT_EQ(std::string("\xC5\xBC\xC3\xB3\xC5\x82w"),
+            doc["txt"].get<std::string>());
+
+  // Repeated access returns the same value.
+
+  EXPECT_EQ(&doc["mid"], &doc["mid"]);
+
+  DbDoc sub = doc["mid"];
+  EXPECT_EQ(20, (int)sub["day"]);
+  EXPECT_EQ(string("Apr"), (string)sub["month"]);
+  std::ostringstream out;
+  out << sub;
+  EXPECT_EQ(R"({ "day": 20, "month" : "Apr" })", out.str());
+
+  // Fields are enumerated in sorted order.
+
+  std::vector<Field> fields;
+  for (Field fld : doc)
+    fields.push_back(fld);
+
+  std::vector<Field> expected = { "ab", "esc", "mid", "nil", "num", "txt", "zoo" };
+  EXPECT_EQ(expected, fields);
+
+  // Errors in the JSON string are reported on first access.
+
+  DbDoc bad(R"({"a": 1, "b": [1, 2 })");
+  EXPECT_THROW(bad.hasField("a"), Error);
+}
+
+
 
 TEST_F(First, api)
 {
@@ -302,6 +302,140 @@ TEST_F(Sess, trx)
   cout << "Done!" << endl;
 }
 
+
+TEST_F(Sess, trx_lazy)
+{
+  cout << "Invalid transaction begin settings" << endl;
+
+  EXPECT_THROW(SessionSettings("mysqlx://user@host/?trx-begin=foo"), Error);
+  EXPECT_THROW(
+    SessionSettings(SessionOption::TRX_BEGIN, Routing::NONE),
+    Error
+  );
+  EXPECT_NO_THROW(SessionSettings("mysqlx://user@host/?trx-begin=lazy"));
+
+  SKIP_IF_NO_XPLUGIN;
+
+  mysqlx::Session sess(SessionOption::USER, get_user(),
+                       SessionOption::PWD, get_password(),
+                       SessionOption::PORT, get_port(),
+                       SessionOption::TRX_BEGIN, TrxBegin::LAZY);
+
+  Collection coll = sess.getSchema("test").createCollection("c", true);
+  coll.remove("true").execute();
+
+  cout << "Empty transactions" << endl;
+
+  sess.startTransaction();
+  sess.commit();
+  sess.startTransaction();
+  sess.rollback();
+
+  cout << "Begin sent with the first statement" << endl;
+
+  try {
+    sess.startTransaction();
+    coll.add("{\"_id\": \"1\"}").execute();
+    coll.add("{\"_id\": \"2\"}").execute();
+    sess.commit();
+
+    sess.startTransaction();
+    coll.add("{\"_id\": \"3\"}").execute();
+    sess.rollback();
+  }
+  catch (...)
+  {
+    sess.rollback();
+    throw;
+  }
+
+  EXPECT_EQ(2U, coll.count());
+
+  cout << "Commit sent with the last statement" << endl;
+
+  sess.startTransaction();
+  coll.add("{\"_id\": \"3\"}").execute();
+  sess.commitAfterNext();
+  coll.add("{\"_id\": \"4\"}").execute();
+  sess.commit();
+
+  EXPECT_EQ(4U, coll.count());
+
+  cout << "Commit is not executed if the last statement fails" << endl;
+
+  sess.startTransaction();
+  coll.add("{\"_id\": \"5\"}").execute();
+  sess.commitAfterNext();
+  EXPECT_THROW(coll.add("{\"_id\": \"1\"}").execute(), Error);
+  EXPECT_THROW(sess.commit(), Error);
+  sess.rollback();
+
+  EXPECT_EQ(4U, coll.count());
+
+  cout << "Rollback after commit sent with the last statement" << endl;
+
+  sess.startTransaction();
+  coll.add("{\"_id\": \"5\"}").execute();
+  sess.commitAfterNext();
+  coll.add("{\"_id\": \"6\"}").execute();
+  EXPECT_THROW(sess.rollback(), Error);
+
+  EXPECT_EQ(6U, coll.count());
+
+  cout << "Rollback after commit was skipped" << endl;
+
+  sess.startTransaction();
+  coll.add("{\"_id\": \"7\"}").execute();
+  sess.commitAfterNext();
+  EXPECT_THROW(coll.add("{\"_id\": \"1\"}").execute(), Error);
+  sess.rollback();
+
+  EXPECT_EQ(6U, coll.count());
+
+  /*
+    XA START succeeds, but the following COMMIT fails because an XA
+    transaction is active. This must be reported by startTransaction().
+  */
+
+  cout << "Failed commit is reported when new transaction starts" << endl;
+
+  sess.commitAfterNext();
+  sess.sql("XA START 'trx_lazy'").execute();
+
+  try {
+    sess.startTransaction();
+    FAIL() << "Expected error";
+  }
+  catch (const Error &e)
+  {
+    cout << "Expected error: " << e << endl;
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("XAER_RMFAIL"));
+  }
+
+  sess.sql("XA END 'trx_lazy'").execute();
+  sess.sql("XA ROLLBACK 'trx_lazy'").execute();
+
+  cout << "Error of START TRANSACTION is reported for the statement" << endl;
+
+  sess.sql("XA START 'trx_lazy'").execute();
+  sess.startTransaction();
+
+  try {
+    sess.sql("SELECT 1").execute();
+    FAIL() << "Expected error";
+  }
+  catch (const Error &e)
+  {
+    cout << "Expected error: " << e << endl;
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("XAER_RMFAIL"));
+  }
+
+  sess.sql("XA END 'trx_lazy'").execute();
+  sess.sql("XA ROLLBACK 'trx_lazy'").execute();
+
+  cout << "Done!" << endl;
+}
+
 TEST_F(Sess, auth_method)
 {
   SKIP_IF_NO_XPLUGIN;
@@ -1005,8 +1139,176 @@ TEST_F(Sess, failover)
     EXPECT_THROW(mysqlx::Session s(uri.str()) , Error);
   }
 
+  /*
+    Priority 0 is valid, also for several hosts and mixed with other
+    priorities. With random load balancing the zero priority hosts must still
+    be chosen, also after the host with higher priority was picked (here it
+    refuses connections).
+  */
+
+  cout << "Hosts with priority 0" << endl;
+
+  for (unsigned i = 0; i < 10; ++i)
+  {
+    mysqlx::Session s(SessionOption::USER, get_user(),
+                      SessionOption::PWD, get_password() ?
+                        get_password() :
+                        nullptr,
+                      SessionOption::HOST, "127.0.0.1",
+                      SessionOption::PORT, 1,
+                      SessionOption::PRIORITY, 10,
+                      SessionOption::HOST, "localhost",
+                      SessionOption::PORT, get_port(),
+                      SessionOption::PRIORITY, 0,
+                      SessionOption::HOST, "127.0.0.1",
+                      SessionOption::PORT, get_port(),
+                      SessionOption::PRIORITY, 0,
+                      SessionOption::LOAD_BALANCING, LoadBalancing::RANDOM,
+                      SessionOption::DB, "test");
+
+    EXPECT_EQ(string("test"),s.getDefaultSchema().getName());
+  }
+
 }
 
+
+TEST_F(Sess, read_write_split)
+{
+  cout << "Invalid routing settings" << endl;
+
+  EXPECT_THROW(SessionSettings("mysqlx://user@host/?routing=foo"), Error);
+  EXPECT_THROW(SessionSettings("mysqlx://user@host/?sticky-window=1s"), Error);
+  EXPECT_THROW(
+    SessionSettings(SessionOption::ROUTING, SSLMode::DISABLED),
+    Error
+  );
+  EXPECT_THROW(
+    SessionSettings(SessionOption::LOAD_BALANCING, Routing::READ_WRITE_SPLIT),
+    Error
+  );
+
+  SKIP_IF_NO_XPLUGIN;
+
+  // Read/write splitting requires at least two hosts.
+
+  EXPECT_THROW(
+    mysqlx::Session(SessionOption::USER, get_user(),
+                    SessionOption::PWD, get_password(),
+                    SessionOption::PORT, get_port(),
+                    SessionOption::ROUTING, Routing::READ_WRITE_SPLIT),
+    Error);
+
+  /*
+    Use the same server as the primary and the replica. Statements sent
+    to the replica are executed over a different connection.
+  */
+
+  SessionSettings settings(
+    SessionOption::USER, get_user(),
+    SessionOption::PWD, get_password(),
+    SessionOption::HOST, "localhost",
+    SessionOption::PORT, get_port(),
+    SessionOption::HOST, "127.0.0.1",
+    SessionOption::PORT, get_port(),
+    SessionOption::ROUTING, Routing::READ_WRITE_SPLIT,
+    SessionOption::STICKY_WINDOW, 0
+  );
+
+  auto conn_id = [](mysqlx::Session &sess) {
+    return sess.sql("SELECT CONNECTION_ID()").execute()
+      .fetchOne()[0].get<uint64_t>();
+  };
+
+  {
+    mysqlx::Session sess(settings);
+
+    uint64_t replica = conn_id(sess);
+    EXPECT_EQ(replica, conn_id(sess));
+
+    cout << "Statements in transaction go to the primary" << endl;
+
+    sess.startTransaction();
+    uint64_t primary = conn_id(sess);
+    sess.commit();
+
+    EXPECT_NE(replica, primary);
+    EXPECT_EQ(replica, conn_id(sess));
+
+    sess.sql("START TRANSACTION").execute();
+    EXPECT_EQ(primary, conn_id(sess));
+    sess.sql("COMMIT").execute();
+    EXPECT_EQ(replica, conn_id(sess));
+
+    sess.sql("XA START 'rw_split'").execute();
+    EXPECT_EQ(primary, conn_id(sess));
+    sess.sql("XA END 'rw_split'").execute();
+    EXPECT_EQ(replica, conn_id(sess));
+    sess.sql("XA ROLLBACK 'rw_split'").execute();
+    EXPECT_EQ(replica, conn_id(sess));
+
+    cout << "Statements go to the primary while autocommit is off" << endl;
+
+    sess.sql("SET autocommit = 0").execute();
+    EXPECT_EQ(primary, conn_id(sess));
+    sess.sql("COMMIT").execute();
+    EXPECT_EQ(primary, conn_id(sess));
+    sess.sql("SET @@session.autocommit = ON").execute();
+    EXPECT_EQ(replica, conn_id(sess));
+
+    sess.sql("SET @@global.autocommit = @@global.autocommit").execute();
+    EXPECT_EQ(replica, conn_id(sess));
+    sess.sql("SET SESSION autocommit = @@global.autocommit").execute();
+    EXPECT_EQ(primary, conn_id(sess));
+    sess.sql("SET autocommit = 1").execute();
+    EXPECT_EQ(replica, conn_id(sess));
+
+    cout << "Locking reads go to the primary" << endl;
+
+    EXPECT_EQ(primary,
+      sess.sql("SELECT CONNECTION_ID() FROM DUAL FOR UPDATE").execute()
+      .fetchOne()[0].get<uint64_t>());
+
+    auto conn_id_of = [&sess](const char *query) {
+      return sess.sql(query).execute().fetchOne()[0].get<uint64_t>();
+    };
+
+    EXPECT_EQ(primary, conn_id_of(
+      "SELECT CONNECTION_ID() FROM (SELECT 1 FROM DUAL /*!FOR UPDATE */) AS t"
+    ));
+    EXPECT_EQ(primary, conn_id_of(
+      "SELECT CONNECTION_ID() + @@session.autocommit - 1"
+    ));
+
+    cout << "Words in names, literals and comments do not matter" << endl;
+
+    EXPECT_EQ(replica, conn_id_of(
+      "SELECT CONNECTION_ID() FROM (SELECT 1 AS errors_count) AS sessions"
+    ));
+    EXPECT_EQ(replica, conn_id_of(
+      "SELECT CONNECTION_ID() FROM DUAL WHERE 'insert into' != 'a@b.com'"
+    ));
+    EXPECT_EQ(replica, conn_id_of(
+      "SELECT CONNECTION_ID() AS `into`, 1 AS warnings"
+    ));
+    EXPECT_EQ(replica, conn_id_of(
+      "SELECT CONNECTION_ID() /* FOR UPDATE */ FROM DUAL"
+    ));
+  }
+
+  cout << "Reads after write go to the primary within sticky window" << endl;
+
+  {
+    settings.erase(SessionOption::STICKY_WINDOW);
+    settings.set(SessionOption::STICKY_WINDOW, 60000);
+    mysqlx::Session sess(settings);
+
+    uint64_t replica = conn_id(sess);
+    sess.sql("DO 1").execute();
+    EXPECT_NE(replica, conn_id(sess));
+  }
+}
+
+
 #ifndef _WIN32
 TEST_F(Sess, unix_socket)
 {
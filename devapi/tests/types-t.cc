@@ -302,6 +302,13 @@ TEST_F(Types, basic)
 
     EXPECT_GT(row[1].getRawBytes().size(), 1);
     EXPECT_EQ(data_string[i].length(), string(row[4]).length());
+
+    // Exact value of DECIMAL column
+
+    Decimal dec = row[1].get<Decimal>();
+    EXPECT_EQ(2, dec.scale());
+    EXPECT_EQ(0 == i ? "3.14" : "-2.71", dec.str());
+    EXPECT_EQ(data_decimal[i], dec.to_double());
   }
 
   cout << "Testing Boolean value" << endl;
@@ -709,6 +716,48 @@ TEST_F(Types, datetime)
     cout << "- col#" << j << ": " << row[j] << endl;
     EXPECT_EQ(Value::RAW, row[j].getType());
   }
+
+  cout << "Decoding temporal values..." << endl;
+
+  Datetime d = row.getDatetime(0);
+  EXPECT_EQ(Datetime::DATE, d.type());
+  EXPECT_EQ(string("2014-05-11"), string(d.str()));
+
+  Datetime t = row.getDatetime(1);
+  EXPECT_EQ(Datetime::TIME, t.type());
+  EXPECT_EQ(string("10:40:23"), string(t.str()));
+  EXPECT_EQ(std::chrono::seconds(10*3600 + 40*60 + 23), t.duration());
+
+  Datetime dt = row.getDatetime(2);
+  EXPECT_EQ(Datetime::DATETIME, dt.type());
+  EXPECT_EQ(string("2014-05-11 10:40:00"), string(dt.str()));
+  EXPECT_EQ(2014, dt.year());
+  EXPECT_EQ(10, dt.hour());
+  EXPECT_EQ(40, dt.minute());
+
+  Datetime ts = row.getDatetime(3);
+  EXPECT_EQ(string("2014-05-11 11:35:00"), string(ts.str()));
+
+  // 2014-05-11 10:40:00 UTC
+  std::chrono::system_clock::time_point tp
+    = std::chrono::system_clock::time_point(std::chrono::seconds(1399804800));
+  EXPECT_TRUE(tp == dt.time_point());
+
+  cout << "Binding temporal values..." << endl;
+
+  types.remove().execute();
+  types.insert()
+    .values(Datetime(2018, 3, 11), Datetime(std::chrono::minutes(-90)),
+            Datetime(tp), Datetime(tp))
+    .execute();
+
+  res = types.select().execute();
+  row = res.fetchOne();
+
+  EXPECT_EQ(string("2018-03-11"), string(row.getDatetime(0).str()));
+  EXPECT_EQ(string("-01:30:00"), string(row.getDatetime(1).str()));
+  EXPECT_EQ(std::chrono::minutes(-90), row.getDatetime(1).duration());
+  EXPECT_TRUE(tp == row.getDatetime(2).time_point());
 }
 
 
@@ -42,7 +42,9 @@
 */
 
 #include "../common_constants.h"
+#include "error.h"
 #include <string>
+#include <memory>
 
 
 namespace mysqlx {
@@ -64,6 +66,41 @@ enum class Lock_contention
 
 
 class Result_init;
+class Result_cache;
+
+
+/*
+  Abstract interface for expressions which are built by the application
+  instead of being given as strings, such as expressions created with the
+  DSL defined in devapi/dsl.h. Such expressions are passed to the
+  implementation in structured form and are not parsed.
+
+  An expression reports itself to a processor in prefix order: an operator
+  or function call is reported by op_begin() or call_begin(), then its
+  arguments are reported and then args_end() is called. All names are utf8
+  strings. Field names are document paths of the form "a.b.c" in document
+  mode and column names of the form "[[schema.]table.]column" in table mode.
+*/
+
+struct Expr_if
+{
+  struct Processor
+  {
+    virtual void field(const char *name) = 0;
+    virtual void param(const char *name) = 0;
+    virtual void val(const Value&) = 0;
+    virtual void op_begin(const char *name) = 0;
+    virtual void call_begin(const char *name) = 0;
+    virtual void args_end() = 0;
+
+    virtual ~Processor() {}
+  };
+
+  virtual void process(Processor&) const = 0;
+
+  virtual ~Expr_if() {}
+};
+
 
 /*
   Abstract interface for internal implementations of an executable object.
@@ -214,7 +251,14 @@ struct Select_if : public Base
 
 
 struct Collection_find_if : public Select_if<Proj_if>
-{};
+{
+  /*
+    Set client-side cache for results of the operation (see
+    common::Result_cache). Null pointer disables caching.
+  */
+
+  virtual void set_result_cache(const std::shared_ptr<Result_cache>&) = 0;
+};
 
 
 /*
@@ -230,6 +274,15 @@ struct Collection_add_if : public Executable_if
 
   virtual void add_json(const std::string&) = 0;
   virtual void clear_docs() = 0;
+
+  /*
+    Split documents into several commands of given maximal size (0 means
+    no splitting). If `atomic` is true, the commands are executed within
+    a transaction (or a savepoint, if one is already open) so that either
+    all or none of the documents are added.
+  */
+
+  virtual void set_chunk_size(size_t, bool atomic) = 0;
 };
 
 
@@ -268,6 +321,34 @@ struct Collection_modify_if : public Select_if<Sort_if>
 // --------------------------------------------------------------------------
 
 
+/*
+  Describes caller-owned array with values of a single column, used to pass
+  rows to table insert operation in columnar form. The array has one element
+  per row:
+
+  - INT64, UINT64 and DOUBLE: m_data points at an array of int64_t, uint64_t
+    or double values, respectively,
+
+  - BYTES: utf8 strings are stored one after another in the buffer pointed
+    by m_data; the value for row i occupies bytes from m_offsets[i] to
+    m_offsets[i+1].
+
+  If m_nulls is not null, then m_nulls[i] tells if value in row i is NULL.
+  This is the same layout as used by Column_buffer for fetching rows (see
+  common/result.h).
+*/
+
+struct Column_array
+{
+  enum Type { SKIP, INT64, UINT64, DOUBLE, BYTES };
+
+  Type          m_type = SKIP;
+  const void   *m_data = nullptr;
+  const size_t *m_offsets = nullptr;
+  const bool   *m_nulls = nullptr;
+};
+
+
 /*
   Interface to be implemented by internal implementations of
   table insert operation.
@@ -296,6 +377,23 @@ struct Table_insert_if : public Executable_if
 
   virtual void add_row(const Row_impl&) = 0;
   virtual void clear_rows() = 0;
+
+  /*
+    Pass to the implementation row_count rows given by column arrays, one
+    array per inserted column. The arrays are not copied and must remain
+    valid until the operation is executed. These rows are inserted after
+    rows passed with add_row(). Method clear_rows() removes them too.
+  */
+
+  virtual void add_rows(const Column_array*, size_t col_count,
+                        size_t row_count) = 0;
+
+  /*
+    If chunk_size is not 0, rows are sent to the server in several insert
+    commands, each one not bigger than chunk_size bytes (approximately).
+  */
+
+  virtual void set_chunk_size(size_t chunk_size) = 0;
 };
 
 
@@ -308,7 +406,11 @@ struct Table_insert_if : public Executable_if
 */
 
 struct Table_select_if : public Select_if<Proj_if>
-{};
+{
+  // See Collection_find_if.
+
+  virtual void set_result_cache(const std::shared_ptr<Result_cache>&) = 0;
+};
 
 
 /*
@@ -342,6 +444,82 @@ struct Table_update_if : public Table_remove_if
   virtual void clear_modifications() = 0;
 };
 
+
+// --------------------------------------------------------------------------
+
+
+/*
+  The interfaces above are used by the public DevAPI headers and their
+  virtual method tables are part of the connector ABI. To keep applications
+  built against older headers working, the layout of these tables must not
+  change: new virtual methods can be added only at the end of an interface
+  which is not a base of other interfaces, and only under a new name (an
+  overload of an existing method can change the order of entries).
+
+  New variants of existing methods, such as the ones taking structured
+  expressions (Expr_if), are instead declared by separate extension
+  interfaces below. An implementation of an operation derives from both
+  the main interface and the extension, and callers obtain the extension
+  with get_ext<>().
+*/
+
+struct Sort_expr_if
+{
+  virtual void add_sort(const Expr_if&, Sort_if::direction_t) = 0;
+
+  virtual ~Sort_expr_if() {}
+};
+
+
+struct Proj_expr_if
+{
+  using string = std::wstring;
+
+  /*
+    Add projection given by an expression and an alias. For a document query
+    it sets the given field of the resulting document. For a table query
+    the alias can be empty.
+  */
+
+  virtual void add_proj(const Expr_if&, const string &alias) = 0;
+
+  virtual ~Proj_expr_if() {}
+};
+
+
+struct Select_expr_if
+{
+  virtual void set_where(const Expr_if&) = 0;
+
+  virtual ~Select_expr_if() {}
+};
+
+
+struct Update_expr_if
+{
+  using string = std::wstring;
+
+  virtual void add_set(const string&, const Expr_if&) = 0;
+
+  virtual ~Update_expr_if() {}
+};
+
+
+/*
+  Return extension interface Ext implemented by the given operation, or
+  throw error if the implementation does not support it.
+*/
+
+template <class Ext, class Impl>
+inline
+Ext& get_ext(Impl *impl)
+{
+  Ext *ext = dynamic_cast<Ext*>(impl);
+  if (!ext)
+    throw Error("Operation does not support structured expressions");
+  return *ext;
+}
+
 }  // internal
 }  // mysqlx
 
@@ -101,8 +101,34 @@ public:
 
   static  const char* auth_method_name(Auth_method method);
 
+
+  enum class Load_balancing {
+    LOAD_BALANCING_LIST(SETTINGS_VAL_ENUM)
+    LAST
+  };
+
+  static  const char* load_balancing_name(Load_balancing policy);
+
+
+  enum class Routing {
+    ROUTING_LIST(SETTINGS_VAL_ENUM)
+    LAST
+  };
+
+  static  const char* routing_name(Routing routing);
+
+
+  enum class Trx_begin {
+    TRX_BEGIN_LIST(SETTINGS_VAL_ENUM)
+    LAST
+  };
+
+  static  const char* trx_begin_name(Trx_begin mode);
+
 protected:
 
+  void get_data_sources(cdk::ds::Multi_source&, cdk::ds::Multi_source*);
+
   using opt_val_t = std::pair<Option, Value>;
   // TODO: use multimap instead?
   using option_list_t = std::vector<opt_val_t>;
@@ -145,6 +171,16 @@ public:
 
   void get_data_source(cdk::ds::Multi_source&);
 
+  /*
+    If read/write splitting is enabled with ROUTING option, the data source
+    returned by get_data_source() describes only the primary host. This
+    method initializes the given Multi_source object to describe the
+    remaining (replica) hosts and returns true. It returns false if read/write
+    splitting is not enabled.
+  */
+
+  bool get_read_source(cdk::ds::Multi_source&);
+
 
   // Set options based on URI
 
@@ -225,6 +261,39 @@ const char* Settings_impl::auth_method_name(Auth_method method)
   }
 }
 
+inline
+const char* Settings_impl::load_balancing_name(Load_balancing policy)
+{
+  switch (unsigned(policy))
+  {
+    LOAD_BALANCING_LIST(SETTINGS_VAL_NAME)
+  default:
+    return nullptr;
+  }
+}
+
+inline
+const char* Settings_impl::routing_name(Routing routing)
+{
+  switch (unsigned(routing))
+  {
+    ROUTING_LIST(SETTINGS_VAL_NAME)
+  default:
+    return nullptr;
+  }
+}
+
+inline
+const char* Settings_impl::trx_begin_name(Trx_begin mode)
+{
+  switch (unsigned(mode))
+  {
+    TRX_BEGIN_LIST(SETTINGS_VAL_NAME)
+  default:
+    return nullptr;
+  }
+}
+
 
 /*
   Note: For options that can repeat, returns the last value.
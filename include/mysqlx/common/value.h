@@ -32,6 +32,7 @@
 #define MYSQLX_COMMON_VALUE_H
 
 #include <string>
+#include <chrono>
 
 #include "api.h"
 #include "error.h"
@@ -43,6 +44,52 @@ namespace common {
 
 class Value_conv;
 
+
+/*
+  Exact value of a DECIMAL number. It equals coefficient * 10^(-scale),
+  where the unsigned coefficient is a 128-bit integer split into two 64-bit
+  halves. Any DECIMAL value with up to 38 digits can be represented.
+*/
+
+class PUBLIC_API Decimal
+  : public virtual Printable
+{
+  uint64_t  m_lo = 0;
+  uint64_t  m_hi = 0;
+  uint8_t   m_scale = 0;
+  bool      m_negative = false;
+
+  void print(std::ostream &out) const override
+  {
+    out << str();
+  }
+
+public:
+
+  Decimal()
+  {}
+
+  Decimal(uint64_t lo, uint64_t hi, uint8_t scale, bool negative)
+    : m_lo(lo), m_hi(hi), m_scale(scale), m_negative(negative)
+  {}
+
+  uint64_t lo() const { return m_lo; }
+  uint64_t hi() const { return m_hi; }
+  uint8_t  scale() const { return m_scale; }
+  bool     is_negative() const { return m_negative; }
+
+  /*
+    Decimal string representation of the value. The decimal point is
+    always '.', regardless of the current locale.
+  */
+
+  std::string str() const;
+
+  // The nearest double value.
+
+  double to_double() const;
+};
+
 /*
   Class representing a polymorphic value of one of the supported types.
 
@@ -53,6 +100,198 @@ class Value_conv;
   object. Consider if this can be avoided.
 */
 
+/*
+  Value of a temporal type: DATE, DATETIME (also TIMESTAMP) or TIME.
+
+  Date and time values are interpreted as UTC when converting to/from
+  std::chrono::system_clock time points. TIME values are durations: they
+  can be negative and hour can be bigger than 23.
+*/
+
+class PUBLIC_API Datetime
+  : public virtual Printable
+{
+public:
+
+  enum Type { DATE, DATETIME, TIME };
+
+private:
+
+  Type      m_type = DATETIME;
+  uint16_t  m_year = 0;
+  uint8_t   m_month = 0;
+  uint8_t   m_day = 0;
+  uint16_t  m_hour = 0;
+  uint8_t   m_minute = 0;
+  uint8_t   m_second = 0;
+  uint32_t  m_usec = 0;
+  bool      m_negative = false;
+
+  void print(std::ostream &out) const override
+  {
+    out << str();
+  }
+
+  /*
+    Number of days since 1970-01-01 of a date in the proleptic Gregorian
+    calendar and the reverse conversion.
+  */
+
+  static int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+  {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = unsigned(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + int64_t(doe) - 719468;
+  }
+
+  void civil_from_days(int64_t z)
+  {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = unsigned(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    m_day = uint8_t(doy - (153 * mp + 2) / 5 + 1);
+    m_month = uint8_t(mp < 10 ? mp + 3 : mp - 9);
+    m_year = uint16_t(int64_t(yoe) + era * 400 + (m_month <= 2));
+  }
+
+public:
+
+  Datetime()
+  {}
+
+  // DATE value
+
+  Datetime(uint16_t year, uint8_t month, uint8_t day)
+    : m_type(DATE), m_year(year), m_month(month), m_day(day)
+  {}
+
+  // DATETIME value
+
+  Datetime(uint16_t year, uint8_t month, uint8_t day,
+           uint16_t hour, uint8_t minute, uint8_t second, uint32_t usec = 0)
+    : m_year(year), m_month(month), m_day(day)
+    , m_hour(hour), m_minute(minute), m_second(second), m_usec(usec)
+  {}
+
+  // Value of given type with all fields specified
+
+  Datetime(Type type, bool negative,
+           uint16_t year, uint8_t month, uint8_t day,
+           uint16_t hour, uint8_t minute, uint8_t second, uint32_t usec)
+    : m_type(type), m_year(year), m_month(month), m_day(day)
+    , m_hour(hour), m_minute(minute), m_second(second), m_usec(usec)
+    , m_negative(negative)
+  {}
+
+  // DATETIME value corresponding to a time point
+
+  Datetime(std::chrono::system_clock::time_point tp)
+  {
+    using namespace std::chrono;
+
+    int64_t us = duration_cast<microseconds>(tp.time_since_epoch()).count();
+    int64_t day_us = int64_t(86400) * 1000000;
+    int64_t days = (us >= 0 ? us : us - day_us + 1) / day_us;
+    us -= days * day_us;
+
+    civil_from_days(days);
+    m_usec = uint32_t(us % 1000000);
+    us /= 1000000;
+    m_second = uint8_t(us % 60);
+    m_minute = uint8_t((us / 60) % 60);
+    m_hour = uint16_t(us / 3600);
+  }
+
+  // TIME value corresponding to a duration
+
+  template <typename Rep, typename Period>
+  Datetime(std::chrono::duration<Rep, Period> d)
+    : m_type(TIME)
+  {
+    int64_t us
+      = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+
+    m_negative = us < 0;
+    if (m_negative)
+      us = -us;
+
+    m_usec = uint32_t(us % 1000000);
+    us /= 1000000;
+    m_second = uint8_t(us % 60);
+    m_minute = uint8_t((us / 60) % 60);
+    m_hour = uint16_t(us / 3600);
+  }
+
+  Type     type() const { return m_type; }
+  uint16_t year() const { return m_year; }
+  uint8_t  month() const { return m_month; }
+  uint8_t  day() const { return m_day; }
+  uint16_t hour() const { return m_hour; }
+  uint8_t  minute() const { return m_minute; }
+  uint8_t  second() const { return m_second; }
+  uint32_t usec() const { return m_usec; }
+  bool     is_negative() const { return m_negative; }
+
+  /*
+    Return time point of DATE or DATETIME value, throws error for TIME
+    values. Note that time points of system_clock might not cover the
+    whole range of DATETIME values.
+  */
+
+  std::chrono::system_clock::time_point time_point() const
+  {
+    using namespace std::chrono;
+
+    if (TIME == m_type)
+      throw Error("TIME value cannot be converted to time point");
+
+    int64_t secs = days_from_civil(m_year, m_month, m_day) * 86400
+                   + int64_t(m_hour) * 3600 + m_minute * 60 + m_second;
+
+    return system_clock::time_point(
+      duration_cast<system_clock::duration>(
+        microseconds(secs * 1000000 + m_usec)
+      )
+    );
+  }
+
+  /*
+    Return the number of days since 1970-01-01 of the date part of the
+    value. Unlike time_point(), this covers the whole range of dates.
+  */
+
+  int64_t days() const
+  {
+    return days_from_civil(m_year, m_month, m_day);
+  }
+
+  /*
+    Return TIME value as duration, for other values return the time
+    of day.
+  */
+
+  std::chrono::microseconds duration() const
+  {
+    int64_t us = (int64_t(m_hour) * 3600 + m_minute * 60 + m_second)
+                 * 1000000 + m_usec;
+    return std::chrono::microseconds(m_negative ? -us : us);
+  }
+
+  /*
+    String representation in the format used by MySQL server, such as
+    "2018-03-11 10:30:00.000250".
+  */
+
+  std::string str() const;
+};
+
+
 class PUBLIC_API Value
   : public virtual Printable
 {
@@ -70,7 +309,9 @@ public:
     WSTRING,    ///< Wide string
     RAW,        ///< Raw bytes
     EXPR,       ///< String to be interpreted as an expression
-    JSON        ///< JSON string
+    JSON,       ///< JSON string
+    DECIMAL,    ///< Exact decimal number
+    DATETIME    ///< Temporal value
   };
 
 protected:
@@ -141,6 +382,9 @@ public:
   Value(bool v) : m_type(BOOL)
   { m_val.v_bool = v; }
 
+  // Construct an item from a temporal value
+  Value(const Datetime&);
+
   // Construct an item from bytes
   Value(const byte *ptr, size_t len) : m_type(RAW)
   {
@@ -233,7 +477,8 @@ public:
     case INT64:  return 1.0*m_val.v_sint;
     case UINT64: return 1.0*m_val.v_uint;
     case FLOAT:  return m_val.v_float;
-    case DOUBLE: return m_val.v_double;
+    case DOUBLE:
+    case DECIMAL: return m_val.v_double;
     default:
       throw Error("Value can not be converted to double number");
     }
@@ -257,6 +502,20 @@ public:
     }
   }
 
+  /*
+    Note: For DECIMAL values the raw bytes are decoded on each call. Integer
+    values are also converted, other types throw error.
+  */
+
+  Decimal get_decimal() const;
+
+  /*
+    Note: Temporal values are stored in X protocol encoding and decoded
+    on each call.
+  */
+
+  Datetime get_datetime() const;
+
   // Note: these methods perform utf8 conversions as necessary.
 
   const std::string& get_string() const;
@@ -33,6 +33,7 @@
 
 #define DEFAULT_MYSQL_PORT  3306
 #define DEFAULT_MYSQLX_PORT 33060
+#define DEFAULT_STICKY_WINDOW 1000
 
 // ----------------------------------------------------------------------------
 
@@ -73,7 +74,23 @@
   /*! path to a PEM file specifying trusted root certificates*/              \
   OPT_STR(x,SSL_CA,9)                                                        \
   OPT_ANY(x,AUTH,10)      /*!< authentication method, PLAIN, MYSQL41, etc.*/ \
-  OPT_STR(x,SOCKET,11)
+  OPT_STR(x,SOCKET,11)                                                       \
+  /*! policy used to choose one of multiple hosts when creating a session,
+      FAILOVER, ROUND_ROBIN, etc. */                                         \
+  OPT_ANY(x,LOAD_BALANCING,12)                                               \
+  /*! how statements are routed to the hosts of a multi-host session,
+      see `ROUTING_LIST` below */                                            \
+  OPT_ANY(x,ROUTING,13)                                                      \
+  /*! time in milliseconds after a write during which read-only statements
+      are still sent to the primary host (default 1000) */                  \
+  OPT_ANY(x,STICKY_WINDOW,14)                                                \
+  /*! time in milliseconds for which information about existence and type
+      of schemas, collections and tables is cached and shared by sessions
+      connected to the same hosts as the same user (default 0 - no cache) */ \
+  OPT_ANY(x,CATALOG_TTL,15)                                                  \
+  /*! when START TRANSACTION is sent to the server, see `TRX_BEGIN_LIST`
+      below */                                                               \
+  OPT_ANY(x,TRX_BEGIN,16)
   END_LIST
 
 #define OPT_STR(X,Y,N) X##_str(Y,N)
@@ -90,6 +107,11 @@
   X("ssl-mode", SSL_MODE)   \
   X("ssl-ca", SSL_CA)       \
   X("auth", AUTH)           \
+  X("load-balancing", LOAD_BALANCING) \
+  X("routing", ROUTING)     \
+  X("sticky-window", STICKY_WINDOW) \
+  X("catalog-ttl", CATALOG_TTL) \
+  X("trx-begin", TRX_BEGIN) \
   END_LIST
 
 
@@ -127,6 +149,42 @@
                       */ \
   END_LIST
 
+#define LOAD_BALANCING_LIST(x)\
+  x(FAILOVER,1)    /*!< Try hosts in the order of decreasing priorities,
+                      choosing randomly among hosts with the same priority.
+                      This is the default policy. */ \
+  x(ROUND_ROBIN,2) /*!< Each new session starts with the next host
+                      in the list. */ \
+  x(RANDOM,3)      /*!< Choose a random host with probability proportional
+                      to its priority. */ \
+  x(LEAST_OUTSTANDING,4) /*!< Choose the host with the fewest requests
+                      currently executed by sessions of this process. */ \
+  x(LOWEST_LATENCY,5) /*!< Choose the host with the lowest average time
+                      of requests executed by sessions of this process. */ \
+  END_LIST
+
+#define ROUTING_LIST(x)\
+  x(NONE,1)        /*!< All statements are sent to a single host chosen
+                      according to the load balancing policy. This is
+                      the default. */ \
+  x(READ_WRITE_SPLIT,2) /*!< The host with the highest priority is the
+                      primary and the remaining hosts are replicas.
+                      Read-only statements outside of transactions are
+                      sent to one of the replicas, all other statements
+                      to the primary. */ \
+  END_LIST
+
+
+#define TRX_BEGIN_LIST(x)\
+  x(IMMEDIATE,1)   /*!< START TRANSACTION is sent when transaction is
+                      started. This is the default. */ \
+  x(LAZY,2)        /*!< START TRANSACTION is sent together with the first
+                      statement executed in the transaction. Errors
+                      reported for it are reported as errors of that
+                      statement. Transactions in which no statements were
+                      executed do not contact the server. */ \
+  END_LIST
+
 /*
   Types that can be reported by MySQL server.
 */
@@ -206,6 +206,29 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Split the documents into several add commands, each of approximately
+    at most `bytes` bytes. This avoids sending huge messages to the server
+    when adding many documents.
+
+    The commands are sent without waiting for replies to the previous ones.
+    If `atomic` is true, the commands are executed within a transaction
+    (or a savepoint, if a transaction was started with
+    `Session::startTransaction()` or with START TRANSACTION statement), so
+    that either all documents are added or none. Otherwise documents added
+    by commands that succeeded remain in the collection if one of the
+    commands fails, including some commands sent after the failed one.
+  */
+
+  CollectionAdd& chunkSize(size_t bytes, bool atomic = true)
+  {
+    try {
+      get_impl()->set_chunk_size(bytes, atomic);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Collection_add_if;
@@ -303,7 +326,8 @@ struct Collection_find_cmd
 
 struct Collection_find_base
  : public Group_by< Having< Sort< Limit< Offset< Bind_parameters<
-            Set_lock< Collection_find_cmd, common::Collection_find_if >
+            Set_lock< Set_cache< Collection_find_cmd, common::Collection_find_if >,
+                      common::Collection_find_if >
           > > > > > >
 {};
 
@@ -352,6 +376,22 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Create an operation which returns documents selected by an expression
+    built with `mysqlx::dsl` functions.
+  */
+
+  template <class E>
+  CollectionFind(Collection &coll, const dsl::Expr<E> &expr)
+  {
+    try {
+      reset(internal::Crud_factory::mk_find(coll));
+      common::get_ext<common::Select_expr_if>(get_impl())
+        .set_where(dsl::detail::ref(expr));
+    }
+    CATCH_AND_WRAP
+  }
+
 
   CollectionFind(const internal::Collection_find_cmd &other)
   {
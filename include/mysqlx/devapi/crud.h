@@ -40,6 +40,8 @@
 #include "common.h"
 #include "detail/crud.h"
 
+#include <chrono>
+
 
 namespace mysqlx {
 
@@ -119,6 +121,82 @@ enum_class LockContention
   LOCK_CONTENTION_LIST(DEVAPI_LOCK_CONTENTION_ENUM)
 };
 
+
+namespace internal {
+  template <class Base, class IMPL> class Set_cache;
+}
+
+/**
+  Client-side cache for results of read-only queries.
+
+  A cache can be used by `CollectionFind` and `TableSelect` operations
+  (see `Set_cache::cache()`). When such operation is executed, its result is
+  looked up in the cache using a key built from the query and the values
+  of bound parameters. If the result is found, it is returned without
+  sending the query to the server. Otherwise the result read from
+  the server is stored in the cache. Cached results are presented as
+  `DocResult` or `RowResult` in the same way as results read from
+  the server, except that they report no warnings.
+
+  Cached results expire after the given time-to-live and the least recently
+  used results are evicted when the total size of the cache would exceed
+  the given limit. The same cache can be used by operations of many
+  sessions, also in different threads. Results are cached separately for
+  each server and user, so a session never gets results read by a session
+  connected to another server or as another user.
+
+  @note The cache does not detect changes of the data made after
+  a result was stored. It should be used only for queries for which
+  results that are up to time-to-live old are acceptable.
+
+  @ingroup devapi_res
+*/
+
+class PUBLIC_API ResultCache
+{
+  std::shared_ptr<common::Result_cache> m_impl;
+
+public:
+
+  /**
+    Create a cache whose results expire after `ttl` and whose total size
+    is limited to `max_bytes`.
+  */
+
+  ResultCache(std::chrono::milliseconds ttl,
+              size_t max_bytes = 16*1024*1024);
+
+  /// Number of executions whose result was found in the cache.
+
+  uint64_t getHits() const;
+
+  /// Number of executions whose result was not found in the cache.
+
+  uint64_t getMisses() const;
+
+  /// Number of results evicted to make space for new ones.
+
+  uint64_t getEvictions() const;
+
+  /// Approximate number of bytes used by results stored in the cache.
+
+  uint64_t getBytes() const;
+
+  /// Number of results stored in the cache.
+
+  uint64_t getEntries() const;
+
+  /// Remove all results from the cache.
+
+  void clear();
+
+  ///@cond IGNORED
+  template <class Base, class IMPL>
+  friend class internal::Set_cache;
+  ///@endcond
+};
+
+
 namespace internal {
 
 /**
@@ -445,6 +523,45 @@ protected:
 };
 
 
+/// @copydoc Offset
+
+template <class Base, class IMPL>
+class Set_cache
+  : public Base
+{
+  using Operation = Base;
+
+public:
+
+  /**
+    Use the given client-side cache for results of this operation.
+
+    The cache is not used if the operation locks rows/documents that
+    are read.
+
+    @see ResultCache
+  */
+
+  Operation& cache(const ResultCache &cache)
+  {
+    try {
+      get_impl()->set_result_cache(cache.m_impl);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+protected:
+
+  using Impl = IMPL;
+
+  Impl* get_impl()
+  {
+    return static_cast<Impl*>(Base::get_impl());
+  }
+};
+
+
 /// @copydoc Offset
 
 template <class Base, class IMPL>
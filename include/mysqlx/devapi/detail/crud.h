@@ -39,6 +39,7 @@
 
 #include "../common.h"
 #include "../executable.h"
+#include "../dsl.h"
 
 
 namespace mysqlx {
@@ -79,6 +80,21 @@ protected:
     impl->add_sort(ord_spec);
   }
 
+  template <class E>
+  static void process_one(Impl *impl, const dsl::Expr<E> &key)
+  {
+    common::get_ext<common::Sort_expr_if>(impl)
+      .add_sort(dsl::detail::ref(key), Impl::ASC);
+  }
+
+  template <class E>
+  static void process_one(Impl *impl, const dsl::Order<E> &key)
+  {
+    common::get_ext<common::Sort_expr_if>(impl).add_sort(
+      dsl::detail::ref(key.m_expr), key.m_asc ? Impl::ASC : Impl::DESC
+    );
+  }
+
   template <typename... T>
   static void add_sort(Impl *impl, T... args)
   {
@@ -123,6 +139,20 @@ protected:
     impl->add_proj(spec);
   }
 
+  template <class E>
+  static void process_one(Impl *impl, const dsl::Expr<E> &proj)
+  {
+    common::get_ext<common::Proj_expr_if>(impl)
+      .add_proj(dsl::detail::ref(proj), string());
+  }
+
+  template <class E>
+  static void process_one(Impl *impl, const dsl::Alias<E> &proj)
+  {
+    common::get_ext<common::Proj_expr_if>(impl)
+      .add_proj(dsl::detail::ref(proj.m_expr), string(proj.m_alias));
+  }
+
   template <typename... T>
   static void add_proj(Impl *impl, T... proj_spec)
   {
@@ -178,6 +208,18 @@ protected:
     impl->add_proj(proj);
   }
 
+  /*
+    Note: Document projections built with DSL must have an alias which
+    gives the field of the resulting document.
+  */
+
+  template <class E>
+  static void process_one(Impl *impl, const dsl::Alias<E> &proj)
+  {
+    common::get_ext<common::Proj_expr_if>(impl)
+      .add_proj(dsl::detail::ref(proj.m_expr), string(proj.m_alias));
+  }
+
 
   static void do_fields(Impl *impl, const Expression &proj)
   {
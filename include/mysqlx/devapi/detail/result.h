@@ -42,6 +42,7 @@
 #include "../document.h"
 #include "../row.h"
 #include "../collations.h"
+#include "../../common/arrow.h"
 
 #include <deque>
 
@@ -52,6 +53,7 @@ class RowResult;
 class Column;
 class Columns;
 class Session;
+struct ColumnBuffer;
 
 namespace common {
 
@@ -363,6 +365,10 @@ protected:
 
   row_count_t row_count();
 
+  row_count_t fetch_into(const ColumnBuffer*, col_count_t, row_count_t);
+  void get_arrow_schema(ArrowSchema*);
+  row_count_t fetch_arrow(ArrowArray*, row_count_t);
+
   Row get_row()
   {
     if (!iterator_next())
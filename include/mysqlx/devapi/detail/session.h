@@ -217,6 +217,15 @@ protected:
   void  create_collection(const string &name, bool reuse);
   void  drop_collection(const string &name);
 
+  /*
+    Check if this schema exists or if a collection or a table with the given
+    name exists in it. For tables, `is_view` is set to tell if it is a view.
+    These checks use catalog cache if it is enabled for the session.
+  */
+
+  bool  check_exists() const;
+  bool  check_exists(Obj_type, const string &name, bool *is_view = nullptr) const;
+
   friend Collection_detail;
 
   struct Access;
@@ -329,6 +338,7 @@ protected:
 
   void start_transaction();
   void commit();
+  void commit_after_next();
   void rollback(const string &sp = string());
   string savepoint_set(const string &sp = string());
   void savepoint_remove(const string&);
@@ -52,6 +52,9 @@ class Settings_detail
   using SOption    = typename Traits::Options;
   using SSLMode    = typename Traits::SSLMode;
   using AuthMethod = typename Traits::AuthMethod;
+  using LoadBalancing = typename Traits::LoadBalancing;
+  using Routing    = typename Traits::Routing;
+  using TrxBegin   = typename Traits::TrxBegin;
 
 public:
 
@@ -72,7 +75,10 @@ protected:
 
 #define OPT_VAL_TYPE(X) \
   X(SSL_MODE,SSLMode) \
-  X(AUTH,AuthMethod)
+  X(AUTH,AuthMethod) \
+  X(LOAD_BALANCING,LoadBalancing) \
+  X(ROUTING,Routing) \
+  X(TRX_BEGIN,TrxBegin)
 
 #define CHECK_OPT(Opt,Type) \
   if (opt == Option::Opt) \
@@ -123,6 +129,35 @@ protected:
     return unsigned(m);
   }
 
+  static Value opt_val(Option opt, LoadBalancing p)
+  {
+    if (opt != Option::LOAD_BALANCING)
+      throw Error(
+        "SessionSettings::LoadBalancing value can only be used on"
+        " LOAD_BALANCING setting."
+      );
+    return unsigned(p);
+  }
+
+  static Value opt_val(Option opt, Routing r)
+  {
+    if (opt != Option::ROUTING)
+      throw Error(
+        "SessionSettings::Routing value can only be used on ROUTING setting."
+      );
+    return unsigned(r);
+  }
+
+  static Value opt_val(Option opt, TrxBegin m)
+  {
+    if (opt != Option::TRX_BEGIN)
+      throw Error(
+        "SessionSettings::TrxBegin value can only be used on TRX_BEGIN"
+        " setting."
+      );
+    return unsigned(m);
+  }
+
 
   using opt_val_t = std::pair<Option, Value>;
   using opt_list_t = std::list<opt_val_t>;
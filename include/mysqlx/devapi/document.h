@@ -233,6 +233,38 @@ public:
 };
 
 
+/**
+  Exact value of a DECIMAL number.
+
+  It is the coefficient, an unsigned 128-bit integer given by `hi()` and
+  `lo()` halves, times 10 to the power of `-scale()`, with sign given by
+  `is_negative()`. Method `str()` returns the decimal string representation
+  of the number and `to_double()` the nearest double value.
+
+  @see Value::get<Decimal>()
+  @ingroup devapi_res
+*/
+
+using common::Decimal;
+
+
+/**
+  Value of a temporal type: DATE, DATETIME, TIMESTAMP or TIME.
+
+  Fields are accessible with `year()`, `month()`, `day()`, `hour()`,
+  `minute()`, `second()` and `usec()` methods, `type()` tells if this is
+  a DATE, DATETIME or TIME value. DATE and DATETIME values can be converted
+  to and from `std::chrono::system_clock::time_point` (interpreted as UTC),
+  TIME values to and from `std::chrono` durations. Method `str()` returns
+  string representation of the value, such as "2018-03-11 10:30:00".
+
+  @see Value::get<Datetime>(), Row::getDatetime()
+  @ingroup devapi_res
+*/
+
+using common::Datetime;
+
+
 // Value class
 // ===========
 
@@ -248,6 +280,13 @@ public:
   Only direct conversions of stored value to the corresponding C++ type
   are supported. There are no implicit number->string conversions etc.
 
+  Values of DECIMAL columns are reported as DOUBLE values. Their exact
+  value can be obtained with `get<Decimal>()`.
+
+  Values of temporal columns (DATE, DATETIME, TIMESTAMP and TIME) are
+  reported as RAW values holding their X protocol encoding. They can
+  be decoded with `get<Datetime>()`.
+
   Values of type RAW can refer to a region of memory containing raw bytes.
   Such values are created from `bytes` and can by casted to `bytes` type.
 
@@ -307,6 +346,7 @@ public:
   Value(float);
   Value(double);
   Value(bool);
+  Value(const Datetime&);
   Value(const DbDoc& doc);
 
   Value(const std::initializer_list<Value> &list);
@@ -670,6 +710,8 @@ Value::Type Value::getType() const
     case common::Value::RAW:      return RAW;
     case common::Value::EXPR:     return STRING;
     case common::Value::JSON:     return DOCUMENT;
+    case common::Value::DECIMAL:  return DOUBLE;
+    case common::Value::DATETIME: return RAW;
     }
   }
   return VNULL; // quiet compiler warning
@@ -872,6 +914,34 @@ Value::operator double() const
 }
 
 
+template<>
+inline
+Decimal Value::get<Decimal>() const
+{
+  try {
+    return get_decimal();
+  }
+  CATCH_AND_WRAP
+}
+
+
+inline Value::Value(const Datetime &val)
+try
+  : common::Value(val)
+{}
+CATCH_AND_WRAP
+
+template<>
+inline
+Datetime Value::get<Datetime>() const
+{
+  try {
+    return get_datetime();
+  }
+  CATCH_AND_WRAP
+}
+
+
 inline Value::Value(bool val)
 try
   : common::Value(val)
@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2018, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_DSL_H
+#define MYSQLX_DSL_H
+
+/**
+  @file
+  Expressions built from C++ code.
+
+  Instead of passing expressions to CRUD operations as strings which
+  are parsed when operation is executed, an application can build them with
+  C++ operators and functions defined in `mysqlx::dsl` namespace:
+
+  ~~~~~~
+    using namespace mysqlx::dsl;
+
+    coll.find(field("age") > param("a") && field("name").like(param("n")))
+        .sort(field("age").desc())
+        .fields(field("name").as("name"), (field("age") + 1).as("next_age"))
+        ...
+  ~~~~~~
+
+  Such expressions are checked by the compiler and are never parsed. They
+  can be constructed at compile time (`constexpr`) and passed to `find()` or
+  `where()`, `sort()`, `orderBy()`, `fields()` and `set()` methods of CRUD
+  operations.
+
+  Literal values can be numbers, Booleans, `nullptr` or string literals.
+  Strings are not copied, they must exist until the expression is passed to
+  an operation.
+*/
+
+
+#include "../common.h"
+#include "../common/op_if.h"
+
+#include <type_traits>
+
+
+namespace mysqlx {
+namespace dsl {
+
+using common::enable_if_t;
+
+
+template <class E> struct Expr;
+template <class E> struct Order;
+template <class E> struct Alias;
+template <typename... A> struct Op_expr;
+
+
+namespace detail {
+
+template <typename T> struct Literal;
+template <typename T, typename = void> struct Arg;
+
+template <typename T>
+using arg_t = typename Arg<T>::type;
+
+template <typename... A>
+constexpr Op_expr<arg_t<A>...>
+make_op(const char *name, bool call, const A&... args);
+
+}  // detail
+
+
+/*
+  Base of all expression types E (CRTP). It defines methods which build
+  other expressions from this one.
+*/
+
+template <class E>
+struct Expr
+{
+  constexpr const E& self() const
+  {
+    return static_cast<const E&>(*this);
+  }
+
+  template <typename P>
+  constexpr Op_expr<E, detail::arg_t<P>> like(const P &pattern) const
+  {
+    return detail::make_op("like", false, self(), pattern);
+  }
+
+  template <typename P>
+  constexpr Op_expr<E, detail::arg_t<P>> not_like(const P &pattern) const
+  {
+    return detail::make_op("not_like", false, self(), pattern);
+  }
+
+  template <typename... T>
+  constexpr Op_expr<E, detail::arg_t<T>...> in(const T&... items) const
+  {
+    return detail::make_op("in", false, self(), items...);
+  }
+
+  template <typename... T>
+  constexpr Op_expr<E, detail::arg_t<T>...> not_in(const T&... items) const
+  {
+    return detail::make_op("not_in", false, self(), items...);
+  }
+
+  template <typename L, typename H>
+  constexpr Op_expr<E, detail::arg_t<L>, detail::arg_t<H>>
+  between(const L &low, const H &high) const
+  {
+    return detail::make_op("between", false, self(), low, high);
+  }
+
+  constexpr Op_expr<E, detail::Literal<std::nullptr_t>> is_null() const
+  {
+    return detail::make_op("is", false, self(), nullptr);
+  }
+
+  constexpr Op_expr<E, detail::Literal<std::nullptr_t>> is_not_null() const
+  {
+    return detail::make_op("is_not", false, self(), nullptr);
+  }
+
+  // Sort keys.
+
+  constexpr Order<E> asc() const
+  {
+    return Order<E>(self(), true);
+  }
+
+  constexpr Order<E> desc() const
+  {
+    return Order<E>(self(), false);
+  }
+
+  // Projection with the given alias.
+
+  constexpr Alias<E> as(const char *alias) const
+  {
+    return Alias<E>(self(), alias);
+  }
+};
+
+
+namespace detail {
+
+using Processor = common::Expr_if::Processor;
+
+
+/*
+  Test if T is an expression type, that is, if it is derived from Expr<>.
+*/
+
+template <typename T>
+class is_expr
+{
+  template <class E>
+  static std::true_type test(const Expr<E>*);
+  static std::false_type test(...);
+
+public:
+
+  static const bool value = decltype(test((T*)nullptr))::value;
+};
+
+
+/*
+  Literal value of type T.
+*/
+
+template <typename T>
+struct Literal : public Expr<Literal<T>>
+{
+  T m_val;
+
+  constexpr Literal(T val) : m_val(val)
+  {}
+
+  void process(Processor &prc) const
+  {
+    prc.val(common::Value(m_val));
+  }
+};
+
+template <>
+struct Literal<const char*> : public Expr<Literal<const char*>>
+{
+  const char *m_val;
+
+  constexpr Literal(const char *val) : m_val(val)
+  {}
+
+  void process(Processor &prc) const
+  {
+    prc.val(common::Value(std::string(m_val)));
+  }
+};
+
+template <>
+struct Literal<std::nullptr_t> : public Expr<Literal<std::nullptr_t>>
+{
+  constexpr Literal(std::nullptr_t)
+  {}
+
+  void process(Processor &prc) const
+  {
+    prc.val(common::Value());
+  }
+};
+
+
+/*
+  Arg<T>::type is the expression type used for an operator argument of type
+  T. It is T itself if T is an expression, otherwise it is a literal. Types
+  for which Arg<> is not defined can not be used in expressions.
+*/
+
+template <typename T>
+struct Arg<T, enable_if_t<is_expr<T>::value>>
+{
+  using type = T;
+  static constexpr const T& get(const T &expr) { return expr; }
+};
+
+template <typename T>
+struct Arg<T, enable_if_t<std::is_arithmetic<T>::value>>
+{
+  using type = Literal<T>;
+  static constexpr type get(T val) { return type(val); }
+};
+
+template <>
+struct Arg<const char*>
+{
+  using type = Literal<const char*>;
+  static constexpr type get(const char *val) { return type(val); }
+};
+
+template <>
+struct Arg<char*> : public Arg<const char*>
+{};
+
+template <size_t N>
+struct Arg<char[N]> : public Arg<const char*>
+{};
+
+template <>
+struct Arg<std::nullptr_t>
+{
+  using type = Literal<std::nullptr_t>;
+  static constexpr type get(std::nullptr_t) { return type(nullptr); }
+};
+
+/*
+  List of operator or function arguments.
+*/
+
+template <typename... A>
+struct List;
+
+template <>
+struct List<>
+{
+  constexpr List() {}
+  void process(Processor&) const {}
+};
+
+template <typename H, typename... T>
+struct List<H, T...>
+{
+  H m_head;
+  List<T...> m_tail;
+
+  constexpr List(const H &head, const T&... tail)
+    : m_head(head), m_tail(tail...)
+  {}
+
+  void process(Processor &prc) const
+  {
+    m_head.process(prc);
+    m_tail.process(prc);
+  }
+};
+
+
+template <typename... A>
+constexpr Op_expr<arg_t<A>...>
+make_op(const char *name, bool call, const A&... args)
+{
+  return Op_expr<arg_t<A>...>(name, call, Arg<A>::get(args)...);
+}
+
+}  // detail
+
+
+/*
+  Reference to a document field or table column.
+*/
+
+struct Field : public Expr<Field>
+{
+  const char *m_name;
+
+  constexpr Field(const char *name) : m_name(name)
+  {}
+
+  void process(detail::Processor &prc) const
+  {
+    prc.field(m_name);
+  }
+};
+
+
+/*
+  Named parameter whose value is given by bind().
+*/
+
+struct Param : public Expr<Param>
+{
+  const char *m_name;
+
+  constexpr Param(const char *name) : m_name(name)
+  {}
+
+  void process(detail::Processor &prc) const
+  {
+    prc.param(m_name);
+  }
+};
+
+
+/*
+  Operator or function call with arguments of types A.
+*/
+
+template <typename... A>
+struct Op_expr : public Expr<Op_expr<A...>>
+{
+  const char *m_name;
+  bool m_call;
+  detail::List<A...> m_args;
+
+  constexpr Op_expr(const char *name, bool call, const A&... args)
+    : m_name(name), m_call(call), m_args(args...)
+  {}
+
+  void process(detail::Processor &prc) const
+  {
+    if (m_call)
+      prc.call_begin(m_name);
+    else
+      prc.op_begin(m_name);
+    m_args.process(prc);
+    prc.args_end();
+  }
+};
+
+
+template <class E>
+struct Order
+{
+  E    m_expr;
+  bool m_asc;
+
+  constexpr Order(const E &expr, bool asc) : m_expr(expr), m_asc(asc)
+  {}
+};
+
+
+template <class E>
+struct Alias
+{
+  E m_expr;
+  const char *m_alias;
+
+  constexpr Alias(const E &expr, const char *alias)
+    : m_expr(expr), m_alias(alias)
+  {}
+};
+
+
+constexpr Field field(const char *name)
+{
+  return Field(name);
+}
+
+constexpr Param param(const char *name)
+{
+  return Param(name);
+}
+
+template <typename T>
+constexpr detail::arg_t<T> literal(const T &val)
+{
+  return detail::Arg<T>::get(val);
+}
+
+/*
+  Call of a (possibly schema qualified) stored function.
+*/
+
+template <typename... T>
+constexpr Op_expr<detail::arg_t<T>...> func(const char *name, const T&... args)
+{
+  return detail::make_op(name, true, args...);
+}
+
+
+template <class E>
+constexpr Op_expr<E> operator!(const Expr<E> &expr)
+{
+  return detail::make_op("!", false, expr.self());
+}
+
+
+/*
+  Binary operators. They are defined if at least one of the operands is
+  an expression.
+*/
+
+#define MYSQLX_DSL_OPERATORS(X) \
+  X(==, "==") X(!=, "!=") X(<, "<") X(<=, "<=") X(>, ">") X(>=, ">=") \
+  X(&&, "&&") X(||, "||") \
+  X(+, "+") X(-, "-") X(*, "*") X(/, "/") X(%, "%") \
+  X(&, "&") X(|, "|") X(^, "^") X(<<, "<<") X(>>, ">>")
+
+#define MYSQLX_DSL_OPERATOR(OP, NAME) \
+  template <typename L, typename R, \
+    enable_if_t<detail::is_expr<L>::value \
+                || detail::is_expr<R>::value>* = nullptr> \
+  constexpr Op_expr<detail::arg_t<L>, detail::arg_t<R>> \
+  operator OP(const L &lhs, const R &rhs) \
+  { \
+    return detail::make_op(NAME, false, lhs, rhs); \
+  }
+
+MYSQLX_DSL_OPERATORS(MYSQLX_DSL_OPERATOR)
+
+#undef MYSQLX_DSL_OPERATOR
+#undef MYSQLX_DSL_OPERATORS
+
+
+namespace detail {
+
+/*
+  Presents expression of type E as common::Expr_if which is passed to the
+  implementation of an operation.
+*/
+
+template <class E>
+struct Expr_ref : public common::Expr_if
+{
+  const E &m_expr;
+
+  Expr_ref(const E &expr) : m_expr(expr)
+  {}
+
+  void process(Processor &prc) const override
+  {
+    m_expr.process(prc);
+  }
+};
+
+template <class E>
+Expr_ref<E> ref(const Expr<E> &expr)
+{
+  return Expr_ref<E>(expr.self());
+}
+
+}  // detail
+
+}  // dsl
+}  // mysqlx
+
+#endif
@@ -514,9 +514,74 @@ auto internal::Row_result_detail<Columns>::get_columns() const
 template<> PUBLIC_API
 row_count_t internal::Row_result_detail<Columns>::row_count();
 
+template<> PUBLIC_API
+row_count_t internal::Row_result_detail<Columns>::fetch_into(
+  const ColumnBuffer*, col_count_t, row_count_t
+);
+
+template<> PUBLIC_API
+void internal::Row_result_detail<Columns>::get_arrow_schema(ArrowSchema*);
+
+template<> PUBLIC_API
+row_count_t internal::Row_result_detail<Columns>::fetch_arrow(
+  ArrowArray*, row_count_t
+);
+
 } // internal
 
 
+/**
+  Describes an array into which values of a single result column are
+  stored by `RowResult::fetchInto()`.
+
+  Integer and floating point values are stored in an array of `int64_t`,
+  `uint64_t` or `double` elements, one per row. Strings, raw bytes and JSON
+  documents are stored one after another in a byte buffer and an array of
+  offsets locates them: the value for row `i` occupies bytes from
+  `offsets[i]` to `offsets[i+1]` of the buffer, thus the offsets array must
+  have one element more than the batch size. Strings are stored using their
+  original encoding, which is utf8 for columns using utf8 character set.
+
+  If an array of null indicators is given, it tells which values are NULL.
+  Without it, fetching a NULL value is an error. A default constructed
+  `ColumnBuffer` indicates that values of the column are not fetched.
+
+  @ingroup devapi_res
+*/
+
+struct ColumnBuffer
+{
+  enum Type { SKIP, INT64, UINT64, DOUBLE, BYTES };
+
+  Type    type = SKIP;
+  void   *data = nullptr;
+  size_t  size = 0;
+  size_t *offsets = nullptr;
+  bool   *nulls = nullptr;
+
+  ColumnBuffer()
+  {}
+
+  ColumnBuffer(int64_t *arr, bool *null_ind = nullptr)
+    : type(INT64), data(arr), nulls(null_ind)
+  {}
+
+  ColumnBuffer(uint64_t *arr, bool *null_ind = nullptr)
+    : type(UINT64), data(arr), nulls(null_ind)
+  {}
+
+  ColumnBuffer(double *arr, bool *null_ind = nullptr)
+    : type(DOUBLE), data(arr), nulls(null_ind)
+  {}
+
+  ColumnBuffer(char *buf, size_t buf_size, size_t *offs,
+               bool *null_ind = nullptr)
+    : type(BYTES), data(buf), size(buf_size), offsets(offs), nulls(null_ind)
+  {}
+};
+
+
+
 /**
   %Result of an operation that returns rows.
 
@@ -619,6 +684,65 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Fetch at most `batchSize` rows storing their values directly in
+    the arrays described by `cols` (one `ColumnBuffer` per result column).
+
+    Returns the number of rows that were stored, which is 0 if there are no
+    more rows in the result. Fewer rows are stored if remaining space in
+    a byte buffer is too small for the next row - such row can be fetched
+    by the next call. Rows that have already been fetched using `fetchOne()`
+    are not included.
+
+    This method does not create `Row` objects and should be used to
+    efficiently read large numbers of rows.
+  */
+
+  row_count_t fetchInto(const std::vector<ColumnBuffer> &cols,
+                        row_count_t batchSize)
+  {
+    try {
+      return Row_result_detail::fetch_into(
+        cols.data(), (col_count_t)cols.size(), batchSize
+      );
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Describe columns of this result in the given `ArrowSchema` structure, as
+    defined by Arrow C Data Interface. The schema is a struct with one field
+    per column. The caller takes ownership of the schema and should release
+    it using its release callback.
+  */
+
+  void getArrowSchema(ArrowSchema *schema)
+  {
+    try {
+      Row_result_detail::get_arrow_schema(schema);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Fetch at most `batchSize` rows and store them in the given `ArrowArray`
+    structure as a struct array matching the schema returned by
+    `getArrowSchema()`.
+
+    Returns the number of rows stored. If there are no more rows in
+    the result, 0 is returned and `array->release` is set to null. Otherwise
+    the caller takes ownership of the array and should release it using its
+    release callback. The array remains valid after the result is destroyed.
+  */
+
+  row_count_t fetchArrow(ArrowArray *array, row_count_t batchSize)
+  {
+    try {
+      return Row_result_detail::fetch_arrow(array, batchSize);
+    }
+    CATCH_AND_WRAP
+  }
+
   /*
    Iterate over rows (range-for support).
 
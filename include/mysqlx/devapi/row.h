@@ -116,6 +116,19 @@ public:
   }
 
 
+  /**
+    Get decoded value of a DATE, DATETIME, TIMESTAMP or TIME field at
+    position `pos`.
+
+    @throws Error if given field does not hold temporal value.
+  */
+
+  Datetime getDatetime(col_count_t pos) const
+  {
+    return (*this)[pos].get<Datetime>();
+  }
+
+
   /**
     Get reference to row field at position `pos`.
 
@@ -161,6 +161,108 @@ std::string AuthMethodName(AuthMethod m)
 /// @endcond
 
 
+/**
+  Load balancing policies to be used with `LOAD_BALANCING` option.
+*/
+
+enum_class LoadBalancing
+{
+#define LB_ENUM(X,N) X=N,
+
+  LOAD_BALANCING_LIST(LB_ENUM)
+};
+
+
+/// @cond DISABLED
+
+inline
+std::string LoadBalancingName(LoadBalancing p)
+{
+#define LB_NAME(X,N) case LoadBalancing::X: return #X;
+
+  switch(p)
+  {
+    LOAD_BALANCING_LIST(LB_NAME)
+    default:
+    {
+      std::ostringstream buf;
+      buf << "<UKNOWN (" << unsigned(p) << ")>" << std::ends;
+      return buf.str();
+    }
+  };
+}
+
+/// @endcond
+
+
+/**
+  Statement routing modes to be used with `ROUTING` option.
+*/
+
+enum_class Routing
+{
+#define ROUTING_ENUM(X,N) X=N,
+
+  ROUTING_LIST(ROUTING_ENUM)
+};
+
+
+/// @cond DISABLED
+
+inline
+std::string RoutingName(Routing r)
+{
+#define ROUTING_NAME(X,N) case Routing::X: return #X;
+
+  switch(r)
+  {
+    ROUTING_LIST(ROUTING_NAME)
+    default:
+    {
+      std::ostringstream buf;
+      buf << "<UKNOWN (" << unsigned(r) << ")>" << std::ends;
+      return buf.str();
+    }
+  };
+}
+
+/// @endcond
+
+
+/**
+  Transaction begin modes to be used with `TRX_BEGIN` option.
+*/
+
+enum_class TrxBegin
+{
+#define TRX_BEGIN_ENUM(X,N) X=N,
+
+  TRX_BEGIN_LIST(TRX_BEGIN_ENUM)
+};
+
+
+/// @cond DISABLED
+
+inline
+std::string TrxBeginName(TrxBegin m)
+{
+#define TRX_BEGIN_NAME(X,N) case TrxBegin::X: return #X;
+
+  switch(m)
+  {
+    TRX_BEGIN_LIST(TRX_BEGIN_NAME)
+    default:
+    {
+      std::ostringstream buf;
+      buf << "<UKNOWN (" << unsigned(m) << ")>" << std::ends;
+      return buf.str();
+    }
+  };
+}
+
+/// @endcond
+
+
 namespace internal {
 
 /*
@@ -173,6 +275,9 @@ struct Settings_traits
   using Options    = mysqlx::SessionOption;
   using SSLMode    = mysqlx::SSLMode;
   using AuthMethod = mysqlx::AuthMethod;
+  using LoadBalancing = mysqlx::LoadBalancing;
+  using Routing    = mysqlx::Routing;
+  using TrxBegin   = mysqlx::TrxBegin;
 
   static std::string get_mode_name(SSLMode mode)
   {
@@ -188,6 +293,21 @@ struct Settings_traits
   {
     return AuthMethodName(m);
   }
+
+  static std::string get_load_balancing_name(LoadBalancing p)
+  {
+    return LoadBalancingName(p);
+  }
+
+  static std::string get_routing_name(Routing r)
+  {
+    return RoutingName(r);
+  }
+
+  static std::string get_trx_begin_name(TrxBegin m)
+  {
+    return TrxBeginName(m);
+  }
 };
 
 
@@ -285,6 +405,17 @@ public:
 
     - `ssl-mode` : define `SSLMode` option to be used
     - `ssl-ca=`path : path to a PEM file specifying trusted root certificates
+    - `load-balancing` : define `LoadBalancing` policy used to choose one of
+      multiple hosts
+    - `routing` : define `Routing` mode; with `READ_WRITE_SPLIT` the host
+      with the highest priority is the primary and the remaining hosts are
+      replicas used for read-only statements
+    - `sticky-window` : number of milliseconds after a write during which
+      read-only statements are still sent to the primary
+    - `catalog-ttl` : number of milliseconds for which information about
+      existence of schemas, collections and tables is cached (0 = no cache)
+    - `trx-begin` : define `TrxBegin` mode; with `LAZY` START TRANSACTION
+      is sent together with the first statement of a transaction
   */
 
   SessionSettings(const string &uri)
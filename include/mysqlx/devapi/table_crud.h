@@ -200,6 +200,56 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Add `rowCount` rows whose values are given by column arrays, one
+    `ColumnBuffer` per inserted column (see `RowResult::fetchInto()` for
+    the array layout). Strings in `BYTES` arrays should be utf8 encoded.
+
+    Values are read directly from the arrays when the operation is executed,
+    without creating `Row` objects. The arrays are not copied and must remain
+    valid until then.
+  */
+
+  TableInsert& columnValues(const std::vector<ColumnBuffer> &cols,
+                            row_count_t rowCount)
+  {
+    try {
+      std::vector<common::Column_array> arrays(cols.size());
+
+      for (size_t pos = 0; pos < cols.size(); ++pos)
+      {
+        arrays[pos].m_type = common::Column_array::Type(cols[pos].type);
+        arrays[pos].m_data = cols[pos].data;
+        arrays[pos].m_offsets = cols[pos].offsets;
+        arrays[pos].m_nulls = cols[pos].nulls;
+      }
+
+      get_impl()->add_rows(arrays.data(), arrays.size(), rowCount);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Split the rows into several insert commands, each of approximately at
+    most `bytes` bytes. This avoids sending huge messages to the server
+    when inserting many rows. The affected items count of the result covers
+    all the commands. The commands are sent without waiting for replies
+    to the previous ones.
+
+    @note If one of the commands fails, rows inserted by the other ones
+    remain in the table, unless the insert is done within a transaction.
+  */
+
+  TableInsert& chunkSize(size_t bytes)
+  {
+    try {
+      get_impl()->set_chunk_size(bytes);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Table_insert_detail::Impl;
@@ -229,7 +279,8 @@ namespace internal {
 
   struct Table_select_base
     : public Group_by < Having < Order_by < Limit < Offset< Bind_parameters<
-              Set_lock< Table_select_cmd, common::Table_select_if >
+              Set_lock< Set_cache< Table_select_cmd, common::Table_select_if >,
+                        common::Table_select_if >
              > > > > > >
   {};
 
@@ -302,6 +353,22 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Specify row selection criteria given by an expression built with
+    `mysqlx::dsl` functions.
+  */
+
+  template <class E>
+  Operation& where(const dsl::Expr<E> &expr)
+  {
+    try {
+      common::get_ext<common::Select_expr_if>(get_impl())
+        .set_where(dsl::detail::ref(expr));
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Table_select_if;
@@ -392,6 +459,22 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Set the given field in a row to the value of an expression built with
+    `mysqlx::dsl` functions.
+  */
+
+  template <class E>
+  TableUpdate& set(const string& field, const dsl::Expr<E> &expr)
+  {
+    try {
+      common::get_ext<common::Update_expr_if>(get_impl())
+        .add_set(field, dsl::detail::ref(expr));
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
   /**
     Specify selection criteria for rows that should be updated.
   */
@@ -405,6 +488,22 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Specify row selection criteria given by an expression built with
+    `mysqlx::dsl` functions.
+  */
+
+  template <class E>
+  Operation& where(const dsl::Expr<E> &expr)
+  {
+    try {
+      common::get_ext<common::Select_expr_if>(get_impl())
+        .set_where(dsl::detail::ref(expr));
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Table_update_if;
@@ -490,6 +589,22 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Specify row selection criteria given by an expression built with
+    `mysqlx::dsl` functions.
+  */
+
+  template <class E>
+  Operation& where(const dsl::Expr<E> &expr)
+  {
+    try {
+      common::get_ext<common::Select_expr_if>(get_impl())
+        .set_where(dsl::detail::ref(expr));
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Table_remove_if;
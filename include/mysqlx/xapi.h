@@ -79,6 +79,7 @@ extern "C" {
 
 #include "common_constants.h"
 #include "common/api.h"
+#include "common/arrow.h"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -181,6 +182,7 @@ typedef object_id* MYSQLX_GUID;
 #define MYSQLX_ERROR_WRONG_LOCKING_MODE "Wrong value for the row locking mode"
 #define MYSQLX_ERROR_WRONG_EXPRESSION "Expression could not be parsed"
 #define MYSQLX_ERROR_EMPTY_JSON "Empty JSON document string"
+#define MYSQLX_ERROR_COLUMN_ARRAYS_NULL "Column arrays cannot be NULL"
 
 
 /* Opaque structures*/
@@ -284,6 +286,91 @@ typedef struct mysqlx_row_struct mysqlx_row_t;
 typedef struct mysqlx_result_struct mysqlx_result_t;
 
 
+/**
+  Exact value of a DECIMAL number.
+
+  The value equals the coefficient times 10 to the power of `-scale`,
+  where the coefficient is an unsigned 128-bit integer given by its
+  `hi` and `lo` 64-bit halves. If `negative` is non-zero, the value is
+  negative.
+
+  @see mysqlx_get_decimal(), mysqlx_decimal_to_string()
+*/
+
+typedef struct mysqlx_decimal_struct
+{
+  uint64_t lo;        /**< lower 64 bits of the coefficient */
+  uint64_t hi;        /**< upper 64 bits of the coefficient */
+  uint8_t  scale;     /**< number of digits after the decimal point */
+  uint8_t  negative;  /**< non-zero for negative values */
+} mysqlx_decimal_t;
+
+
+/**
+  Value of a temporal type.
+
+  For DATE, DATETIME and TIMESTAMP values the date fields and (optionally)
+  the time fields are used. For TIME values only the time fields are used,
+  `hour` can be bigger than 23 and the value is negative if `negative` is
+  non-zero.
+
+  @see mysqlx_get_datetime(), PARAM_DATETIME(), PARAM_TIME()
+*/
+
+typedef struct mysqlx_datetime_struct
+{
+  uint16_t year;
+  uint8_t  month;
+  uint8_t  day;
+  uint16_t hour;
+  uint8_t  minute;
+  uint8_t  second;
+  uint32_t usec;      /**< microseconds */
+  uint8_t  negative;  /**< non-zero for negative TIME values */
+} mysqlx_datetime_t;
+
+
+/**
+  Types of arrays used by `mysqlx_fetch_batch()`.
+
+  @see mysqlx_column_buffer_t
+*/
+
+typedef enum mysqlx_buffer_type_enum
+{
+  MYSQLX_BUFFER_SKIP = 0,   /**< column values are not fetched */
+  MYSQLX_BUFFER_INT64 = 1,  /**< array of `int64_t` values */
+  MYSQLX_BUFFER_UINT64 = 2, /**< array of `uint64_t` values */
+  MYSQLX_BUFFER_DOUBLE = 3, /**< array of `double` values */
+  MYSQLX_BUFFER_BYTES = 4   /**< byte buffer with array of offsets */
+} mysqlx_buffer_type_t;
+
+
+/**
+  Describes an array into which values of a single result column are
+  stored by `mysqlx_fetch_batch()`.
+
+  For `MYSQLX_BUFFER_BYTES` type the values, such as strings or JSON
+  documents, are stored one after another in the buffer `data` of size
+  `data_size`. The value for row `i` occupies bytes from `offsets[i]` to
+  `offsets[i+1]`, thus the `offsets` array must have one element more than
+  the batch size. Strings are stored using their original encoding, which is
+  utf8 for columns using utf8 character set.
+
+  If `nulls` is not NULL then `nulls[i]` is set to non-zero if value in row
+  `i` is NULL. Otherwise fetching a NULL value is an error.
+*/
+
+typedef struct mysqlx_column_buffer_struct
+{
+  mysqlx_buffer_type_t type;
+  void     *data;       /**< array of values or byte buffer */
+  size_t    data_size;  /**< size of the byte buffer */
+  size_t   *offsets;    /**< array of offsets into the byte buffer */
+  bool     *nulls;      /**< array of null indicators (can be NULL) */
+} mysqlx_column_buffer_t;
+
+
 /**
   The data type identifiers used in MYSQLX API.
 */
@@ -323,6 +410,8 @@ typedef enum mysqlx_data_type_enum
 #define PARAM_BYTES(DATA, SIZE) (void*)MYSQLX_TYPE_BYTES, (void*)DATA, (size_t)SIZE
 #define PARAM_STRING(A) (void*)MYSQLX_TYPE_STRING, A
 #define PARAM_EXPR(A) (void*)MYSQLX_TYPE_EXPR, A
+#define PARAM_DATETIME(A) (void*)MYSQLX_TYPE_DATETIME, (const mysqlx_datetime_t*)A
+#define PARAM_TIME(A) (void*)MYSQLX_TYPE_TIME, (const mysqlx_datetime_t*)A
 #define PARAM_NULL() (void*)MYSQLX_TYPE_NULL
 
 #define PARAM_END (void*)0
@@ -376,6 +465,11 @@ mysqlx_opt_type_t;
 #define OPT_SSL_CA(A)   MYSQLX_OPT_SSL_CA, (A)
 #define OPT_PRIORITY(A) MYSQLX_OPT_PRIORITY, (unsigned int)(A)
 #define OPT_AUTH(A)     MYSQLX_OPT_AUTH, (unsigned int)(A)
+#define OPT_LOAD_BALANCING(A) MYSQLX_OPT_LOAD_BALANCING, (unsigned int)(A)
+#define OPT_ROUTING(A)  MYSQLX_OPT_ROUTING, (unsigned int)(A)
+#define OPT_STICKY_WINDOW(A) MYSQLX_OPT_STICKY_WINDOW, (unsigned int)(A)
+#define OPT_CATALOG_TTL(A) MYSQLX_OPT_CATALOG_TTL, (unsigned int)(A)
+#define OPT_TRX_BEGIN(A) MYSQLX_OPT_TRX_BEGIN, (unsigned int)(A)
 
 /**
   Session SSL mode values for use with `mysqlx_session_option_get()`
@@ -405,6 +499,48 @@ typedef enum mysqlx_auth_method_enum
 }
 mysqlx_auth_method_t;
 
+/**
+  Load balancing policy values for use with `mysqlx_session_option_get()`
+  and `mysqlx_session_option_set()` functions setting or getting
+  MYSQLX_OPT_LOAD_BALANCING option.
+*/
+
+typedef enum mysqlx_load_balancing_enum
+{
+#define XAPI_LB_ENUM(X,N)  MYSQLX_LB_##X = N,
+
+  LOAD_BALANCING_LIST(XAPI_LB_ENUM)
+}
+mysqlx_load_balancing_t;
+
+/**
+  Statement routing values for use with `mysqlx_session_option_get()`
+  and `mysqlx_session_option_set()` functions setting or getting
+  MYSQLX_OPT_ROUTING option.
+*/
+
+typedef enum mysqlx_routing_enum
+{
+#define XAPI_ROUTING_ENUM(X,N)  MYSQLX_ROUTING_##X = N,
+
+  ROUTING_LIST(XAPI_ROUTING_ENUM)
+}
+mysqlx_routing_t;
+
+/**
+  Transaction begin mode values for use with `mysqlx_session_option_get()`
+  and `mysqlx_session_option_set()` functions setting or getting
+  MYSQLX_OPT_TRX_BEGIN option.
+*/
+
+typedef enum mysqlx_trx_begin_enum
+{
+#define XAPI_TRX_BEGIN_ENUM(X,N)  MYSQLX_TRX_BEGIN_##X = N,
+
+  TRX_BEGIN_LIST(XAPI_TRX_BEGIN_ENUM)
+}
+mysqlx_trx_begin_t;
+
 
 /**
   Constants for defining the row locking options for
@@ -481,6 +617,16 @@ mysqlx_get_session(const char *host, int port, const char *user,
 
   - `ssl-enable` : use TLS connection
   - `ssl-ca=`path : path to a PEM file specifying trusted root certificates
+  - `load-balancing=`policy : policy used to choose one of multiple hosts,
+    see `mysqlx_load_balancing_t`
+  - `routing=`mode : how statements are routed to multiple hosts,
+    see `mysqlx_routing_t`
+  - `sticky-window=`ms : time after a write during which read-only
+    statements are still sent to the primary host
+  - `catalog-ttl=`ms : time for which information about existence of schemas,
+    collections and tables is cached and shared with other sessions
+  - `trx-begin=`mode : when START TRANSACTION is sent to the server,
+    see `mysqlx_trx_begin_t`
 
   Specifying `ssl-ca` option implies `ssl-enable`.
 
@@ -1340,6 +1486,33 @@ PUBLIC_API int
 mysqlx_set_add_document(mysqlx_stmt_t *stmt, const char *json_doc);
 
 
+/**
+  Split documents added by an ADD statement into several commands.
+
+  If `chunk_size` is not 0, documents are sent to the server in several add
+  commands, each one of approximately at most `chunk_size` bytes. Affected
+  rows count and generated document ids of the result cover all
+  the commands.
+
+  @param stmt statement handle
+  @param chunk_size maximal size of a single add command in bytes, 0 means
+                    that all documents are sent in one command
+  @param atomic if true, the commands are executed within a transaction
+                (or a savepoint, if a transaction was started with
+                `mysqlx_transaction_begin()` or with START TRANSACTION
+                statement) so that either all or none of the documents
+                are added
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - on error
+
+  @ingroup xapi_coll
+*/
+
+PUBLIC_API int
+mysqlx_set_add_chunk_size(mysqlx_stmt_t *stmt, size_t chunk_size,
+                          bool atomic);
+
+
 /**
   Create a statement which removes documents from a collection.
 
@@ -1835,6 +2008,59 @@ PUBLIC_API int
 mysqlx_set_insert_row(mysqlx_stmt_t *stmt, ...);
 
 
+/**
+  Specify rows to be added by an INSERT statement as column arrays.
+
+  Values of `row_count` rows are given by arrays described by `cols`, one
+  `mysqlx_column_buffer_t` per inserted column, using the same layout as
+  for `mysqlx_fetch_batch()`. Strings in `MYSQLX_BUFFER_BYTES` arrays should
+  be utf8 encoded. Values are read directly from the arrays when
+  the statement is executed - the arrays are not copied and must remain
+  valid until then.
+
+  @param stmt statement handle
+  @param cols array of column buffer descriptions
+  @param col_count number of elements in `cols` array
+  @param row_count number of rows
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - on error
+
+  @note These rows are inserted after rows given by `mysqlx_set_insert_row()`.
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int
+mysqlx_set_insert_arrays(mysqlx_stmt_t *stmt,
+                         const mysqlx_column_buffer_t *cols,
+                         uint32_t col_count, size_t row_count);
+
+
+/**
+  Split rows inserted by an INSERT statement into several commands.
+
+  If `chunk_size` is not 0, rows are sent to the server in several insert
+  commands, each one of approximately at most `chunk_size` bytes. The
+  commands are sent without waiting for replies to the previous ones.
+  Affected rows count of the result covers all the commands.
+
+  @param stmt statement handle
+  @param chunk_size maximal size of a single insert command in bytes, 0 means
+                    that all rows are sent in one command
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - on error
+
+  @note If one of the commands fails, rows inserted by the other ones
+        remain in the table, unless the statement is executed within
+        a transaction.
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int
+mysqlx_set_insert_chunk_size(mysqlx_stmt_t *stmt, size_t chunk_size);
+
+
 /**
   Create a statement executing a table DELETE operation.
 
@@ -2391,6 +2617,90 @@ PUBLIC_API int
 mysqlx_store_result(mysqlx_result_t *result, size_t *num);
 
 
+/**
+  Fetch a batch of rows into arrays provided by the caller
+
+  Values of the result columns for at most `batch_size` rows are decoded
+  directly into the arrays described by `cols`, which must contain one
+  `mysqlx_column_buffer_t` for each result column. Rows are not stored
+  in the result, thus this is an efficient way of reading large numbers
+  of rows. Rows that have already been fetched by `mysqlx_row_fetch_one()`
+  are not included.
+
+  @param result result handle
+  @param cols array of column buffer descriptions
+  @param col_count number of elements in `cols` array
+  @param batch_size maximum number of rows to fetch
+  @param[out] num number of rows stored in the arrays, 0 if there are no
+              more rows in the result. It can be less than `batch_size` if
+              remaining space in a byte buffer is too small for the next row
+              - such row is returned by the next call.
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - on error. If the error
+          occurred it can be retrieved by `mysqlx_error()` function.
+
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_fetch_batch(mysqlx_result_t *result,
+                   const mysqlx_column_buffer_t *cols, uint32_t col_count,
+                   size_t batch_size, size_t *num);
+
+
+/**
+  Describe columns of the result using Arrow C Data Interface
+
+  The schema is a struct with one nullable field per result column. Integer,
+  floating point, DECIMAL and temporal values are mapped to the corresponding
+  Arrow types, strings and documents to utf8 strings and other values to
+  binary strings.
+
+  @param result result handle
+  @param[out] schema structure which receives the schema; the caller
+              owns it and should release it using its `release` callback
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - on error. If the error
+          occurred it can be retrieved by `mysqlx_error()` function.
+
+  @see mysqlx_fetch_arrow()
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_result_arrow_schema(mysqlx_result_t *result,
+                           struct ArrowSchema *schema);
+
+
+/**
+  Fetch a batch of rows as Arrow array
+
+  At most `batch_size` rows are fetched and stored in a struct array with one
+  child array per result column, as described by the schema returned by
+  `mysqlx_result_arrow_schema()`. Rows that have already been fetched by
+  `mysqlx_row_fetch_one()` are not included.
+
+  @param result result handle
+  @param[out] array structure which receives the array; if any rows were
+              fetched the caller owns it and should release it using its
+              `release` callback, otherwise `release` is set to NULL
+  @param batch_size maximum number of rows to fetch
+  @param[out] num number of rows stored in the array, 0 if there are no
+              more rows in the result
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - on error. If the error
+          occurred it can be retrieved by `mysqlx_error()` function.
+
+  @note The array remains valid after the result is freed.
+
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_fetch_arrow(mysqlx_result_t *result, struct ArrowArray *array,
+                   size_t batch_size, size_t *num);
+
+
 /**
   Get identifiers of the documents added to the collection.
 
@@ -2548,6 +2858,70 @@ PUBLIC_API int
 mysqlx_get_double(mysqlx_row_t* row, uint32_t col, double *val);
 
 
+/**
+  Get a temporal value from a row.
+
+  Values of DATE, DATETIME, TIMESTAMP and TIME columns are decoded from
+  their binary representation. For DATE values the time fields are 0,
+  for TIME values the date fields are 0.
+
+  @param row row handle
+  @param col zero-based column number
+  @param[out] val the pointer to a structure in which to write the data
+
+  @return `RESULT_OK` - on success; `RESULT_NULL` when the column is NULL;
+          `RESULT_ERR` - on error
+
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_get_datetime(mysqlx_row_t* row, uint32_t col, mysqlx_datetime_t *val);
+
+
+/**
+  Get exact value of a DECIMAL number from a row.
+
+  Values with up to 38 digits can be retrieved this way. For bigger
+  values the function returns an error. Integer columns are also accepted.
+
+  @param row row handle
+  @param col zero-based column number
+  @param[out] val the pointer to a structure in which to write the data
+
+  @return `RESULT_OK` - on success; `RESULT_NULL` when the column is NULL;
+          `RESULT_ERR` - on error
+
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_get_decimal(mysqlx_row_t* row, uint32_t col, mysqlx_decimal_t *val);
+
+
+/**
+  Write decimal string representation of a DECIMAL number into a buffer.
+
+  The decimal point is always '.', regardless of the current locale.
+  The buffer of `MYSQLX_DECIMAL_STR_SIZE` bytes is big enough for values
+  with scale not exceeding 38.
+
+  @param val the DECIMAL value
+  @param[out] buf the buffer into which to write the zero-terminated string
+  @param buf_len length of the buffer
+
+  @return `RESULT_OK` - on success; `RESULT_ERR` - if buffer is too small
+
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_decimal_to_string(const mysqlx_decimal_t *val,
+                         char *buf, size_t buf_len);
+
+#define MYSQLX_DECIMAL_STR_SIZE 48
+
+
 /**
   Free the result explicitly.
 
@@ -194,13 +194,7 @@ public:
   bool existsInDatabase() const
   {
     try {
-      /*
-        Note: We get from server a list of schemata filtered by the name of
-        this schema - if the schema exists the list should not be empty.
-      */
-      internal::Session_detail::Name_src list(*m_sess, m_name);
-      list.iterator_start();
-      return list.iterator_next();
+      return check_exists();
     }
     CATCH_AND_WRAP
   }
@@ -475,8 +469,7 @@ public:
   bool existsInDatabase() const
   {
     try {
-      Schema::StringList list(m_schema, Schema::COLLECTION, m_name);
-      return list.begin() != list.end();
+      return m_schema.check_exists(Schema::COLLECTION, m_name);
     }
     CATCH_AND_WRAP
   }
@@ -537,6 +530,20 @@ public:
     CATCH_AND_WRAP;
   }
 
+  /**
+    Return an operation which finds documents that satisfy criteria given by
+    an expression built with `mysqlx::dsl` functions (see devapi/dsl.h).
+  */
+
+  template <class E>
+  CollectionFind find(const dsl::Expr<E> &cond)
+  {
+    try {
+      return CollectionFind(*this, cond);
+    }
+    CATCH_AND_WRAP;
+  }
+
   /**
     Return an operation which adds documents to the collection.
 
@@ -997,13 +1004,12 @@ bool Table::existsInDatabase() const
       a plain table because this information is fetched from the server when
       querying for a list of tables.
     */
-    Schema::TableList list(m_schema, m_name);
-    auto it = list.begin();
+    bool is_view = false;
 
-    if (!(it != list.end()))
+    if (!m_schema.check_exists(Schema::TABLE, m_name, &is_view))
       return false;
 
-    const_cast<Table*>(this)->m_type = (*it).isView() ? VIEW : TABLE;
+    const_cast<Table*>(this)->m_type = is_view ? VIEW : TABLE;
     return true;
   }
   CATCH_AND_WRAP
@@ -1277,6 +1283,26 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Send commit of the opened transaction together with the next statement.
+
+    The commit is not executed if the statement fails. The following call
+    to `commit()` reports whether the transaction was committed and, if
+    the statement was executed, does not contact the server. A call to
+    `rollback()` instead throws error if the transaction was committed and
+    rolls it back otherwise. A call to `startTransaction()` reports error
+    if the commit failed. Together with `TrxBegin::LAZY` mode this allows
+    executing a short transaction in a single round trip to the server.
+  */
+
+  void commitAfterNext()
+  {
+    try {
+      Session_detail::commit_after_next();
+    }
+    CATCH_AND_WRAP
+  }
+
   /**
     Roll back opened transaction, if any.
 
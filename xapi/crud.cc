@@ -64,6 +64,20 @@ Value get_value(int64_t type, va_list &args)
     }
     case MYSQLX_TYPE_EXPR:
       return Value::Access::mk_expr(va_arg(args, char*));
+    case MYSQLX_TYPE_DATETIME:
+    case MYSQLX_TYPE_TIME:
+    {
+      const mysqlx_datetime_t *dt = va_arg(args, const mysqlx_datetime_t*);
+      if (!dt)
+        throw_error("NULL temporal value in variable argument list.");
+      return common::Datetime(
+        MYSQLX_TYPE_TIME == type ? common::Datetime::TIME
+                                 : common::Datetime::DATETIME,
+        0 != dt->negative,
+        dt->year, dt->month, dt->day,
+        dt->hour, dt->minute, dt->second, dt->usec
+      );
+    }
 
     default:
       throw_error("Unknown data type in variable argument list.");
@@ -197,6 +211,50 @@ int mysqlx_stmt_struct::add_columns(va_list &args)
 }
 
 
+/*
+  Add rows given by column arrays to INSERT operation.
+*/
+
+int mysqlx_stmt_struct::add_rows(
+  const mysqlx_column_buffer_t *cols, uint32_t col_count, size_t row_count
+)
+{
+  if (m_op_type != OP_INSERT)
+  {
+    m_error.set("Wrong operation type. Only INSERT is supported.", 0);
+    return RESULT_ERROR;
+  }
+
+  auto *impl = get_impl<OP_INSERT>(this);
+
+  std::vector<common::Column_array> arrays(col_count);
+
+  for (uint32_t pos = 0; pos < col_count; ++pos)
+  {
+    arrays[pos].m_type = common::Column_array::Type(cols[pos].type);
+    arrays[pos].m_data = cols[pos].data;
+    arrays[pos].m_offsets = cols[pos].offsets;
+    arrays[pos].m_nulls = cols[pos].nulls;
+  }
+
+  impl->add_rows(arrays.data(), col_count, row_count);
+  return RESULT_OK;
+}
+
+
+int mysqlx_stmt_struct::set_chunk_size(size_t chunk_size)
+{
+  if (m_op_type != OP_INSERT)
+  {
+    m_error.set("Wrong operation type. Only INSERT is supported.", 0);
+    return RESULT_ERROR;
+  }
+
+  get_impl<OP_INSERT>(this)->set_chunk_size(chunk_size);
+  return RESULT_OK;
+}
+
+
 /*
   Member function for adding row values CRUD ADD.
 
@@ -621,6 +679,19 @@ int mysqlx_stmt_struct::add_document(const char *json_doc)
 }
 
 
+int mysqlx_stmt_struct::set_add_chunk_size(size_t chunk_size, bool atomic)
+{
+  if (m_op_type != OP_ADD)
+  {
+    set_diagnostic("Wrong operation type. Only ADD is supported.", 0);
+    return RESULT_ERROR;
+  }
+
+  get_impl<OP_ADD>(this)->set_chunk_size(chunk_size, atomic);
+  return RESULT_OK;
+}
+
+
 int mysqlx_stmt_struct::add_multiple_documents(va_list &args)
 {
   // Note: we report error if no documents were passed
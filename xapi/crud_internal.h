@@ -177,6 +177,10 @@ public:
   int add_order_by(va_list &args);
   int add_row(bool get_columns, va_list &args);
   int add_columns(va_list &args);
+  int add_rows(const mysqlx_column_buffer_t *cols, uint32_t col_count,
+               size_t row_count);
+  int set_chunk_size(size_t chunk_size);
+  int set_add_chunk_size(size_t chunk_size, bool atomic);
   int add_document(const char *json_doc);
   int add_multiple_documents(va_list &args);
   int add_projections(va_list &args);
@@ -31,6 +31,7 @@
 #include <mysqlx/common.h>
 #include <mysqlx/xapi.h>
 #include "mysqlx_cc_internal.h"
+#include "../common/arrow.h"
 #include <stdlib.h>
 #include <string.h>
 #include <iostream>
@@ -314,6 +315,27 @@ int mysqlx_set_insert_columns(mysqlx_stmt_struct *stmt, ...)
 }
 
 
+int STDCALL
+mysqlx_set_insert_arrays(mysqlx_stmt_struct *stmt,
+                         const mysqlx_column_buffer_t *cols,
+                         uint32_t col_count, size_t row_count)
+{
+  SAFE_EXCEPTION_BEGIN(stmt, RESULT_ERROR)
+  PARAM_NULL_CHECK(cols, stmt, MYSQLX_ERROR_COLUMN_ARRAYS_NULL, RESULT_ERROR)
+  return stmt->add_rows(cols, col_count, row_count);
+  SAFE_EXCEPTION_END(stmt, RESULT_ERROR)
+}
+
+
+int STDCALL
+mysqlx_set_insert_chunk_size(mysqlx_stmt_struct *stmt, size_t chunk_size)
+{
+  SAFE_EXCEPTION_BEGIN(stmt, RESULT_ERROR)
+  return stmt->set_chunk_size(chunk_size);
+  SAFE_EXCEPTION_END(stmt, RESULT_ERROR)
+}
+
+
 int STDCALL
 mysqlx_set_add_document(mysqlx_stmt_struct *stmt, const char *json_doc)
 {
@@ -324,6 +346,16 @@ mysqlx_set_add_document(mysqlx_stmt_struct *stmt, const char *json_doc)
 }
 
 
+int STDCALL
+mysqlx_set_add_chunk_size(mysqlx_stmt_struct *stmt, size_t chunk_size,
+                          bool atomic)
+{
+  SAFE_EXCEPTION_BEGIN(stmt, RESULT_ERROR)
+  return stmt->set_add_chunk_size(chunk_size, atomic);
+  SAFE_EXCEPTION_END(stmt, RESULT_ERROR)
+}
+
+
 mysqlx_stmt_struct * STDCALL
 mysqlx_table_select_new(mysqlx_table_struct *table)
 {
@@ -723,6 +755,61 @@ mysqlx_store_result(mysqlx_result_struct *result, size_t *num)
 }
 
 
+int STDCALL
+mysqlx_fetch_batch(mysqlx_result_struct *result,
+                   const mysqlx_column_buffer_t *cols, uint32_t col_count,
+                   size_t batch_size, size_t *num)
+{
+  SAFE_EXCEPTION_BEGIN(result, RESULT_ERROR)
+  OUT_BUF_CHECK(num, result, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+
+  std::vector<common::Column_buffer> bufs(col_count);
+
+  for (uint32_t pos = 0; pos < col_count; ++pos)
+  {
+    common::Column_buffer &buf = bufs[pos];
+    buf.m_type = common::Column_buffer::Type(cols[pos].type);
+    buf.m_data = cols[pos].data;
+    buf.m_data_size = cols[pos].data_size;
+    buf.m_offsets = cols[pos].offsets;
+    buf.m_nulls = cols[pos].nulls;
+  }
+
+  *num = (size_t)result->fetch_into(bufs.data(), col_count, batch_size);
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(result, RESULT_ERROR)
+}
+
+
+int STDCALL
+mysqlx_result_arrow_schema(mysqlx_result_struct *result, ArrowSchema *schema)
+{
+  SAFE_EXCEPTION_BEGIN(result, RESULT_ERROR)
+  OUT_BUF_CHECK(schema, result, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+
+  common::get_arrow_schema(*result, schema);
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(result, RESULT_ERROR)
+}
+
+
+int STDCALL
+mysqlx_fetch_arrow(mysqlx_result_struct *result, ArrowArray *array,
+                   size_t batch_size, size_t *num)
+{
+  SAFE_EXCEPTION_BEGIN(result, RESULT_ERROR)
+  OUT_BUF_CHECK(array, result, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+  OUT_BUF_CHECK(num, result, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+
+  *num = (size_t)common::fetch_arrow(*result, array, batch_size);
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(result, RESULT_ERROR)
+}
+
+
 /*
   Accessing row fields
   -------------------------------------------------------------------------
@@ -859,6 +946,75 @@ int STDCALL mysqlx_get_double(mysqlx_row_struct* row, uint32_t col, double *val)
 }
 
 
+int STDCALL
+mysqlx_get_datetime(mysqlx_row_struct* row, uint32_t col, mysqlx_datetime_t *val)
+{
+  SAFE_EXCEPTION_BEGIN(row, RESULT_ERROR)
+  OUT_BUF_CHECK(val, row, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+  CHECK_COLUMN_RANGE(col, row)
+
+  Value &v = row->get(col);
+  if (v.is_null())
+    return RESULT_NULL;
+
+  common::Datetime dt = v.get_datetime();
+  val->year = dt.year();
+  val->month = dt.month();
+  val->day = dt.day();
+  val->hour = dt.hour();
+  val->minute = dt.minute();
+  val->second = dt.second();
+  val->usec = dt.usec();
+  val->negative = dt.is_negative() ? 1 : 0;
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(row, RESULT_ERROR)
+}
+
+
+int STDCALL
+mysqlx_get_decimal(mysqlx_row_struct* row, uint32_t col, mysqlx_decimal_t *val)
+{
+  SAFE_EXCEPTION_BEGIN(row, RESULT_ERROR)
+  OUT_BUF_CHECK(val, row, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+  CHECK_COLUMN_RANGE(col, row)
+
+  Value &v = row->get(col);
+  if (v.is_null())
+    return RESULT_NULL;
+
+  common::Decimal dec = v.get_decimal();
+  val->lo = dec.lo();
+  val->hi = dec.hi();
+  val->scale = dec.scale();
+  val->negative = dec.is_negative() ? 1 : 0;
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(row, RESULT_ERROR)
+}
+
+
+int STDCALL
+mysqlx_decimal_to_string(const mysqlx_decimal_t *val, char *buf, size_t buf_len)
+{
+  SAFE_EXCEPTION_BEGIN(val, RESULT_ERROR)
+  if (!buf)
+    return RESULT_ERROR;
+
+  std::string str = common::Decimal(
+    val->lo, val->hi, val->scale, 0 != val->negative
+  ).str();
+
+  if (str.length() >= buf_len)
+    return RESULT_ERROR;
+
+  memcpy(buf, str.c_str(), str.length() + 1);
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_SILENT_END(RESULT_ERROR)
+}
+
+
 /*
   Get the number of columns in the result
   PARAMETERS:
@@ -153,7 +153,7 @@ const char * mysqlx_result_struct::get_next_generated_id()
   {
     if (!m_reply)
       return NULL;
-    for (auto id : m_reply->generated_ids())
+    for (auto id : get_generated_ids())
       m_doc_id_list.push_back(id);
   }
 
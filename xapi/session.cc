@@ -44,6 +44,9 @@ mysqlx_session_struct::mysqlx_session_struct(
   cdk::ds::Multi_source ds;
   opt->get_data_source(ds);
   m_impl = std::make_shared<common::Session_impl>(ds);
+  m_impl->set_routing(*opt);
+  m_impl->set_catalog(*opt);
+  m_impl->set_trx_begin(*opt);
 }
 
 
@@ -2891,27 +2891,42 @@ TEST_F(xapi, test_decimal_type)
       EXPECT_EQ(RESULT_ERROR, mysqlx_get_float(row, 2, &f2));
 
     EXPECT_EQ(RESULT_OK, mysqlx_get_double(row, 2, &d2));
+
+    mysqlx_decimal_t dec;
+    char buf[MYSQLX_DECIMAL_STR_SIZE];
+    EXPECT_EQ(RESULT_OK, mysqlx_get_decimal(row, 1, &dec));
+    EXPECT_EQ(10, dec.scale);
+    EXPECT_EQ(RESULT_OK, mysqlx_decimal_to_string(&dec, buf, sizeof(buf)));
+    EXPECT_EQ(RESULT_ERROR, mysqlx_decimal_to_string(&dec, buf, 4));
+
     switch (row_num)
     {
     case 1:
       EXPECT_TRUE(f == -786.9876543219F);
       EXPECT_TRUE(d > -786.987654322L && d < -786.987654321L);
+      EXPECT_STREQ("-786.9876543219", buf);
       break;
     case 2:
       EXPECT_TRUE(f == 10.000001234F);
       EXPECT_TRUE(d > 10.000001230L && d < 10.000001240L);
+      EXPECT_STREQ("10.0000012340", buf);
       break;
     case 3:
       EXPECT_TRUE(f == 999999999999999.5F);
       EXPECT_TRUE(d > 999999999999999.4L && d < 999999999999999.6L);
+      EXPECT_STREQ("999999999999999.5555000000", buf);
       break;
     case 4:
       EXPECT_TRUE(f == -1.1F);
       EXPECT_TRUE(d > -1.11L && d < -1.09);
+      EXPECT_STREQ("-1.1000000000", buf);
       break;
     case 5:
       // Work around non-exact values
       EXPECT_TRUE(d2 > 9.87654321098765E+64 && d2 < 9.87654321098766E+64);
+      EXPECT_STREQ("0.0000000000", buf);
+      // Too many digits for exact representation
+      EXPECT_EQ(RESULT_ERROR, mysqlx_get_decimal(row, 2, &dec));
       break;
     default:
       FAIL();
@@ -2923,6 +2938,280 @@ TEST_F(xapi, test_decimal_type)
 }
 
 
+TEST_F(xapi, test_datetime_type)
+{
+  SKIP_IF_NO_XPLUGIN
+
+  mysqlx_result_t *res;
+  mysqlx_schema_t *schema;
+  mysqlx_table_t *table;
+  mysqlx_row_t *row;
+  mysqlx_datetime_t dt = { 2018, 3, 11, 10, 30, 5, 250, 0 };
+  mysqlx_datetime_t tm = { 0, 0, 0, 100, 20, 0, 0, 1 };
+  mysqlx_datetime_t val;
+
+  AUTHENTICATE();
+
+  mysqlx_schema_drop(get_session(), "xapi_dt_test");
+  EXPECT_EQ(RESULT_OK, mysqlx_schema_create(get_session(), "xapi_dt_test"));
+  res = mysqlx_sql(get_session(), "CREATE TABLE xapi_dt_test.dt_test" \
+                   "(d DATE, dt DATETIME(6), t TIME)",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+  res = mysqlx_sql_param(get_session(),
+                         "INSERT INTO xapi_dt_test.dt_test VALUES (?, ?, ?)",
+                         MYSQLX_NULL_TERMINATED, PARAM_DATETIME(&dt),
+                         PARAM_DATETIME(&dt), PARAM_TIME(&tm), PARAM_END);
+  EXPECT_TRUE(res != NULL);
+  EXPECT_TRUE((schema = mysqlx_get_schema(get_session(), "xapi_dt_test", 1)) != NULL);
+  EXPECT_TRUE((table = mysqlx_get_table(schema, "dt_test", 1)) != NULL);
+
+  res = mysqlx_table_select(table, NULL);
+  EXPECT_TRUE(res != NULL);
+  EXPECT_TRUE((row = mysqlx_row_fetch_one(res)) != NULL);
+
+  EXPECT_EQ(RESULT_OK, mysqlx_get_datetime(row, 0, &val));
+  EXPECT_EQ(2018, val.year);
+  EXPECT_EQ(3, val.month);
+  EXPECT_EQ(11, val.day);
+  EXPECT_EQ(0, val.hour);
+  EXPECT_EQ(0, val.usec);
+
+  EXPECT_EQ(RESULT_OK, mysqlx_get_datetime(row, 1, &val));
+  EXPECT_EQ(2018, val.year);
+  EXPECT_EQ(3, val.month);
+  EXPECT_EQ(11, val.day);
+  EXPECT_EQ(10, val.hour);
+  EXPECT_EQ(30, val.minute);
+  EXPECT_EQ(5, val.second);
+  EXPECT_EQ(250, val.usec);
+
+  EXPECT_EQ(RESULT_OK, mysqlx_get_datetime(row, 2, &val));
+  EXPECT_EQ(1, val.negative);
+  EXPECT_EQ(100, val.hour);
+  EXPECT_EQ(20, val.minute);
+  EXPECT_EQ(0, val.second);
+
+  mysqlx_schema_drop(get_session(), "xapi_dt_test");
+}
+
+
+TEST_F(xapi, fetch_batch)
+{
+  SKIP_IF_NO_XPLUGIN
+
+  mysqlx_result_t *res;
+  int64_t ids[8];
+  double vals[8];
+  char names[32];
+  size_t offsets[9];
+  bool nulls[8];
+  size_t num = 0;
+  int64_t id = 0;
+  const char *expected[] = { "zero", "", "two", "three", "four", "five",
+                             "six", "seven", "eight", "nine", "ten" };
+
+  mysqlx_column_buffer_t cols[3] = {
+    { MYSQLX_BUFFER_INT64, ids, 0, NULL, NULL },
+    { MYSQLX_BUFFER_DOUBLE, vals, 0, NULL, NULL },
+    { MYSQLX_BUFFER_BYTES, names, sizeof(names), offsets, nulls }
+  };
+
+  AUTHENTICATE();
+
+  mysqlx_schema_drop(get_session(), "xapi_batch_test");
+  EXPECT_EQ(RESULT_OK, mysqlx_schema_create(get_session(), "xapi_batch_test"));
+  res = mysqlx_sql(get_session(), "CREATE TABLE xapi_batch_test.batch_test" \
+                   "(id BIGINT, val DECIMAL(10,2), name VARCHAR(32))",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+  res = mysqlx_sql(get_session(), "INSERT INTO xapi_batch_test.batch_test" \
+                   " VALUES (0, 0.5, 'zero'), (1, 1.5, NULL), (2, 2.5, 'two'),"\
+                   " (3, 3.5, 'three'), (4, 4.5, 'four'), (5, 5.5, 'five'),"\
+                   " (6, 6.5, 'six'), (7, 7.5, 'seven'), (8, 8.5, 'eight'),"\
+                   " (9, 9.5, 'nine'), (10, 10.5, 'ten')",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+
+  res = mysqlx_sql(get_session(), "SELECT id, val, name" \
+                   " FROM xapi_batch_test.batch_test ORDER BY id",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+
+  EXPECT_EQ(RESULT_ERROR, mysqlx_fetch_batch(res, cols, 2, 8, &num));
+  printf("Expected error: %s\n", mysqlx_error_message(res));
+
+  do {
+    EXPECT_EQ(RESULT_OK, mysqlx_fetch_batch(res, cols, 3, 8, &num));
+    EXPECT_TRUE(num <= 8);
+
+    for (size_t i = 0; i < num; ++i, ++id)
+    {
+      EXPECT_EQ(id, ids[i]);
+      EXPECT_EQ(id + 0.5, vals[i]);
+      EXPECT_EQ(1 == id, nulls[i]);
+      EXPECT_EQ(string(expected[id]),
+                string(names + offsets[i], offsets[i+1] - offsets[i]));
+    }
+  } while (num > 0);
+
+  EXPECT_EQ(11, id);
+  EXPECT_EQ(NULL, mysqlx_row_fetch_one(res));
+
+  mysqlx_schema_drop(get_session(), "xapi_batch_test");
+}
+
+
+TEST_F(xapi, fetch_arrow)
+{
+  SKIP_IF_NO_XPLUGIN
+
+  mysqlx_result_t *res;
+  struct ArrowSchema schema;
+  struct ArrowArray array;
+  size_t num = 0;
+  int64_t id = 0;
+
+  AUTHENTICATE();
+
+  res = mysqlx_sql(get_session(), "SELECT 1 AS id, 'one' AS name," \
+                   " CAST(0.5 AS DECIMAL(10,1)) AS val" \
+                   " UNION SELECT 2, NULL, 1.5 UNION SELECT 3, 'three', 2.5" \
+                   " ORDER BY id",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+
+  EXPECT_EQ(RESULT_OK, mysqlx_result_arrow_schema(res, &schema));
+  EXPECT_EQ(string("+s"), string(schema.format));
+  EXPECT_EQ(3, schema.n_children);
+  EXPECT_EQ(string("id"), string(schema.children[0]->name));
+  EXPECT_EQ(string("u"), string(schema.children[1]->format));
+  EXPECT_EQ(string("d:10,1"), string(schema.children[2]->format));
+  schema.release(&schema);
+
+  do {
+    EXPECT_EQ(RESULT_OK, mysqlx_fetch_arrow(res, &array, 2, &num));
+
+    if (0 == num)
+    {
+      EXPECT_TRUE(NULL == array.release);
+      break;
+    }
+
+    EXPECT_EQ((int64_t)num, array.length);
+
+    const int64_t *ids = (const int64_t*)array.children[0]->buffers[1];
+    const int32_t *offsets = (const int32_t*)array.children[1]->buffers[1];
+    const int64_t *vals = (const int64_t*)array.children[2]->buffers[1];
+
+    for (size_t i = 0; i < num; ++i)
+    {
+      ++id;
+      EXPECT_EQ(id, ids[i]);
+      EXPECT_EQ(id * 10 - 5, vals[2 * i]);
+      EXPECT_EQ(2 == id, offsets[i] == offsets[i + 1]);
+    }
+
+    array.release(&array);
+
+  } while (true);
+
+  EXPECT_EQ(3, id);
+  EXPECT_EQ(NULL, mysqlx_row_fetch_one(res));
+
+  EXPECT_EQ(RESULT_ERROR, mysqlx_fetch_arrow(res, NULL, 2, &num));
+}
+
+
+TEST_F(xapi, insert_arrays)
+{
+  SKIP_IF_NO_XPLUGIN
+
+  mysqlx_result_t *res;
+  mysqlx_schema_t *schema;
+  mysqlx_table_t *table;
+  mysqlx_stmt_t *stmt;
+  mysqlx_row_t *row;
+  int64_t ids[100];
+  double vals[100];
+  char names[1024];
+  size_t offsets[101];
+  bool nulls[100];
+  size_t pos = 0;
+  int64_t id = 0;
+
+  for (int i = 0; i < 100; ++i)
+  {
+    ids[i] = i;
+    vals[i] = i + 0.5;
+    nulls[i] = (0 == i % 7);
+    offsets[i] = pos;
+    if (!nulls[i])
+      pos += sprintf(names + pos, "name%d", i);
+  }
+  offsets[100] = pos;
+
+  mysqlx_column_buffer_t cols[3] = {
+    { MYSQLX_BUFFER_INT64, ids, 0, NULL, NULL },
+    { MYSQLX_BUFFER_DOUBLE, vals, 0, NULL, NULL },
+    { MYSQLX_BUFFER_BYTES, names, pos, offsets, nulls }
+  };
+
+  AUTHENTICATE();
+
+  mysqlx_schema_drop(get_session(), "xapi_insert_test");
+  EXPECT_EQ(RESULT_OK, mysqlx_schema_create(get_session(), "xapi_insert_test"));
+  res = mysqlx_sql(get_session(), "CREATE TABLE xapi_insert_test.insert_test" \
+                   "(id BIGINT, val DOUBLE, name VARCHAR(32))",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+
+  EXPECT_TRUE((schema = mysqlx_get_schema(get_session(), "xapi_insert_test", 1)) != NULL);
+  EXPECT_TRUE((table = mysqlx_get_table(schema, "insert_test", 1)) != NULL);
+
+  stmt = mysqlx_table_insert_new(table);
+  EXPECT_EQ(RESULT_OK, mysqlx_set_insert_columns(stmt, "id", "val", "name", PARAM_END));
+  EXPECT_EQ(RESULT_ERROR, mysqlx_set_insert_arrays(stmt, cols, 2, 100));
+  printf("Expected error: %s\n", mysqlx_error_message(stmt));
+  EXPECT_EQ(RESULT_OK, mysqlx_set_insert_arrays(stmt, cols, 3, 100));
+  EXPECT_EQ(RESULT_OK, mysqlx_set_insert_chunk_size(stmt, 256));
+  CRUD_CHECK(res = mysqlx_execute(stmt), stmt);
+  EXPECT_EQ(100U, mysqlx_get_affected_count(res));
+
+  res = mysqlx_sql(get_session(), "SELECT id, val, name" \
+                   " FROM xapi_insert_test.insert_test ORDER BY id",
+                   MYSQLX_NULL_TERMINATED);
+  EXPECT_TRUE(res != NULL);
+
+  while ((row = mysqlx_row_fetch_one(res)) != NULL)
+  {
+    int64_t v_id = 0;
+    double v_val = 0;
+    char buf[32];
+    size_t buflen = sizeof(buf);
+
+    EXPECT_EQ(RESULT_OK, mysqlx_get_sint(row, 0, &v_id));
+    EXPECT_EQ(RESULT_OK, mysqlx_get_double(row, 1, &v_val));
+    EXPECT_EQ(id, v_id);
+    EXPECT_EQ(id + 0.5, v_val);
+
+    if (0 == id % 7)
+      EXPECT_EQ(RESULT_NULL, mysqlx_get_bytes(row, 2, 0, buf, &buflen));
+    else
+    {
+      EXPECT_EQ(RESULT_OK, mysqlx_get_bytes(row, 2, 0, buf, &buflen));
+      EXPECT_EQ(string(names + offsets[id], offsets[id + 1] - offsets[id]),
+                string(buf));
+    }
+    ++id;
+  }
+
+  EXPECT_EQ(100, id);
+
+  mysqlx_schema_drop(get_session(), "xapi_insert_test");
+}
+
+
 TEST_F(xapi, expr_in_expr)
 {
   SKIP_IF_NO_XPLUGIN